@@ -22,11 +22,13 @@ BufferPoolManager::~BufferPoolManager() {
 }
 
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+  // parallel scans fetch pages from several threads
+  std::lock_guard<recursive_mutex> guard(latch_);
   // 1.     Search the page table for the requested page (P).
   frame_id_t new_frame_id = 0;
   // 1.1    If P exists, pin it and return it immediately.
   if(page_table_.count(page_id)==1) {
-    replacer_->Pin(page_id);
+    replacer_->Pin((*page_table_.find(page_id)).second);
     if (pages_[(*page_table_.find(page_id)).second].pin_count_ < 0) std::cerr << "pin count < 0" << std::endl;
     pages_[(*page_table_.find(page_id)).second].pin_count_ = 1;
     return pages_ + (*page_table_.find(page_id)).second;
@@ -36,11 +38,13 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   if(free_list_.size()!=0) {
     new_frame_id = free_list_.front();
     free_list_.pop_front();
-  } else {
-    replacer_->Victim(&new_frame_id);
+  } else if (!replacer_->Victim(&new_frame_id)) {
+    return nullptr;
   }
   // 2.     If R is dirty, write it back to the disk.
-  if (pages_[new_frame_id].IsDirty() == 1) disk_manager_->WritePage(new_frame_id, pages_[new_frame_id].data_);
+  if (pages_[new_frame_id].IsDirty() == 1) {
+    disk_manager_->WritePage(pages_[new_frame_id].page_id_, pages_[new_frame_id].data_);
+  }
   // 3.     Delete R from the page table and insert P.
   if (page_table_.find(pages_[new_frame_id].page_id_)!=page_table_.end())
     page_table_.erase(page_table_.find(pages_[new_frame_id].page_id_));
@@ -56,6 +60,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
 }
 
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  std::lock_guard<recursive_mutex> guard(latch_);
   // 0.   Make sure you call AllocatePage!
   
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
@@ -75,7 +80,9 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
     free_list_.pop_front();
   } else {
     replacer_->Victim(&new_frame_id);
-    if (pages_[new_frame_id].IsDirty() == 1) disk_manager_->WritePage(new_frame_id, pages_[new_frame_id].data_);
+    if (pages_[new_frame_id].IsDirty() == 1) {
+      disk_manager_->WritePage(pages_[new_frame_id].page_id_, pages_[new_frame_id].data_);
+    }
     page_table_.erase(page_table_.find(pages_[new_frame_id].page_id_));
   }
   
@@ -92,6 +99,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
 }
 
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  std::lock_guard<recursive_mutex> guard(latch_);
   // 0.   Make sure you call DeallocatePage!
   disk_manager_->DeAllocatePage(page_id);
   // 1.   Search the page table for the requested page (P).
@@ -105,6 +113,7 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
     return false;
   }
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  replacer_->Pin(the_frame->second);
   pages_[the_frame->second].ResetMemory();
   free_list_.push_back(the_frame->second);
   page_table_.erase(page_id);
@@ -112,12 +121,14 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
 }
 
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::lock_guard<recursive_mutex> guard(latch_);
   replacer_->Unpin((*page_table_.find(page_id)).second);
   pages_[(*page_table_.find(page_id)).second].is_dirty_ |= is_dirty;
   pages_[(*page_table_.find(page_id)).second].pin_count_ = 0;
   return true;
 }
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  std::lock_guard<recursive_mutex> guard(latch_);
   if (pages_[(*page_table_.find(page_id)).second].IsDirty() == true) {
     disk_manager_->WritePage(page_id, pages_[(*page_table_.find(page_id)).second].data_);
   }
@@ -133,7 +144,29 @@ void BufferPoolManager::DeallocatePage(page_id_t page_id) {
   disk_manager_->DeAllocatePage(page_id);
 }
 
+bool BufferPoolManager::DeletePages(const std::vector<page_id_t> &page_ids) {
+  std::lock_guard<recursive_mutex> guard(latch_);
+  disk_manager_->DeAllocatePages(page_ids);
+  bool deleted = true;
+  for (auto page_id : page_ids) {
+    auto the_frame = page_table_.find(page_id);
+    if (the_frame == page_table_.end()) continue;
+    if (pages_[the_frame->second].pin_count_ != 0) {
+      std::cerr << "pined cannot delete" << endl;
+      deleted = false;
+      continue;
+    }
+    // a free frame must not be handed out by the replacer as well
+    replacer_->Pin(the_frame->second);
+    pages_[the_frame->second].ResetMemory();
+    free_list_.push_back(the_frame->second);
+    page_table_.erase(the_frame);
+  }
+  return deleted;
+}
+
 bool BufferPoolManager::IsPageFree(page_id_t page_id) {
+  std::lock_guard<recursive_mutex> guard(latch_);
   return disk_manager_->IsPageFree(page_id);
 }
  
@@ -22,10 +22,10 @@ void LRUReplacer::Pin(frame_id_t frame_id) {
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-  //full
-  if (m_track.size() >= m_size) exit(1);
   //exists
   if (m_table.count(frame_id) != 0) return;
+  //full
+  if (m_track.size() >= m_size) exit(1);
 
   m_track.push_front(frame_id);
   m_table.insert(make_pair(frame_id, m_track.begin()));
@@ -1,6 +1,8 @@
 #include "catalog/catalog.h"
+#include <atomic>
 #include <vector>
 #include <string>
+#include "page/statistics_page.h"
 void CatalogMeta::SerializeTo(char *buf) const {
   // ASSERT(false, "Not Implemented yet");
   uint32_t ofs = 0;
@@ -28,6 +30,8 @@ void CatalogMeta::SerializeTo(char *buf) const {
     ofs = ofs + 4;
   }
 
+  MACH_WRITE_UINT32(buf + ofs, row_format_version_);
+  ofs = ofs + 4;
 }
 
 CatalogMeta *CatalogMeta::DeserializeFrom(char *buf, MemHeap *heap) {
@@ -72,16 +76,25 @@ CatalogMeta *CatalogMeta::DeserializeFrom(char *buf, MemHeap *heap) {
     my_catalogmeta->index_meta_pages_[tmp_index_id] = tmp_page_id;
   }
 
+  // catalogs written before the row format version have zero here
+  my_catalogmeta->row_format_version_ = MACH_READ_UINT32(buf + ofs);
+  ofs = ofs + 4;
+
   return my_catalogmeta;
 }
 
 uint32_t CatalogMeta::GetSerializedSize() const { 
-    return 12 + table_meta_pages_.size() * 8 + index_meta_pages_.size() * 8; 
+    return 16 + table_meta_pages_.size() * 8 + index_meta_pages_.size() * 8; 
 }
 
 CatalogMeta::CatalogMeta() {}
 
 
+uint64_t CatalogManager::NextVersion() {
+  static std::atomic<uint64_t> last_version{0};
+  return ++last_version;
+}
+
 CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
                                LogManager *log_manager, bool init)
         : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
@@ -107,7 +120,10 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
       TableInfo* tinfo=nullptr;
       tinfo = TableInfo::Create(heap_);
       TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, meta->GetFirstPageId(), meta->GetSchema(), 
-                                                 log_manager_, lock_manager_, heap_);
+                                                 log_manager_, lock_manager_, heap_, meta->GetLayout(),
+                                                 meta->GetDirectoryPageId());
+      AttachPageDirectory(meta, table_heap, it.second);
+      LoadStatistics(meta);
       tinfo->Init(meta, table_heap);
       table_names_[meta->GetTableName()] = meta->GetTableId();
       tables_[meta->GetTableId()] = tinfo;
@@ -128,33 +144,64 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
     }
 
     buffer_pool_manager->UnpinPage(CATALOG_META_PAGE_ID, false);
+
+    // rewrite the rows of a database created with an older row format, the new version is only stored
+    // once no legacy row is left, otherwise the migration is retried when the database is opened again
+    if (catalog_meta_->row_format_version_ != Row::ROW_FORMAT_VERSION) {
+      bool migrated = true;
+      for (auto it : tables_) {
+        std::vector<std::pair<RowId, RowId>> moved;
+        if (!it.second->GetTableHeap()->MigrateRowFormat(moved, nullptr)) {
+          migrated = false;
+        }
+        MoveIndexEntries(it.second, moved);
+      }
+      if (migrated) {
+        catalog_meta_->row_format_version_ = Row::ROW_FORMAT_VERSION;
+      } else {
+        std::cerr << "Rows in the old format are left, they are rewritten when the database is opened again\n";
+      }
+    }
   }
 }
 
 CatalogManager::~CatalogManager() {
+  // the statistics changed by inserts and deletes are written once, when the database is closed
+  for (auto &it : statistics_) {
+    if (it.second.dirty_) {
+      WriteStatistics(it.first);
+    }
+  }
   catalog_meta_->SerializeTo((buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID))->GetData());
   buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
   delete heap_;
 }
 
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema,
-                                    Transaction *txn, TableInfo *&table_info) {
+                                    Transaction *txn, TableInfo *&table_info, TableLayout layout) {
   // ASSERT(false, "Not Implemented yet");
   if(table_names_.find(table_name) != table_names_.end()){ //table exist
     return DB_TABLE_ALREADY_EXIST;
   }
+  version_ = NextVersion();
   table_info = TableInfo::Create(heap_);
   page_id_t page_id; //分配数据页
   Page* new_table_page = buffer_pool_manager_->NewPage(page_id);
   catalog_meta_->table_meta_pages_[next_table_id_] = page_id;
 
-  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,schema,txn,log_manager_,lock_manager_,table_info->GetMemHeap());
-  TableMetadata *table_meta = TableMetadata::Create(next_table_id_,table_name,table_heap->GetFirstPageId(),schema,heap_);
+  TableHeap *table_heap =
+      TableHeap::Create(buffer_pool_manager_, schema, txn, log_manager_, lock_manager_, table_info->GetMemHeap(), layout);
+  TableMetadata *table_meta =
+      TableMetadata::Create(next_table_id_, table_name, table_heap->GetFirstPageId(), schema, heap_, layout,
+                            table_heap->GetDirectoryPageId());
 
   // cout << table_heap->GetFirstPageId() <<endl; 
 
   table_info->Init(table_meta, table_heap);
   tables_[next_table_id_] = table_info; //update tables_
+  // the statistics of a new table follow its rows from the start
+  statistics_[next_table_id_] = TableStatistics(schema->GetColumnCount());
+  WriteStatistics(next_table_id_);
   
   table_meta->SerializeTo(new_table_page->GetData());
   
@@ -216,7 +263,6 @@ dberr_t CatalogManager::GetTable(const string &table_name, TableInfo *&table_inf
   auto tmp = table_names_.find(table_name);
     if (tmp != table_names_.end()){ //find the table
       auto table_id = tmp->second;
-      cout << "get_table_id: " << table_id << endl;
       table_info = tables_[table_id];
       return DB_SUCCESS;
     }
@@ -278,15 +324,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   index_info->Init(index_meta_data_ptr,table_info,buffer_pool_manager_);
   //put all the info into the new index
 
-  std::vector<Field> tmp_fields;
-  for (auto i = table_info->GetTableHeap()->Begin(nullptr); i != table_info->GetTableHeap()->End(); i++) {
-    tmp_fields.clear();
-    //get the key_field
-    for (auto j : key_map) tmp_fields.push_back(*(i->GetField(j)));
-    //ctor the key_row
-    Row tmp_row = Row(tmp_fields);
-    index_info->GetIndex()->InsertEntry(tmp_row, i->GetRowId(), nullptr);
-  }
+  FillIndex(table_info, index_info, key_map);
 
   //将index的信息写入index_roots_page
   page_id_t page_id;
@@ -294,6 +332,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   catalog_meta_->index_meta_pages_[next_index_id_]=page_id; //update catalog_meta_
   catalog_meta_->SerializeTo((buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID))->GetData());
   cout<<"CreatIndex Success, <tid, pid> = "<<next_index_id_<<", "<<page_id<<endl;
+  version_ = NextVersion();
   indexes_[next_index_id_] = index_info; //update indexes_
   index_names_[table_name][index_name] = next_index_id_++; //update index_names_ & next_index_id_
 
@@ -303,6 +342,41 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   return DB_SUCCESS;
 }
 
+void CatalogManager::FillIndex(TableInfo *table_info, IndexInfo *index_info, const std::vector<uint32_t> &key_map) {
+  // the keys of a page are built in an arena which is reset when the scan moves to the next page
+  ArenaMemHeap scan_heap;
+  page_id_t scan_page_id = INVALID_PAGE_ID;
+  for (auto i = table_info->GetTableHeap()->ViewBegin(&key_map); !i.IsEnd(); ++i) {
+    if (i->GetRowId().GetPageId() != scan_page_id) {
+      scan_page_id = i->GetRowId().GetPageId();
+      scan_heap.Reset();
+    }
+    Row key_row(i->GetRowId(), &scan_heap);
+    i->Project(key_map, &key_row);
+    index_info->GetIndex()->InsertEntry(key_row, i->GetRowId(), nullptr);
+  }
+}
+
+void CatalogManager::MoveIndexEntries(TableInfo *table_info, const std::vector<std::pair<RowId, RowId>> &moved) {
+  if (moved.empty()) {
+    return;
+  }
+  for (auto &it : index_names_[table_info->GetTableName()]) {
+    IndexInfo *index_info = indexes_[it.second];
+    for (auto &move : moved) {
+      Row row(move.second);
+      table_info->GetTableHeap()->GetTuple(&row, nullptr);
+      std::vector<Field> fields;
+      for (auto column : index_info->GetIndexKeySchema()->GetColumns()) {
+        fields.push_back(*row.GetField(column->GetTableInd()));
+      }
+      Row key_row(fields);
+      index_info->GetIndex()->RemoveEntry(key_row, move.first, nullptr);
+      index_info->GetIndex()->InsertEntry(key_row, move.second, nullptr);
+    }
+  }
+}
+
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<Column*> &index_keys, Transaction *txn) {
   // ASSERT(false, "Not Implemented yet");
@@ -330,15 +404,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   index_info->Init(index_meta_data_ptr, table_info, buffer_pool_manager_);
   // put all the info into the new index
 
-  std::vector<Field> tmp_fields;
-  for (auto i = table_info->GetTableHeap()->Begin(nullptr); i != table_info->GetTableHeap()->End(); i++) {
-    tmp_fields.clear();
-    // get the key_field
-    for (auto j : key_map) tmp_fields.push_back(*(i->GetField(j)));
-    // ctor the key_row
-    Row tmp_row = Row(tmp_fields);
-    index_info->GetIndex()->InsertEntry(tmp_row, i->GetRowId(), nullptr);
-  }
+  FillIndex(table_info, index_info, key_map);
 
   //将index的信息写入index_roots_page
   page_id_t page_id;
@@ -346,6 +412,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   catalog_meta_->index_meta_pages_[next_index_id_] = page_id;  // update catalog_meta_
   catalog_meta_->SerializeTo((buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID))->GetData());
   cout << "CreatIndex Success, <tid, pid> = " << next_index_id_ << ", " << page_id << endl;
+  version_ = NextVersion();
   indexes_[next_index_id_] = index_info;                    // update indexes_
   index_names_[table_name][index_name] = next_index_id_++;  // update index_names_ & next_index_id_
 
@@ -393,6 +460,7 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   // ASSERT(false, "Not Implemented yet");
   auto tmp = table_names_.find(table_name);
   if (tmp != table_names_.end()){ //find the table
+    version_ = NextVersion();
     // auto table_id = tmp->second;
     auto index = index_names_.find(table_name);
     std::vector<std::string> del_indexs;
@@ -405,12 +473,14 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
       DropIndex(table_name, i);
     }
 
+    FreeStatistics(tables_[tmp->second]->GetTableMetadata()->GetStatisticsPageId());
     //delete metapage
     buffer_pool_manager_->DeletePage((catalog_meta_->table_meta_pages_[tmp->second]));
     catalog_meta_->table_meta_pages_.erase(tmp->second);
     // delete the table in disk
     tables_[tmp->second]->GetTableHeap()->FreeHeap();
     //delete metadata
+    statistics_.erase(tmp->second);
     tables_.erase(tmp->second);      // delete tables_
     table_names_.erase(table_name); //delete table_names_
     index_names_.erase(table_name); //delete index_names_
@@ -419,6 +489,104 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   else return DB_TABLE_NOT_EXIST; // not find
 }
 
+dberr_t CatalogManager::TruncateTable(const string &table_name) {
+  auto it = table_names_.find(table_name);
+  if (it == table_names_.end()) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  TableInfo *table_info = tables_[it->second];
+  table_info->GetTableHeap()->Truncate(nullptr);
+  for (auto &index : index_names_[table_name]) {
+    indexes_[index.second]->GetIndex()->Clear();
+  }
+  SetStatistics(it->second, TableStatistics(table_info->GetSchema()->GetColumnCount()));
+  return DB_SUCCESS;
+}
+
+TableStatistics *CatalogManager::GetStatistics(table_id_t table_id) {
+  auto it = statistics_.find(table_id);
+  return it == statistics_.end() ? nullptr : &it->second;
+}
+
+void CatalogManager::SetStatistics(table_id_t table_id, TableStatistics statistics) {
+  statistics_[table_id] = std::move(statistics);
+  WriteStatistics(table_id);
+}
+
+void CatalogManager::WriteStatistics(table_id_t table_id) {
+  TableStatistics &statistics = statistics_[table_id];
+  TableMetadata *table_meta = tables_[table_id]->GetTableMetadata();
+  std::vector<char> buf;
+  statistics.SerializeTo(buf);
+  // the pages of the stored chain are written over, so only a first write changes the table metadata
+  page_id_t page_id = table_meta->GetStatisticsPageId();
+  bool reused = page_id != INVALID_PAGE_ID;
+  Page *page = reused ? buffer_pool_manager_->FetchPage(page_id) : buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    std::cerr << "Statistics of table " << table_id << " can not be stored\n";
+    return;
+  }
+  page_id_t first_page_id = page_id;
+  uint32_t offset = 0;
+  while (page != nullptr) {
+    auto *statistics_page = reinterpret_cast<StatisticsPage *>(page->GetData());
+    page_id_t old_next_page_id = reused ? statistics_page->GetNextPageId() : INVALID_PAGE_ID;
+    uint32_t size = std::min<uint32_t>(StatisticsPage::MAX_DATA_SIZE, buf.size() - offset);
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    Page *next_page = nullptr;
+    if (offset + size < buf.size()) {
+      reused = old_next_page_id != INVALID_PAGE_ID;
+      next_page_id = old_next_page_id;
+      next_page = reused ? buffer_pool_manager_->FetchPage(next_page_id) : buffer_pool_manager_->NewPage(next_page_id);
+      if (next_page == nullptr) {
+        // cut short, which fails to read back, so the next analyze gathers them again
+        std::cerr << "Statistics of table " << table_id << " can not be stored\n";
+        next_page_id = INVALID_PAGE_ID;
+      }
+    } else {
+      FreeStatistics(old_next_page_id);
+    }
+    statistics_page->Init(next_page_id, buf.data() + offset, size);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    offset += size;
+    page = next_page;
+    page_id = next_page_id;
+  }
+  if (table_meta->GetStatisticsPageId() != first_page_id) {
+    table_meta->SetStatisticsPageId(first_page_id);
+    page_id_t meta_page_id = catalog_meta_->table_meta_pages_[table_id];
+    table_meta->SerializeTo(buffer_pool_manager_->FetchPage(meta_page_id)->GetData());
+    buffer_pool_manager_->UnpinPage(meta_page_id, true);
+  }
+  statistics.dirty_ = false;
+}
+
+void CatalogManager::LoadStatistics(TableMetadata *table_meta) {
+  std::vector<char> buf;
+  for (page_id_t page_id = table_meta->GetStatisticsPageId(); page_id != INVALID_PAGE_ID;) {
+    auto *page = reinterpret_cast<StatisticsPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    buf.insert(buf.end(), page->GetData(), page->GetData() + page->GetDataSize());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  TableStatistics statistics;
+  if (!buf.empty() && TableStatistics::DeserializeFrom(buf.data(), buf.size(), statistics) &&
+      statistics.columns_.size() == table_meta->GetSchema()->GetColumnCount()) {
+    statistics_[table_meta->GetTableId()] = std::move(statistics);
+  }
+}
+
+void CatalogManager::FreeStatistics(page_id_t first_page_id) {
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *page = reinterpret_cast<StatisticsPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
 dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_name) {
   // ASSERT(false, "Not Implemented yet");
   auto tmp_table = index_names_.find(table_name);
@@ -429,6 +597,7 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
       return DB_INDEX_NOT_FOUND;
     }
     auto index_id = tmp_index_id->second;
+    version_ = NextVersion();
     //1. delete index metapage
     buffer_pool_manager_->DeletePage((catalog_meta_->index_meta_pages_[index_id]));
     catalog_meta_->index_meta_pages_.erase(index_id);
@@ -457,7 +626,9 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   TableMetadata::DeserializeFrom(buffer_pool_manager_->FetchPage(page_id)->GetData(),table_meta,table_info->GetMemHeap());
   ASSERT(table_meta != nullptr,"TABLEINFO INIT ERROR");
   //根据table_meta信息生成table_heap
-  auto *table_heap = TableHeap::Create(buffer_pool_manager_,table_meta->GetFirstPageId(),table_meta->GetSchema(),log_manager_,lock_manager_,table_info->GetMemHeap());
+  auto *table_heap = TableHeap::Create(buffer_pool_manager_,table_meta->GetFirstPageId(),table_meta->GetSchema(),log_manager_,lock_manager_,table_info->GetMemHeap(),table_meta->GetLayout(),table_meta->GetDirectoryPageId());
+  AttachPageDirectory(table_meta, table_heap, page_id);
+  LoadStatistics(table_meta);
   //初始化table_info并插入catalogManager
   table_info->Init(table_meta, table_heap);
   tables_[table_id] = table_info;
@@ -468,6 +639,15 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
   return DB_SUCCESS;
 }
 
+void CatalogManager::AttachPageDirectory(TableMetadata *table_meta, TableHeap *table_heap, page_id_t page_id) {
+  if (table_meta->GetDirectoryPageId() != INVALID_PAGE_ID) {
+    return;
+  }
+  table_meta->SetDirectoryPageId(table_heap->BuildPageDirectory());
+  table_meta->SerializeTo(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
 dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t page_id) {
   // ASSERT(false, "Not Implemented yet");
   //新建写入内存的index_info
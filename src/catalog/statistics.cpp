@@ -0,0 +1,410 @@
+#include "catalog/statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "common/hash_util.h"
+#include "record/filter_kernels.h"
+
+double HyperLogLog::Estimate() const {
+  static const std::vector<double> powers = [] {
+    std::vector<double> powers(65);
+    for (int rank = 0; rank <= 64; rank++) powers[rank] = std::ldexp(1.0, -rank);
+    return powers;
+  }();
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (uint8_t rank : registers_) {
+    sum += powers[rank];
+    zeros += rank == 0;
+  }
+  double m = REGISTER_COUNT;
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  if (estimate <= 2.5 * m && zeros > 0) {
+    // linear counting is more accurate while many registers are still empty
+    estimate = m * std::log(m / zeros);
+  }
+  return estimate;
+}
+
+double ColumnStatistics::FractionBelow(double key) const {
+  if (bounds_.empty() || key <= bounds_.front()) {
+    return 0;
+  }
+  if (key > bounds_.back()) {
+    return 1;
+  }
+  // bounds_[i - 1] < key <= bounds_[i], the values are taken as spread evenly within a bucket
+  size_t i = std::lower_bound(bounds_.begin(), bounds_.end(), key) - bounds_.begin();
+  double low = bounds_[i - 1], high = bounds_[i];
+  double within = high > low ? (key - low) / (high - low) : 0;
+  return (static_cast<double>(i - 1) + within) / static_cast<double>(bounds_.size() - 1);
+}
+
+void ColumnStatistics::Refresh(uint64_t non_null_count) {
+  changes_ = 0;
+  distinct_count_ = std::min<uint64_t>(std::llround(distinct_.Estimate()), non_null_count);
+  if (non_null_count > 0) {
+    distinct_count_ = std::max<uint64_t>(distinct_count_, 1);
+  }
+  bounds_.clear();
+  if (sample_.empty()) {
+    return;
+  }
+  std::vector<double> keys = sample_;
+  std::sort(keys.begin(), keys.end());
+  size_t buckets = std::min<size_t>(TableStatistics::HISTOGRAM_BUCKETS, keys.size() - 1);
+  for (size_t j = 0; j <= buckets; j++) {
+    bounds_.push_back(keys[buckets == 0 ? 0 : (keys.size() - 1) * j / buckets]);
+  }
+  if (value_count_ == sample_.size()) {
+    // every value is sampled, which also drops the extremes deleted since
+    min_ = keys.front();
+    max_ = keys.back();
+  }
+  // the sample may miss the extremes
+  bounds_.front() = std::min(bounds_.front(), min_);
+  bounds_.back() = std::max(bounds_.back(), max_);
+}
+
+void TableStatistics::AddValue(uint32_t column, bool is_null, double key, uint64_t hash) {
+  ColumnStatistics &stats = columns_[column];
+  stats.changes_++;
+  if (is_null) {
+    stats.null_count_++;
+    return;
+  }
+  if (stats.value_count_ == 0) {
+    stats.min_ = stats.max_ = key;
+  }
+  stats.min_ = std::min(stats.min_, key);
+  stats.max_ = std::max(stats.max_, key);
+  // a value out of the histogram widens the edge buckets until the next refresh
+  if (!stats.bounds_.empty() && key < stats.bounds_.front()) {
+    if (stats.bounds_.size() == 1) {
+      stats.bounds_.insert(stats.bounds_.begin(), key);
+    } else {
+      stats.bounds_.front() = key;
+    }
+  } else if (!stats.bounds_.empty() && key > stats.bounds_.back()) {
+    if (stats.bounds_.size() == 1) {
+      stats.bounds_.push_back(key);
+    } else {
+      stats.bounds_.back() = key;
+    }
+  }
+  stats.distinct_.Add(hash);
+  stats.value_count_++;
+  if (stats.sample_.size() < ColumnStatistics::SAMPLE_SIZE) {
+    stats.sample_.push_back(key);
+  } else {
+    uint64_t slot = random_() % stats.value_count_;
+    if (slot < ColumnStatistics::SAMPLE_SIZE) {
+      stats.sample_[slot] = key;
+    }
+  }
+}
+
+void TableStatistics::RemoveValue(uint32_t column, bool is_null, double key) {
+  ColumnStatistics &stats = columns_[column];
+  stats.changes_++;
+  if (is_null) {
+    stats.null_count_ -= stats.null_count_ > 0;
+    return;
+  }
+  // the removed value is the sampled one with the share of the sampled copies among all its copies,
+  // which are guessed from the distinct count
+  uint64_t sampled = std::count(stats.sample_.begin(), stats.sample_.end(), key);
+  if (sampled > 0) {
+    double copies = static_cast<double>(stats.value_count_) / std::max<uint64_t>(stats.distinct_count_, 1);
+    if (std::uniform_real_distribution<double>(0, 1)(random_) * std::max<double>(copies, sampled) < sampled) {
+      auto iter = std::find(stats.sample_.begin(), stats.sample_.end(), key);
+      *iter = stats.sample_.back();
+      stats.sample_.pop_back();
+    }
+  }
+  stats.value_count_ = std::max<uint64_t>(stats.value_count_ - (stats.value_count_ > 0), stats.sample_.size());
+}
+
+void TableStatistics::InsertRow(const Row &row) {
+  for (uint32_t column = 0; column < columns_.size(); column++) {
+    const Field *field = row.GetField(column);
+    if (field->IsNull()) {
+      AddValue(column, true, 0, 0);
+    } else {
+      AddValue(column, false, OrderKey(*field), HashValue(*field));
+    }
+  }
+  row_count_++;
+  dirty_ = true;
+}
+
+void TableStatistics::RemoveRow(const Row &row) {
+  for (uint32_t column = 0; column < columns_.size(); column++) {
+    const Field *field = row.GetField(column);
+    RemoveValue(column, field->IsNull(), field->IsNull() ? 0 : OrderKey(*field));
+  }
+  row_count_ -= row_count_ > 0;
+  dirty_ = true;
+}
+
+void TableStatistics::Refresh() {
+  for (ColumnStatistics &stats : columns_) {
+    uint64_t non_null_count = row_count_ - std::min(row_count_, stats.null_count_);
+    if (stats.NeedsRefresh(non_null_count)) {
+      stats.Refresh(non_null_count);
+    }
+    stats.distinct_count_ = std::min(stats.distinct_count_, non_null_count);
+  }
+}
+
+double TableStatistics::Selectivity(uint32_t column, CompareOp op, const Field &value) const {
+  if (value.IsNull()) {
+    return 0;
+  }
+  if (column >= columns_.size()) {
+    return DefaultSelectivity(op);
+  }
+  const ColumnStatistics &stats = columns_[column];
+  if (row_count_ == 0 || stats.bounds_.empty()) {
+    return 0;
+  }
+  double non_null =
+      static_cast<double>(row_count_ - std::min(row_count_, stats.null_count_)) / static_cast<double>(row_count_);
+  double key = OrderKey(value);
+  double eq = 0;
+  if (key >= stats.bounds_.front() && key <= stats.bounds_.back()) {
+    eq = 1.0 / static_cast<double>(std::max<uint64_t>(stats.distinct_count_, 1));
+    // a value filling whole buckets is more frequent than the average one
+    auto range = std::equal_range(stats.bounds_.begin(), stats.bounds_.end(), key);
+    if (range.second - range.first > 1) {
+      eq = std::max(eq, static_cast<double>(range.second - range.first - 1) / (stats.bounds_.size() - 1));
+    }
+  }
+  // the values equal to key are not below it, even at the max
+  double below = std::min(stats.FractionBelow(key), 1 - eq);
+  double share = 0;
+  switch (op) {
+    case kCmpEq:
+      share = eq;
+      break;
+    case kCmpNe:
+      share = 1 - eq;
+      break;
+    case kCmpLt:
+      share = below;
+      break;
+    case kCmpLe:
+      share = below + eq;
+      break;
+    case kCmpGt:
+      share = 1 - below - eq;
+      break;
+    case kCmpGe:
+      share = 1 - below;
+      break;
+    default:
+      return DefaultSelectivity(op);
+  }
+  return non_null * std::min(1.0, std::max(0.0, share));
+}
+
+double TableStatistics::DefaultSelectivity(CompareOp op) {
+  switch (op) {
+    case kCmpEq:
+      return DEFAULT_EQ_SELECTIVITY;
+    case kCmpNe:
+      return 1 - DEFAULT_EQ_SELECTIVITY;
+    default:
+      return DEFAULT_RANGE_SELECTIVITY;
+  }
+}
+
+double TableStatistics::OrderKey(const Field &value) {
+  switch (value.type_id_) {
+    case kTypeInt:
+      return value.value_.integer_;
+    case kTypeFloat:
+      return value.value_.float_;
+    default:
+      return OrderKey(value.value_.chars_, value.len_);
+  }
+}
+
+double TableStatistics::OrderKey(const char *chars, uint32_t length) {
+  // 6 bytes fit the mantissa of a double exactly
+  double key = 0;
+  for (uint32_t i = 0; i < 6; i++) {
+    key = key * 256 + (i < length ? static_cast<unsigned char>(chars[i]) : 0);
+  }
+  return key;
+}
+
+std::string TableStatistics::OrderKeyChars(double key) {
+  std::string chars(6, '\0');
+  uint64_t bits = static_cast<uint64_t>(key);
+  for (int i = 5; i >= 0; i--) {
+    chars[i] = static_cast<char>(bits & 0xff);
+    bits >>= 8;
+  }
+  chars.resize(strnlen(chars.data(), chars.size()));
+  return chars;
+}
+
+uint64_t TableStatistics::HashValue(const Field &value) {
+  if (value.type_id_ == kTypeChar) {
+    return HashBytes(value.value_.chars_, value.len_);
+  }
+  return HashValue(value.type_id_, value.value_.integer_, value.value_.float_);
+}
+
+uint64_t TableStatistics::HashValue(TypeId type, int32_t integer, float real) {
+  if (type == kTypeFloat) {
+    if (real == 0) real = 0;
+    return HashBytes(reinterpret_cast<const char *>(&real), sizeof(float));
+  }
+  return HashBytes(reinterpret_cast<const char *>(&integer), sizeof(int32_t));
+}
+
+template <typename T>
+static void Append(std::vector<char> &buf, const T &value) {
+  size_t offset = buf.size();
+  buf.resize(offset + sizeof(T));
+  memcpy(buf.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static bool Take(const char *&buf, const char *end, T &value) {
+  if (end - buf < static_cast<ptrdiff_t>(sizeof(T))) {
+    return false;
+  }
+  memcpy(&value, buf, sizeof(T));
+  buf += sizeof(T);
+  return true;
+}
+
+static void AppendKeys(std::vector<char> &buf, const std::vector<double> &keys) {
+  Append(buf, static_cast<uint32_t>(keys.size()));
+  for (double key : keys) {
+    Append(buf, key);
+  }
+}
+
+static bool TakeKeys(const char *&buf, const char *end, std::vector<double> &keys, uint32_t max_size) {
+  uint32_t size;
+  if (!Take(buf, end, size) || size > max_size) {
+    return false;
+  }
+  keys.resize(size);
+  for (double &key : keys) {
+    if (!Take(buf, end, key)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TableStatistics::SerializeTo(std::vector<char> &buf) const {
+  Append(buf, STATISTICS_MAGIC_NUM);
+  Append(buf, row_count_);
+  Append(buf, page_count_);
+  Append(buf, static_cast<uint32_t>(columns_.size()));
+  for (const ColumnStatistics &stats : columns_) {
+    Append(buf, stats.null_count_);
+    Append(buf, stats.value_count_);
+    Append(buf, stats.distinct_count_);
+    Append(buf, stats.min_);
+    Append(buf, stats.max_);
+    Append(buf, stats.changes_);
+    AppendKeys(buf, stats.sample_);
+    AppendKeys(buf, stats.bounds_);
+    const std::vector<uint8_t> &registers = stats.distinct_.GetRegisters();
+    buf.insert(buf.end(), registers.begin(), registers.end());
+  }
+}
+
+bool TableStatistics::DeserializeFrom(const char *buf, uint32_t size, TableStatistics &statistics) {
+  const char *end = buf + size;
+  uint32_t magic_num, column_count;
+  if (!Take(buf, end, magic_num) || magic_num != STATISTICS_MAGIC_NUM) {
+    return false;
+  }
+  if (!Take(buf, end, statistics.row_count_) || !Take(buf, end, statistics.page_count_) ||
+      !Take(buf, end, column_count)) {
+    return false;
+  }
+  statistics.columns_.assign(column_count, ColumnStatistics());
+  for (ColumnStatistics &stats : statistics.columns_) {
+    if (!Take(buf, end, stats.null_count_) || !Take(buf, end, stats.value_count_) ||
+        !Take(buf, end, stats.distinct_count_) || !Take(buf, end, stats.min_) || !Take(buf, end, stats.max_) ||
+        !Take(buf, end, stats.changes_) || !TakeKeys(buf, end, stats.sample_, ColumnStatistics::SAMPLE_SIZE) ||
+        !TakeKeys(buf, end, stats.bounds_, HISTOGRAM_BUCKETS + 1)) {
+      return false;
+    }
+    std::vector<uint8_t> &registers = stats.distinct_.GetRegisters();
+    if (end - buf < static_cast<ptrdiff_t>(registers.size())) {
+      return false;
+    }
+    memcpy(registers.data(), buf, registers.size());
+    buf += registers.size();
+  }
+  statistics.dirty_ = false;
+  return true;
+}
+
+void StatisticsBuilder::AddChunk(const DataChunk &chunk) {
+  const uint64_t *visible = chunk.GetVisible();
+  for (uint32_t w = 0; w < SelectionWords(chunk.GetSize()); w++) {
+    statistics_.row_count_ += __builtin_popcountll(visible[w]);
+  }
+  for (uint32_t column = 0; column < schema_->GetColumnCount(); column++) {
+    TypeId type = schema_->GetColumn(column)->GetType();
+    std::vector<double> &keys = keys_[column];
+    ForEachSelected(visible, chunk.GetSize(), [&](uint32_t i) {
+      if (chunk.IsNull(i, column)) {
+        statistics_.AddValue(column, true, 0, 0);
+        return;
+      }
+      double key;
+      uint64_t hash;
+      if (type == kTypeInt) {
+        int32_t value = chunk.GetInt(i, column);
+        key = value;
+        hash = TableStatistics::HashValue(type, value, 0);
+      } else if (type == kTypeFloat) {
+        float value = chunk.GetFloat(i, column);
+        key = value;
+        hash = TableStatistics::HashValue(type, 0, value);
+      } else {
+        const char *chars = chunk.GetChars(i, column);
+        uint32_t length = chunk.GetCharLength(i, column);
+        key = TableStatistics::OrderKey(chars, length);
+        hash = HashBytes(chars, length);
+      }
+      keys.push_back(key);
+      statistics_.AddValue(column, false, key, hash);
+    });
+  }
+}
+
+TableStatistics StatisticsBuilder::Finish(uint32_t page_count) {
+  statistics_.page_count_ = page_count;
+  statistics_.dirty_ = true;
+  for (uint32_t column = 0; column < schema_->GetColumnCount(); column++) {
+    ColumnStatistics &stats = statistics_.columns_[column];
+    stats.Refresh(stats.value_count_);
+    // the whole column gives a better histogram than the sample
+    std::vector<double> &keys = keys_[column];
+    if (!keys.empty()) {
+      std::sort(keys.begin(), keys.end());
+      size_t buckets = std::min<size_t>(TableStatistics::HISTOGRAM_BUCKETS, keys.size() - 1);
+      stats.bounds_.clear();
+      for (size_t j = 0; j <= buckets; j++) {
+        stats.bounds_.push_back(keys[buckets == 0 ? 0 : (keys.size() - 1) * j / buckets]);
+      }
+    }
+    std::vector<double>().swap(keys);
+  }
+  return statistics_;
+}
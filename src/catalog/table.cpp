@@ -18,13 +18,22 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   MACH_WRITE_INT32(buf + ofs, root_page_id_);
   ofs = ofs + 4;
 
+  MACH_WRITE_UINT32(buf + ofs, layout_);
+  ofs = ofs + 4;
+
+  MACH_WRITE_INT32(buf + ofs, directory_page_id_);
+  ofs = ofs + 4;
+
+  MACH_WRITE_INT32(buf + ofs, statistics_page_id_);
+  ofs = ofs + 4;
+
   ofs = ofs + schema_->SerializeTo(buf + ofs);
 
   return ofs;
 }
 
 uint32_t TableMetadata::GetSerializedSize() const { 
-  return 16 + table_name_.length() + schema_->GetSerializedSize(); 
+  return 28 + table_name_.length() + schema_->GetSerializedSize(); 
 }
 
 /**
@@ -41,7 +50,8 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   }
 
   uint32_t Magic_Number = MACH_READ_UINT32(buf + ofs);
-  if (Magic_Number != 344528) {
+  if (Magic_Number != TABLE_METADATA_MAGIC_NUM && Magic_Number != TABLE_METADATA_MAGIC_NUM_V3 &&
+      Magic_Number != TABLE_METADATA_MAGIC_NUM_V2 && Magic_Number != TABLE_METADATA_MAGIC_NUM_V1) {
     std::cerr << "TABLE_METADATA_MAGIC_NUM does not match" << std::endl;
     return 0;
   } else {
@@ -65,10 +75,29 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   table_id_t root_page_id_ = MACH_READ_INT32(buf + ofs);
   ofs = ofs + 4;
 
+  TableLayout layout = kLayoutRow;
+  if (Magic_Number != TABLE_METADATA_MAGIC_NUM_V1) {
+    layout = static_cast<TableLayout>(MACH_READ_UINT32(buf + ofs));
+    ofs = ofs + 4;
+  }
+
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  if (Magic_Number == TABLE_METADATA_MAGIC_NUM || Magic_Number == TABLE_METADATA_MAGIC_NUM_V3) {
+    directory_page_id = MACH_READ_INT32(buf + ofs);
+    ofs = ofs + 4;
+  }
+
+  page_id_t statistics_page_id = INVALID_PAGE_ID;
+  if (Magic_Number == TABLE_METADATA_MAGIC_NUM) {
+    statistics_page_id = MACH_READ_INT32(buf + ofs);
+    ofs = ofs + 4;
+  }
+
   Schema *schema;
   ofs = ofs + Schema::DeserializeFrom(buf + ofs, schema, heap);
 
-  table_meta = ALLOC_P(heap, TableMetadata)(table_id, table_name, root_page_id_, schema);
+  table_meta = ALLOC_P(heap, TableMetadata)(table_id, table_name, root_page_id_, schema, layout, directory_page_id,
+                                            statistics_page_id);
 
   return ofs;
 }
@@ -79,11 +108,20 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name,
-                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap) {
+                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                                     TableLayout layout, page_id_t directory_page_id, page_id_t statistics_page_id) {
   // allocate space for table metadata
   void *buf = heap->Allocate(sizeof(TableMetadata));
-  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema);
+  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema, layout, directory_page_id,
+                               statistics_page_id);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             TableLayout layout, page_id_t directory_page_id, page_id_t statistics_page_id)
+        : table_id_(table_id),
+          table_name_(table_name),
+          root_page_id_(root_page_id),
+          schema_(schema),
+          layout_(layout),
+          directory_page_id_(directory_page_id),
+          statistics_page_id_(statistics_page_id) {}
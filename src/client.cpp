@@ -0,0 +1,165 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "server/server.h"
+
+struct ClientOptions {
+  std::string host{"127.0.0.1"};
+  uint16_t port{0};
+  std::string socket_path;
+  std::string script;       // replay this file instead of reading stdin
+  uint32_t connections{1};  // concurrent connections used to replay the script
+};
+
+static int Connect(const ClientOptions &options) {
+  int fd;
+  if (!options.socket_path.empty()) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, options.socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+      return fd;
+    }
+  } else {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(options.port);
+    inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0) {
+      return fd;
+    }
+  }
+  std::cerr << "connect: " << strerror(errno) << std::endl;
+  if (fd >= 0) close(fd);
+  return -1;
+}
+
+/**
+ * Read the next statement terminated by ';'. Returns false at end of input.
+ */
+static bool NextStatement(std::istream &in, std::string &statement) {
+  statement.clear();
+  char ch;
+  bool in_string = false;
+  while (in.get(ch)) {
+    if (ch == '"') in_string = !in_string;
+    if (statement.empty() && isspace(ch)) continue;
+    statement.push_back(ch);
+    if (ch == ';' && !in_string) return true;
+  }
+  return false;
+}
+
+static int Interactive(const ClientOptions &options) {
+  int fd = Connect(options);
+  if (fd < 0) return 1;
+  std::string statement, reply;
+  while (true) {
+    std::cout << "minisql > " << std::flush;
+    if (!NextStatement(std::cin, statement)) break;
+    // a server turning the connection away replies before reading the request
+    bool sent = SendFrame(fd, statement);
+    if (!RecvFrame(fd, reply) || reply.empty()) {
+      std::cerr << "connection closed by server" << std::endl;
+      break;
+    }
+    std::cout.write(reply.data() + 1, reply.size() - 1);
+    if (reply[0] == kReplyBye) {
+      std::cout << "bye!" << std::endl;
+      break;
+    }
+    if (!sent) break;
+  }
+  close(fd);
+  return 0;
+}
+
+/**
+ * Replay a script on several connections at once and report the statement throughput.
+ */
+static int Replay(const ClientOptions &options) {
+  std::vector<std::string> statements;
+  std::ifstream in(options.script);
+  if (!in.good()) {
+    std::cerr << "cannot open " << options.script << std::endl;
+    return 1;
+  }
+  std::string statement;
+  while (NextStatement(in, statement)) {
+    statements.push_back(statement);
+  }
+  std::atomic<uint64_t> executed{0}, failed{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < options.connections; i++) {
+    threads.emplace_back([&]() {
+      int fd = Connect(options);
+      if (fd < 0) return;
+      std::string reply;
+      for (auto &sql : statements) {
+        bool sent = SendFrame(fd, sql);
+        if (!RecvFrame(fd, reply) || reply.empty()) break;
+        executed++;
+        if (reply[0] == kReplyError) failed++;
+        if (reply[0] == kReplyBye || !sent) break;
+      }
+      close(fd);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << executed << " statements (" << failed << " failed) on " << options.connections << " connections in "
+            << elapsed.count() << "s, " << executed / elapsed.count() << " statements/s" << std::endl;
+  return 0;
+}
+
+static void Usage(const char *name) {
+  std::cerr << "usage: " << name << " (-p port [-h host] | -s socket_path) [-f script.sql [-c connections]]"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  ClientOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      Usage(argv[0]);
+      return 1;
+    }
+    if (arg == "-p") {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "-h") {
+      options.host = argv[++i];
+    } else if (arg == "-s") {
+      options.socket_path = argv[++i];
+    } else if (arg == "-f") {
+      options.script = argv[++i];
+    } else if (arg == "-c") {
+      options.connections = static_cast<uint32_t>(atoi(argv[++i]));
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (options.port == 0 && options.socket_path.empty()) {
+    Usage(argv[0]);
+    return 1;
+  }
+  if (options.connections == 0) options.connections = 1;
+  return options.script.empty() ? Interactive(options) : Replay(options);
+}
@@ -0,0 +1,66 @@
+#include "executor/chunk_filter.h"
+
+#include <algorithm>
+#include <cstring>
+
+uint32_t ChunkFilter::AddCompare(uint32_t column, CompareOp op, const Field *value) {
+  nodes_.push_back({kCompareNode, column, op, value, 0, 0});
+  if (std::find(columns_.begin(), columns_.end(), column) == columns_.end()) {
+    columns_.push_back(column);
+  }
+  return nodes_.size() - 1;
+}
+
+uint32_t ChunkFilter::AddConnector(bool is_and, uint32_t left, uint32_t right) {
+  nodes_.push_back({is_and ? kAndNode : kOrNode, 0, kCmpInvalid, nullptr, left, right});
+  return nodes_.size() - 1;
+}
+
+void ChunkFilter::Evaluate(const DataChunk &chunk, uint64_t *selection) {
+  if (nodes_.empty()) {
+    memcpy(selection, chunk.GetVisible(), SelectionWords(chunk.GetSize()) * sizeof(uint64_t));
+    return;
+  }
+  // the right side of a connector needs a bitmap while the left one is kept, at most one per node
+  scratch_.resize(nodes_.size() * SelectionWords(FILTER_VECTOR_SIZE));
+  EvaluateNode(nodes_.size() - 1, chunk, selection, 0);
+  SelectionAnd(selection, chunk.GetVisible(), chunk.GetSize());
+}
+
+void ChunkFilter::EvaluateNode(uint32_t id, const DataChunk &chunk, uint64_t *selection, uint32_t depth) {
+  const Node &node = nodes_[id];
+  uint32_t words = SelectionWords(chunk.GetSize());
+  if (node.type_ == kCompareNode) {
+    FilterVector(chunk.GetColumn(node.column_), node.op_, *node.value_, selection);
+    return;
+  }
+  EvaluateNode(node.left_, chunk, selection, depth + 1);
+  // nothing passes an and whose left side selects nothing
+  if (node.type_ == kAndNode) {
+    uint64_t any = 0;
+    for (uint32_t i = 0; i < words; i++) {
+      any |= selection[i];
+    }
+    if (any == 0) return;
+  }
+  uint64_t *right = scratch_.data() + depth * SelectionWords(FILTER_VECTOR_SIZE);
+  EvaluateNode(node.right_, chunk, right, depth + 1);
+  for (uint32_t i = 0; i < words; i++) {
+    selection[i] = node.type_ == kAndNode ? selection[i] & right[i] : selection[i] | right[i];
+  }
+}
+
+bool ChunkFilter::Evaluate(const TupleView &tuple) const {
+  return nodes_.empty() || EvaluateNode(nodes_.size() - 1, tuple);
+}
+
+bool ChunkFilter::EvaluateNode(uint32_t id, const TupleView &tuple) const {
+  const Node &node = nodes_[id];
+  if (node.type_ == kCompareNode) {
+    return tuple.Compare(node.column_, node.op_, *node.value_) == kTrue;
+  }
+  if (node.type_ == kAndNode) {
+    return EvaluateNode(node.left_, tuple) && EvaluateNode(node.right_, tuple);
+  }
+  return EvaluateNode(node.left_, tuple) || EvaluateNode(node.right_, tuple);
+}
@@ -3,13 +3,17 @@
 #include <string>
 
 #include <cstdio>
+#include <fstream>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <chrono>
 #include <algorithm>
+#include <numeric>
+#include <thread>
 #include "parser/syntax_tree_printer.h"
-#include "utils/tree_file_mgr.h"
-
-#define ENABLE_PARSER_DEBUG
+#include "index/b_plus_tree_index.h"
+#include "executor/rowid_bitmap.h"
 
 extern "C" {
     int yyparse(void);
@@ -17,14 +21,73 @@ extern "C" {
 #include "parser/parser.h"
 }
 
-ExecuteEngine::ExecuteEngine() {}
+ExecuteEngine::ExecuteEngine() : dbs_(own_dbs_), scan_workers_(std::max(std::thread::hardware_concurrency(), 1u)) {}
+
+ExecuteEngine::ExecuteEngine(ExecuteEngine *shared)
+    : dbs_(shared->dbs_), result_format_(shared->result_format_), scan_workers_(shared->scan_workers_) {
+  SetDebugMode(shared->debug_mode_);
+}
+
+void ExecuteEngine::SetDebugMode(bool debug_mode) {
+    debug_mode_ = debug_mode;
+    if (debug_mode_ && syntax_tree_file_mgr_ == nullptr) {
+        syntax_tree_file_mgr_ = std::make_unique<TreeFileManagers>("syntax_tree_");
+    }
+}
+
+dberr_t ExecuteEngine::ExecuteSql(const char *sql, ExecuteContext *context) {
+    // statement cache fast path: a known shape only needs its literals re-bound
+    std::string shape;
+    std::vector<std::string> literals;
+    bool cacheable = !debug_mode_ && StatementCache::Normalize(sql, shape, literals);
+    context->plan_ = nullptr;
+    if (cacheable) {
+        CachedStatement *statement = statement_cache_.Lookup(shape);
+        if (statement != nullptr) {
+            statement->Bind(literals);
+            context->plan_ = &statement->plan_;
+            return Execute(statement->tree_, context);
+        }
+    }
+    YY_BUFFER_STATE bp = yy_scan_string(sql);
+    if (bp == nullptr) {
+        LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
+        return DB_FAILED;
+    }
+    yy_switch_to_buffer(bp);
+    MinisqlParserInit();
+    yyparse();
+    dberr_t ret_val = DB_FAILED;
+    if (MinisqlParserGetError()) {
+        std::cout << MinisqlParserGetErrorMessage() << std::endl;
+    } else if (!debug_mode_) {
+        CachedStatement *statement =
+            cacheable ? statement_cache_.Insert(shape, literals, MinisqlGetParserRootNode()) : nullptr;
+        if (statement != nullptr) {
+            context->plan_ = &statement->plan_;
+        }
+        ret_val = Execute(MinisqlGetParserRootNode(), context);
+    } else {
+        std::cout << "[INFO] Sql syntax parse ok!" << std::endl;
+        SyntaxTreePrinter printer(MinisqlGetParserRootNode());
+        printer.PrintTree((*syntax_tree_file_mgr_)[syntax_tree_id_++]);
+        auto start = std::chrono::high_resolution_clock::now();
+        ret_val = Execute(MinisqlGetParserRootNode(), context);
+        std::chrono::duration<float> duration = std::chrono::high_resolution_clock::now() - start;
+        std::cout << duration.count() << "s" << std::endl;
+    }
+    MinisqlParserFinish();
+    yy_delete_buffer(bp);
+    yylex_destroy();
+    return ret_val;
+}
 
 dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext* context) {
     if (ast == nullptr) {
         return DB_FAILED;
     }
+    query_heap_.Reset();
     dberr_t ret_val = DB_FAILED;
-    auto start = std::chrono::high_resolution_clock::now();
     switch (ast->type_) {
     case kNodeCreateDB:
       ret_val = ExecuteCreateDatabase(ast, context);
@@ -91,18 +154,40 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext* context) {
     case kNodeExecFile:
         ret_val = ExecuteExecfile(ast, context);
       break;
+    case kNodeLoad:
+        ret_val = ExecuteLoad(ast, context);
+      break;
+    case kNodeAnalyze:
+        ret_val = ExecuteAnalyze(ast, context);
+      break;
+    case kNodeShowStats:
+        ret_val = ExecuteShowStats(ast, context);
+      break;
+    case kNodeTruncateTable:
+        ret_val = ExecuteTruncateTable(ast, context);
+      break;
+    case kNodeVacuum:
+        ret_val = ExecuteVacuum(ast, context);
+      break;
     case kNodeQuit:
         ret_val = ExecuteQuit(ast, context);
       break;
     default:
         break;
     }
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<float> duration = end - start;
-    std::cout << duration.count() << "s" << std::endl;
     return ret_val;
 }
 
+DBStorageEngine *ExecuteEngine::CurrentDatabase() {
+  auto iter = dbs_.find(current_db_);
+  if (iter == dbs_.end()) {
+    // dropped by another session
+    current_db_ = "";
+    return nullptr;
+  }
+  return iter->second;
+}
+
 dberr_t ExecuteEngine::ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext* context) {
     std::string database_name = ast->child_->val_;
     //жǷڸdatabaseļ
@@ -227,12 +312,12 @@ dberr_t ExecuteEngine::ExecuteShowTables(pSyntaxNode ast, ExecuteContext* contex
 
     return DB_SUCCESS;
 
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
     vector<TableInfo*> my_tables;
     if (database_now->catalog_mgr_->GetTables(my_tables) == DB_FAILED) {
         //޷ȡtable
@@ -265,12 +350,12 @@ dberr_t ExecuteEngine::ExecuteShowTables(pSyntaxNode ast, ExecuteContext* contex
 dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext* context) {
   SimpleMemHeap local_heap;
 
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
     std::string table_name = ast->child_->val_;
     TableInfo* my_tableinfo = nullptr;
     if (database_now->catalog_mgr_->GetTable(table_name, my_tableinfo) == DB_SUCCESS) {
@@ -349,9 +434,22 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext* conte
     }
 
     
+    // create table ... using row|pax
+    TableLayout layout = kLayoutRow;
+    pSyntaxNode layout_node = ast->child_->next_->next_;
+    if (layout_node != nullptr) {
+      std::string layout_name = layout_node->child_->val_;
+      if (layout_name == "pax") {
+        layout = kLayoutPax;
+      } else if (layout_name != "row") {
+        std::cerr << "Unknown table layout " << layout_name << "\n";
+        return DB_FAILED;
+      }
+    }
+
     TableSchema *my_schema = new TableSchema(column_definition, pks);
     // call the create table
-    return database_now->catalog_mgr_->CreateTable(table_name, my_schema, nullptr, my_tableinfo);
+    return database_now->catalog_mgr_->CreateTable(table_name, my_schema, nullptr, my_tableinfo, layout);
 }
 
 dberr_t ExecuteEngine::ExecuteDropTable(pSyntaxNode ast, ExecuteContext* context) {
@@ -359,27 +457,41 @@ dberr_t ExecuteEngine::ExecuteDropTable(pSyntaxNode ast, ExecuteContext* context
     LOG(INFO) << "ExecuteDropIndex" << std::endl;
     #endif
     return DB_FAILED;*/
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
     std::string table_name = ast->child_->val_;
-    DBStorageEngine* database_now = dbs_[current_db_];
     return database_now->catalog_mgr_->DropTable(table_name);
 }
 
+dberr_t ExecuteEngine::ExecuteTruncateTable(pSyntaxNode ast, ExecuteContext *context) {
+  DBStorageEngine *database_now = CurrentDatabase();
+  if (database_now == nullptr) {
+    std::cerr << "no db is chosen\n";
+    return DB_FAILED;
+  }
+  if (database_now->catalog_mgr_->TruncateTable(ast->child_->val_) != DB_SUCCESS) {
+    std::cerr << "No such table\n";
+    return DB_FAILED;
+  }
+  std::cout << "Table " << ast->child_->val_ << " is truncated\n";
+  return DB_SUCCESS;
+}
+
 dberr_t ExecuteEngine::ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext* context) {
     /*#ifdef ENABLE_EXECUTE_DEBUG
       LOG(INFO) << "ExecuteDropIndex" << std::endl;
       #endif
       return DB_FAILED;*/
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
     
     for (auto i = database_now->catalog_mgr_->GetIndexs_()->begin();
          i != database_now->catalog_mgr_->GetIndexs_()->end(); i++) {
@@ -401,12 +513,12 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext* conte
     LOG(INFO) << "ExecuteDropIndex" << std::endl;
     #endif
     return DB_FAILED;*/
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
     std::string index_name = ast->child_->val_;
     std::string table_name = ast->child_->next_->val_;
     TableInfo* my_table_info = nullptr;
@@ -435,12 +547,12 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext* context
     LOG(INFO) << "ExecuteDropIndex" << std::endl;
     #endif
     return DB_FAILED;*/
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
     std::string index_name = ast->child_->val_;
     auto i = database_now->catalog_mgr_->GetIndexNames_()->begin();
     for (; i != database_now->catalog_mgr_->GetIndexNames_()->end(); i++) {
@@ -458,20 +570,33 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
       LOG(INFO) << "ExecuteDropIndex" << std::endl;
       #endif
       return DB_FAILED;*/
-  SimpleMemHeap local_heap;
+  MemHeap &local_heap = query_heap_;
 
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
       std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
     //row
-    std::vector<Row> select_rows;
+    std::vector<RowId> select_ids;
     pSyntaxNode select_type = ast->child_;
+    if (select_type->next_->type_ == kNodeTableList) {
+      return ExecuteJoin(ast, context);
+    }
+    // aggregate functions or a group by
+    bool aggregate = false;
+    for (pSyntaxNode node = select_type->next_->next_; node != nullptr; node = node->next_) {
+      aggregate |= node->type_ == kNodeColumnList;
+    }
+    for (pSyntaxNode item = select_type->child_; item != nullptr; item = item->next_) {
+      aggregate |= item->type_ == kNodeAggregate;
+    }
+    if (aggregate) {
+      return ExecuteAggregate(ast, context);
+    }
     bool all_columns = false;
     std::vector<string> select_column_name;
-    std::set<uint32_t> column_map;
     // select * ģʽ
     if (select_type->type_ == kNodeAllColumns) {
         all_columns = true;
@@ -487,98 +612,534 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
     }
     // from xxx
     // only one table is supported
-    std::string table_name = select_type->next_->val_;
-    TableInfo* my_table_info = nullptr;
-    if (database_now->catalog_mgr_->GetTable(table_name, my_table_info)) {
-        //Ҳtable
-      std::cerr << "No such table\n";
+    TablePlan local_plan;
+    TablePlan &plan = context->plan_ != nullptr ? *context->plan_ : local_plan;
+    if (!plan.IsValid(database_now)) {
+      if (ResolveTablePlan(database_now, select_type->next_->val_, plan) != DB_SUCCESS) {
+        std::cerr << "No such table\n";
         return DB_FAILED;
+      }
+      std::set<uint32_t> column_map;
+      for (auto i : select_column_name) {
+        uint32_t index = 0;
+        if (ResolveColumn(plan, i, index)) {
+          std::cerr << "Wrong column\n";
+          plan.table_ = nullptr;
+          return DB_FAILED;
+        }
+        column_map.insert(index);
+      }
+      plan.column_map_.assign(column_map.begin(), column_map.end());
     }
-    vector<Column*> my_columns = my_table_info->GetSchema()->GetColumns();
-    for (auto i : select_column_name) {
-      uint32_t index = 0;
-      if (my_table_info->GetSchema()->GetColumnIndex(i, index)) {
+    TableInfo* my_table_info = plan.table_;
+    // rows are streamed into the sink of the context, or printed as text
+    std::unique_ptr<ResultSink> local_sink;
+    ResultSink *sink = context->sink_;
+    if (sink == nullptr) {
+      local_sink = ResultSink::Create(result_format_, std::cout);
+      sink = local_sink.get();
+    }
+    std::vector<uint32_t> output_columns = plan.column_map_;
+    if (all_columns == true) {
+      output_columns.resize(my_table_info->GetSchema()->GetColumnCount());
+      for (uint32_t i = 0; i < output_columns.size(); i++) output_columns[i] = i;
+    }
+    pSyntaxNode condition = nullptr;
+    for (pSyntaxNode node = select_type->next_->next_; node != nullptr; node = node->next_) {
+      if (node->type_ == kNodeConditions) condition = node->child_;
+    }
+    std::vector<SortKey> sort_keys;
+    uint64_t limit = ExternalSort::NO_LIMIT;
+    auto resolve_order = [&](const std::string &name, uint32_t &column) {
+      if (ResolveColumn(plan, name, column) != DB_SUCCESS) {
         std::cerr << "Wrong column\n";
         return DB_FAILED;
       }
-      column_map.insert(index);
+      return DB_SUCCESS;
+    };
+    if (ResolveOrderBy(ast, resolve_order, sort_keys, limit) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    // an order by the pk alone is the order of the pk index, which holds no null keys. A condition
+    // with an index lookup selects fewer rows than a walk of the whole index, unless a limit stops it
+    IndexInfo *order_index = nullptr;
+    if (sort_keys.size() == 1 && !sort_keys[0].descending_ && plan.pk_index_ != nullptr &&
+        plan.pk_index_->GetIndexKeySchema()->GetColumnCount() == 1 &&
+        plan.pk_index_->GetIndexKeySchema()->GetColumn(0)->GetName() ==
+            my_table_info->GetSchema()->GetColumn(sort_keys[0].column_)->GetName() &&
+        (condition == nullptr || (limit != ExternalSort::NO_LIMIT && !UseIndexScan(plan, condition)))) {
+      order_index = plan.pk_index_;
+      sort_keys.clear();
+    }
+    std::unique_ptr<ResultSink> sort_sink;
+    if (!sort_keys.empty() || limit != ExternalSort::NO_LIMIT) {
+      sort_sink = std::make_unique<SortResultSink>(sink, sort_keys, limit, database_now->bpm_);
+      sink = sort_sink.get();
+    }
+    sink->Begin(my_table_info->GetSchema(), output_columns);
+    if (order_index != nullptr) {
+      dberr_t ret = SelectInIndexOrder(plan, order_index, condition, *sink, local_heap);
+      sink->End();
+      return sink->HasFailed() ? DB_FAILED : ret;
     }
 
     // from xxxûwhere
-    if (select_type->next_->next_ == NULL) {
-        for (auto iter = my_table_info->GetTableHeap()->Begin(nullptr); iter != my_table_info->GetTableHeap()->End();
-            iter++) {
-            Row my_row = *iter;
-            select_rows.push_back(my_row);
+    // an unfiltered scan of a row table has nothing to compare in vectors, its views are printed as they are
+    if (condition == nullptr && my_table_info->GetLayout() == kLayoutRow) {
+      auto iter = my_table_info->GetTableHeap()->ViewBegin(all_columns ? nullptr : &plan.column_map_);
+      for (; !iter.IsEnd(); ++iter) {
+        if (!sink->Consume(*iter)) break;
+      }
+      sink->End();
+      return sink->HasFailed() ? DB_FAILED : DB_SUCCESS;
+    }
+    if (condition == nullptr || !UseIndexScan(plan, condition)) {
+        // scan, filter and print the table a chunk at a time, the sort columns are read as well
+        std::vector<uint32_t> load_columns = output_columns;
+        for (auto &key : sort_keys) {
+          if (std::find(load_columns.begin(), load_columns.end(), key.column_) == load_columns.end()) {
+            load_columns.push_back(key.column_);
+          }
         }
+        std::sort(load_columns.begin(), load_columns.end());
+        dberr_t ret = SelectChunks(plan, condition, load_columns, *sink, local_heap);
+        sink->End();
+        return sink->HasFailed() ? DB_FAILED : ret;
     }
     // from xxxwhere
-    else {
-        pSyntaxNode condition = select_type->next_->next_->child_;
-        pSyntaxNode compare = condition;
-        std::vector<pSyntaxNode> conditions;
-        std::string oper, col_name, val;
-
-        //get the leftest node
-        std::string tmp_val = compare->val_;
-        while (tmp_val == "and" || tmp_val == "or") {
-          conditions.push_back(compare);
-          compare = compare->child_;
-          tmp_val = compare->val_;
-        }
-        
-        std::vector<Row> base_set;
-        std::vector<Row> another_set;
-        //1. get the base
-        oper = compare->val_;
-        col_name = compare->child_->val_;
-        val = compare->child_->next_->val_;
-        GetRowSet(database_now, base_set, my_table_info, oper, col_name, val, local_heap);
-        select_rows = base_set;
-        //2. has at least one condition
-        while (conditions.empty() == false) {
-          select_rows.clear();
-          condition = conditions.back();
-          conditions.pop_back();
-          compare = condition->child_->next_;
-          oper = compare->val_;
-          col_name = compare->child_->val_;
-          val = compare->child_->next_->val_;
-          GetRowSet(database_now, another_set, my_table_info, oper, col_name, val, local_heap);
-          //union / intersect
-          tmp_val = condition->val_;
-          if (tmp_val == "and")
-            Intersect(base_set, another_set, select_rows);
-          else if (tmp_val == "or")
-            Union(base_set, another_set, select_rows);
-
-          base_set = select_rows;
-        }
-        
+    if (SelectRowIds(plan, condition, select_ids, local_heap) != DB_SUCCESS) {
+        sink->End();
+        return DB_FAILED;
     }
 
-    if (all_columns == true) {
-      for (auto i : select_rows) {
-        for (auto j : i.GetFields()) {
-          std::cout << j->GetData() << "\t";
-        }
-        std::cout << std::endl;
+    // the row ids come grouped by page, every page is fetched once for all its rows
+    const std::vector<uint32_t> *read_columns = all_columns || !sort_keys.empty() ? nullptr : &plan.column_map_;
+    for (auto iter = my_table_info->GetTableHeap()->FetchBegin(select_ids, read_columns); !iter.IsEnd(); ++iter) {
+      if (!sink->Consume(*iter)) break;
+    }
+    sink->End();
+    return sink->HasFailed() ? DB_FAILED : DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteAggregate(pSyntaxNode ast, ExecuteContext *context) {
+  MemHeap &local_heap = query_heap_;
+  DBStorageEngine *database_now = CurrentDatabase();
+  pSyntaxNode select_type = ast->child_;
+  TablePlan local_plan;
+  TablePlan &plan = context->plan_ != nullptr ? *context->plan_ : local_plan;
+  if (!plan.IsValid(database_now) && ResolveTablePlan(database_now, select_type->next_->val_, plan) != DB_SUCCESS) {
+    std::cerr << "No such table\n";
+    return DB_FAILED;
+  }
+  const Schema *schema = plan.table_->GetSchema();
+  pSyntaxNode condition = nullptr, group_by = nullptr;
+  for (pSyntaxNode node = select_type->next_->next_; node != nullptr; node = node->next_) {
+    if (node->type_ == kNodeConditions) {
+      condition = node->child_;
+    } else if (node->type_ == kNodeColumnList) {
+      group_by = node;
+    }
+  }
+  std::vector<uint32_t> group_columns;
+  for (pSyntaxNode node = group_by == nullptr ? nullptr : group_by->child_; node != nullptr; node = node->next_) {
+    uint32_t index = 0;
+    if (ResolveColumn(plan, node->val_, index) != DB_SUCCESS) {
+      std::cerr << "Wrong column\n";
+      return DB_FAILED;
+    }
+    group_columns.push_back(index);
+  }
+  if (select_type->type_ == kNodeAllColumns) {
+    std::cerr << "Select * cannot be grouped\n";
+    return DB_FAILED;
+  }
+  // a result is | group columns | aggregates |, the select list picks from it
+  std::vector<AggregateSpec> aggregates;
+  std::vector<uint32_t> output;
+  std::vector<std::string> names;
+  for (pSyntaxNode item = select_type->child_; item != nullptr; item = item->next_) {
+    uint32_t index = 0;
+    if (item->type_ != kNodeAggregate) {
+      if (ResolveColumn(plan, item->val_, index) != DB_SUCCESS) {
+        std::cerr << "Wrong column\n";
+        return DB_FAILED;
+      }
+      auto it = std::find(group_columns.begin(), group_columns.end(), index);
+      if (it == group_columns.end()) {
+        std::cerr << "Column " << item->val_ << " is not in the group by\n";
+        return DB_FAILED;
+      }
+      output.push_back(it - group_columns.begin());
+      continue;
+    }
+    AggregateSpec spec{kAggregateCount, AggregateSpec::AGGREGATE_ALL_COLUMNS};
+    if (!AggregateSpec::GetType(item->val_, spec.type_)) {
+      std::cerr << "Unknown function " << item->val_ << "\n";
+      return DB_FAILED;
+    }
+    std::string argument = "*";
+    if (item->child_->type_ != kNodeAllColumns) {
+      argument = item->child_->val_;
+      if (ResolveColumn(plan, argument, spec.column_) != DB_SUCCESS) {
+        std::cerr << "Wrong column\n";
+        return DB_FAILED;
       }
+    } else if (spec.type_ != kAggregateCount) {
+      std::cerr << item->val_ << "(*) is not supported\n";
+      return DB_FAILED;
+    }
+    if ((spec.type_ == kAggregateSum || spec.type_ == kAggregateAvg) &&
+        schema->GetColumn(spec.column_)->GetType() == kTypeChar) {
+      std::cerr << item->val_ << " of a char column is not supported\n";
+      return DB_FAILED;
+    }
+    output.push_back(group_columns.size() + aggregates.size());
+    names.push_back(std::string(item->val_) + "(" + argument + ")");
+    aggregates.push_back(spec);
+  }
+  // the results are sorted by their group columns
+  std::vector<SortKey> sort_keys;
+  uint64_t limit = ExternalSort::NO_LIMIT;
+  auto resolve_order = [&](const std::string &name, uint32_t &column) {
+    if (ResolveColumn(plan, name, column) != DB_SUCCESS) {
+      std::cerr << "Wrong column\n";
+      return DB_FAILED;
+    }
+    auto it = std::find(group_columns.begin(), group_columns.end(), column);
+    if (it == group_columns.end()) {
+      std::cerr << "Order by column " << name << " is not in the group by\n";
+      return DB_FAILED;
+    }
+    column = it - group_columns.begin();
+    return DB_SUCCESS;
+  };
+  if (ResolveOrderBy(ast, resolve_order, sort_keys, limit) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  // the schema of the results, named like the select list
+  std::vector<Column *> result_columns;
+  for (uint32_t i = 0; i < group_columns.size(); i++) {
+    result_columns.push_back(ALLOC_COLUMN(local_heap)(schema->GetColumn(group_columns[i])));
+  }
+  for (uint32_t i = 0; i < aggregates.size(); i++) {
+    TypeId type = aggregates[i].GetResultType(schema);
+    uint32_t index = result_columns.size();
+    if (type == kTypeChar) {
+      uint32_t length = schema->GetColumn(aggregates[i].column_)->GetLength();
+      result_columns.push_back(ALLOC_COLUMN(local_heap)(names[i], type, length, index, true, false));
+    } else {
+      result_columns.push_back(ALLOC_COLUMN(local_heap)(names[i], type, index, true, false));
+    }
+  }
+  Schema result_schema(result_columns);
 
-        return DB_SUCCESS;
+  HashAggregate hash_aggregate(schema, group_columns, aggregates, database_now->bpm_);
+  TableHeap *table_heap = plan.table_->GetTableHeap();
+  if (condition != nullptr && UseIndexScan(plan, condition)) {
+    std::vector<RowId> select_ids;
+    if (SelectRowIds(plan, condition, select_ids, local_heap) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    for (auto iter = table_heap->FetchBegin(select_ids); !iter.IsEnd(); ++iter) {
+      hash_aggregate.Consume(*iter);
+    }
+  } else {
+    ChunkFilter filter;
+    uint32_t id = 0;
+    if (condition != nullptr && CompileFilter(plan, condition, local_heap, filter, id) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    // the aggregated columns are only decoded once the filter selected some tuples of a chunk
+    std::vector<uint32_t> columns = hash_aggregate.GetColumns();
+    auto iter = filter.IsEmpty() ? table_heap->ChunkBegin(columns) : table_heap->ChunkBegin(filter.GetColumns(), columns);
+    uint64_t selection[FILTER_VECTOR_SIZE / 64];
+    for (; !iter.IsEnd(); ++iter) {
+      filter.Evaluate(*iter, selection);
+      uint64_t any = 0;
+      for (uint32_t w = 0; w < SelectionWords(iter->GetSize()); w++) {
+        any |= selection[w];
+      }
+      if (any == 0) continue;
+      iter.LoadLazyColumns();
+      hash_aggregate.Consume(*iter, selection);
     }
+  }
 
-    for (auto i : select_rows) {
-      int count = 0;
-      for (auto j : i.GetFields()) {
-        if (column_map.find(count)!=column_map.end())
-            std::cout << j->GetData() << "\t";
+  std::unique_ptr<ResultSink> local_sink;
+  ResultSink *sink = context->sink_;
+  if (sink == nullptr) {
+    local_sink = ResultSink::Create(result_format_, std::cout);
+    sink = local_sink.get();
+  }
+  std::unique_ptr<ResultSink> sort_sink;
+  if (!sort_keys.empty() || limit != ExternalSort::NO_LIMIT) {
+    sort_sink = std::make_unique<SortResultSink>(sink, sort_keys, limit, database_now->bpm_);
+    sink = sort_sink.get();
+  }
+  sink->Begin(&result_schema, output);
+  dberr_t finished = hash_aggregate.Finish([sink](std::vector<Field> &result) {
+    Row row(result);
+    return sink->ConsumeRow(row);
+  });
+  sink->End();
+  return sink->HasFailed() ? DB_FAILED : finished;
+}
 
-        count++;
+/**
+ * @return true if a op b, a compare with null is false
+ */
+static bool CompareFields(const Field &a, CompareOp op, const Field &b) {
+  switch (op) {
+    case kCmpEq:
+      return a.CompareEquals(b) == kTrue;
+    case kCmpNe:
+      return a.CompareNotEquals(b) == kTrue;
+    case kCmpLt:
+      return a.CompareLessThan(b) == kTrue;
+    case kCmpLe:
+      return a.CompareLessThanEquals(b) == kTrue;
+    case kCmpGt:
+      return a.CompareGreaterThan(b) == kTrue;
+    case kCmpGe:
+      return a.CompareGreaterThanEquals(b) == kTrue;
+    default:
+      return false;
+  }
+}
+
+dberr_t ExecuteEngine::ExecuteJoin(pSyntaxNode ast, ExecuteContext *context) {
+  MemHeap &local_heap = query_heap_;
+  DBStorageEngine *database_now = CurrentDatabase();
+  pSyntaxNode select_type = ast->child_;
+  pSyntaxNode condition = nullptr;
+  for (pSyntaxNode node = select_type->next_->next_; node != nullptr; node = node->next_) {
+    if (node->type_ == kNodeColumnList) {
+      std::cerr << "Group by over a join is not supported\n";
+      return DB_FAILED;
+    }
+    if (node->type_ == kNodeConditions) condition = node->child_;
+  }
+  // the tables are joined left-deep, in from order
+  std::vector<TablePlan> plans;
+  for (pSyntaxNode node = select_type->next_->child_; node != nullptr; node = node->next_) {
+    for (auto &plan : plans) {
+      if (plan.table_->GetTableName() == node->val_) {
+        std::cerr << "Table " << node->val_ << " appears twice in the join\n";
+        return DB_FAILED;
       }
-      std::cout << std::endl;
     }
+    plans.emplace_back();
+    if (ResolveTablePlan(database_now, node->val_, plans.back()) != DB_SUCCESS) {
+      std::cerr << "No such table\n";
+      return DB_FAILED;
+    }
+  }
+  uint32_t table_count = plans.size();
+  // the output columns as | table | column |, in select order
+  std::vector<std::pair<uint32_t, uint32_t>> output;
+  if (select_type->type_ == kNodeAllColumns) {
+    for (uint32_t t = 0; t < table_count; t++) {
+      for (uint32_t i = 0; i < plans[t].table_->GetSchema()->GetColumnCount(); i++) {
+        output.emplace_back(t, i);
+      }
+    }
+  } else {
+    for (pSyntaxNode item = select_type->child_; item != nullptr; item = item->next_) {
+      if (item->type_ == kNodeAggregate) {
+        std::cerr << "Aggregates over a join are not supported\n";
+        return DB_FAILED;
+      }
+      uint32_t table = 0, column = 0;
+      if (ResolveJoinColumn(plans, item->val_, table, column) != DB_SUCCESS) {
+        return DB_FAILED;
+      }
+      output.emplace_back(table, column);
+    }
+  }
+  // the results are sorted by their selected columns
+  std::vector<SortKey> sort_keys;
+  uint64_t limit = ExternalSort::NO_LIMIT;
+  auto resolve_order = [&](const std::string &name, uint32_t &column) {
+    uint32_t table = 0;
+    if (ResolveJoinColumn(plans, name, table, column) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    auto it = std::find(output.begin(), output.end(), std::make_pair(table, column));
+    if (it == output.end()) {
+      std::cerr << "Order by column " << name << " is not selected\n";
+      return DB_FAILED;
+    }
+    column = it - output.begin();
     return DB_SUCCESS;
+  };
+  if (ResolveOrderBy(ast, resolve_order, sort_keys, limit) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  std::vector<std::vector<uint32_t>> columns(table_count);
+  for (auto &ref : output) {
+    columns[ref.first].push_back(ref.second);
+  }
+
+  // split the and of the where condition: a compare of two columns joins their tables, any other
+  // condition must be on a single table and filters it before it is joined
+  struct JoinPredicate {
+    uint32_t left_table_, left_column_;
+    CompareOp op_;
+    uint32_t right_table_, right_column_;
+  };
+  std::vector<JoinPredicate> predicates;
+  std::vector<ChunkFilter> filters(table_count);
+  std::vector<uint32_t> filter_ids(table_count, 0);
+  std::vector<pSyntaxNode> conditions;
+  if (condition != nullptr) conditions.push_back(condition);
+  while (!conditions.empty()) {
+    pSyntaxNode node = conditions.back();
+    conditions.pop_back();
+    if (node->type_ == kNodeConnector && std::string(node->val_) == "and") {
+      conditions.push_back(node->child_->next_);
+      conditions.push_back(node->child_);
+      continue;
+    }
+    if (node->type_ == kNodeCompareOperator && node->child_->next_->type_ == kNodeIdentifier) {
+      JoinPredicate predicate{};
+      predicate.op_ = GetCompareOp(node->val_);
+      if (predicate.op_ == kCmpInvalid) {
+        std::cerr << "Unknown compare operator " << node->val_ << "\n";
+        return DB_FAILED;
+      }
+      if (ResolveJoinColumn(plans, node->child_->val_, predicate.left_table_, predicate.left_column_) != DB_SUCCESS ||
+          ResolveJoinColumn(plans, node->child_->next_->val_, predicate.right_table_, predicate.right_column_) !=
+              DB_SUCCESS) {
+        return DB_FAILED;
+      }
+      if (predicate.left_table_ == predicate.right_table_) {
+        std::cerr << "Compare of two columns is only supported between two tables\n";
+        return DB_FAILED;
+      }
+      if (plans[predicate.left_table_].table_->GetSchema()->GetColumn(predicate.left_column_)->GetType() !=
+          plans[predicate.right_table_].table_->GetSchema()->GetColumn(predicate.right_column_)->GetType()) {
+        std::cerr << "Cannot compare columns of different types\n";
+        return DB_FAILED;
+      }
+      columns[predicate.left_table_].push_back(predicate.left_column_);
+      columns[predicate.right_table_].push_back(predicate.right_column_);
+      predicates.push_back(predicate);
+      continue;
+    }
+    std::set<uint32_t> tables;
+    if (CollectJoinTables(plans, node, tables) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    if (tables.size() != 1) {
+      std::cerr << "A condition on several tables must be a compare of two columns\n";
+      return DB_FAILED;
+    }
+    uint32_t table = *tables.begin();
+    bool first = filters[table].IsEmpty();
+    uint32_t id = 0;
+    if (CompileFilter(plans[table], node, local_heap, filters[table], id) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    filter_ids[table] = first ? id : filters[table].AddConnector(true, filter_ids[table], id);
+  }
+
+  std::vector<JoinTable> tables;
+  for (uint32_t t = 0; t < table_count; t++) {
+    std::sort(columns[t].begin(), columns[t].end());
+    columns[t].erase(std::unique(columns[t].begin(), columns[t].end()), columns[t].end());
+    tables.push_back({plans[t].table_->GetTableHeap(), plans[t].table_->GetSchema(), &filters[t], columns[t]});
+  }
+  auto column_index = [&plans](uint32_t table, uint32_t column) -> IndexInfo * {
+    const std::string &name = plans[table].table_->GetSchema()->GetColumn(column)->GetName();
+    for (auto index : plans[table].indexes_) {
+      if (index->GetIndexKeySchema()->GetColumnCount() == 1 && index->GetIndexKeySchema()->GetColumn(0)->GetName() == name) {
+        return index;
+      }
+    }
+    return nullptr;
+  };
+  // the first equality with a table joined before is the key of a join, without one the join is a
+  // cross join; the other compares of two columns are checked on the joined tuples
+  std::vector<bool> is_key(predicates.size(), false);
+  std::unique_ptr<JoinSource> source = std::make_unique<TableScanSource>(tables[0]);
+  bool left_filtered = !filters[0].IsEmpty();
+  for (uint32_t k = 1; k < table_count; k++) {
+    JoinKey left_key{0, 0};
+    uint32_t right_column = HashJoin::NO_KEY;
+    for (uint32_t i = 0; i < predicates.size() && right_column == HashJoin::NO_KEY; i++) {
+      auto &predicate = predicates[i];
+      if (predicate.op_ != kCmpEq) continue;
+      if (predicate.left_table_ == k && predicate.right_table_ < k) {
+        left_key = {predicate.right_table_, predicate.right_column_};
+        right_column = predicate.left_column_;
+      } else if (predicate.right_table_ == k && predicate.left_table_ < k) {
+        left_key = {predicate.left_table_, predicate.left_column_};
+        right_column = predicate.right_column_;
+      } else {
+        continue;
+      }
+      is_key[i] = true;
+    }
+    IndexInfo *right_index = right_column == HashJoin::NO_KEY ? nullptr : column_index(k, right_column);
+    IndexInfo *left_index = k == 1 && right_index != nullptr ? column_index(0, left_key.column_) : nullptr;
+    if (left_index != nullptr && filters[0].IsEmpty() && filters[1].IsEmpty() &&
+        static_cast<size_t>(tables[1].table_heap_->GetPageCount()) * PAGE_SIZE > HashJoin::DEFAULT_MEMORY_BUDGET) {
+      // both whole tables in key order, nothing to build where a hash table would spill
+      source = std::make_unique<MergeJoin>(tables[0], left_index, tables[1], right_index);
+    } else if (right_index != nullptr &&
+               (left_filtered || (k == 1 && tables[0].table_heap_->GetPageCount() * 4 <= tables[1].table_heap_->GetPageCount()))) {
+      // few left records, probing the index is cheaper than scanning the right table
+      source = std::make_unique<IndexNestedLoopJoin>(std::move(source), left_key, tables[k], right_index);
+    } else {
+      source = std::make_unique<HashJoin>(std::move(source), left_key, tables[k], right_column, database_now->bpm_);
+    }
+    left_filtered |= !filters[k].IsEmpty();
+  }
+
+  // the schema of the results, the selected columns of all the tables
+  std::vector<Column *> result_columns;
+  for (auto &ref : output) {
+    result_columns.push_back(ALLOC_COLUMN(local_heap)(plans[ref.first].table_->GetSchema()->GetColumn(ref.second)));
+  }
+  Schema result_schema(result_columns);
+  std::vector<uint32_t> result_output(output.size());
+  for (uint32_t i = 0; i < result_output.size(); i++) result_output[i] = i;
+
+  std::unique_ptr<ResultSink> local_sink;
+  ResultSink *sink = context->sink_;
+  if (sink == nullptr) {
+    local_sink = ResultSink::Create(result_format_, std::cout);
+    sink = local_sink.get();
+  }
+  std::unique_ptr<ResultSink> sort_sink;
+  if (!sort_keys.empty() || limit != ExternalSort::NO_LIMIT) {
+    sort_sink = std::make_unique<SortResultSink>(sink, sort_keys, limit, database_now->bpm_);
+    sink = sort_sink.get();
+  }
+  sink->Begin(&result_schema, result_output);
+  std::vector<TupleView> views;
+  Row values(INVALID_ROWID);
+  Row row(INVALID_ROWID);
+  source->Run([&](const char *record, uint32_t size) {
+    JoinRecord::Parse(record, size, source->GetSchemas(), views);
+    for (uint32_t i = 0; i < predicates.size(); i++) {
+      if (is_key[i]) continue;
+      auto &predicate = predicates[i];
+      values.Clear();
+      views[predicate.left_table_].Project({predicate.left_column_}, &values);
+      views[predicate.right_table_].Project({predicate.right_column_}, &values);
+      if (!CompareFields(*values.GetField(0), predicate.op_, *values.GetField(1))) {
+        return true;
+      }
+    }
+    row.Clear();
+    for (auto &ref : output) {
+      views[ref.first].Project({ref.second}, &row);
+    }
+    return sink->ConsumeRow(row);
+  });
+  sink->End();
+  return source->HasFailed() || sink->HasFailed() ? DB_FAILED : DB_SUCCESS;
 }
 
 dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext* context) {
@@ -586,25 +1147,51 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext* context) {
     LOG(INFO) << "ExecuteInsert" << std::endl;
     #endif
     return DB_FAILED;*/
-    if (current_db_ == "") {
+    DBStorageEngine* database_now = CurrentDatabase();
+    if (database_now == nullptr) {
         //δѡdatabase
         std::cerr << "no db is chosen\n";
         return DB_FAILED;
     }
-    DBStorageEngine* database_now = dbs_[current_db_];
-    std::string table_name = ast->child_->val_;
-    TableInfo* my_table_info = nullptr;
-    vector<Column*> my_columns;
-    vector<Field> my_fields;
-    vector<Field> pk_fields;
-    pSyntaxNode column_value = ast->child_->next_->child_;
-    if (database_now->catalog_mgr_->GetTable(table_name, my_table_info)) {
-        //Ҳtable
+    TablePlan local_plan;
+    TablePlan &plan = context->plan_ != nullptr ? *context->plan_ : local_plan;
+    if (!plan.IsValid(database_now) && ResolveTablePlan(database_now, ast->child_->val_, plan) != DB_SUCCESS) {
         return DB_FAILED;
     }
-    else {
-        my_columns = my_table_info->GetSchema()->GetColumns();
+    pSyntaxNode values = ast->child_->next_;
+    if (values->next_ == NULL) {
+        vector<Field> my_fields;
+        if (MakeInsertRow(plan, values->child_, my_fields) != DB_SUCCESS) {
+            return DB_FAILED;
+        }
+        Row *my_row = new Row(my_fields);
+        dberr_t ret_val = Insert(database_now, plan, my_row);
+        delete my_row;
+        return ret_val;
+    }
+    // several value tuples take the bulk path
+    std::vector<Row> rows;
+    for (; values != NULL; values = values->next_) {
+        vector<Field> my_fields;
+        if (MakeInsertRow(plan, values->child_, my_fields) != DB_SUCCESS) {
+            return DB_FAILED;
+        }
+        if (my_fields.size() != plan.table_->GetSchema()->GetColumnCount()) {
+            std::cerr << "Wrong number of values\n";
+            return DB_FAILED;
+        }
+        rows.emplace_back(my_fields);
     }
+    uint32_t rejected = 0;
+    if (BulkInsert(plan, rows, rejected) != DB_SUCCESS) {
+        return DB_FAILED;
+    }
+    std::cout << rows.size() - rejected << " rows are inserted, " << rejected << " rows are rejected\n";
+    return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::MakeInsertRow(const TablePlan &plan, pSyntaxNode column_value, vector<Field> &my_fields) {
+    const vector<Column*> &my_columns = plan.table_->GetSchema()->GetColumns();
     uint32_t i = 0;
     while (i < my_columns.size() && column_value != NULL) {
         TypeId tmp_type = my_columns[i]->GetType();
@@ -661,106 +1248,70 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext* context) {
     if (column_value != NULL) {
         std::cout << "Too many elements!" << std::endl;
     }
-    Row *my_row = new Row(my_fields);
-    dberr_t ret_val = Insert(database_now, my_table_info, my_row);
-    delete my_row;
+    return DB_SUCCESS;
+}
 
-    return ret_val;
+/**
+ * Copy the tuples of row_ids into data, fetching every page once for a run of row ids on it, and
+ * point tuples at the copies.
+ */
+static void CopyTuples(TableHeap *table_heap, const std::vector<RowId> &row_ids, std::vector<char> &data,
+                       std::vector<TupleView> &tuples) {
+  std::vector<size_t> offsets;
+  for (auto iter = table_heap->FetchBegin(row_ids); !iter.IsEnd(); ++iter) {
+    offsets.push_back(data.size());
+    data.insert(data.end(), iter->GetData(), iter->GetData() + iter->GetSize());
+    tuples.push_back(*iter);
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    tuples[i].Reset(data.data() + offsets[i], tuples[i].GetSchema(), tuples[i].GetRowId());
+  }
 }
 
 dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
 #ifdef ENABLE_EXECUTE_DEBUG
     LOG(INFO) << "ExecuteDelete" << std::endl;
 #endif
-    SimpleMemHeap local_heap;
-    if (current_db_ == "") {
+    MemHeap &local_heap = query_heap_;
+    DBStorageEngine *database_now = CurrentDatabase();
+    if (database_now == nullptr) {
       //δѡdatabase
       std::cerr << "no db is chosen\n";
       return DB_FAILED;
     }
-    DBStorageEngine *database_now = dbs_[current_db_];
     //row
-    std::vector<Row> select_rows;
+    std::vector<RowId> select_ids;
 
     // from xxx
     // only one table is supported
-    std::string table_name = ast->child_->val_;
-    TableInfo *my_table_info = nullptr;
-    if (database_now->catalog_mgr_->GetTable(table_name, my_table_info) == DB_FAILED) {
-      //Ҳtable
+    TablePlan plan;
+    if (ResolveTablePlan(database_now, ast->child_->val_, plan) != DB_SUCCESS) {
       return DB_FAILED;
     }
+    TableInfo *my_table_info = plan.table_;
+    TableHeap *table_heap = my_table_info->GetTableHeap();
 
-    // from xxxûwhere
-    if (ast->child_->next_ == NULL) {
-      for (auto iter = my_table_info->GetTableHeap()->Begin(nullptr); iter != my_table_info->GetTableHeap()->End();
-           iter++) {
-        Row my_row = *iter;
-        select_rows.push_back(my_row);
-      }
-    }
-    // from xxxwhere
-    else {
-      pSyntaxNode condition = ast->child_->next_->child_;
-      pSyntaxNode compare = condition;
-      std::vector<pSyntaxNode> conditions;
-      std::string oper, col_name, val;
-
-      // get the leftest node
-      std::string tmp_val = compare->val_;
-      while (tmp_val == "and" || tmp_val == "or") {
-        conditions.push_back(compare);
-        compare = compare->child_;
-        tmp_val = compare->val_;
-      }
-
-      std::vector<Row> base_set;
-      std::vector<Row> another_set;
-      // 1. get the base
-      oper = compare->val_;
-      col_name = compare->child_->val_;
-      val = compare->child_->next_->val_;
-      GetRowSet(database_now, base_set, my_table_info, oper, col_name, val, local_heap);
-      select_rows = base_set;
-      // 2. has at least one condition
-      while (conditions.empty() == false) {
-        select_rows.clear();
-        condition = conditions.back();
-        conditions.pop_back();
-        compare = condition->child_->next_;
-        oper = compare->val_;
-        col_name = compare->child_->val_;
-        val = compare->child_->next_->val_;
-        GetRowSet(database_now, another_set, my_table_info, oper, col_name, val, local_heap);
-        // union / intersect
-        tmp_val = condition->val_;
-        if (tmp_val == "and")
-          Intersect(base_set, another_set, select_rows);
-        else if (tmp_val == "or")
-          Union(base_set, another_set, select_rows);
-
-        base_set = select_rows;
-      }
+    pSyntaxNode condition = ast->child_->next_ == NULL ? nullptr : ast->child_->next_->child_;
+    if (SelectRowIds(plan, condition, select_ids, local_heap) != DB_SUCCESS) {
+      return DB_FAILED;
     }
 
-    std::cout << select_rows.size() << " rows are effected\n";
-    IndexInfo *tmp_index;
-    for (auto z = select_rows.begin(); z != select_rows.end(); z++) {
+    std::cout << select_ids.size() << " rows are effected\n";
+    std::vector<char> data;
+    std::vector<TupleView> tuples;
+    CopyTuples(table_heap, select_ids, data, tuples);
+    Row row(INVALID_ROWID);
+    TableStatistics *statistics = database_now->catalog_mgr_->GetStatistics(my_table_info->GetTableId());
+    for (auto &tuple : tuples) {
       // delete from table
-      my_table_info->GetTableHeap()->MarkDelete(z->GetRowId(), nullptr);
-      // delete from index
-      for (auto i = ((*(database_now->catalog_mgr_->GetIndexNames_()))[table_name]).begin();
-           i != ((*(database_now->catalog_mgr_->GetIndexNames_()))[table_name]).end(); i++) {
-        std::vector<Field> key_field;
-        tmp_index = (*(database_now->catalog_mgr_->GetIndexs_()))[i->second];
-        // get keys
-        for (auto j = tmp_index->GetIndexKeySchema()->GetColumns().begin();
-             j != tmp_index->GetIndexKeySchema()->GetColumns().end(); j++)
-          key_field.push_back(*(z->GetField((*j)->GetTableInd())));
-        Row key = Row(key_field);
-        (*(database_now->catalog_mgr_->GetIndexs_()))[i->second]->GetIndex()->RemoveEntry(key, z->GetRowId(), nullptr);
+      table_heap->MarkDelete(tuple.GetRowId(), nullptr);
+      if (statistics != nullptr) {
+        tuple.Materialize(&row);
+        statistics->RemoveRow(row);
       }
     }
+    // delete from index
+    RemoveIndexEntries(plan.indexes_, tuples);
     return DB_SUCCESS;
 }
 
@@ -768,24 +1319,23 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
 #ifdef ENABLE_EXECUTE_DEBUG
     LOG(INFO) << "ExecuteUpdate" << std::endl;
 #endif
-    SimpleMemHeap local_heap;
-    if (current_db_ == "") {
+    MemHeap &local_heap = query_heap_;
+    DBStorageEngine *database_now = CurrentDatabase();
+    if (database_now == nullptr) {
       //δѡdatabase
       std::cerr << "no db is chosen\n";
       return DB_FAILED;
     }
-    DBStorageEngine *database_now = dbs_[current_db_];
     //row
-    std::vector<Row> select_rows;
+    std::vector<RowId> select_ids;
 
     // from xxx
     // only one table is supported
-    std::string table_name = ast->child_->val_;
-    TableInfo *my_table_info = nullptr;
-    if (database_now->catalog_mgr_->GetTable(table_name, my_table_info) == DB_FAILED) {
-      //Ҳtable
+    TablePlan plan;
+    if (ResolveTablePlan(database_now, ast->child_->val_, plan) != DB_SUCCESS) {
       return DB_FAILED;
     }
+    TableInfo *my_table_info = plan.table_;
 
     // get the new value
     pSyntaxNode update_val = ast->child_->next_->child_;
@@ -805,85 +1355,48 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
       update_val = update_val->next_;
     }
 
-    // from xxxûwhere
-    if (ast->child_->next_->next_ == NULL) {
-      for (auto iter = my_table_info->GetTableHeap()->Begin(nullptr); iter != my_table_info->GetTableHeap()->End();
-           iter++) {
-        Row my_row = *iter;
-        select_rows.push_back(my_row);
-      }
+    pSyntaxNode condition = ast->child_->next_->next_ == NULL ? nullptr : ast->child_->next_->next_->child_;
+    if (SelectRowIds(plan, condition, select_ids, local_heap) != DB_SUCCESS) {
+      return DB_FAILED;
     }
-    // from xxxwhere
-    else {
-      pSyntaxNode condition = ast->child_->next_->next_->child_;
-      pSyntaxNode compare = condition;
-      std::vector<pSyntaxNode> conditions;
-      std::string oper, col_name, val;
-
-      // get the leftest node
-      std::string tmp_val = compare->val_;
-      while (tmp_val == "and" || tmp_val == "or") {
-        conditions.push_back(compare);
-        compare = compare->child_;
-        tmp_val = compare->val_;
-      }
 
-      std::vector<Row> base_set;
-      std::vector<Row> another_set;
-      // 1. get the base
-      oper = compare->val_;
-      col_name = compare->child_->val_;
-      val = compare->child_->next_->val_;
-      GetRowSet(database_now, base_set, my_table_info, oper, col_name, val, local_heap);
-      select_rows = base_set;
-      // 2. has at least one condition
-      while (conditions.empty() == false) {
-        select_rows.clear();
-        condition = conditions.back();
-        conditions.pop_back();
-        compare = condition->child_->next_;
-        oper = compare->val_;
-        col_name = compare->child_->val_;
-        val = compare->child_->next_->val_;
-        GetRowSet(database_now, another_set, my_table_info, oper, col_name, val, local_heap);
-        // union / intersect
-        tmp_val = condition->val_;
-        if (tmp_val == "and")
-          Intersect(base_set, another_set, select_rows);
-        else if (tmp_val == "or")
-          Union(base_set, another_set, select_rows);
-
-        base_set = select_rows;
+    std::cout << select_ids.size() << " rows are effected\n";
+    // the new values are the same for every row
+    std::vector<Field *> values;
+    for (size_t j = 0; j < key_map.size(); j++) {
+      values.push_back(MakeField(new_val[j], my_table_info->GetSchema()->GetColumn(key_map[j])->GetType(), local_heap));
+      if (values.back() == nullptr) {
+        std::cerr << "Field make failed\n";
+        return DB_FAILED;
       }
     }
-
-    std::cout << select_rows.size() << " rows are effected\n";
-    //delete
-    IndexInfo *tmp_index;
-    for (auto z = select_rows.begin(); z != select_rows.end(); z++) {
-      // delete from table
-      my_table_info->GetTableHeap()->MarkDelete(z->GetRowId(), nullptr);
-      // delete from index
-      for (auto i = ((*(database_now->catalog_mgr_->GetIndexNames_()))[table_name]).begin();
-           i != ((*(database_now->catalog_mgr_->GetIndexNames_()))[table_name]).end(); i++) {
-        std::vector<Field> key_field;
-        tmp_index = (*(database_now->catalog_mgr_->GetIndexs_()))[i->second];
-        // get keys
-        for (auto j = tmp_index->GetIndexKeySchema()->GetColumns().begin();
-             j != tmp_index->GetIndexKeySchema()->GetColumns().end(); j++)
-          key_field.push_back(*(z->GetField((*j)->GetTableInd())));
-        Row key = Row(key_field);
-        (*(database_now->catalog_mgr_->GetIndexs_()))[i->second]->GetIndex()->RemoveEntry(key, z->GetRowId(), nullptr);
+    // only the keys of the indexes on an updated column change
+    std::vector<IndexInfo *> changed_indexes;
+    for (auto index : plan.indexes_) {
+      for (auto column : index->GetIndexKeySchema()->GetColumns()) {
+        if (std::find(key_map.begin(), key_map.end(), column->GetTableInd()) != key_map.end()) {
+          changed_indexes.push_back(index);
+          break;
+        }
       }
     }
-    // prepare to insert
-    for (auto z = select_rows.begin(); z != select_rows.end(); z++) {
-      for (auto j = key_map.begin(); j != key_map.end();j++) {
-        z->GetFields()[*j] =
-            MakeField(new_val[j - key_map.begin()], my_table_info->GetSchema()->GetColumn(*j)->GetType(), local_heap);
+    // read all the rows before the first one changes, a new pk or unique key which is taken rejects the
+    // statement before any row changes
+    std::vector<char> data;
+    std::vector<TupleView> tuples;
+    CopyTuples(my_table_info->GetTableHeap(), select_ids, data, tuples);
+    if (CheckUpdateKeys(plan, changed_indexes, tuples, key_map, values) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    Row new_row(INVALID_ROWID);
+    for (auto &tuple : tuples) {
+      tuple.Materialize(&new_row);
+      for (size_t j = 0; j < key_map.size(); j++) {
+        new_row.SetField(key_map[j], *values[j]);
+      }
+      if (UpdateRow(plan, changed_indexes, tuple, new_row) != DB_SUCCESS) {
+        return DB_FAILED;
       }
-      // insert
-      Insert(database_now, my_table_info, &(*z));
     }
 
     return DB_SUCCESS;
@@ -921,35 +1434,17 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext* context)
     //ļ
     if (test_file.good()) {
         test_file.close();
-        FILE* txt = fopen(txt_name.c_str(), "r");
-        char code[1024];
-        while (!feof(txt)) {
-            fscanf(txt, "%[^;]%*c", code);
-            if (feof(txt)) break;
-            strcat(code, ";");
-            YY_BUFFER_STATE bp = yy_scan_string(code);
-            cout << "code = " << code << endl;
-            if (bp == nullptr) {
-                LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-                exit(-1);
-            }
-            yy_switch_to_buffer(bp);
-            MinisqlParserInit();
-            yyparse();
-            if (MinisqlParserGetError()) {
-                printf("%s\n", MinisqlParserGetErrorMessage());
-            }
-            Execute(MinisqlGetParserRootNode(), context);
-            //sleep(1);
-            MinisqlParserFinish();
-            yy_delete_buffer(bp);
-            yylex_destroy();
+        ifstream txt(txt_name, ios::in);
+        std::string code;
+        while (getline(txt, code, ';')) {
+            if (code.find_first_not_of(" \t\r\n") == std::string::npos) break;
+            code += ";";
+            ExecuteSql(code.c_str(), context);
             if (context->flag_quit_) {
-                printf("bye!\n");
+                std::cout << "bye!" << std::endl;
                 break;
             }
         }
-        fclose(txt);
         return DB_SUCCESS;
     }
     //ļ
@@ -987,7 +1482,7 @@ dberr_t ExecuteEngine::TransferPks(std::vector<std::string> &in, std::vector<Col
   return DB_SUCCESS;
 }
 //Where clouse
-Field *ExecuteEngine::MakeField(std::string &expect_val, TypeId tmp_type,SimpleMemHeap &heap) {  
+Field *ExecuteEngine::MakeField(std::string &expect_val, TypeId tmp_type, MemHeap &heap) {  
   Field *tmp_field;
   if (tmp_type == kTypeInt) {
     int32_t tmp_compare_val = stoi(expect_val);
@@ -1007,195 +1502,1009 @@ Field *ExecuteEngine::MakeField(std::string &expect_val, TypeId tmp_type,SimpleM
   return tmp_field;
 }
 
-dberr_t ExecuteEngine::GetRowSet(DBStorageEngine *database_now, std::vector<Row> &result, TableInfo *table,
-                                 std::string &condition,
-               string compare_column_name,std::string &val,SimpleMemHeap &heap) {
-  //get the column
-  Column *target = nullptr;
-  for (auto i = table->GetSchema()->GetColumns().begin(); i != table->GetSchema()->GetColumns().end();i++) {
-    if ((*i)->GetName() == compare_column_name) {
-      target = (*i);
-      break;
+dberr_t ExecuteEngine::ResolveTablePlan(DBStorageEngine *database_now, const std::string &table_name,
+                                        TablePlan &plan) {
+  plan = TablePlan();
+  if (database_now->catalog_mgr_->GetTable(table_name, plan.table_) != DB_SUCCESS) {
+    return DB_TABLE_NOT_EXIST;
+  }
+  database_now->catalog_mgr_->GetTableIndexes(table_name, plan.indexes_);
+  for (auto index : plan.indexes_) {
+    if (index->GetIndexName() == PKINDEX) plan.pk_index_ = index;
+  }
+  // the pk index first, then the indexes of unique columns
+  if (plan.pk_index_ != nullptr) plan.unique_indexes_.push_back(plan.pk_index_);
+  for (auto index : plan.indexes_) {
+    const auto &key_columns = index->GetIndexKeySchema()->GetColumns();
+    if (index != plan.pk_index_ && key_columns.size() == 1 && key_columns[0]->IsUnique()) {
+      plan.unique_indexes_.push_back(index);
     }
-    if (i == table->GetSchema()->GetColumns().end()) {
-      std::cerr << "Where condition is wrong, Cannot find the column\n";
+  }
+  plan.database_ = database_now;
+  plan.catalog_version_ = database_now->catalog_mgr_->GetVersion();
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ResolveColumn(const TablePlan &plan, const std::string &name, uint32_t &column) {
+  size_t dot = name.find('.');
+  if (dot == std::string::npos) {
+    return plan.table_->GetSchema()->GetColumnIndex(name, column);
+  }
+  if (name.substr(0, dot) != plan.table_->GetTableName()) {
+    return DB_COLUMN_NAME_NOT_EXIST;
+  }
+  return plan.table_->GetSchema()->GetColumnIndex(name.substr(dot + 1), column);
+}
+
+dberr_t ExecuteEngine::ResolveJoinColumn(const std::vector<TablePlan> &plans, const std::string &name,
+                                         uint32_t &table, uint32_t &column) {
+  bool found = false;
+  for (uint32_t t = 0; t < plans.size(); t++) {
+    uint32_t index = 0;
+    if (ResolveColumn(plans[t], name, index) != DB_SUCCESS) continue;
+    if (found) {
+      std::cerr << "Column " << name << " is ambiguous\n";
       return DB_FAILED;
     }
+    found = true;
+    table = t;
+    column = index;
   }
-  //try to find a index
-  auto vec = &((*(database_now->catalog_mgr_->GetIndexNames_()))[table->GetTableName()]);
-  auto i = vec->begin();
-  for (; i != vec->end(); i++) {
-    uint32_t num = 0;
-    if (((*(database_now->catalog_mgr_->GetIndexs_()))[i->second])->GetIndexKeySchema()->GetColumnCount() == 1 &&
-        ((*(database_now->catalog_mgr_->GetIndexs_()))[i->second])
-                ->GetIndexKeySchema()
-                ->GetColumnIndex(compare_column_name, num) == DB_SUCCESS) {
-      break;
+  if (!found) {
+    std::cerr << "Wrong column\n";
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::CollectJoinTables(const std::vector<TablePlan> &plans, pSyntaxNode condition,
+                                         std::set<uint32_t> &tables) {
+  if (condition->type_ == kNodeConnector) {
+    if (CollectJoinTables(plans, condition->child_, tables) != DB_SUCCESS) {
+      return DB_FAILED;
     }
+    return CollectJoinTables(plans, condition->child_->next_, tables);
   }
-  //get the key
-  Field *key_f = MakeField(val, target->GetType(), heap);
-  Field *record_field = nullptr;
-  if (key_f == nullptr) {
-    std::cerr << "Field make failed\n";
+  if (condition->child_->next_->type_ == kNodeIdentifier) {
+    std::cerr << "Compare of two columns is only supported in the and of the where conditions\n";
     return DB_FAILED;
   }
+  uint32_t table = 0, column = 0;
+  if (ResolveJoinColumn(plans, condition->child_->val_, table, column) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  tables.insert(table);
+  return DB_SUCCESS;
+}
 
-  std::vector<Field> key_fs;
-  key_fs.push_back(*key_f);
-  Row key = Row(key_fs);
-  std::vector<RowId> result_ids;
-  
-  if (condition == "=") {
-    if (i != vec->end()) {
-      ((*(database_now->catalog_mgr_->GetIndexs_()))[i->second])->GetIndex()->ScanKey(key, result_ids, nullptr);
-      for (auto j = result_ids.begin(); j != result_ids.end(); j++)
-      {
-        Row tmp_row = Row(*j);
-        table->GetTableHeap()->GetTuple(&tmp_row, nullptr);
-        result.push_back(tmp_row);
+dberr_t ExecuteEngine::SelectRowIds(const TablePlan &plan, pSyntaxNode condition, std::vector<RowId> &result,
+                                    MemHeap &heap) {
+  result.clear();
+  AccessPath path;
+  if (condition != nullptr) {
+    ChooseAccessPath(plan, condition, heap, path);
+  }
+  if (path.lookups_.empty()) {
+    // only the row ids are needed, no column but the compared ones is read
+    ChunkFilter filter;
+    uint32_t id = 0;
+    if (condition != nullptr && CompileFilter(plan, condition, heap, filter, id) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+    if (!filter.IsEmpty() && scan_workers_ > 1) {
+      ParallelScan parallel_scan(plan.table_->GetTableHeap(), filter, scan_workers_);
+      if (parallel_scan.IsWorthwhile()) {
+        parallel_scan.Run(result);
+        return DB_SUCCESS;
       }
-    }else {
-      for (auto i = table->GetTableHeap()->Begin(nullptr); i != table->GetTableHeap()->End(); i++) {
-        record_field = i->GetField(target->GetTableInd());
-        if (record_field->CompareEquals(*key_f) == true) result.push_back(*i);
+    }
+    uint64_t selection[FILTER_VECTOR_SIZE / 64];
+    for (auto iter = plan.table_->GetTableHeap()->ChunkBegin(filter.GetColumns()); !iter.IsEnd(); ++iter) {
+      filter.Evaluate(*iter, selection);
+      ForEachSelected(selection, iter->GetSize(), [&](uint32_t i) { result.push_back(iter->GetRowId(i)); });
+    }
+    return DB_SUCCESS;
+  }
+  // the row ids of the probes of a lookup united, the lookups intersected
+  RowIdBitmap bitmap;
+  std::vector<RowId> ids;
+  for (size_t i = 0; i < path.lookups_.size() && (i == 0 || !bitmap.IsEmpty()); i++) {
+    RowIdBitmap either;
+    for (auto &probe : path.lookups_[i].probes_) {
+      TypeId type = plan.table_->GetSchema()->GetColumn(probe.column_)->GetType();
+      Field *value = MakeCompareValue(probe.compare_, type, heap);
+      if (value == nullptr) {
+        std::cerr << "Field make failed\n";
+        return DB_FAILED;
       }
+      std::vector<Field> key_fields;
+      key_fields.emplace_back(*value);
+      Row key(key_fields);
+      ids.clear();
+      probe.index_->GetIndex()->ScanKey(key, ids, nullptr);
+      either.Or(RowIdBitmap::FromRowIds(ids));
+    }
+    if (i == 0) {
+      bitmap = std::move(either);
+    } else {
+      bitmap.And(either);
     }
+  }
+  if (path.exact_) {
+    bitmap.ToRowIds(result);
+    return DB_SUCCESS;
+  }
+  // the rest of the condition is checked on the pages of the rows found, in page order, every page is
+  // read once and only the selected slots are kept
+  ChunkFilter filter;
+  uint32_t id = 0;
+  if (CompileFilter(plan, condition, heap, filter, id) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  const std::vector<page_id_t> &pages = bitmap.GetPageIds();
+  uint64_t selection[FILTER_VECTOR_SIZE / 64];
+  uint64_t mask[FILTER_VECTOR_SIZE / 64];
+  uint32_t k = 0;
+  TableChunkIterator iter(plan.table_->GetTableHeap(), pages.data(), pages.size(), filter.GetColumns());
+  for (; !iter.IsEnd(); ++iter) {
+    RowId first = iter->GetRowId(0);
+    while (pages[k] != first.GetPageId()) {
+      k++;
+    }
+    bitmap.GetSlotBits(k, first.GetSlotNum(), iter->GetSize(), mask);
+    filter.Evaluate(*iter, selection);
+    SelectionAnd(selection, mask, iter->GetSize());
+    ForEachSelected(selection, iter->GetSize(), [&](uint32_t i) { result.push_back(iter->GetRowId(i)); });
+  }
+  return DB_SUCCESS;
+}
 
+bool ExecuteEngine::UseIndexScan(const TablePlan &plan, pSyntaxNode condition) {
+  AccessPath path;
+  ChooseAccessPath(plan, condition, query_heap_, path);
+  return !path.lookups_.empty();
+}
 
+/**
+ * Collect the operands of the and of condition, a condition that is no and is its only operand.
+ */
+static void CollectConjuncts(pSyntaxNode condition, std::vector<pSyntaxNode> &conjuncts) {
+  if (condition->type_ == kNodeConnector && std::string(condition->val_) == "and") {
+    CollectConjuncts(condition->child_, conjuncts);
+    CollectConjuncts(condition->child_->next_, conjuncts);
+    return;
+  }
+  conjuncts.push_back(condition);
+}
 
-  } else if (condition == ">") {
-    for (auto i = table->GetTableHeap()->Begin(nullptr); i != table->GetTableHeap()->End(); i++) {
-      record_field = i->GetField(target->GetTableInd());
-      if (record_field->CompareGreaterThan(*key_f) == true) result.push_back(*i);
+void ExecuteEngine::ChooseAccessPath(const TablePlan &plan, pSyntaxNode condition, MemHeap &heap, AccessPath &path) {
+  path = AccessPath();
+  double pages = std::max<uint32_t>(plan.table_->GetTableHeap()->GetPageCount(), 1);
+  double rows = EstimateRowCount(plan);
+  path.cost_ = pages * AccessPath::SEQ_PAGE_COST + rows * AccessPath::CPU_TUPLE_COST;
+  // the equalities with a constant, or ors of them, on columns with a single column index
+  std::vector<pSyntaxNode> conjuncts;
+  CollectConjuncts(condition, conjuncts);
+  std::vector<std::pair<double, AccessPath::Lookup>> candidates;
+  for (auto conjunct : conjuncts) {
+    AccessPath::Lookup lookup;
+    if (MakeLookup(plan, conjunct, lookup)) {
+      candidates.push_back({EstimateSelectivity(plan, conjunct, heap), lookup});
     }
-  } else if (condition == "<") {
-    for (auto i = table->GetTableHeap()->Begin(nullptr); i != table->GetTableHeap()->End(); i++) {
-      record_field = i->GetField(target->GetTableInd());
-      if (record_field->CompareLessThan(*key_f) == true) result.push_back(*i);
+  }
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const std::pair<double, AccessPath::Lookup> &a, const std::pair<double, AccessPath::Lookup> &b) {
+                     return a.first < b.first;
+                   });
+  // every further lookup costs its row ids, and saves the fetches of the rows it rules out
+  double lookup_cost = 0, share = 1;
+  for (size_t k = 0; k < candidates.size(); k++) {
+    lookup_cost += candidates[k].second.probes_.size() * AccessPath::INDEX_PROBE_COST +
+                   rows * candidates[k].first * AccessPath::INDEX_ENTRY_COST;
+    share *= candidates[k].first;
+    double cost = lookup_cost + rows * share * AccessPath::ROW_FETCH_COST;
+    if (cost < path.cost_) {
+      path.cost_ = cost;
+      path.lookups_.clear();
+      for (size_t i = 0; i <= k; i++) {
+        path.lookups_.push_back(candidates[i].second);
+      }
+    }
+  }
+  path.exact_ = !path.lookups_.empty() && path.lookups_.size() == conjuncts.size();
+}
+
+bool ExecuteEngine::MakeLookup(const TablePlan &plan, pSyntaxNode condition, AccessPath::Lookup &lookup) {
+  if (condition->type_ == kNodeConnector) {
+    return std::string(condition->val_) == "or" && MakeLookup(plan, condition->child_, lookup) &&
+           MakeLookup(plan, condition->child_->next_, lookup);
+  }
+  uint32_t column = 0;
+  if (condition->type_ != kNodeCompareOperator || std::string(condition->val_) != "=" ||
+      condition->child_->next_->type_ == kNodeIdentifier ||
+      ResolveColumn(plan, condition->child_->val_, column) != DB_SUCCESS) {
+    return false;
+  }
+  const std::string &name = plan.table_->GetSchema()->GetColumn(column)->GetName();
+  for (auto index : plan.indexes_) {
+    if (index->GetIndexKeySchema()->GetColumnCount() == 1 && index->GetIndexKeySchema()->GetColumn(0)->GetName() == name) {
+      lookup.probes_.push_back({index, condition, column});
+      return true;
     }
-  } else if (condition == ">=") {
-    for (auto i = table->GetTableHeap()->Begin(nullptr); i != table->GetTableHeap()->End(); i++) {
-      record_field = i->GetField(target->GetTableInd());
-      if (record_field->CompareGreaterThanEquals(*key_f) == true) result.push_back(*i);
+  }
+  return false;
+}
+
+double ExecuteEngine::EstimateSelectivity(const TablePlan &plan, pSyntaxNode condition, MemHeap &heap) {
+  if (condition->type_ == kNodeConnector) {
+    double left = EstimateSelectivity(plan, condition->child_, heap);
+    double right = EstimateSelectivity(plan, condition->child_->next_, heap);
+    return std::string(condition->val_) == "and" ? left * right : left + right - left * right;
+  }
+  CompareOp op = GetCompareOp(condition->val_);
+  uint32_t column = 0;
+  if (condition->child_->next_->type_ == kNodeIdentifier ||
+      ResolveColumn(plan, condition->child_->val_, column) != DB_SUCCESS) {
+    return TableStatistics::DefaultSelectivity(op);
+  }
+  const Column *target = plan.table_->GetSchema()->GetColumn(column);
+  double selectivity = TableStatistics::DefaultSelectivity(op);
+  TableStatistics *statistics = plan.database_->catalog_mgr_->GetStatistics(plan.table_->GetTableId());
+  if (statistics != nullptr) {
+    statistics->Refresh();
+    Field *value = MakeCompareValue(condition, target->GetType(), heap);
+    if (value != nullptr) {
+      selectivity = statistics->Selectivity(column, op, *value);
     }
-  } else if (condition == "<=") {
-    for (auto i = table->GetTableHeap()->Begin(nullptr); i != table->GetTableHeap()->End(); i++) {
-      record_field = i->GetField(target->GetTableInd());
-      if (record_field->CompareLessThanEquals(*key_f) == true) result.push_back(*i);
+  }
+  // a value of a unique column or of a single column pk is in one row at most
+  bool unique = target->IsUnique() || (plan.pk_index_ != nullptr && plan.pk_index_->GetIndexKeySchema()->GetColumnCount() == 1 &&
+                                       plan.pk_index_->GetIndexKeySchema()->GetColumn(0)->GetName() == target->GetName());
+  if (op == kCmpEq && unique) {
+    selectivity = std::min(selectivity, 1.0 / std::max(EstimateRowCount(plan), 1.0));
+  }
+  return selectivity;
+}
+
+double ExecuteEngine::EstimateRowCount(const TablePlan &plan) {
+  const TableStatistics *statistics = plan.database_->catalog_mgr_->GetStatistics(plan.table_->GetTableId());
+  if (statistics == nullptr) {
+    return static_cast<double>(plan.table_->GetTableHeap()->GetPageCount()) * AccessPath::DEFAULT_ROWS_PER_PAGE;
+  }
+  // the row count follows the inserts and deletes
+  return static_cast<double>(statistics->row_count_);
+}
+
+Field *ExecuteEngine::MakeCompareValue(pSyntaxNode compare, TypeId type, MemHeap &heap) {
+  // the constant of a char compare points into the syntax tree, which outlives the statement
+  const char *val = compare->child_->next_->val_;
+  if (type == kTypeChar) {
+    return new (heap.Allocate(sizeof(Field))) Field(kTypeChar, const_cast<char *>(val), strlen(val), false);
+  }
+  std::string val_str = val;
+  return MakeField(val_str, type, heap);
+}
+
+dberr_t ExecuteEngine::CompileFilter(const TablePlan &plan, pSyntaxNode condition, MemHeap &heap, ChunkFilter &filter,
+                                     uint32_t &id) {
+  if (condition->type_ == kNodeConnector && std::string(condition->val_) == "and") {
+    // the later operands of an and are skipped for the chunks where no tuple passed the earlier ones
+    std::vector<pSyntaxNode> conjuncts;
+    CollectConjuncts(condition, conjuncts);
+    std::vector<std::pair<double, pSyntaxNode>> operands;
+    for (auto conjunct : conjuncts) {
+      operands.emplace_back(EstimateSelectivity(plan, conjunct, heap), conjunct);
+    }
+    std::stable_sort(operands.begin(), operands.end(),
+                     [](const std::pair<double, pSyntaxNode> &a, const std::pair<double, pSyntaxNode> &b) {
+                       return a.first < b.first;
+                     });
+    for (size_t i = 0; i < operands.size(); i++) {
+      uint32_t operand = 0;
+      if (CompileFilter(plan, operands[i].second, heap, filter, operand) != DB_SUCCESS) {
+        return DB_FAILED;
+      }
+      id = i == 0 ? operand : filter.AddConnector(true, id, operand);
     }
-  } else if (condition == "<>") {
-    for (auto i = table->GetTableHeap()->Begin(nullptr); i != table->GetTableHeap()->End(); i++) {
-      record_field = i->GetField(target->GetTableInd());
-      if (record_field->CompareNotEquals(*key_f) == true) result.push_back(*i);
+    return DB_SUCCESS;
+  }
+  if (condition->type_ == kNodeConnector) {
+    uint32_t left = 0, right = 0;
+    if (CompileFilter(plan, condition->child_, heap, filter, left) != DB_SUCCESS ||
+        CompileFilter(plan, condition->child_->next_, heap, filter, right) != DB_SUCCESS) {
+      return DB_FAILED;
     }
+    id = filter.AddConnector(std::string(condition->val_) == "and", left, right);
+    return DB_SUCCESS;
+  }
+  if (condition->child_->next_->type_ == kNodeIdentifier) {
+    std::cerr << "Compare of two columns is only supported in a join\n";
+    return DB_FAILED;
+  }
+  const Schema *schema = plan.table_->GetSchema();
+  uint32_t column = 0;
+  if (ResolveColumn(plan, condition->child_->val_, column) != DB_SUCCESS) {
+    std::cerr << "Where condition is wrong, Cannot find the column\n";
+    return DB_FAILED;
   }
+  CompareOp op = GetCompareOp(condition->val_);
+  if (op == kCmpInvalid) {
+    std::cerr << "Unknown compare operator " << condition->val_ << "\n";
+    return DB_FAILED;
+  }
+  Field *value = MakeCompareValue(condition, schema->GetColumn(column)->GetType(), heap);
+  if (value == nullptr) {
+    std::cerr << "Field make failed\n";
+    return DB_FAILED;
+  }
+  id = filter.AddCompare(column, op, value);
+  return DB_SUCCESS;
+}
 
+dberr_t ExecuteEngine::ResolveOrderBy(pSyntaxNode ast,
+                                      const std::function<dberr_t(const std::string &, uint32_t &)> &resolve,
+                                      std::vector<SortKey> &keys, uint64_t &limit) {
+  keys.clear();
+  limit = ExternalSort::NO_LIMIT;
+  for (pSyntaxNode node = ast->child_->next_->next_; node != nullptr; node = node->next_) {
+    if (node->type_ == kNodeOrderBy) {
+      for (pSyntaxNode item = node->child_; item != nullptr; item = item->next_) {
+        SortKey key{0, std::string(item->val_) == "desc"};
+        if (resolve(item->child_->val_, key.column_) != DB_SUCCESS) {
+          return DB_FAILED;
+        }
+        keys.push_back(key);
+      }
+    } else if (node->type_ == kNodeLimit) {
+      std::string value = node->child_->val_;
+      if (value.empty() || value.size() > 18 || value.find_first_not_of("0123456789") != std::string::npos) {
+        std::cerr << "Limit must be a non-negative integer\n";
+        return DB_FAILED;
+      }
+      limit = std::stoull(value);
+    }
+  }
   return DB_SUCCESS;
 }
 
-void ExecuteEngine::Intersect(std::vector<Row> &a, std::vector<Row> &b, std::vector<Row> &result) {
-  std::unordered_map<int64_t, Row *> map;
-  for (auto i = a.begin(); i != a.end(); i++) {
-    map.insert(make_pair((i->GetRowId().Get()), &(*i)));
+dberr_t ExecuteEngine::SelectInIndexOrder(const TablePlan &plan, IndexInfo *index, pSyntaxNode condition,
+                                          ResultSink &sink, MemHeap &heap) {
+  ChunkFilter filter;
+  uint32_t id = 0;
+  if (condition != nullptr && CompileFilter(plan, condition, heap, filter, id) != DB_SUCCESS) {
+    return DB_FAILED;
   }
+  using TreeIndex = BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>;
+  auto *tree = static_cast<TreeIndex *>(index->GetIndex());
+  TableHeap *table_heap = plan.table_->GetTableHeap();
+  Schema *schema = plan.table_->GetSchema();
+  Row row(INVALID_ROWID);
+  std::vector<char> buf;
+  auto end = tree->GetEndIterator();
+  for (auto iter = tree->GetBeginIterator(); iter != end; ++iter) {
+    row.SetRowId((*iter).second);
+    if (!table_heap->GetTuple(&row, nullptr)) continue;
+    buf.resize(row.GetSerializedSize(schema));
+    row.SerializeTo(buf.data(), schema);
+    TupleView tuple(buf.data(), schema, row.GetRowId());
+    if (!filter.Evaluate(tuple)) continue;
+    if (!sink.Consume(tuple)) break;
+  }
+  return DB_SUCCESS;
+}
 
-  for (auto i = b.begin(); i != b.end(); i++) {
-    if (map.find(i->GetRowId().Get()) != map.end()) {
-      result.push_back(*i);
-    } else {
-      // not exists in both set
+dberr_t ExecuteEngine::SelectChunks(const TablePlan &plan, pSyntaxNode condition, const std::vector<uint32_t> &output,
+                                    ResultSink &sink, MemHeap &heap) {
+  ChunkFilter filter;
+  uint32_t id = 0;
+  if (condition != nullptr && CompileFilter(plan, condition, heap, filter, id) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  TableHeap *table_heap = plan.table_->GetTableHeap();
+  if (!filter.IsEmpty() && scan_workers_ > 1) {
+    // a large table is filtered by several threads, the results still come in table order
+    ParallelScan parallel_scan(table_heap, filter, scan_workers_);
+    if (parallel_scan.IsWorthwhile()) {
+      parallel_scan.Run(output, sink);
+      return DB_SUCCESS;
     }
   }
+  // the output columns of a chunk are only decoded once the filter selected some of its tuples
+  auto iter = filter.IsEmpty() ? table_heap->ChunkBegin(output) : table_heap->ChunkBegin(filter.GetColumns(), output);
+  uint64_t selection[FILTER_VECTOR_SIZE / 64];
+  for (; !iter.IsEnd(); ++iter) {
+    filter.Evaluate(*iter, selection);
+    uint64_t any = 0;
+    for (uint32_t w = 0; w < SelectionWords(iter->GetSize()); w++) {
+      any |= selection[w];
+    }
+    if (any == 0) continue;
+    iter.LoadLazyColumns();
+    if (!sink.ConsumeChunk(*iter, selection)) break;
+  }
+  return DB_SUCCESS;
 }
 
-void ExecuteEngine::Union(std::vector<Row> &a, std::vector<Row> &b, std::vector<Row> &result) {
-  std::unordered_map<int64_t, Row *> map;
-  for (auto i = a.begin(); i != a.end(); i++) {
-    map.insert(make_pair((i->GetRowId().Get()), &(*i)));
-    result.push_back(*i);
+/**
+ * @return the columns of the table in the key of index
+ */
+static std::vector<uint32_t> KeyColumns(IndexInfo *index) {
+  std::vector<uint32_t> key_columns;
+  for (auto column : index->GetIndexKeySchema()->GetColumns()) {
+    key_columns.push_back(column->GetTableInd());
   }
+  return key_columns;
+}
 
-  for (auto i = b.begin(); i != b.end(); i++) {
-    if (map.find(i->GetRowId().Get()) != map.end()) {
-        //already exists
-    } else {
-      result.push_back(*i);
+static Row MakeKey(const Row &row, const std::vector<uint32_t> &key_columns) {
+  std::vector<Field> key_fields;
+  for (auto column : key_columns) {
+    key_fields.push_back(*row.GetField(column));
+  }
+  return Row(key_fields);
+}
+
+/**
+ * Tell that the key of a row is already taken in index, one of the indexes enforcing a constraint.
+ */
+static void ReportDuplicate(const TablePlan &plan, IndexInfo *index) {
+  if (index == plan.pk_index_) {
+    std::cerr << "PK Already exists\n";
+  } else if (index->GetIndexKeySchema()->GetColumnCount() > 1) {
+    std::cerr << "Key of index " << index->GetIndexName() << " Already exists\n";
+  } else {
+    std::cerr << "Unique item " << index->GetIndexKeySchema()->GetColumn(0)->GetName() << " Already exists\n";
+  }
+}
+
+/**
+ * Order two tuples by the given key columns, null sorts first.
+ */
+static bool TupleKeyLess(const TupleView &a, const TupleView &b, const std::vector<uint32_t> &key_columns) {
+  for (auto column : key_columns) {
+    if (a.IsNull(column) || b.IsNull(column)) {
+      if (a.IsNull(column) != b.IsNull(column)) return a.IsNull(column);
+      continue;
+    }
+    switch (a.GetSchema()->GetColumn(column)->GetType()) {
+      case kTypeInt:
+        if (a.GetInt(column) != b.GetInt(column)) return a.GetInt(column) < b.GetInt(column);
+        break;
+      case kTypeFloat:
+        if (a.GetFloat(column) != b.GetFloat(column)) return a.GetFloat(column) < b.GetFloat(column);
+        break;
+      default: {
+        uint32_t a_length = a.GetCharLength(column), b_length = b.GetCharLength(column);
+        int cmp = memcmp(a.GetChars(column), b.GetChars(column), std::min(a_length, b_length));
+        if (cmp != 0) return cmp < 0;
+        if (a_length != b_length) return a_length < b_length;
+      }
     }
   }
+  return false;
 }
 
-dberr_t ExecuteEngine::Insert(DBStorageEngine *database_now, TableInfo *my_table_info, Row *my_row) {
-  // get pks
-  vector<Field> pk_fields;
+void ExecuteEngine::RemoveIndexEntries(const std::vector<IndexInfo *> &indexes, const std::vector<TupleView> &tuples) {
+  ArenaMemHeap key_heap;
+  std::vector<uint32_t> order(tuples.size());
+  for (auto index : indexes) {
+    std::vector<uint32_t> key_columns = KeyColumns(index);
+    // consecutive removes descend the same paths of the tree, their pages are still in the buffer pool
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return TupleKeyLess(tuples[a], tuples[b], key_columns); });
+    for (auto i : order) {
+      // the key only lives until the entry is removed
+      key_heap.Reset();
+      Row key(tuples[i].GetRowId(), &key_heap);
+      tuples[i].Project(key_columns, &key);
+      index->GetIndex()->RemoveEntry(key, tuples[i].GetRowId(), nullptr);
+    }
+  }
+}
+
+void ExecuteEngine::MoveIndexEntries(const std::vector<IndexInfo *> &indexes, const std::vector<TupleView> &tuples,
+                                     const std::vector<RowId> &old_row_ids) {
+  ArenaMemHeap key_heap;
+  std::vector<uint32_t> order(tuples.size());
+  for (auto index : indexes) {
+    std::vector<uint32_t> key_columns = KeyColumns(index);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](uint32_t a, uint32_t b) { return TupleKeyLess(tuples[a], tuples[b], key_columns); });
+    for (auto i : order) {
+      key_heap.Reset();
+      Row key(tuples[i].GetRowId(), &key_heap);
+      tuples[i].Project(key_columns, &key);
+      index->GetIndex()->RemoveEntry(key, old_row_ids[i], nullptr);
+      index->GetIndex()->InsertEntry(key, tuples[i].GetRowId(), nullptr);
+    }
+  }
+}
+
+dberr_t ExecuteEngine::Insert(DBStorageEngine *database_now, const TablePlan &plan, Row *my_row) {
+  TableInfo *my_table_info = plan.table_;
   for (auto i : my_table_info->GetSchema()->GetPks()) {
     if (my_row->GetField(i->GetTableInd())->IsNull() == true) {
       std::cerr << "PK IS NULL\n";
       return DB_FAILED;
     }
-    pk_fields.push_back(*(my_row->GetField(i->GetTableInd())));
   }
-  Row pk = Row(pk_fields);
-  // /uniqueж
-  // 1. check the pk
-  if (((*(database_now->catalog_mgr_->GetIndexNames_()))[my_table_info->GetTableName()]).find(PKINDEX) ==
-      ((*(database_now->catalog_mgr_->GetIndexNames_()))[my_table_info->GetTableName()]).end()) {
+  if (plan.pk_index_ == nullptr) {
     std::cerr << "PK INDEX CANNT FIND\n";
     return DB_FAILED;
   }
+  // insert into table, the index entries need the row id
+  TableHeap *table_heap = my_table_info->GetTableHeap();
+  if (!table_heap->InsertTuple(*my_row, nullptr)) {
+    std::cerr << "Insert tuple failed\n";
+    return DB_FAILED;
+  }
+  // insert into index, the pk and unique indexes first: every index checks its key in the same descent.
+  // The tree keeps one row per key, so an index on several columns rejects a key it holds as well, else
+  // it would miss the row. A duplicate key rolls the row back from the indexes before and from the table
+  std::vector<IndexInfo *> indexes = plan.unique_indexes_;
+  for (auto index : plan.indexes_) {
+    if (std::find(indexes.begin(), indexes.end(), index) == indexes.end()) {
+      indexes.push_back(index);
+    }
+  }
+  for (size_t k = 0; k < indexes.size(); k++) {
+    IndexInfo *index = indexes[k];
+    if (index->GetIndex()->InsertEntry(MakeKey(*my_row, KeyColumns(index)), my_row->GetRowId(), nullptr) == DB_SUCCESS) {
+      continue;
+    }
+    ReportDuplicate(plan, index);
+    for (size_t i = 0; i < k; i++) {
+      IndexInfo *inserted = indexes[i];
+      inserted->GetIndex()->RemoveEntry(MakeKey(*my_row, KeyColumns(inserted)), my_row->GetRowId(), nullptr);
+    }
+    table_heap->MarkDelete(my_row->GetRowId(), nullptr);
+    table_heap->ApplyDelete(my_row->GetRowId(), nullptr);
+    return DB_FAILED;
+  }
+  TableStatistics *statistics = database_now->catalog_mgr_->GetStatistics(my_table_info->GetTableId());
+  if (statistics != nullptr) statistics->InsertRow(*my_row);
+  return DB_SUCCESS;
+}
+
+/**
+ * Order two rows by the given key columns, null sorts first.
+ */
+static bool KeyLess(const Row &a, const Row &b, const std::vector<uint32_t> &key_columns) {
+  for (auto column : key_columns) {
+    Field *x = a.GetField(column), *y = b.GetField(column);
+    if (x->IsNull() || y->IsNull()) {
+      if (x->IsNull() != y->IsNull()) return x->IsNull();
+      continue;
+    }
+    if (x->CompareLessThan(*y) == CmpBool::kTrue) return true;
+    if (x->CompareGreaterThan(*y) == CmpBool::kTrue) return false;
+  }
+  return false;
+}
 
-  index_id_t tmp_index_id = ((*(database_now->catalog_mgr_->GetIndexNames_()))[my_table_info->GetTableName()])[PKINDEX];
-  if (database_now->catalog_mgr_->GetIndexs_()->find(tmp_index_id) == database_now->catalog_mgr_->GetIndexs_()->end()) {
+dberr_t ExecuteEngine::BulkInsert(const TablePlan &plan, std::vector<Row> &rows, uint32_t &rejected) {
+  TableInfo *my_table_info = plan.table_;
+  if (plan.pk_index_ == nullptr) {
     std::cerr << "PK INDEX CANNT FIND\n";
     return DB_FAILED;
   }
-
-  IndexInfo *tmp_index = (*(database_now->catalog_mgr_->GetIndexs_()))[tmp_index_id];
-  std::vector<RowId> tmp_result;
-  tmp_index->GetIndex()->ScanKey(pk, tmp_result, nullptr);
-  if (tmp_result.empty() != true) {
-    std::cerr << "PK Already exists\n";
+  // rows with a null pk never reach the heap
+  std::vector<bool> pk_null(rows.size(), false);
+  uint32_t pk_null_count = 0;
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (auto column : my_table_info->GetSchema()->GetPks()) {
+      pk_null[i] = pk_null[i] || rows[i].GetField(column->GetTableInd())->IsNull();
+    }
+    pk_null_count += pk_null[i];
+  }
+  std::vector<Row> filtered;
+  if (pk_null_count > 0) {
+    for (size_t i = 0; i < rows.size(); i++) {
+      if (!pk_null[i]) filtered.push_back(rows[i]);
+    }
+    rejected += pk_null_count;
+  }
+  std::vector<Row> &batch = pk_null_count > 0 ? filtered : rows;
+  if (batch.empty()) {
+    return DB_SUCCESS;
+  }
+  // 1. append the whole batch to the heap
+  if (!my_table_info->GetTableHeap()->AppendTuples(batch, nullptr)) {
+    std::cerr << "Append tuples failed\n";
+    for (auto &row : batch) {
+      if (row.GetRowId().GetPageId() != INVALID_PAGE_ID) {
+        my_table_info->GetTableHeap()->ApplyDelete(row.GetRowId(), nullptr);
+      }
+    }
     return DB_FAILED;
   }
+  // 2. build the indexes in key order, the pk and unique indexes first. Every index rejects a key it
+  // holds, the tree keeps one row per key
+  std::vector<IndexInfo *> indexes = plan.unique_indexes_;
+  for (auto index : plan.indexes_) {
+    if (std::find(indexes.begin(), indexes.end(), index) == indexes.end()) {
+      indexes.push_back(index);
+    }
+  }
+  const size_t not_rejected = indexes.size();
+  std::vector<size_t> rejected_at(batch.size(), not_rejected);  /** index that rejected the row */
+  std::vector<uint32_t> order(batch.size());
+  for (size_t k = 0; k < indexes.size(); k++) {
+    std::vector<uint32_t> key_columns = KeyColumns(indexes[k]);
+    order.clear();
+    for (uint32_t i = 0; i < batch.size(); i++) {
+      if (rejected_at[i] == not_rejected) order.push_back(i);
+    }
+    // stable: the first of several rows with the same key wins
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return KeyLess(batch[a], batch[b], key_columns); });
+    for (auto i : order) {
+      Row key = MakeKey(batch[i], key_columns);
+      if (indexes[k]->GetIndex()->InsertEntry(key, batch[i].GetRowId(), nullptr) != DB_SUCCESS) {
+        rejected_at[i] = k;
+      }
+    }
+  }
+  // 3. roll back the rejected rows from the indexes which accepted them and from the heap
+  for (uint32_t i = 0; i < batch.size(); i++) {
+    if (rejected_at[i] == not_rejected) continue;
+    for (size_t k = 0; k < rejected_at[i]; k++) {
+      indexes[k]->GetIndex()->RemoveEntry(MakeKey(batch[i], KeyColumns(indexes[k])), batch[i].GetRowId(), nullptr);
+    }
+    my_table_info->GetTableHeap()->MarkDelete(batch[i].GetRowId(), nullptr);
+    my_table_info->GetTableHeap()->ApplyDelete(batch[i].GetRowId(), nullptr);
+    rejected++;
+  }
+  TableStatistics *statistics = plan.database_->catalog_mgr_->GetStatistics(my_table_info->GetTableId());
+  if (statistics != nullptr) {
+    for (uint32_t i = 0; i < batch.size(); i++) {
+      if (rejected_at[i] == not_rejected) statistics->InsertRow(batch[i]);
+    }
+  }
+  return DB_SUCCESS;
+}
 
-  // 2. check the unique
-  for (auto i = my_table_info->GetSchema()->GetColumns().begin(); i != my_table_info->GetSchema()->GetColumns().end();
-       i++) {
-    int count = 1;
-    if ((*i)->IsUnique() == true) {
-      tmp_index_id = ((*(database_now->catalog_mgr_
-                             ->GetIndexNames_()))[my_table_info->GetTableName()])[UNIQUE_INDEX + std::to_string(count)];
-      tmp_index = (*(database_now->catalog_mgr_->GetIndexs_()))[tmp_index_id];
-      tmp_result.clear();
-      pk_fields.clear();
-      pk_fields.push_back(*(my_row->GetField((*i)->GetTableInd())));
-      Row key = Row(pk_fields);
-      tmp_index->GetIndex()->ScanKey(key, tmp_result, nullptr);
-
-      if (tmp_result.empty() != true) {
-        std::cerr << "Unique item " << (*i)->GetName() << " Already exists\n ";
+dberr_t ExecuteEngine::CheckUpdateKeys(const TablePlan &plan, const std::vector<IndexInfo *> &changed_indexes,
+                                       const std::vector<TupleView> &tuples, const std::vector<uint32_t> &columns,
+                                       const std::vector<Field *> &values) {
+  std::vector<int64_t> updated_ids;
+  for (auto &tuple : tuples) {
+    updated_ids.push_back(tuple.GetRowId().Get());
+  }
+  std::sort(updated_ids.begin(), updated_ids.end());
+  Row new_row(INVALID_ROWID);
+  std::vector<RowId> holders;
+  for (auto index : changed_indexes) {
+    std::vector<uint32_t> key_columns = KeyColumns(index);
+    std::vector<Row> keys;
+    keys.reserve(tuples.size());
+    for (auto &tuple : tuples) {
+      tuple.Materialize(&new_row);
+      for (size_t j = 0; j < columns.size(); j++) {
+        new_row.SetField(columns[j], *values[j]);
+      }
+      keys.push_back(MakeKey(new_row, key_columns));
+    }
+    std::vector<uint32_t> key_fields(key_columns.size());
+    std::iota(key_fields.begin(), key_fields.end(), 0);
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return KeyLess(keys[a], keys[b], key_fields); });
+    for (size_t i = 0; i < order.size(); i++) {
+      // two updated rows get the same key, or a row which is not updated holds it
+      bool taken = i > 0 && !KeyLess(keys[order[i - 1]], keys[order[i]], key_fields);
+      holders.clear();
+      index->GetIndex()->ScanKey(keys[order[i]], holders, nullptr);
+      for (auto &holder : holders) {
+        taken = taken || !std::binary_search(updated_ids.begin(), updated_ids.end(), holder.Get());
+      }
+      if (taken) {
+        ReportDuplicate(plan, index);
         return DB_FAILED;
       }
+    }
+  }
+  return DB_SUCCESS;
+}
 
-      count++;
+dberr_t ExecuteEngine::UpdateRow(const TablePlan &plan, const std::vector<IndexInfo *> &changed_indexes,
+                                 const TupleView &old_tuple, Row &new_row) {
+  TableHeap *table_heap = plan.table_->GetTableHeap();
+  RowId rid = old_tuple.GetRowId();
+  bool updated = true;
+  for (auto column : plan.table_->GetSchema()->GetPks()) {
+    if (updated && new_row.GetField(column->GetTableInd())->IsNull()) {
+      std::cerr << "PK IS NULL\n";
+      updated = false;
+    }
+  }
+  if (!updated) {
+    return DB_FAILED;
+  }
+  // the old keys make way for the new ones, a new key taken by another row rejects the update
+  ArenaMemHeap key_heap;
+  for (auto index : changed_indexes) {
+    key_heap.Reset();
+    Row key(rid, &key_heap);
+    old_tuple.Project(KeyColumns(index), &key);
+    index->GetIndex()->RemoveEntry(key, rid, nullptr);
+  }
+  size_t inserted = 0;
+  for (; inserted < changed_indexes.size(); inserted++) {
+    IndexInfo *index = changed_indexes[inserted];
+    if (index->GetIndex()->InsertEntry(MakeKey(new_row, KeyColumns(index)), rid, nullptr) != DB_SUCCESS) {
+      ReportDuplicate(plan, index);
+      updated = false;
+      break;
+    }
+  }
+  // in place if the tuple still fits into its page
+  if (updated && !table_heap->UpdateTuple(new_row, rid, nullptr)) {
+    std::cerr << "Update tuple failed\n";
+    updated = false;
+  }
+  if (!updated) {
+    // the row keeps its old keys
+    for (size_t k = 0; k < changed_indexes.size(); k++) {
+      std::vector<uint32_t> key_columns = KeyColumns(changed_indexes[k]);
+      if (k < inserted) {
+        changed_indexes[k]->GetIndex()->RemoveEntry(MakeKey(new_row, key_columns), rid, nullptr);
+      }
+      key_heap.Reset();
+      Row key(rid, &key_heap);
+      old_tuple.Project(key_columns, &key);
+      if (changed_indexes[k]->GetIndex()->InsertEntry(key, rid, nullptr) != DB_SUCCESS) {
+        std::cerr << "Index " << changed_indexes[k]->GetIndexName() << " lost the entry of a row\n";
+      }
     }
+    return DB_FAILED;
+  }
+  if (new_row.GetRowId().Get() != rid.Get()) {
+    // the tuple moved to another page, every index points at its new place
+    for (auto index : plan.indexes_) {
+      Row key = MakeKey(new_row, KeyColumns(index));
+      index->GetIndex()->RemoveEntry(key, rid, nullptr);
+      index->GetIndex()->InsertEntry(key, new_row.GetRowId(), nullptr);
+    }
+  }
+  TableStatistics *statistics = plan.database_->catalog_mgr_->GetStatistics(plan.table_->GetTableId());
+  if (statistics != nullptr) {
+    Row old_row(rid);
+    old_tuple.Materialize(&old_row);
+    statistics->RemoveRow(old_row);
+    statistics->InsertRow(new_row);
   }
+  return DB_SUCCESS;
+}
 
-  // insert into table
-  my_table_info->GetTableHeap()->InsertTuple(*my_row, nullptr);
-  // insert into index
-  for (auto i = ((*(database_now->catalog_mgr_->GetIndexNames_()))[my_table_info->GetTableName()]).begin();
-       i != ((*(database_now->catalog_mgr_->GetIndexNames_()))[my_table_info->GetTableName()]).end(); i++) {
-    std::vector<Field> key_field;
-    tmp_index = (*(database_now->catalog_mgr_->GetIndexs_()))[i->second];
-    // get keys
-    for (auto j = tmp_index->GetIndexKeySchema()->GetColumns().begin();
-         j != tmp_index->GetIndexKeySchema()->GetColumns().end(); j++)
-      key_field.push_back(*(my_row->GetField((*j)->GetTableInd())));
-    Row key = Row(key_field);
-    (*(database_now->catalog_mgr_->GetIndexs_()))[i->second]->GetIndex()->InsertEntry(key, my_row->GetRowId(), nullptr);
+/**
+ * Split one csv record into its values. A quoted value may contain ',' and "" for a quote,
+ * an empty or unquoted null value is a null field.
+ * @return false if a quote is not closed
+ */
+static bool SplitCsvRecord(const std::string &line, std::vector<std::string> &values, std::vector<bool> &nulls) {
+  values.clear();
+  nulls.clear();
+  size_t p = 0;
+  while (true) {
+    std::string value;
+    bool quoted = false;
+    if (p < line.size() && line[p] == '"') {
+      quoted = true;
+      for (p++;; p++) {
+        if (p >= line.size()) return false;
+        if (line[p] == '"') {
+          if (p + 1 < line.size() && line[p + 1] == '"') {
+            value.push_back('"');
+            p++;
+          } else {
+            p++;
+            break;
+          }
+        } else {
+          value.push_back(line[p]);
+        }
+      }
+    }
+    size_t end = line.find(',', p);
+    if (!quoted) {
+      value = line.substr(p, end == std::string::npos ? std::string::npos : end - p);
+    }
+    nulls.push_back(!quoted && (value.empty() || value == "null" || value == "NULL"));
+    values.push_back(std::move(value));
+    if (end == std::string::npos) return true;
+    p = end + 1;
+  }
+}
+
+/**
+ * Convert the values of a csv record into the fields of a row of the table.
+ */
+static dberr_t MakeCsvRow(const std::vector<Column *> &columns, const std::vector<std::string> &values,
+                          const std::vector<bool> &nulls, std::vector<Field> &fields) {
+  if (values.size() != columns.size()) {
+    return DB_FAILED;
+  }
+  for (size_t i = 0; i < columns.size(); i++) {
+    TypeId type = columns[i]->GetType();
+    const char *value = values[i].c_str();
+    char *end = nullptr;
+    if (nulls[i]) {
+      if (!columns[i]->IsNullable()) return DB_FAILED;
+      fields.emplace_back(type);
+    } else if (type == kTypeInt) {
+      long integer = strtol(value, &end, 10);
+      if (*value == '\0' || *end != '\0') return DB_FAILED;
+      fields.emplace_back(kTypeInt, static_cast<int32_t>(integer));
+    } else if (type == kTypeFloat) {
+      float real = strtof(value, &end);
+      if (*value == '\0' || *end != '\0') return DB_FAILED;
+      fields.emplace_back(kTypeFloat, real);
+    } else if (type == kTypeChar) {
+      fields.emplace_back(kTypeChar, const_cast<char *>(value), values[i].size(), true);
+    } else {
+      return DB_FAILED;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteLoad(pSyntaxNode ast, ExecuteContext *context) {
+  DBStorageEngine *database_now = CurrentDatabase();
+  if (database_now == nullptr) {
+    std::cerr << "no db is chosen\n";
+    return DB_FAILED;
+  }
+  TablePlan plan;
+  if (ResolveTablePlan(database_now, ast->child_->next_->val_, plan) != DB_SUCCESS) {
+    std::cerr << "No such table\n";
+    return DB_FAILED;
+  }
+  std::ifstream csv(ast->child_->val_);
+  if (!csv.is_open()) {
+    cout << "The file is not exist!" << endl;
+    return DB_FAILED;
+  }
+  const std::vector<Column *> &columns = plan.table_->GetSchema()->GetColumns();
+  std::vector<Row> rows;
+  rows.reserve(LOAD_BATCH_SIZE);
+  std::vector<std::string> values;
+  std::vector<bool> nulls;
+  std::string line;
+  uint64_t line_no = 0, inserted = 0, rejected = 0;
+  // the file is streamed, only one batch of rows is in memory
+  while (true) {
+    bool more = static_cast<bool>(std::getline(csv, line));
+    if (more) {
+      line_no++;
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.empty()) continue;
+      std::vector<Field> fields;
+      if (!SplitCsvRecord(line, values, nulls) || MakeCsvRow(columns, values, nulls, fields) != DB_SUCCESS) {
+        std::cerr << "line " << line_no << ": bad record\n";
+        rejected++;
+        continue;
+      }
+      rows.emplace_back(fields);
+    }
+    if (rows.size() >= LOAD_BATCH_SIZE || (!more && !rows.empty())) {
+      uint32_t batch_rejected = 0;
+      if (BulkInsert(plan, rows, batch_rejected) != DB_SUCCESS) {
+        std::cout << inserted << " rows are inserted, " << rejected << " rows are rejected\n";
+        return DB_FAILED;
+      }
+      inserted += rows.size() - batch_rejected;
+      rejected += batch_rejected;
+      rows.clear();
+    }
+    if (!more) break;
+  }
+  std::cout << inserted << " rows are inserted, " << rejected << " rows are rejected\n";
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context) {
+  DBStorageEngine *database_now = CurrentDatabase();
+  if (database_now == nullptr) {
+    std::cerr << "no db is chosen\n";
+    return DB_FAILED;
+  }
+  TableInfo *table_info = nullptr;
+  if (database_now->catalog_mgr_->GetTable(ast->child_->val_, table_info) != DB_SUCCESS) {
+    std::cerr << "No such table\n";
+    return DB_FAILED;
+  }
+  const Schema *schema = table_info->GetSchema();
+  std::vector<uint32_t> columns(schema->GetColumnCount());
+  for (uint32_t i = 0; i < columns.size(); i++) columns[i] = i;
+  TableHeap *table_heap = table_info->GetTableHeap();
+  StatisticsBuilder builder(schema);
+  for (auto iter = table_heap->ChunkBegin(columns); !iter.IsEnd(); ++iter) {
+    builder.AddChunk(*iter);
+  }
+  TableStatistics statistics = builder.Finish(table_heap->GetPageCount());
+  std::cout << "Table " << table_info->GetTableName() << " is analyzed: " << statistics.row_count_ << " rows in "
+            << statistics.page_count_ << " pages\n";
+  database_now->catalog_mgr_->SetStatistics(table_info->GetTableId(), std::move(statistics));
+  return DB_SUCCESS;
+}
+
+dberr_t ExecuteEngine::ExecuteShowStats(pSyntaxNode ast, ExecuteContext *context) {
+  DBStorageEngine *database_now = CurrentDatabase();
+  if (database_now == nullptr) {
+    std::cerr << "no db is chosen\n";
+    return DB_FAILED;
+  }
+  TableInfo *table_info = nullptr;
+  if (database_now->catalog_mgr_->GetTable(ast->child_->val_, table_info) != DB_SUCCESS) {
+    std::cerr << "No such table\n";
+    return DB_FAILED;
+  }
+  TableStatistics *statistics = database_now->catalog_mgr_->GetStatistics(table_info->GetTableId());
+  if (statistics == nullptr) {
+    std::cerr << "Table " << table_info->GetTableName() << " has no statistics, analyze it first\n";
+    return DB_FAILED;
+  }
+  statistics->Refresh();
+  std::cout << "Table " << table_info->GetTableName() << ": " << statistics->row_count_ << " rows in "
+            << table_info->GetTableHeap()->GetPageCount() << " pages\n";
+  std::cout << "column\tnulls\tdistinct\tmin\tmax\n";
+  const Schema *schema = table_info->GetSchema();
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    const ColumnStatistics &stats = statistics->columns_[i];
+    std::cout << column->GetName() << "\t" << stats.null_count_ << "\t" << stats.distinct_count_ << "\t";
+    if (stats.bounds_.empty()) {
+      std::cout << "null\tnull\n";
+    } else if (column->GetType() == kTypeChar) {
+      // a char value is known by its first bytes only
+      std::cout << TableStatistics::OrderKeyChars(stats.bounds_.front()) << "\t"
+                << TableStatistics::OrderKeyChars(stats.bounds_.back()) << "\n";
+    } else {
+      std::cout << stats.bounds_.front() << "\t" << stats.bounds_.back() << "\n";
+    }
   }
+  return DB_SUCCESS;
+}
 
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context) {
+  DBStorageEngine *database_now = CurrentDatabase();
+  if (database_now == nullptr) {
+    std::cerr << "no db is chosen\n";
+    return DB_FAILED;
+  }
+  TablePlan plan;
+  if (ResolveTablePlan(database_now, ast->child_->val_, plan) != DB_SUCCESS) {
+    std::cerr << "No such table\n";
+    return DB_FAILED;
+  }
+  TableHeap *table_heap = plan.table_->GetTableHeap();
+  std::vector<std::pair<RowId, RowId>> moved;
+  uint32_t freed = table_heap->Vacuum(moved, nullptr);
+  // the index entries of the moved tuples are pointed to their new row ids
+  std::unordered_map<int64_t, RowId> old_row_ids;
+  std::vector<RowId> new_row_ids;
+  for (auto &move : moved) {
+    old_row_ids.emplace(move.second.Get(), move.first);
+    new_row_ids.push_back(move.second);
+  }
+  std::vector<char> data;
+  std::vector<TupleView> tuples;
+  CopyTuples(table_heap, new_row_ids, data, tuples);
+  std::vector<RowId> tuple_old_row_ids;
+  for (auto &tuple : tuples) {
+    tuple_old_row_ids.push_back(old_row_ids[tuple.GetRowId().Get()]);
+  }
+  MoveIndexEntries(plan.indexes_, tuples, tuple_old_row_ids);
+  // the rows and their values are the same, only the pages changed
+  TableStatistics *statistics = database_now->catalog_mgr_->GetStatistics(plan.table_->GetTableId());
+  if (statistics != nullptr) {
+    statistics->page_count_ = table_heap->GetPageCount();
+    statistics->dirty_ = true;
+  }
+  std::cout << "Table " << plan.table_->GetTableName() << " is vacuumed: " << moved.size() << " rows moved, "
+            << freed << " pages freed\n";
   return DB_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,309 @@
+#include "executor/external_sort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+static constexpr uint32_t PREFIX_SIZE = sizeof(uint64_t);
+
+static inline uint64_t PrefixOf(const std::string &top) {
+  uint64_t prefix;
+  memcpy(&prefix, top.data(), PREFIX_SIZE);
+  return prefix;
+}
+
+ExternalSort::ExternalSort(const Schema *schema, std::vector<SortKey> keys, BufferPoolManager *bpm, uint64_t limit,
+                           size_t memory_budget)
+    : schema_(schema),
+      keys_(std::move(keys)),
+      bpm_(bpm),
+      limit_(limit),
+      memory_budget_(memory_budget),
+      top_n_(limit <= MAX_TOP_N) {
+  ASSERT(!keys_.empty(), "A sort needs a key.");
+}
+
+/**
+ * | not null(8) | value(56) | of the first key, ints and floats mapped to unsigned integers of the
+ * same order, chars by their first 7 bytes. The complement for a descending key.
+ */
+uint64_t ExternalSort::Prefix(const TupleView &tuple) const {
+  const SortKey &key = keys_[0];
+  uint64_t prefix = 0;
+  if (!tuple.IsNull(key.column_)) {
+    uint64_t value = 0;
+    switch (schema_->GetColumn(key.column_)->GetType()) {
+      case kTypeInt:
+        value = static_cast<uint64_t>(static_cast<uint32_t>(tuple.GetInt(key.column_)) ^ 0x80000000u) << 24;
+        break;
+      case kTypeFloat: {
+        float f = tuple.GetFloat(key.column_);
+        if (f == 0) f = 0;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(float));
+        bits = (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+        value = static_cast<uint64_t>(bits) << 24;
+        break;
+      }
+      default: {
+        auto chars = reinterpret_cast<const unsigned char *>(tuple.GetChars(key.column_));
+        uint32_t len = std::min(tuple.GetCharLength(key.column_), 7u);
+        for (uint32_t i = 0; i < len; i++) {
+          value |= static_cast<uint64_t>(chars[i]) << (48 - 8 * i);
+        }
+      }
+    }
+    prefix = (1ull << 56) | value;
+  }
+  return key.descending_ ? ~prefix : prefix;
+}
+
+int ExternalSort::Compare(const char *a, const char *b) const {
+  TupleView left(a, schema_, INVALID_ROWID);
+  TupleView right(b, schema_, INVALID_ROWID);
+  for (auto &key : keys_) {
+    uint32_t column = key.column_;
+    bool left_null = left.IsNull(column), right_null = right.IsNull(column);
+    int cmp = 0;
+    if (left_null || right_null) {
+      cmp = static_cast<int>(right_null) - static_cast<int>(left_null);
+    } else {
+      switch (schema_->GetColumn(column)->GetType()) {
+        case kTypeInt:
+          cmp = (left.GetInt(column) > right.GetInt(column)) - (left.GetInt(column) < right.GetInt(column));
+          break;
+        case kTypeFloat:
+          cmp = (left.GetFloat(column) > right.GetFloat(column)) - (left.GetFloat(column) < right.GetFloat(column));
+          break;
+        default: {
+          // the order of TupleView::Compare, a prefix is less than the longer string
+          uint32_t left_len = left.GetCharLength(column), right_len = right.GetCharLength(column);
+          cmp = memcmp(left.GetChars(column), right.GetChars(column), std::min(left_len, right_len));
+          if (cmp == 0) cmp = (left_len > right_len) - (left_len < right_len);
+        }
+      }
+    }
+    if (cmp != 0) {
+      return key.descending_ ? -cmp : cmp;
+    }
+  }
+  return 0;
+}
+
+void ExternalSort::Add(const TupleView &tuple) {
+  if (top_n_) {
+    AddTop(tuple);
+    return;
+  }
+  uint32_t size = tuple.GetSize();
+  uint32_t offset = data_.size();
+  data_.insert(data_.end(), tuple.GetData(), tuple.GetData() + size);
+  entries_.push_back({Prefix(tuple), offset, size});
+  if (data_.size() + entries_.size() * sizeof(Entry) > memory_budget_) {
+    SpillRun();
+  }
+}
+
+void ExternalSort::AddTop(const TupleView &tuple) {
+  auto less = [this](const std::string &a, const std::string &b) {
+    return Less(PrefixOf(a), a.data() + PREFIX_SIZE, PrefixOf(b), b.data() + PREFIX_SIZE);
+  };
+  uint64_t prefix = Prefix(tuple);
+  if (top_.size() == limit_) {
+    // replace the last of the first limit_ tuples if tuple sorts before it
+    if (limit_ == 0 || !Less(prefix, tuple.GetData(), PrefixOf(top_.front()), top_.front().data() + PREFIX_SIZE)) {
+      return;
+    }
+    std::pop_heap(top_.begin(), top_.end(), less);
+  } else {
+    top_.emplace_back();
+  }
+  uint32_t size = tuple.GetSize();
+  std::string &top = top_.back();
+  top.resize(PREFIX_SIZE + size);
+  memcpy(&top[0], &prefix, PREFIX_SIZE);
+  memcpy(&top[PREFIX_SIZE], tuple.GetData(), size);
+  std::push_heap(top_.begin(), top_.end(), less);
+}
+
+void ExternalSort::SortRun() {
+  const char *data = data_.data();
+  std::sort(entries_.begin(), entries_.end(), [this, data](const Entry &a, const Entry &b) {
+    return Less(a.prefix_, data + a.offset_, b.prefix_, data + b.offset_);
+  });
+}
+
+void ExternalSort::SpillRun() {
+  SortRun();
+  auto run = std::make_unique<SpillFile>(bpm_);
+  for (auto &entry : entries_) {
+    if (!run->Append(data_.data() + entry.offset_, entry.size_)) {
+      // no page left in the buffer pool, the run stays in memory beyond the budget
+      memory_budget_ = SIZE_MAX;
+      return;
+    }
+  }
+  runs_.push_back(std::move(run));
+  spilled_runs_++;
+  data_.clear();
+  entries_.clear();
+}
+
+dberr_t ExternalSort::Merge(std::vector<std::unique_ptr<SpillFile>> &runs, bool with_memory,
+                            const std::function<bool(const char *, uint32_t)> &emit) {
+  struct Cursor {
+    uint64_t prefix_;
+    const char *data_;
+    uint32_t size_;
+  };
+  std::vector<std::unique_ptr<SpillFile::Reader>> readers;
+  for (auto &run : runs) {
+    readers.push_back(std::make_unique<SpillFile::Reader>(run.get()));
+  }
+  // the run in memory is the source after the readers
+  uint32_t sources = readers.size() + (with_memory ? 1 : 0);
+  std::vector<Cursor> cursors(sources);
+  size_t next_entry = 0;
+  bool failed = false;
+  auto advance = [&](uint32_t i) {
+    Cursor &cursor = cursors[i];
+    if (i == readers.size()) {
+      if (next_entry == entries_.size()) return false;
+      const Entry &entry = entries_[next_entry++];
+      cursor = {entry.prefix_, data_.data() + entry.offset_, entry.size_};
+      return true;
+    }
+    if (!readers[i]->Next(&cursor.data_, &cursor.size_)) {
+      failed = failed || readers[i]->HasFailed();
+      return false;
+    }
+    cursor.prefix_ = Prefix(TupleView(cursor.data_, schema_, INVALID_ROWID));
+    return true;
+  };
+  // a min heap of the sources by their current tuples
+  auto greater = [&](uint32_t a, uint32_t b) {
+    return Less(cursors[b].prefix_, cursors[b].data_, cursors[a].prefix_, cursors[a].data_);
+  };
+  std::vector<uint32_t> heap;
+  for (uint32_t i = 0; i < sources; i++) {
+    if (advance(i)) heap.push_back(i);
+  }
+  std::make_heap(heap.begin(), heap.end(), greater);
+  while (!heap.empty() && !failed) {
+    std::pop_heap(heap.begin(), heap.end(), greater);
+    uint32_t i = heap.back();
+    // the tuple of a reader is valid until it advances
+    if (!emit(cursors[i].data_, cursors[i].size_)) {
+      return DB_SUCCESS;
+    }
+    if (advance(i)) {
+      std::push_heap(heap.begin(), heap.end(), greater);
+    } else {
+      heap.pop_back();
+    }
+  }
+  return failed ? DB_FAILED : DB_SUCCESS;
+}
+
+dberr_t ExternalSort::Finish(const Emit &emit) {
+  uint64_t count = 0;
+  auto emit_tuple = [&](const char *data, uint32_t size) {
+    if (count >= limit_) return false;
+    count++;
+    return emit(TupleView(data, schema_, INVALID_ROWID)) && count < limit_;
+  };
+  if (top_n_) {
+    auto less = [this](const std::string &a, const std::string &b) {
+      return Less(PrefixOf(a), a.data() + PREFIX_SIZE, PrefixOf(b), b.data() + PREFIX_SIZE);
+    };
+    std::sort_heap(top_.begin(), top_.end(), less);
+    for (auto &top : top_) {
+      if (!emit_tuple(top.data() + PREFIX_SIZE, top.size() - PREFIX_SIZE)) break;
+    }
+    top_.clear();
+    return DB_SUCCESS;
+  }
+  dberr_t result = DB_SUCCESS;
+  SortRun();
+  if (runs_.empty()) {
+    for (auto &entry : entries_) {
+      if (!emit_tuple(data_.data() + entry.offset_, entry.size_)) break;
+    }
+  } else {
+    // merge the oldest runs into longer ones until the run in memory fits into the last merge
+    while (runs_.size() >= MERGE_FAN_IN) {
+      std::vector<std::unique_ptr<SpillFile>> merged_runs;
+      for (uint32_t i = 0; i < MERGE_FAN_IN; i++) {
+        merged_runs.push_back(std::move(runs_[i]));
+      }
+      runs_.erase(runs_.begin(), runs_.begin() + MERGE_FAN_IN);
+      auto run = std::make_unique<SpillFile>(bpm_);
+      bool appended = true;
+      dberr_t merged = Merge(merged_runs, false, [&run, &appended](const char *data, uint32_t size) {
+        appended = run->Append(data, size);
+        return appended;
+      });
+      if (merged != DB_SUCCESS || !appended) {
+        result = DB_FAILED;
+        break;
+      }
+      runs_.push_back(std::move(run));
+      spilled_runs_++;
+    }
+    if (result == DB_SUCCESS) {
+      result = Merge(runs_, true, emit_tuple);
+    }
+  }
+  runs_.clear();
+  data_.clear();
+  entries_.clear();
+  if (result != DB_SUCCESS) {
+    std::cerr << "No page left in the buffer pool for the runs of a sort\n";
+  }
+  return result;
+}
+
+void SortResultSink::Begin(const Schema *schema, const std::vector<uint32_t> &columns) {
+  ResultSink::Begin(schema, columns);
+  target_->Begin(schema, columns);
+  count_ = 0;
+  failed_ = false;
+  if (!keys_.empty()) {
+    sort_ = std::make_unique<ExternalSort>(schema, keys_, bpm_, limit_);
+  }
+}
+
+bool SortResultSink::Consume(const TupleView &tuple) {
+  if (sort_ != nullptr) {
+    sort_->Add(tuple);
+    return true;
+  }
+  if (count_ >= limit_) {
+    return false;
+  }
+  count_++;
+  return target_->Consume(tuple) && count_ < limit_;
+}
+
+bool SortResultSink::ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) {
+  if (sort_ == nullptr) {
+    uint64_t selected = 0;
+    for (uint32_t w = 0; w < SelectionWords(chunk.GetSize()); w++) {
+      selected += __builtin_popcountll(selection[w]);
+    }
+    // a chunk within the limit is formatted by the target directly
+    if (selected <= limit_ - count_) {
+      count_ += selected;
+      return target_->ConsumeChunk(chunk, selection) && count_ < limit_;
+    }
+  }
+  return ResultSink::ConsumeChunk(chunk, selection);
+}
+
+void SortResultSink::End() {
+  if (sort_ != nullptr) {
+    failed_ = sort_->Finish([this](const TupleView &tuple) { return target_->Consume(tuple); }) != DB_SUCCESS;
+    sort_.reset();
+  }
+  target_->End();
+}
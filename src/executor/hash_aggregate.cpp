@@ -0,0 +1,451 @@
+#include "executor/hash_aggregate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "common/hash_util.h"
+
+/** slots of the table once it holds a group */
+static constexpr size_t INITIAL_SLOTS = 1024;
+/** 4 bits of the hash pick the partition per level, the low 32 bits are left to the slots */
+static constexpr uint32_t MAX_SPILL_LEVEL = 7;
+static constexpr uint32_t HASH_SIZE = sizeof(uint64_t);
+static constexpr uint32_t COUNT_SIZE = sizeof(int64_t);
+
+/**
+ * @return the bytes of a value of column in a key or a min/max state: 4 for numbers, a length
+ * and the zero-padded bytes for chars
+ */
+static uint32_t ValueSize(const Column *column) {
+  return column->GetType() == kTypeChar ? sizeof(uint16_t) + column->GetLength() : sizeof(int32_t);
+}
+
+template <typename Tuple>
+static void WriteValue(char *dest, const Column *column, const Tuple &tuple, uint32_t index) {
+  if (column->GetType() == kTypeInt) {
+    int32_t value = tuple.GetInt(index);
+    memcpy(dest, &value, sizeof(int32_t));
+  } else if (column->GetType() == kTypeFloat) {
+    // -0 and 0 are the same group
+    float value = tuple.GetFloat(index) == 0 ? 0.0f : tuple.GetFloat(index);
+    memcpy(dest, &value, sizeof(float));
+  } else {
+    uint16_t length = std::min(tuple.GetCharLength(index), column->GetLength());
+    memcpy(dest, &length, sizeof(uint16_t));
+    memcpy(dest + sizeof(uint16_t), tuple.GetChars(index), length);
+    memset(dest + sizeof(uint16_t) + length, 0, column->GetLength() - length);
+  }
+}
+
+/**
+ * Compare two values written by WriteValue, a char prefix is less than the longer string.
+ */
+static int CompareValue(const char *a, const char *b, TypeId type) {
+  if (type == kTypeInt) {
+    int32_t x, y;
+    memcpy(&x, a, sizeof(int32_t));
+    memcpy(&y, b, sizeof(int32_t));
+    return x < y ? -1 : (x > y ? 1 : 0);
+  }
+  if (type == kTypeFloat) {
+    float x, y;
+    memcpy(&x, a, sizeof(float));
+    memcpy(&y, b, sizeof(float));
+    return x < y ? -1 : (x > y ? 1 : 0);
+  }
+  uint16_t x, y;
+  memcpy(&x, a, sizeof(uint16_t));
+  memcpy(&y, b, sizeof(uint16_t));
+  int cmp = memcmp(a + sizeof(uint16_t), b + sizeof(uint16_t), std::min(x, y));
+  return cmp != 0 ? cmp : (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+static Field ReadValue(const char *src, TypeId type) {
+  if (type == kTypeInt) {
+    int32_t value;
+    memcpy(&value, src, sizeof(int32_t));
+    return Field(kTypeInt, value);
+  }
+  if (type == kTypeFloat) {
+    float value;
+    memcpy(&value, src, sizeof(float));
+    return Field(kTypeFloat, value);
+  }
+  uint16_t length;
+  memcpy(&length, src, sizeof(uint16_t));
+  return Field(kTypeChar, const_cast<char *>(src + sizeof(uint16_t)), length, false);
+}
+
+bool AggregateSpec::GetType(const std::string &name, AggregateType &type) {
+  static const struct {
+    const char *name;
+    AggregateType type;
+  } functions[] = {{"count", kAggregateCount}, {"sum", kAggregateSum}, {"avg", kAggregateAvg},
+                   {"min", kAggregateMin},     {"max", kAggregateMax}};
+  for (auto &function : functions) {
+    if (name == function.name) {
+      type = function.type;
+      return true;
+    }
+  }
+  return false;
+}
+
+TypeId AggregateSpec::GetResultType(const Schema *schema) const {
+  switch (type_) {
+    case kAggregateCount:
+      return kTypeInt;
+    case kAggregateSum:
+    case kAggregateAvg:
+      return kTypeFloat;
+    default:
+      return schema->GetColumn(column_)->GetType();
+  }
+}
+
+HashAggregate::HashAggregate(const Schema *schema, std::vector<uint32_t> group_columns,
+                             std::vector<AggregateSpec> aggregates, BufferPoolManager *bpm, size_t memory_budget)
+    : schema_(schema),
+      group_columns_(std::move(group_columns)),
+      aggregates_(std::move(aggregates)),
+      bpm_(bpm),
+      memory_budget_(memory_budget),
+      partitions_(SPILL_PARTITIONS) {
+  // | null(1) | value | per group column
+  for (auto column : group_columns_) {
+    key_offsets_.push_back(key_size_);
+    key_size_ += 1 + ValueSize(schema_->GetColumn(column));
+  }
+  // | count(8) | sum(8) or min/max value | per aggregate
+  entry_size_ = HASH_SIZE + key_size_;
+  for (auto &aggregate : aggregates_) {
+    state_offsets_.push_back(entry_size_);
+    entry_size_ += COUNT_SIZE;
+    if (aggregate.type_ == kAggregateSum || aggregate.type_ == kAggregateAvg) {
+      entry_size_ += sizeof(double);
+    } else if (aggregate.type_ != kAggregateCount) {
+      entry_size_ += ValueSize(schema_->GetColumn(aggregate.column_));
+    }
+  }
+  key_.resize(entry_size_);
+  single_.resize(entry_size_);
+}
+
+std::vector<uint32_t> HashAggregate::GetColumns() const {
+  std::vector<uint32_t> columns = group_columns_;
+  for (auto &aggregate : aggregates_) {
+    if (aggregate.column_ != AggregateSpec::AGGREGATE_ALL_COLUMNS &&
+        std::find(columns.begin(), columns.end(), aggregate.column_) == columns.end()) {
+      columns.push_back(aggregate.column_);
+    }
+  }
+  return columns;
+}
+
+void HashAggregate::Consume(const DataChunk &chunk, const uint64_t *selection) {
+  ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) { ConsumeTuple(ChunkTuple(chunk, i)); });
+}
+
+void HashAggregate::Consume(const TupleView &tuple) { ConsumeTuple(tuple); }
+
+template <typename Tuple>
+void HashAggregate::ConsumeTuple(const Tuple &tuple) {
+  char *key = key_.data() + HASH_SIZE;
+  for (uint32_t i = 0; i < group_columns_.size(); i++) {
+    const Column *column = schema_->GetColumn(group_columns_[i]);
+    char *value = key + key_offsets_[i];
+    if (tuple.IsNull(group_columns_[i])) {
+      value[0] = 1;
+      memset(value + 1, 0, ValueSize(column));
+    } else {
+      value[0] = 0;
+      WriteValue(value + 1, column, tuple, group_columns_[i]);
+    }
+  }
+  uint64_t hash = HashBytes(key, key_size_);
+  memcpy(key_.data(), &hash, HASH_SIZE);
+  char *entry = FindOrInsert(hash);
+  if (entry == nullptr) {
+    // a new group while the table is full, it goes to its partition as an entry of its own
+    memcpy(single_.data(), key_.data(), HASH_SIZE + key_size_);
+    InitStates(single_.data());
+    Update(single_.data(), tuple);
+    Spill(single_.data());
+    return;
+  }
+  Update(entry, tuple);
+}
+
+char *HashAggregate::FindOrInsert(uint64_t hash) {
+  if (slots_.empty()) {
+    slots_.resize(INITIAL_SLOTS);
+  }
+  uint64_t tag = hash >> 32;
+  size_t mask = slots_.size() - 1;
+  size_t i = hash & mask;
+  for (; slots_[i] != 0; i = (i + 1) & mask) {
+    if ((slots_[i] >> 32) == tag) {
+      char *entry = entries_.data() + ((slots_[i] & UINT32_MAX) - 1) * entry_size_;
+      if (memcmp(entry + HASH_SIZE, key_.data() + HASH_SIZE, key_size_) == 0) {
+        return entry;
+      }
+    }
+  }
+  size_t memory = entries_.size() + entry_size_ + slots_.size() * sizeof(uint64_t);
+  if (group_count_ > 0 && memory > memory_budget_ && level_ < MAX_SPILL_LEVEL &&
+      entry_size_ <= SpillFile::MAX_RECORD_SIZE) {
+    return nullptr;
+  }
+  // at most half of the slots are used
+  if ((group_count_ + 1) * 2 > slots_.size()) {
+    Grow();
+    mask = slots_.size() - 1;
+    for (i = hash & mask; slots_[i] != 0; i = (i + 1) & mask) {
+    }
+  }
+  entries_.resize(entries_.size() + entry_size_);
+  char *entry = entries_.data() + group_count_ * entry_size_;
+  memcpy(entry, key_.data(), HASH_SIZE + key_size_);
+  InitStates(entry);
+  slots_[i] = (tag << 32) | (group_count_ + 1);
+  group_count_++;
+  return entry;
+}
+
+void HashAggregate::Grow() {
+  std::vector<uint64_t> slots(slots_.size() * 2);
+  size_t mask = slots.size() - 1;
+  for (uint32_t index = 0; index < group_count_; index++) {
+    uint64_t hash;
+    memcpy(&hash, entries_.data() + index * entry_size_, HASH_SIZE);
+    size_t i = hash & mask;
+    while (slots[i] != 0) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = ((hash >> 32) << 32) | (index + 1);
+  }
+  slots_.swap(slots);
+}
+
+void HashAggregate::Reset() {
+  slots_.clear();
+  entries_.clear();
+  group_count_ = 0;
+}
+
+void HashAggregate::InitStates(char *entry) { memset(entry + HASH_SIZE + key_size_, 0, entry_size_ - HASH_SIZE - key_size_); }
+
+template <typename Tuple>
+void HashAggregate::Update(char *entry, const Tuple &tuple) {
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    const AggregateSpec &aggregate = aggregates_[i];
+    char *state = entry + state_offsets_[i];
+    if (aggregate.column_ != AggregateSpec::AGGREGATE_ALL_COLUMNS && tuple.IsNull(aggregate.column_)) {
+      continue;
+    }
+    int64_t count;
+    memcpy(&count, state, COUNT_SIZE);
+    char *value = state + COUNT_SIZE;
+    if (aggregate.type_ == kAggregateSum || aggregate.type_ == kAggregateAvg) {
+      // int sums are exact in 64 bits
+      if (schema_->GetColumn(aggregate.column_)->GetType() == kTypeInt) {
+        int64_t sum;
+        memcpy(&sum, value, sizeof(int64_t));
+        sum += tuple.GetInt(aggregate.column_);
+        memcpy(value, &sum, sizeof(int64_t));
+      } else {
+        double sum;
+        memcpy(&sum, value, sizeof(double));
+        sum += tuple.GetFloat(aggregate.column_);
+        memcpy(value, &sum, sizeof(double));
+      }
+    } else if (aggregate.type_ != kAggregateCount) {
+      const Column *column = schema_->GetColumn(aggregate.column_);
+      if (count == 0) {
+        WriteValue(value, column, tuple, aggregate.column_);
+      } else {
+        char current[sizeof(uint16_t) + PAGE_SIZE];
+        WriteValue(current, column, tuple, aggregate.column_);
+        int cmp = CompareValue(current, value, column->GetType());
+        if ((aggregate.type_ == kAggregateMin && cmp < 0) || (aggregate.type_ == kAggregateMax && cmp > 0)) {
+          memcpy(value, current, ValueSize(column));
+        }
+      }
+    }
+    count++;
+    memcpy(state, &count, COUNT_SIZE);
+  }
+}
+
+void HashAggregate::Merge(char *entry, const char *other) {
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    const AggregateSpec &aggregate = aggregates_[i];
+    char *state = entry + state_offsets_[i];
+    const char *other_state = other + state_offsets_[i];
+    int64_t count, other_count;
+    memcpy(&count, state, COUNT_SIZE);
+    memcpy(&other_count, other_state, COUNT_SIZE);
+    if (other_count == 0) {
+      continue;
+    }
+    char *value = state + COUNT_SIZE;
+    const char *other_value = other_state + COUNT_SIZE;
+    if (aggregate.type_ == kAggregateSum || aggregate.type_ == kAggregateAvg) {
+      if (schema_->GetColumn(aggregate.column_)->GetType() == kTypeInt) {
+        int64_t sum, other_sum;
+        memcpy(&sum, value, sizeof(int64_t));
+        memcpy(&other_sum, other_value, sizeof(int64_t));
+        sum += other_sum;
+        memcpy(value, &sum, sizeof(int64_t));
+      } else {
+        double sum, other_sum;
+        memcpy(&sum, value, sizeof(double));
+        memcpy(&other_sum, other_value, sizeof(double));
+        sum += other_sum;
+        memcpy(value, &sum, sizeof(double));
+      }
+    } else if (aggregate.type_ != kAggregateCount) {
+      const Column *column = schema_->GetColumn(aggregate.column_);
+      int cmp = count == 0 ? 0 : CompareValue(other_value, value, column->GetType());
+      if (count == 0 || (aggregate.type_ == kAggregateMin && cmp < 0) ||
+          (aggregate.type_ == kAggregateMax && cmp > 0)) {
+        memcpy(value, other_value, ValueSize(column));
+      }
+    }
+    count += other_count;
+    memcpy(state, &count, COUNT_SIZE);
+  }
+}
+
+void HashAggregate::Spill(const char *entry) {
+  uint64_t hash;
+  memcpy(&hash, entry, HASH_SIZE);
+  uint32_t partition = (hash >> (60 - 4 * level_)) & (SPILL_PARTITIONS - 1);
+  if (partitions_[partition] == nullptr) {
+    partitions_[partition] = std::make_unique<SpillFile>(bpm_);
+  }
+  if (partitions_[partition]->Append(entry, entry_size_)) {
+    spilled_count_++;
+    return;
+  }
+  // no page left in the buffer pool, the table grows beyond its budget instead
+  size_t budget = memory_budget_;
+  memory_budget_ = SIZE_MAX;
+  memcpy(key_.data(), entry, HASH_SIZE + key_size_);
+  Merge(FindOrInsert(hash), entry);
+  memory_budget_ = budget;
+}
+
+bool HashAggregate::EmitTable(const Emit &emit) {
+  for (uint32_t i = 0; i < group_count_; i++) {
+    if (!EmitEntry(entries_.data() + i * entry_size_, emit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HashAggregate::EmitEntry(const char *entry, const Emit &emit) {
+  std::vector<Field> result;
+  result.reserve(group_columns_.size() + aggregates_.size());
+  for (uint32_t i = 0; i < group_columns_.size(); i++) {
+    const char *value = entry + HASH_SIZE + key_offsets_[i];
+    TypeId type = schema_->GetColumn(group_columns_[i])->GetType();
+    if (value[0] != 0) {
+      result.emplace_back(type);
+    } else {
+      result.emplace_back(ReadValue(value + 1, type));
+    }
+  }
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    const AggregateSpec &aggregate = aggregates_[i];
+    const char *state = entry + state_offsets_[i];
+    int64_t count;
+    memcpy(&count, state, COUNT_SIZE);
+    TypeId type = aggregate.GetResultType(schema_);
+    if (aggregate.type_ == kAggregateCount) {
+      if (count > INT32_MAX) {
+        std::cerr << "Count " << count << " is out of the range of int\n";
+        failed_ = true;
+        return false;
+      }
+      result.emplace_back(kTypeInt, static_cast<int32_t>(count));
+    } else if (count == 0) {
+      result.emplace_back(type);
+    } else if (aggregate.type_ == kAggregateSum || aggregate.type_ == kAggregateAvg) {
+      double sum;
+      if (schema_->GetColumn(aggregate.column_)->GetType() == kTypeInt) {
+        int64_t int_sum;
+        memcpy(&int_sum, state + COUNT_SIZE, sizeof(int64_t));
+        sum = static_cast<double>(int_sum);
+      } else {
+        memcpy(&sum, state + COUNT_SIZE, sizeof(double));
+      }
+      result.emplace_back(kTypeFloat, static_cast<float>(aggregate.type_ == kAggregateSum ? sum : sum / count));
+    } else {
+      result.emplace_back(ReadValue(state + COUNT_SIZE, type));
+    }
+  }
+  return emit(result);
+}
+
+bool HashAggregate::Drain(Partitions &partitions, uint32_t level, const Emit &emit) {
+  for (auto &partition : partitions) {
+    if (partition == nullptr) {
+      continue;
+    }
+    Reset();
+    level_ = level;
+    {
+      SpillFile::Reader reader(partition.get());
+      const char *record;
+      uint32_t size;
+      while (reader.Next(&record, &size)) {
+        uint64_t hash;
+        memcpy(&hash, record, HASH_SIZE);
+        memcpy(key_.data(), record, HASH_SIZE + key_size_);
+        char *entry = FindOrInsert(hash);
+        if (entry == nullptr) {
+          Spill(record);
+        } else {
+          Merge(entry, record);
+        }
+      }
+      if (reader.HasFailed()) {
+        std::cerr << "No page left in the buffer pool for the partitions of an aggregate\n";
+        failed_ = true;
+        return false;
+      }
+    }
+    partition.reset();
+    Partitions spilled(SPILL_PARTITIONS);
+    spilled.swap(partitions_);
+    if (!EmitTable(emit) || !Drain(spilled, level + 1, emit)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+dberr_t HashAggregate::Finish(const Emit &emit) {
+  bool more = true;
+  if (group_columns_.empty() && group_count_ == 0 && spilled_count_ == 0) {
+    // an aggregate over no tuples still has a result: count 0, the other ones null
+    InitStates(single_.data());
+    more = EmitEntry(single_.data(), emit);
+  }
+  Partitions spilled(SPILL_PARTITIONS);
+  spilled.swap(partitions_);
+  if (more && EmitTable(emit)) {
+    Drain(spilled, level_ + 1, emit);
+  }
+  Reset();
+  std::vector<char>().swap(entries_);
+  std::vector<uint64_t>().swap(slots_);
+  partitions_ = Partitions(SPILL_PARTITIONS);
+  level_ = 0;
+  dberr_t result = failed_ ? DB_FAILED : DB_SUCCESS;
+  failed_ = false;
+  return result;
+}
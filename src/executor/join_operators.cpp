@@ -0,0 +1,428 @@
+#include "executor/join_operators.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "common/hash_util.h"
+#include "index/b_plus_tree_index.h"
+#include "index/generic_key.h"
+
+using JoinIndex = BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>;
+
+void JoinRecord::AppendTuple(std::string &record, const char *tuple, uint32_t size) {
+  record.append(reinterpret_cast<const char *>(&size), sizeof(uint32_t));
+  record.append(tuple, size);
+}
+
+void JoinRecord::Parse(const char *record, uint32_t size, const std::vector<const Schema *> &schemas,
+                       std::vector<TupleView> &views) {
+  views.resize(schemas.size());
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < schemas.size(); i++) {
+    uint32_t tuple_size;
+    memcpy(&tuple_size, record + offset, sizeof(uint32_t));
+    views[i].Reset(record + offset + sizeof(uint32_t), schemas[i], INVALID_ROWID);
+    offset += sizeof(uint32_t) + tuple_size;
+  }
+  ASSERT(offset == size, "Join record does not match its schemas.");
+}
+
+/**
+ * Hand the filtered tuples of table to consume, serialized with the columns of the table.
+ * @return false if consume stopped the scan
+ */
+static bool ScanTable(const JoinTable &table, const std::function<bool(const char *, uint32_t)> &consume) {
+  ChunkFilter &filter = *table.filter_;
+  auto iter = filter.IsEmpty() ? table.table_heap_->ChunkBegin(table.columns_)
+                               : table.table_heap_->ChunkBegin(filter.GetColumns(), table.columns_);
+  uint64_t selection[FILTER_VECTOR_SIZE / 64];
+  std::vector<char> buf;
+  for (; !iter.IsEnd(); ++iter) {
+    filter.Evaluate(*iter, selection);
+    uint64_t any = 0;
+    for (uint32_t w = 0; w < SelectionWords(iter->GetSize()); w++) {
+      any |= selection[w];
+    }
+    if (any == 0) continue;
+    iter.LoadLazyColumns();
+    bool more = true;
+    ForEachSelected(selection, iter->GetSize(), [&](uint32_t i) {
+      if (!more) return;
+      iter->SerializeTuple(i, buf);
+      more = consume(buf.data(), buf.size());
+    });
+    if (!more) return false;
+  }
+  return true;
+}
+
+/**
+ * Read the tuple rid of table into buf if it passes the filter of the table.
+ */
+static bool FetchTuple(const JoinTable &table, RowId rid, Row &row, std::vector<char> &buf) {
+  row.SetRowId(rid);
+  if (!table.table_heap_->GetTuple(&row, nullptr)) {
+    return false;
+  }
+  Schema *schema = const_cast<Schema *>(table.schema_);
+  buf.resize(row.GetSerializedSize(schema));
+  row.SerializeTo(buf.data(), schema);
+  return table.filter_->Evaluate(TupleView(buf.data(), table.schema_, rid));
+}
+
+/**
+ * Hash of a join key, numbers by their bytes with -0 as 0, chars by their bytes.
+ */
+static uint64_t HashValue(const TupleView &tuple, uint32_t column, bool &is_null) {
+  is_null = tuple.IsNull(column);
+  if (is_null) {
+    return 0;
+  }
+  TypeId type = tuple.GetSchema()->GetColumn(column)->GetType();
+  if (type == kTypeChar) {
+    return HashBytes(tuple.GetChars(column), tuple.GetCharLength(column));
+  }
+  int32_t value = tuple.GetInt(column);
+  if (type == kTypeFloat && tuple.GetFloat(column) == 0) {
+    value = 0;
+  }
+  return HashBytes(reinterpret_cast<const char *>(&value), sizeof(int32_t));
+}
+
+static bool ValueEquals(const TupleView &a, uint32_t column_a, const TupleView &b, uint32_t column_b) {
+  TypeId type = a.GetSchema()->GetColumn(column_a)->GetType();
+  if (type == kTypeInt) {
+    return a.GetInt(column_a) == b.GetInt(column_b);
+  }
+  if (type == kTypeFloat) {
+    return a.GetFloat(column_a) == b.GetFloat(column_b);
+  }
+  return a.GetCharLength(column_a) == b.GetCharLength(column_b) &&
+         memcmp(a.GetChars(column_a), b.GetChars(column_b), a.GetCharLength(column_a)) == 0;
+}
+
+TableScanSource::TableScanSource(JoinTable table) : table_(std::move(table)) { schemas_.push_back(table_.schema_); }
+
+bool TableScanSource::Run(const JoinConsumer &consume) {
+  std::string record;
+  return ScanTable(table_, [&](const char *tuple, uint32_t size) {
+    record.clear();
+    JoinRecord::AppendTuple(record, tuple, size);
+    return consume(record.data(), record.size());
+  });
+}
+
+HashJoin::HashJoin(std::unique_ptr<JoinSource> left, JoinKey left_key, JoinTable right, uint32_t right_column,
+                   BufferPoolManager *bpm, size_t memory_budget)
+    : left_(std::move(left)),
+      left_key_(left_key),
+      right_(std::move(right)),
+      right_column_(right_column),
+      bpm_(bpm),
+      memory_budget_(memory_budget) {
+  schemas_ = left_->GetSchemas();
+  schemas_.push_back(right_.schema_);
+}
+
+static constexpr uint32_t ENTRY_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+void HashJoin::Insert(uint64_t hash, const char *tuple, uint32_t size) {
+  // one bucket per entry at most
+  if (entry_count_ >= buckets_.size()) {
+    std::vector<uint32_t> buckets(std::max<size_t>(1024, buckets_.size() * 2), 0);
+    for (uint32_t offset = 0; offset < entries_.size();) {
+      uint64_t entry_hash;
+      uint32_t entry_size;
+      memcpy(&entry_hash, entries_.data() + offset + sizeof(uint32_t), sizeof(uint64_t));
+      memcpy(&entry_size, entries_.data() + offset + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint32_t));
+      uint32_t &head = buckets[entry_hash & (buckets.size() - 1)];
+      memcpy(entries_.data() + offset, &head, sizeof(uint32_t));
+      head = offset + 1;
+      offset += ENTRY_HEADER_SIZE + entry_size;
+    }
+    buckets_.swap(buckets);
+  }
+  uint32_t offset = entries_.size();
+  entries_.resize(offset + ENTRY_HEADER_SIZE + size);
+  char *entry = entries_.data() + offset;
+  uint32_t &head = buckets_[hash & (buckets_.size() - 1)];
+  memcpy(entry, &head, sizeof(uint32_t));
+  memcpy(entry + sizeof(uint32_t), &hash, sizeof(uint64_t));
+  memcpy(entry + sizeof(uint32_t) + sizeof(uint64_t), &size, sizeof(uint32_t));
+  memcpy(entry + ENTRY_HEADER_SIZE, tuple, size);
+  head = offset + 1;
+  entry_count_++;
+}
+
+void HashJoin::ClearTable() {
+  buckets_.clear();
+  entries_.clear();
+  entry_count_ = 0;
+}
+
+uint64_t HashJoin::HashLeft(const TupleView &tuple, bool &is_null) const {
+  if (right_column_ == NO_KEY) {
+    is_null = false;
+    return 0;
+  }
+  return HashValue(tuple, left_key_.column_, is_null);
+}
+
+uint64_t HashJoin::HashRight(const TupleView &tuple, bool &is_null) const {
+  if (right_column_ == NO_KEY) {
+    is_null = false;
+    return 0;
+  }
+  return HashValue(tuple, right_column_, is_null);
+}
+
+static uint32_t PartitionOf(uint64_t hash) { return hash >> 60; }
+
+bool HashJoin::StartPartitioning() {
+  partitioned_ = true;
+  for (uint32_t i = 0; i < PARTITIONS; i++) {
+    build_partitions_.push_back(std::make_unique<SpillFile>(bpm_));
+    probe_partitions_.push_back(std::make_unique<SpillFile>(bpm_));
+  }
+  for (uint32_t offset = 0; offset < entries_.size();) {
+    uint64_t hash;
+    uint32_t size;
+    memcpy(&hash, entries_.data() + offset + sizeof(uint32_t), sizeof(uint64_t));
+    memcpy(&size, entries_.data() + offset + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint32_t));
+    if (!build_partitions_[PartitionOf(hash)]->Append(entries_.data() + offset + ENTRY_HEADER_SIZE, size)) {
+      return Fail();
+    }
+    offset += ENTRY_HEADER_SIZE + size;
+  }
+  ClearTable();
+  std::vector<char>().swap(entries_);
+  return true;
+}
+
+bool HashJoin::Fail() {
+  std::cerr << "No page left in the buffer pool for the partitions of a hash join\n";
+  failed_ = true;
+  return false;
+}
+
+bool HashJoin::Probe(const char *record, uint32_t size, const JoinConsumer &consume) {
+  JoinRecord::Parse(record, size, left_->GetSchemas(), views_);
+  const TupleView &left = views_[left_key_.table_];
+  bool is_null;
+  uint64_t hash = HashLeft(left, is_null);
+  if (is_null || buckets_.empty()) {
+    return true;
+  }
+  uint32_t next = buckets_[hash & (buckets_.size() - 1)];
+  while (next != 0) {
+    const char *entry = entries_.data() + next - 1;
+    uint64_t entry_hash;
+    uint32_t entry_size;
+    memcpy(&next, entry, sizeof(uint32_t));
+    memcpy(&entry_hash, entry + sizeof(uint32_t), sizeof(uint64_t));
+    memcpy(&entry_size, entry + sizeof(uint32_t) + sizeof(uint64_t), sizeof(uint32_t));
+    if (entry_hash != hash) continue;
+    TupleView right(entry + ENTRY_HEADER_SIZE, right_.schema_, INVALID_ROWID);
+    if (right_column_ != NO_KEY && !ValueEquals(left, left_key_.column_, right, right_column_)) continue;
+    output_.assign(record, size);
+    JoinRecord::AppendTuple(output_, entry + ENTRY_HEADER_SIZE, entry_size);
+    if (!consume(output_.data(), output_.size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool HashJoin::Run(const JoinConsumer &consume) {
+  ClearTable();
+  partitioned_ = false;
+  failed_ = false;
+  build_partitions_.clear();
+  probe_partitions_.clear();
+  // build, a cross join has nothing to partition by
+  ScanTable(right_, [&](const char *tuple, uint32_t size) {
+    bool is_null;
+    uint64_t hash = HashRight(TupleView(tuple, right_.schema_, INVALID_ROWID), is_null);
+    if (is_null) {
+      return true;
+    }
+    if (partitioned_) {
+      return build_partitions_[PartitionOf(hash)]->Append(tuple, size) || Fail();
+    }
+    Insert(hash, tuple, size);
+    if (right_column_ != NO_KEY && entries_.size() + buckets_.size() * sizeof(uint32_t) > memory_budget_) {
+      return StartPartitioning();
+    }
+    return true;
+  });
+  if (failed_) {
+    ClearTable();
+    build_partitions_.clear();
+    return false;
+  }
+
+  // probe, or partition the left records by their tuples
+  std::vector<TupleView> views;
+  bool more = left_->Run([&](const char *record, uint32_t size) {
+    if (!partitioned_) {
+      return Probe(record, size, consume);
+    }
+    JoinRecord::Parse(record, size, left_->GetSchemas(), views);
+    bool is_null;
+    uint64_t hash = HashLeft(views[left_key_.table_], is_null);
+    if (is_null) {
+      return true;
+    }
+    SpillFile *partition = probe_partitions_[PartitionOf(hash)].get();
+    for (uint32_t offset = 0; offset < size;) {
+      uint32_t tuple_size;
+      memcpy(&tuple_size, record + offset, sizeof(uint32_t));
+      if (!partition->Append(record + offset + sizeof(uint32_t), tuple_size)) {
+        return Fail();
+      }
+      offset += sizeof(uint32_t) + tuple_size;
+    }
+    return true;
+  });
+  if (!more || !partitioned_) {
+    ClearTable();
+    build_partitions_.clear();
+    probe_partitions_.clear();
+    return more;
+  }
+
+  // join the partitions pair by pair
+  std::string record;
+  for (uint32_t i = 0; i < PARTITIONS && more; i++) {
+    ClearTable();
+    {
+      SpillFile::Reader reader(build_partitions_[i].get());
+      const char *tuple;
+      uint32_t size;
+      while (reader.Next(&tuple, &size)) {
+        bool is_null;
+        Insert(HashRight(TupleView(tuple, right_.schema_, INVALID_ROWID), is_null), tuple, size);
+      }
+      if (reader.HasFailed()) {
+        more = Fail();
+        break;
+      }
+    }
+    build_partitions_[i].reset();
+    SpillFile::Reader reader(probe_partitions_[i].get());
+    const char *tuple;
+    uint32_t size;
+    uint32_t tables = left_->GetSchemas().size();
+    while (more) {
+      record.clear();
+      for (uint32_t t = 0; t < tables && reader.Next(&tuple, &size); t++) {
+        JoinRecord::AppendTuple(record, tuple, size);
+      }
+      if (reader.HasFailed()) {
+        more = Fail();
+        break;
+      }
+      if (record.empty()) break;
+      more = Probe(record.data(), record.size(), consume);
+    }
+  }
+  ClearTable();
+  build_partitions_.clear();
+  probe_partitions_.clear();
+  return more;
+}
+
+IndexNestedLoopJoin::IndexNestedLoopJoin(std::unique_ptr<JoinSource> left, JoinKey left_key, JoinTable right,
+                                         IndexInfo *right_index)
+    : left_(std::move(left)), left_key_(left_key), right_(std::move(right)), right_index_(right_index) {
+  schemas_ = left_->GetSchemas();
+  schemas_.push_back(right_.schema_);
+}
+
+bool IndexNestedLoopJoin::Run(const JoinConsumer &consume) {
+  std::vector<TupleView> views;
+  std::vector<RowId> rids;
+  std::vector<char> buf;
+  Row key(INVALID_ROWID);
+  Row row(INVALID_ROWID);
+  std::string output;
+  return left_->Run([&](const char *record, uint32_t size) {
+    JoinRecord::Parse(record, size, left_->GetSchemas(), views);
+    const TupleView &left = views[left_key_.table_];
+    if (left.IsNull(left_key_.column_)) {
+      return true;
+    }
+    key.Clear();
+    left.Project({left_key_.column_}, &key);
+    rids.clear();
+    right_index_->GetIndex()->ScanKey(key, rids, nullptr);
+    for (auto rid : rids) {
+      if (!FetchTuple(right_, rid, row, buf)) continue;
+      output.assign(record, size);
+      JoinRecord::AppendTuple(output, buf.data(), buf.size());
+      if (!consume(output.data(), output.size())) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+MergeJoin::MergeJoin(JoinTable left, IndexInfo *left_index, JoinTable right, IndexInfo *right_index)
+    : left_(std::move(left)), left_index_(left_index), right_(std::move(right)), right_index_(right_index) {
+  schemas_.push_back(left_.schema_);
+  schemas_.push_back(right_.schema_);
+}
+
+bool MergeJoin::Run(const JoinConsumer &consume) {
+  auto *left_tree = static_cast<JoinIndex *>(left_index_->GetIndex());
+  auto *right_tree = static_cast<JoinIndex *>(right_index_->GetIndex());
+  Schema *left_key_schema = left_index_->GetIndexKeySchema();
+  Schema *right_key_schema = right_index_->GetIndexKeySchema();
+  Row left_key(INVALID_ROWID);
+  Row right_key(INVALID_ROWID);
+  Row row(INVALID_ROWID);
+  std::vector<char> left_buf;
+  std::vector<char> right_buf;
+  std::string output;
+  auto left_end = left_tree->GetEndIterator();
+  auto right_end = right_tree->GetEndIterator();
+  auto left_iter = left_tree->GetBeginIterator();
+  auto right_iter = right_tree->GetBeginIterator();
+  bool load_left = true;
+  bool load_right = true;
+  while (left_iter != left_end && right_iter != right_end) {
+    if (load_left) {
+      (*left_iter).first.DeserializeToKey(left_key, left_key_schema);
+      load_left = false;
+    }
+    if (load_right) {
+      (*right_iter).first.DeserializeToKey(right_key, right_key_schema);
+      load_right = false;
+    }
+    const Field *left_value = left_key.GetField(0);
+    const Field *right_value = right_key.GetField(0);
+    if (left_value->IsNull() || left_value->CompareLessThan(*right_value) == kTrue) {
+      ++left_iter;
+      load_left = true;
+      continue;
+    }
+    if (right_value->IsNull() || right_value->CompareLessThan(*left_value) == kTrue) {
+      ++right_iter;
+      load_right = true;
+      continue;
+    }
+    if (FetchTuple(left_, (*left_iter).second, row, left_buf) && FetchTuple(right_, (*right_iter).second, row, right_buf)) {
+      output.clear();
+      JoinRecord::AppendTuple(output, left_buf.data(), left_buf.size());
+      JoinRecord::AppendTuple(output, right_buf.data(), right_buf.size());
+      if (!consume(output.data(), output.size())) {
+        return false;
+      }
+    }
+    ++left_iter;
+    ++right_iter;
+    load_left = load_right = true;
+  }
+  return true;
+}
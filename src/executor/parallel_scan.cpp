@@ -0,0 +1,116 @@
+#include "executor/parallel_scan.h"
+
+#include <algorithm>
+#include <thread>
+
+ParallelScan::ParallelScan(const TableHeap *table_heap, const ChunkFilter &filter, uint32_t workers)
+    : table_heap_(table_heap),
+      filter_(filter),
+      workers_(std::max(workers, 1u)),
+      page_count_(table_heap->GetPageIds().size()),
+      range_count_((page_count_ + PARALLEL_SCAN_RANGE_PAGES - 1) / PARALLEL_SCAN_RANGE_PAGES) {}
+
+bool ParallelScan::IsWorthwhile() const { return workers_ > 1 && range_count_ >= workers_; }
+
+void ParallelScan::Run(const std::vector<uint32_t> &output, ResultSink &sink) {
+  const Schema *schema = table_heap_->GetSchema();
+  Gather(&output, [&](const RangeResult &result) {
+    for (size_t i = 0; i < result.rids_.size(); i++) {
+      if (!sink.Consume(TupleView(result.tuples_.data() + result.offsets_[i], schema, result.rids_[i]))) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+void ParallelScan::Run(std::vector<RowId> &result) {
+  Gather(nullptr, [&](const RangeResult &range) {
+    result.insert(result.end(), range.rids_.begin(), range.rids_.end());
+    return true;
+  });
+}
+
+template <typename Consume>
+void ParallelScan::Gather(const std::vector<uint32_t> *output, Consume consume) {
+  results_.assign(PARALLEL_SCAN_WINDOW, RangeResult());
+  next_range_ = 0;
+  consumed_ranges_ = 0;
+  stopped_ = false;
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < std::min(workers_, range_count_); i++) {
+    threads.emplace_back(&ParallelScan::Work, this, output);
+  }
+  RangeResult result;
+  for (uint32_t range = 0; range < range_count_; range++) {
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      RangeResult &slot = results_[range % PARALLEL_SCAN_WINDOW];
+      range_done_.wait(lock, [&slot]() { return slot.done_; });
+      result = std::move(slot);
+      slot = RangeResult();
+      consumed_ranges_ = range + 1;
+    }
+    range_consumed_.notify_all();
+    if (!consume(result)) {
+      std::lock_guard<std::mutex> guard(latch_);
+      stopped_ = true;
+      break;
+    }
+  }
+  range_consumed_.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void ParallelScan::Work(const std::vector<uint32_t> *output) {
+  // evaluating keeps scratch bitmaps in the filter, every worker needs its own
+  ChunkFilter filter = filter_;
+  const std::vector<uint32_t> no_columns;
+  uint64_t selection[FILTER_VECTOR_SIZE / 64];
+  std::vector<char> tuple;
+  while (true) {
+    uint32_t range = 0;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      range_consumed_.wait(lock, [this]() {
+        return stopped_ || next_range_ >= range_count_ || next_range_ < consumed_ranges_ + PARALLEL_SCAN_WINDOW;
+      });
+      if (stopped_ || next_range_ >= range_count_) {
+        return;
+      }
+      range = next_range_++;
+    }
+    RangeResult result;
+    uint32_t first = range * PARALLEL_SCAN_RANGE_PAGES;
+    uint32_t count = std::min(PARALLEL_SCAN_RANGE_PAGES, page_count_ - first);
+    auto iter = table_heap_->ChunkBegin(first, count, filter.GetColumns(), output == nullptr ? no_columns : *output);
+    for (; !iter.IsEnd(); ++iter) {
+      filter.Evaluate(*iter, selection);
+      uint64_t any = 0;
+      for (uint32_t w = 0; w < SelectionWords(iter->GetSize()); w++) {
+        any |= selection[w];
+      }
+      if (any == 0) continue;
+      if (output != nullptr) {
+        iter.LoadLazyColumns();
+      }
+      const DataChunk &chunk = *iter;
+      ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) {
+        result.rids_.push_back(chunk.GetRowId(i));
+        if (output != nullptr) {
+          chunk.SerializeTuple(i, tuple);
+          result.offsets_.push_back(result.tuples_.size());
+          result.tuples_.insert(result.tuples_.end(), tuple.begin(), tuple.end());
+        }
+      });
+    }
+    result.done_ = true;
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      results_[range % PARALLEL_SCAN_WINDOW] = std::move(result);
+    }
+    range_done_.notify_all();
+  }
+}
@@ -0,0 +1,203 @@
+#include "executor/result_sink.h"
+
+#include <cstdio>
+
+std::unique_ptr<ResultSink> ResultSink::Create(ResultFormat format, std::ostream &out) {
+  switch (format) {
+    case kResultCsv:
+      return std::unique_ptr<ResultSink>(new CsvResultSink(out));
+    case kResultBinary:
+      return std::unique_ptr<ResultSink>(new BinaryResultSink(out));
+    default:
+      return std::unique_ptr<ResultSink>(new TextResultSink(out));
+  }
+}
+
+void BufferedResultSink::Flush() {
+  out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  out_.flush();
+  buffer_.clear();
+}
+
+bool ResultSink::ConsumeRow(const Row &row) {
+  Schema *schema = const_cast<Schema *>(schema_);
+  scratch_.resize(row.GetSerializedSize(schema));
+  row.SerializeTo(scratch_.data(), schema);
+  return Consume(TupleView(scratch_.data(), schema_, row.GetRowId()));
+}
+
+bool ResultSink::ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) {
+  bool more = true;
+  ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) {
+    if (!more) return;
+    chunk.SerializeTuple(i, scratch_);
+    more = Consume(TupleView(scratch_.data(), schema_, chunk.GetRowId(i)));
+  });
+  return more;
+}
+
+/**
+ * Append the text of a non-null field. Char data is not null terminated.
+ */
+template <typename Tuple>
+static void AppendFieldText(const Tuple &tuple, uint32_t column, TypeId type, std::string &buffer) {
+  char text[32];
+  int len = 0;
+  if (type == kTypeInt) {
+    len = snprintf(text, sizeof(text), "%d", tuple.GetInt(column));
+  } else if (type == kTypeFloat) {
+    len = snprintf(text, sizeof(text), "%f", tuple.GetFloat(column));
+  } else if (type == kTypeChar) {
+    buffer.append(tuple.GetChars(column), tuple.GetCharLength(column));
+    return;
+  }
+  buffer.append(text, len);
+}
+
+bool TextResultSink::Consume(const TupleView &tuple) {
+  AppendTuple(tuple);
+  return true;
+}
+
+bool TextResultSink::ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) {
+  ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) { AppendTuple(ChunkTuple(chunk, i)); });
+  return true;
+}
+
+template <typename Tuple>
+void TextResultSink::AppendTuple(const Tuple &tuple) {
+  for (auto column : columns_) {
+    if (tuple.IsNull(column)) {
+      buffer_ += "null";
+    } else {
+      AppendFieldText(tuple, column, schema_->GetColumn(column)->GetType(), buffer_);
+    }
+    buffer_.push_back('\t');
+  }
+  buffer_.push_back('\n');
+  MaybeFlush();
+}
+
+static void AppendCsvQuoted(const char *data, size_t len, std::string &buffer) {
+  buffer.push_back('"');
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] == '"') buffer.push_back('"');
+    buffer.push_back(data[i]);
+  }
+  buffer.push_back('"');
+}
+
+void CsvResultSink::Begin(const Schema *schema, const std::vector<uint32_t> &columns) {
+  ResultSink::Begin(schema, columns);
+  for (size_t i = 0; i < columns_.size(); i++) {
+    if (i > 0) buffer_.push_back(',');
+    const std::string &name = schema_->GetColumn(columns_[i])->GetName();
+    AppendCsvQuoted(name.data(), name.size(), buffer_);
+  }
+  buffer_.push_back('\n');
+}
+
+bool CsvResultSink::Consume(const TupleView &tuple) {
+  AppendTuple(tuple);
+  return true;
+}
+
+bool CsvResultSink::ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) {
+  ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) { AppendTuple(ChunkTuple(chunk, i)); });
+  return true;
+}
+
+template <typename Tuple>
+void CsvResultSink::AppendTuple(const Tuple &tuple) {
+  for (size_t i = 0; i < columns_.size(); i++) {
+    if (i > 0) buffer_.push_back(',');
+    uint32_t column = columns_[i];
+    if (tuple.IsNull(column)) continue;
+    TypeId type = schema_->GetColumn(column)->GetType();
+    if (type == kTypeChar) {
+      AppendCsvQuoted(tuple.GetChars(column), tuple.GetCharLength(column), buffer_);
+    } else {
+      AppendFieldText(tuple, column, type, buffer_);
+    }
+  }
+  buffer_.push_back('\n');
+  MaybeFlush();
+}
+
+template <typename T>
+static void AppendRaw(std::string &buffer, T value) {
+  buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void BinaryResultSink::Begin(const Schema *schema, const std::vector<uint32_t> &columns) {
+  ResultSink::Begin(schema, columns);
+  AppendRaw<uint32_t>(buffer_, columns_.size());
+  for (auto column : columns_) {
+    const Column *col = schema_->GetColumn(column);
+    AppendRaw<uint8_t>(buffer_, col->GetType());
+    AppendRaw<uint32_t>(buffer_, col->GetName().size());
+    buffer_ += col->GetName();
+  }
+  column_nulls_.assign(columns_.size(), std::string());
+  column_values_.assign(columns_.size(), std::string());
+  block_rows_ = 0;
+}
+
+bool BinaryResultSink::Consume(const TupleView &tuple) {
+  AppendTuple(tuple);
+  return true;
+}
+
+bool BinaryResultSink::ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) {
+  ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) { AppendTuple(ChunkTuple(chunk, i)); });
+  return true;
+}
+
+template <typename Tuple>
+void BinaryResultSink::AppendTuple(const Tuple &tuple) {
+  if (block_rows_ % 8 == 0) {
+    for (auto &nulls : column_nulls_) nulls.push_back(0);
+  }
+  for (size_t i = 0; i < columns_.size(); i++) {
+    uint32_t column = columns_[i];
+    if (tuple.IsNull(column)) {
+      column_nulls_[i].back() |= static_cast<char>(1 << (block_rows_ % 8));
+      continue;
+    }
+    std::string &values = column_values_[i];
+    if (schema_->GetColumn(column)->GetType() == kTypeChar) {
+      uint32_t len = tuple.GetCharLength(column);
+      AppendRaw<uint32_t>(values, len);
+      values.append(tuple.GetChars(column), len);
+    } else if (schema_->GetColumn(column)->GetType() == kTypeInt) {
+      AppendRaw<int32_t>(values, tuple.GetInt(column));
+    } else {
+      AppendRaw<float>(values, tuple.GetFloat(column));
+    }
+  }
+  if (++block_rows_ == BLOCK_ROWS) {
+    WriteBlock();
+  }
+}
+
+void BinaryResultSink::End() {
+  if (block_rows_ > 0) {
+    WriteBlock();
+  }
+  AppendRaw<uint32_t>(buffer_, 0);
+  Flush();
+}
+
+void BinaryResultSink::WriteBlock() {
+  AppendRaw<uint32_t>(buffer_, block_rows_);
+  for (size_t i = 0; i < columns_.size(); i++) {
+    buffer_ += column_nulls_[i];
+    buffer_ += column_values_[i];
+    column_nulls_[i].clear();
+    column_values_[i].clear();
+  }
+  block_rows_ = 0;
+  MaybeFlush();
+}
+
+bool CallbackResultSink::Consume(const TupleView &tuple) { return callback_(tuple, columns_); }
@@ -0,0 +1,201 @@
+#include "executor/rowid_bitmap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+RowIdBitmap RowIdBitmap::FromRowIds(std::vector<RowId> &row_ids) {
+  std::sort(row_ids.begin(), row_ids.end(), [](const RowId &a, const RowId &b) {
+    return a.GetPageId() != b.GetPageId() ? a.GetPageId() < b.GetPageId() : a.GetSlotNum() < b.GetSlotNum();
+  });
+  RowIdBitmap bitmap;
+  for (size_t i = 0; i < row_ids.size(); i++) {
+    if (bitmap.page_ids_.empty() || bitmap.page_ids_.back() != row_ids[i].GetPageId()) {
+      if (!bitmap.containers_.empty()) bitmap.containers_.back().Optimize();
+      bitmap.page_ids_.push_back(row_ids[i].GetPageId());
+      bitmap.containers_.emplace_back();
+    }
+    std::vector<uint16_t> &slots = bitmap.containers_.back().slots_;
+    uint16_t slot = static_cast<uint16_t>(row_ids[i].GetSlotNum());
+    if (slots.empty() || slots.back() != slot) {
+      slots.push_back(slot);
+    }
+  }
+  if (!bitmap.containers_.empty()) bitmap.containers_.back().Optimize();
+  return bitmap;
+}
+
+void RowIdBitmap::And(const RowIdBitmap &other) {
+  size_t kept = 0;
+  for (size_t i = 0, j = 0; i < page_ids_.size() && j < other.page_ids_.size();) {
+    if (page_ids_[i] < other.page_ids_[j]) {
+      i++;
+    } else if (page_ids_[i] > other.page_ids_[j]) {
+      j++;
+    } else {
+      Container both = And(containers_[i], other.containers_[j]);
+      if (both.GetCardinality() > 0) {
+        page_ids_[kept] = page_ids_[i];
+        containers_[kept++] = std::move(both);
+      }
+      i++;
+      j++;
+    }
+  }
+  page_ids_.resize(kept);
+  containers_.resize(kept);
+}
+
+void RowIdBitmap::Or(const RowIdBitmap &other) {
+  std::vector<page_id_t> page_ids;
+  std::vector<Container> containers;
+  size_t i = 0, j = 0;
+  while (i < page_ids_.size() || j < other.page_ids_.size()) {
+    if (j == other.page_ids_.size() || (i < page_ids_.size() && page_ids_[i] < other.page_ids_[j])) {
+      page_ids.push_back(page_ids_[i]);
+      containers.push_back(std::move(containers_[i++]));
+    } else if (i == page_ids_.size() || page_ids_[i] > other.page_ids_[j]) {
+      page_ids.push_back(other.page_ids_[j]);
+      containers.push_back(other.containers_[j++]);
+    } else {
+      page_ids.push_back(page_ids_[i]);
+      containers.push_back(Or(containers_[i++], other.containers_[j++]));
+    }
+  }
+  page_ids_.swap(page_ids);
+  containers_.swap(containers);
+}
+
+uint64_t RowIdBitmap::GetCardinality() const {
+  uint64_t cardinality = 0;
+  for (auto &container : containers_) {
+    cardinality += container.GetCardinality();
+  }
+  return cardinality;
+}
+
+void RowIdBitmap::GetSlotBits(uint32_t index, uint32_t first, uint32_t count, uint64_t *mask) const {
+  const Container &container = containers_[index];
+  uint32_t words = (count + 63) / 64;
+  memset(mask, 0, words * sizeof(uint64_t));
+  if (container.IsBitset()) {
+    uint32_t begin = first / 64;
+    if (begin < container.bits_.size()) {
+      uint32_t copied = std::min<uint32_t>(words, container.bits_.size() - begin);
+      memcpy(mask, container.bits_.data() + begin, copied * sizeof(uint64_t));
+    }
+    if (count % 64 != 0) {
+      mask[words - 1] &= (1ULL << (count % 64)) - 1;
+    }
+    return;
+  }
+  auto iter = std::lower_bound(container.slots_.begin(), container.slots_.end(), first);
+  for (; iter != container.slots_.end() && *iter < first + count; ++iter) {
+    uint32_t bit = *iter - first;
+    mask[bit / 64] |= 1ULL << (bit % 64);
+  }
+}
+
+void RowIdBitmap::ToRowIds(std::vector<RowId> &row_ids) const {
+  for (size_t i = 0; i < page_ids_.size(); i++) {
+    const Container &container = containers_[i];
+    if (!container.IsBitset()) {
+      for (auto slot : container.slots_) {
+        row_ids.emplace_back(page_ids_[i], slot);
+      }
+      continue;
+    }
+    for (uint32_t w = 0; w < container.bits_.size(); w++) {
+      for (uint64_t word = container.bits_[w]; word != 0; word &= word - 1) {
+        row_ids.emplace_back(page_ids_[i], w * 64 + static_cast<uint32_t>(__builtin_ctzll(word)));
+      }
+    }
+  }
+}
+
+uint32_t RowIdBitmap::Container::GetCardinality() const {
+  if (!IsBitset()) {
+    return slots_.size();
+  }
+  uint32_t cardinality = 0;
+  for (auto word : bits_) {
+    cardinality += __builtin_popcountll(word);
+  }
+  return cardinality;
+}
+
+void RowIdBitmap::Container::Optimize() {
+  while (!bits_.empty() && bits_.back() == 0) {
+    bits_.pop_back();
+  }
+  uint32_t cardinality = GetCardinality();
+  if (IsBitset() && cardinality * sizeof(uint16_t) < bits_.size() * sizeof(uint64_t)) {
+    std::vector<uint16_t> slots;
+    slots.reserve(cardinality);
+    for (uint32_t w = 0; w < bits_.size(); w++) {
+      for (uint64_t word = bits_[w]; word != 0; word &= word - 1) {
+        slots.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+      }
+    }
+    slots_.swap(slots);
+    std::vector<uint64_t>().swap(bits_);
+  } else if (!IsBitset() && !slots_.empty() &&
+             (slots_.back() / 64 + 1) * sizeof(uint64_t) < cardinality * sizeof(uint16_t)) {
+    ToBitset();
+  }
+}
+
+void RowIdBitmap::Container::ToBitset() {
+  if (IsBitset() || slots_.empty()) {
+    return;
+  }
+  bits_.assign(slots_.back() / 64 + 1, 0);
+  for (auto slot : slots_) {
+    bits_[slot / 64] |= 1ULL << (slot % 64);
+  }
+  std::vector<uint16_t>().swap(slots_);
+}
+
+RowIdBitmap::Container RowIdBitmap::And(const Container &a, const Container &b) {
+  Container both;
+  if (!a.IsBitset() && !b.IsBitset()) {
+    std::set_intersection(a.slots_.begin(), a.slots_.end(), b.slots_.begin(), b.slots_.end(),
+                          std::back_inserter(both.slots_));
+    return both;
+  }
+  if (a.IsBitset() && b.IsBitset()) {
+    both.bits_.resize(std::min(a.bits_.size(), b.bits_.size()));
+    for (size_t w = 0; w < both.bits_.size(); w++) {
+      both.bits_[w] = a.bits_[w] & b.bits_[w];
+    }
+    both.Optimize();
+    return both;
+  }
+  // the slots of the array which are set in the bitset
+  const Container &array = a.IsBitset() ? b : a;
+  const Container &bitset = a.IsBitset() ? a : b;
+  for (auto slot : array.slots_) {
+    if (slot / 64u < bitset.bits_.size() && (bitset.bits_[slot / 64] >> (slot % 64) & 1) != 0) {
+      both.slots_.push_back(slot);
+    }
+  }
+  return both;
+}
+
+RowIdBitmap::Container RowIdBitmap::Or(const Container &a, const Container &b) {
+  Container either;
+  if (!a.IsBitset() && !b.IsBitset()) {
+    std::set_union(a.slots_.begin(), a.slots_.end(), b.slots_.begin(), b.slots_.end(),
+                   std::back_inserter(either.slots_));
+  } else {
+    Container x = a, y = b;
+    x.ToBitset();
+    y.ToBitset();
+    either.bits_.assign(std::max(x.bits_.size(), y.bits_.size()), 0);
+    for (size_t w = 0; w < either.bits_.size(); w++) {
+      either.bits_[w] = (w < x.bits_.size() ? x.bits_[w] : 0) | (w < y.bits_.size() ? y.bits_[w] : 0);
+    }
+  }
+  either.Optimize();
+  return either;
+}
@@ -0,0 +1,81 @@
+#include "executor/spill_file.h"
+
+#include <cstring>
+
+bool SpillFile::Append(const char *data, uint32_t size) {
+  ASSERT(size <= MAX_RECORD_SIZE, "Spilled record is larger than a page.");
+  uint32_t used = 0;
+  if (write_page_ != nullptr) {
+    memcpy(&used, write_page_->GetData(), sizeof(uint32_t));
+  }
+  if (write_page_ == nullptr || used + sizeof(uint32_t) + size > PAGE_SIZE) {
+    page_id_t page_id = INVALID_PAGE_ID;
+    Page *page = bpm_->NewPage(page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    FinishPage();
+    write_page_ = page;
+    page_ids_.push_back(page_id);
+    used = sizeof(uint32_t);
+  }
+  char *buf = write_page_->GetData();
+  memcpy(buf + used, &size, sizeof(uint32_t));
+  memcpy(buf + used + sizeof(uint32_t), data, size);
+  used += sizeof(uint32_t) + size;
+  memcpy(buf, &used, sizeof(uint32_t));
+  record_count_++;
+  return true;
+}
+
+void SpillFile::FinishPage() {
+  if (write_page_ != nullptr) {
+    bpm_->UnpinPage(write_page_->GetPageId(), true);
+    write_page_ = nullptr;
+  }
+}
+
+void SpillFile::Free() {
+  FinishPage();
+  for (auto page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+  page_ids_.clear();
+  record_count_ = 0;
+}
+
+SpillFile::Reader::Reader(SpillFile *file) : file_(file) { file_->FinishPage(); }
+
+SpillFile::Reader::~Reader() {
+  if (page_ != nullptr) {
+    file_->bpm_->UnpinPage(page_->GetPageId(), false);
+  }
+}
+
+bool SpillFile::Reader::Next(const char **data, uint32_t *size) {
+  uint32_t used = 0;
+  if (page_ != nullptr) {
+    memcpy(&used, page_->GetData(), sizeof(uint32_t));
+  }
+  if (page_ == nullptr || offset_ >= used) {
+    if (page_ != nullptr) {
+      file_->bpm_->UnpinPage(page_->GetPageId(), false);
+      page_ = nullptr;
+    }
+    if (page_index_ >= file_->page_ids_.size()) {
+      return false;
+    }
+    page_ = file_->bpm_->FetchPage(file_->page_ids_[page_index_]);
+    if (page_ == nullptr) {
+      failed_ = true;
+      return false;
+    }
+    page_index_++;
+    offset_ = sizeof(uint32_t);
+  }
+  const char *buf = page_->GetData();
+  memcpy(size, buf + offset_, sizeof(uint32_t));
+  *data = buf + offset_ + sizeof(uint32_t);
+  offset_ += sizeof(uint32_t) + *size;
+  return true;
+}
@@ -0,0 +1,126 @@
+#include "executor/statement_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+/**
+ * Copy a syntax tree outside of the parser's node list, so it survives MinisqlParserFinish.
+ */
+static pSyntaxNode CopySyntaxTree(pSyntaxNode node, std::vector<pSyntaxNode> &literals) {
+  if (node == nullptr) {
+    return nullptr;
+  }
+  auto copy = reinterpret_cast<pSyntaxNode>(malloc(sizeof(struct SyntaxNode)));
+  *copy = *node;
+  copy->val_ = node->val_ == nullptr ? nullptr : strdup(node->val_);
+  if (node->type_ == kNodeNumber || node->type_ == kNodeString) {
+    literals.push_back(copy);
+  }
+  copy->child_ = CopySyntaxTree(node->child_, literals);
+  copy->next_ = CopySyntaxTree(node->next_, literals);
+  return copy;
+}
+
+static void FreeSyntaxTree(pSyntaxNode node) {
+  while (node != nullptr) {
+    pSyntaxNode next = node->next_;
+    FreeSyntaxTree(node->child_);
+    free(node->val_);
+    free(node);
+    node = next;
+  }
+}
+
+void CachedStatement::Bind(const std::vector<std::string> &literals) {
+  for (size_t i = 0; i < params_.size(); i++) {
+    pSyntaxNode param = params_[i];
+    if (strcmp(param->val_, literals[i].c_str()) != 0) {
+      free(param->val_);
+      param->val_ = strdup(literals[i].c_str());
+    }
+  }
+}
+
+bool StatementCache::Normalize(const char *sql, std::string &shape, std::vector<std::string> &literals) {
+  shape.clear();
+  literals.clear();
+  const char *p = sql;
+  while (*p != '\0') {
+    const char *q = p;
+    if (isspace(*p)) {
+      p++;
+      continue;
+    } else if (*p == '"') {
+      // \"(\\.|[^"\\])*\"
+      for (q = p + 1; *q != '"'; q++) {
+        if (*q == '\0') return false;
+        if (*q == '\\' && *++q == '\0') return false;
+      }
+      literals.emplace_back(p + 1, q - p - 1);
+      shape += "?s";
+      q++;
+    } else if (isalpha(*p) || *p == '_') {
+      // {L}{LD}*
+      while (isalnum(*q) || *q == '_') q++;
+      shape.append(p, q - p);
+    } else if (isdigit(*p) || *p == '-' || (*p == '.' && isdigit(p[1]))) {
+      // [-]?{D}*\.{D}+ or [-]?{D}*
+      if (*q == '-') q++;
+      while (isdigit(*q)) q++;
+      if (*q == '.' && isdigit(q[1])) {
+        for (q++; isdigit(*q); q++) {
+        }
+      }
+      literals.emplace_back(p, q - p);
+      shape += "?n";
+    } else if ((*p == '<' && (p[1] == '>' || p[1] == '=')) || (*p == '>' && p[1] == '=')) {
+      q += 2;
+      shape.append(p, 2);
+    } else {
+      q++;
+      shape.push_back(*p);
+    }
+    shape.push_back(' ');
+    p = q;
+  }
+  return true;
+}
+
+CachedStatement *StatementCache::Lookup(const std::string &shape) {
+  auto it = statements_.find(shape);
+  return it == statements_.end() ? nullptr : &it->second;
+}
+
+CachedStatement *StatementCache::Insert(const std::string &shape, const std::vector<std::string> &literals,
+                                        pSyntaxNode ast) {
+  if (ast == nullptr || (ast->type_ != kNodeInsert && ast->type_ != kNodeSelect)) {
+    return nullptr;
+  }
+  std::vector<pSyntaxNode> params;
+  pSyntaxNode tree = CopySyntaxTree(ast, params);
+  // the lexer creates literal nodes in text order
+  std::sort(params.begin(), params.end(), [](pSyntaxNode a, pSyntaxNode b) { return a->id_ < b->id_; });
+  bool matched = params.size() == literals.size();
+  for (size_t i = 0; matched && i < params.size(); i++) {
+    matched = literals[i] == params[i]->val_;
+  }
+  if (!matched) {
+    FreeSyntaxTree(tree);
+    return nullptr;
+  }
+  if (statements_.size() >= capacity_) {
+    Clear();
+  }
+  CachedStatement &statement = statements_[shape];
+  statement.tree_ = tree;
+  statement.params_ = std::move(params);
+  return &statement;
+}
+
+void StatementCache::Clear() {
+  for (auto &it : statements_) {
+    FreeSyntaxTree(it.second.tree_);
+  }
+  statements_.clear();
+}
@@ -28,6 +28,12 @@ public:
 
   bool DeletePage(page_id_t page_id);
 
+  /**
+   * Delete a batch of pages, freeing them on disk in one pass, see DiskManager::DeAllocatePages.
+   * @return false if one of them is pinned, its frame is kept then
+   */
+  bool DeletePages(const std::vector<page_id_t> &page_ids);
+
   bool IsPageFree(page_id_t page_id);
 
   bool CheckAllUnpinned();
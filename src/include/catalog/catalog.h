@@ -7,6 +7,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/indexes.h"
+#include "catalog/statistics.h"
 #include "catalog/table.h"
 #include "common/config.h"
 #include "common/dberr.h"
@@ -55,6 +56,13 @@ public:
     return &index_meta_pages_;
   }
 
+  /**
+   * Used only for testing
+   */
+  inline uint32_t *GetRowFormatVersion() {
+    return &row_format_version_;
+  }
+
 private:
   explicit CatalogMeta();
 
@@ -62,6 +70,7 @@ private:
   static constexpr uint32_t CATALOG_METADATA_MAGIC_NUM = 89849;
   std::map<table_id_t, page_id_t> table_meta_pages_;
   std::map<index_id_t, page_id_t> index_meta_pages_;
+  uint32_t row_format_version_{Row::ROW_FORMAT_VERSION};  /** format of the rows in the table heaps */
 };
 
 /**
@@ -75,7 +84,8 @@ public:
 
   ~CatalogManager();
 
-  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info);
+  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info,
+                      TableLayout layout = kLayoutRow);
 
   dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
@@ -103,15 +113,75 @@ public:
 
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  /**
+   * Remove every row of the table: the heap keeps only its first page, the indexes are emptied and
+   * the statistics are reset. The table and index infos stay valid.
+   */
+  dberr_t TruncateTable(const std::string &table_name);
+
+  /**
+   * Changed by every create/drop of a table or index, so callers caching TableInfo/IndexInfo pointers
+   * can tell whether they are still valid. Versions are drawn from a process-wide counter, a catalog
+   * never takes a version another catalog had, even one of a dropped database at the same address.
+   */
+  inline uint64_t GetVersion() const { return version_; }
+
+  /**
+   * @return the statistics of the table, kept up to date by the changes of its rows, nullptr if it
+   *         has none, which is the case for a table of an older database until it is analyzed
+   */
+  TableStatistics *GetStatistics(table_id_t table_id);
+
+  /**
+   * Replace the statistics of the table and store them.
+   */
+  void SetStatistics(table_id_t table_id, TableStatistics statistics);
+
 private:
+  /**
+   * @return a catalog version no catalog of this process had before
+   */
+  static uint64_t NextVersion();
+
   dberr_t FlushCatalogMetaPage() const;
 
   dberr_t LoadTable(const table_id_t table_id, const page_id_t page_id);
 
   dberr_t LoadIndex(const index_id_t index_id, const page_id_t page_id);
 
+  /**
+   * Give a table written before tables had a page directory one, and store it in the table
+   * metadata on page page_id.
+   */
+  void AttachPageDirectory(TableMetadata *table_meta, TableHeap *table_heap, page_id_t page_id);
+
+  /**
+   * Store the statistics of the table in its chain of statistics pages, which grows or shrinks to fit.
+   */
+  void WriteStatistics(table_id_t table_id);
+
+  /**
+   * Read the stored statistics of a table, if any.
+   */
+  void LoadStatistics(TableMetadata *table_meta);
+
+  /**
+   * Free the chain of statistics pages starting at first_page_id.
+   */
+  void FreeStatistics(page_id_t first_page_id);
+
   dberr_t GetTable(const table_id_t table_id, TableInfo *&table_info);
 
+  /**
+   * Insert the key of every tuple of the table into a new index.
+   */
+  void FillIndex(TableInfo *table_info, IndexInfo *index_info, const std::vector<uint32_t> &key_map);
+
+  /**
+   * Point the index entries of the table's tuples which moved from the first to the second row id at their new slots.
+   */
+  void MoveIndexEntries(TableInfo *table_info, const std::vector<std::pair<RowId, RowId>> &moved);
+
  private:
   [[maybe_unused]] BufferPoolManager *buffer_pool_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -125,6 +195,8 @@ private:
   // map for indexes: table_name->index_name->indexes
   [[maybe_unused]] std::unordered_map<std::string, std::unordered_map<std::string, index_id_t>> index_names_;
   [[maybe_unused]] std::unordered_map<index_id_t, IndexInfo *> indexes_;
+  uint64_t version_{NextVersion()};
+  std::unordered_map<table_id_t, TableStatistics> statistics_;
 
  public:
   // memory heap
@@ -0,0 +1,194 @@
+#ifndef MINISQL_STATISTICS_H
+#define MINISQL_STATISTICS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "record/data_chunk.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/tuple_view.h"
+
+/**
+ * HyperLogLog sketch of the distinct values of a column, fed with 64-bit hashes of the values. The
+ * estimate is within about 2.3% of the distinct count, linear counting takes over for small ones.
+ */
+class HyperLogLog {
+public:
+  static constexpr uint32_t PRECISION = 11;
+  static constexpr uint32_t REGISTER_COUNT = 1u << PRECISION;
+
+  HyperLogLog() : registers_(REGISTER_COUNT, 0) {}
+
+  inline void Add(uint64_t hash) {
+    // the first bits pick a register, which keeps the longest run of leading zeros of the rest
+    uint32_t index = static_cast<uint32_t>(hash >> (64 - PRECISION));
+    uint64_t rest = hash << PRECISION;
+    uint8_t rank = rest == 0 ? 64 - PRECISION + 1 : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers_[index]) {
+      registers_[index] = rank;
+    }
+  }
+
+  double Estimate() const;
+
+  inline const std::vector<uint8_t> &GetRegisters() const { return registers_; }
+
+  inline std::vector<uint8_t> &GetRegisters() { return registers_; }
+
+private:
+  std::vector<uint8_t> registers_;
+};
+
+/**
+ * Statistics of a column: the null count, a HyperLogLog sketch of the distinct values and a
+ * reservoir sample of the order keys of the values, see TableStatistics::OrderKey. The sample gives
+ * an equi-depth histogram, which is recomputed when it is read after enough changes.
+ */
+struct ColumnStatistics {
+  static constexpr uint32_t SAMPLE_SIZE = 512;
+
+  uint64_t null_count_{0};
+  /** the non-null values the sample is drawn from, a new one is sampled with probability SAMPLE_SIZE / value_count_ */
+  uint64_t value_count_{0};
+  double min_{0};
+  double max_{0};
+  HyperLogLog distinct_;
+  std::vector<double> sample_;
+  uint32_t changes_{0};  /** values added or removed since bounds_ was computed */
+
+  /** from the sketch and the sample, by Refresh */
+  uint64_t distinct_count_{0};
+  /** bounds_[0] is the min and bounds_.back() the max, every bucket between two bounds holds the same share */
+  std::vector<double> bounds_;
+
+  /**
+   * @return the share of the non-null values less than key
+   */
+  double FractionBelow(double key) const;
+
+  /**
+   * @return true if as many values changed as a tenth of the sample since the histogram was computed
+   */
+  inline bool NeedsRefresh(uint64_t non_null_count) const {
+    return changes_ > 0 && (bounds_.empty() || changes_ * 10 >= std::min<uint64_t>(non_null_count, SAMPLE_SIZE));
+  }
+
+  /**
+   * Compute the distinct count and the histogram again.
+   * @param non_null_count the number of non-null values of the column, caps the distinct count
+   */
+  void Refresh(uint64_t non_null_count);
+};
+
+/**
+ * Statistics of a table, used to estimate how many rows a condition selects. Analyze gathers them
+ * from a scan of the table, the inserts, deletes and updates keep them up to date until the next one.
+ */
+struct TableStatistics {
+  static constexpr uint32_t HISTOGRAM_BUCKETS = 32;
+  /** guesses for a table without statistics */
+  static constexpr double DEFAULT_EQ_SELECTIVITY = 0.005;
+  static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3;
+
+  TableStatistics() = default;
+
+  explicit TableStatistics(uint32_t column_count) : columns_(column_count) {}
+
+  uint64_t row_count_{0};
+  uint32_t page_count_{0};  /** at the last analyze or vacuum */
+  std::vector<ColumnStatistics> columns_;
+  bool dirty_{false};       /** changed since it was last written */
+
+  /**
+   * Count a non-null value of column, or a null one if is_null.
+   * @param key the order key of the value
+   * @param hash the hash of the value, see HashValue
+   */
+  void AddValue(uint32_t column, bool is_null, double key, uint64_t hash);
+
+  void RemoveValue(uint32_t column, bool is_null, double key);
+
+  /**
+   * Count a row inserted into the table.
+   */
+  void InsertRow(const Row &row);
+
+  /**
+   * Count a row removed from the table.
+   */
+  void RemoveRow(const Row &row);
+
+  /**
+   * Recompute the distinct counts and histograms of the columns which changed enough, called before
+   * they are read so a batch of changes pays for one refresh.
+   */
+  void Refresh();
+
+  /**
+   * @return the estimated share of the rows for which column op value is true
+   */
+  double Selectivity(uint32_t column, CompareOp op, const Field &value) const;
+
+  static double DefaultSelectivity(CompareOp op);
+
+  /**
+   * An order preserving map of a value to a double: numbers by their values, chars by their first 6 bytes.
+   */
+  static double OrderKey(const Field &value);
+
+  static double OrderKey(const char *chars, uint32_t length);
+
+  /**
+   * @return the chars an order key of a char value starts with
+   */
+  static std::string OrderKeyChars(double key);
+
+  /**
+   * @return the hash of a value for the distinct counts, equal numbers of either sign hash alike
+   */
+  static uint64_t HashValue(const Field &value);
+
+  static uint64_t HashValue(TypeId type, int32_t integer, float real);
+
+  /**
+   * Append the statistics to buf.
+   */
+  void SerializeTo(std::vector<char> &buf) const;
+
+  /**
+   * @return false if buf holds no statistics
+   */
+  static bool DeserializeFrom(const char *buf, uint32_t size, TableStatistics &statistics);
+
+private:
+  static constexpr uint32_t STATISTICS_MAGIC_NUM = 271828;
+
+  std::minstd_rand random_{42};
+};
+
+/**
+ * Gathers the statistics of a table from a scan of all its columns.
+ */
+class StatisticsBuilder {
+public:
+  explicit StatisticsBuilder(const Schema *schema)
+      : schema_(schema), statistics_(schema->GetColumnCount()), keys_(schema->GetColumnCount()) {}
+
+  /**
+   * Add the visible tuples of chunk, which holds every column.
+   */
+  void AddChunk(const DataChunk &chunk);
+
+  TableStatistics Finish(uint32_t page_count);
+
+private:
+  const Schema *schema_;
+  TableStatistics statistics_;
+  /** the order keys of all the values, for an exact histogram */
+  std::vector<std::vector<double>> keys_;
+};
+
+#endif  // MINISQL_STATISTICS_H
@@ -18,7 +18,9 @@ public:
   static uint32_t DeserializeFrom(char *buf, TableMetadata *&table_meta, MemHeap *heap);
 
   static TableMetadata *Create(table_id_t table_id, std::string table_name,
-                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap);
+                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                               TableLayout layout = kLayoutRow, page_id_t directory_page_id = INVALID_PAGE_ID,
+                               page_id_t statistics_page_id = INVALID_PAGE_ID);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -28,18 +30,41 @@ public:
 
   inline Schema *GetSchema() const { return schema_; }
 
+  inline TableLayout GetLayout() const { return layout_; }
+
+  /**
+   * @return the first page of the page directory of the table, INVALID_PAGE_ID if it was written
+   *         before tables had one
+   */
+  inline page_id_t GetDirectoryPageId() const { return directory_page_id_; }
+
+  inline void SetDirectoryPageId(page_id_t directory_page_id) { directory_page_id_ = directory_page_id; }
+
+  /**
+   * @return the first page of the stored statistics of the table, INVALID_PAGE_ID if there are none
+   */
+  inline page_id_t GetStatisticsPageId() const { return statistics_page_id_; }
+
+  inline void SetStatisticsPageId(page_id_t statistics_page_id) { statistics_page_id_ = statistics_page_id; }
 
 private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                TableLayout layout, page_id_t directory_page_id, page_id_t statistics_page_id);
 
 private:
-  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344531;
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM_V3 = 344530;  /** before the statistics were stored */
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM_V2 = 344529;  /** before the page directory was stored */
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM_V1 = 344528;  /** before the layout was stored, always row */
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
   Schema *schema_;
+  TableLayout layout_;
+  page_id_t directory_page_id_;
+  page_id_t statistics_page_id_;
 };
 
 /**
@@ -73,6 +98,10 @@ public:
 
   inline page_id_t GetRootPageId() const { return table_meta_->root_page_id_; }
 
+  inline TableLayout GetLayout() const { return table_meta_->layout_; }
+
+  inline TableMetadata *GetTableMetadata() const { return table_meta_; }
+
 private:
   explicit TableInfo() : heap_(new SimpleMemHeap()) {};
 
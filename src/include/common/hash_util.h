@@ -0,0 +1,34 @@
+#ifndef MINISQL_HASH_UTIL_H
+#define MINISQL_HASH_UTIL_H
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * 64-bit hash of a byte string for the hash tables of the executor, the high and the low bits are
+ * both well mixed, so either can pick a partition or a bucket.
+ */
+inline uint64_t HashBytes(const char *data, uint32_t size) {
+  uint64_t hash = 0x9e3779b97f4a7c15ULL ^ size;
+  uint32_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(uint64_t));
+    hash = (hash ^ word) * 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 32;
+  }
+  if (i < size) {
+    uint64_t word = 0;
+    memcpy(&word, data + i, size - i);
+    hash = (hash ^ word) * 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 32;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+#endif  // MINISQL_HASH_UTIL_H
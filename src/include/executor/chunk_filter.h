@@ -0,0 +1,72 @@
+#ifndef MINISQL_CHUNK_FILTER_H
+#define MINISQL_CHUNK_FILTER_H
+
+#include <vector>
+
+#include "record/data_chunk.h"
+#include "record/field.h"
+#include "record/filter_kernels.h"
+
+/**
+ * A where condition compiled for the batch executor: compares of a column with a constant, combined
+ * by and/or. Evaluating a chunk runs one filter kernel per compare and combines the selection
+ * bitmaps, the conditions are dispatched once per chunk instead of once per tuple.
+ */
+class ChunkFilter {
+public:
+  /**
+   * @param value constant of the type of column, must outlive the filter
+   * @return the id of the new condition
+   */
+  uint32_t AddCompare(uint32_t column, CompareOp op, const Field *value);
+
+  /**
+   * @param is_and true for and, false for or
+   * @return the id of the new condition, left and right are ids of conditions added before
+   */
+  uint32_t AddConnector(bool is_and, uint32_t left, uint32_t right);
+
+  /**
+   * The condition added last is the whole where condition.
+   */
+  inline bool IsEmpty() const { return nodes_.empty(); }
+
+  /**
+   * @return the columns the compares read, each once
+   */
+  inline const std::vector<uint32_t> &GetColumns() const { return columns_; }
+
+  /**
+   * Set the bits of the visible tuples of chunk which satisfy the condition, clear the other ones.
+   * An empty filter selects every visible tuple.
+   */
+  void Evaluate(const DataChunk &chunk, uint64_t *selection);
+
+  /**
+   * Evaluate the condition on a single tuple, e.g. one read through an index.
+   * @return true if tuple satisfies it, an empty filter selects every tuple
+   */
+  bool Evaluate(const TupleView &tuple) const;
+
+private:
+  enum NodeType { kCompareNode, kAndNode, kOrNode };
+
+  struct Node {
+    NodeType type_;
+    uint32_t column_;
+    CompareOp op_;
+    const Field *value_;
+    uint32_t left_;
+    uint32_t right_;
+  };
+
+  void EvaluateNode(uint32_t id, const DataChunk &chunk, uint64_t *selection, uint32_t depth);
+
+  bool EvaluateNode(uint32_t id, const TupleView &tuple) const;
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> columns_;
+  std::vector<uint64_t> scratch_;  /** a bitmap per level of the condition tree */
+};
+
+#endif  // MINISQL_CHUNK_FILTER_H
@@ -1,11 +1,22 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <algorithm>
+#include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include "common/dberr.h"
 #include "common/instance.h"
+#include "executor/chunk_filter.h"
+#include "executor/external_sort.h"
+#include "executor/hash_aggregate.h"
+#include "executor/join_operators.h"
+#include "executor/parallel_scan.h"
+#include "executor/result_sink.h"
+#include "executor/statement_cache.h"
 #include "transaction/transaction.h"
+#include "utils/tree_file_mgr.h"
 
 extern "C" {
 #include "parser/parser.h"
@@ -20,6 +31,38 @@ extern "C" {
 struct ExecuteContext {
   bool flag_quit_{false};
   Transaction *txn_{nullptr};
+  TablePlan *plan_{nullptr};  /** plan kept by the statement cache for this statement, may be null */
+  ResultSink *sink_{nullptr};  /** receives the rows of a select, the engine prints them if null */
+};
+
+/**
+ * How the rows satisfying a where condition are found: a scan of the table, or the intersection of
+ * the row ids of one or more index lookups, picked by their estimated costs. The costs are counted
+ * in sequentially scanned pages. The row ids are combined as RowIdBitmaps.
+ */
+struct AccessPath {
+  static constexpr double SEQ_PAGE_COST = 1.0;
+  static constexpr double CPU_TUPLE_COST = 0.01;   /** filter one tuple */
+  static constexpr double INDEX_PROBE_COST = 4.0;  /** descend an index to a key */
+  static constexpr double INDEX_ENTRY_COST = 0.01; /** read and combine one row id of a lookup */
+  static constexpr double ROW_FETCH_COST = 0.25;   /** fetch and check one row by its row id */
+  static constexpr double DEFAULT_ROWS_PER_PAGE = 100;
+
+  /** an equality with a constant, looked up in the index of its column */
+  struct Probe {
+    IndexInfo *index_;
+    pSyntaxNode compare_;
+    uint32_t column_;
+  };
+
+  /** an operand of the and of the condition: an equality, or an or of equalities whose row ids are united */
+  struct Lookup {
+    std::vector<Probe> probes_;
+  };
+
+  std::vector<Lookup> lookups_;  /** empty for a scan, most selective first */
+  bool exact_{false};            /** the lookups are the whole condition, the rows found need no check */
+  double cost_{0};
 };
 
 /**
@@ -29,7 +72,16 @@ class ExecuteEngine {
 public:
   ExecuteEngine();
 
+  /**
+   * Create a session engine sharing the databases opened by shared.
+   * Only the current database is private to the session; shared must outlive it.
+   */
+  explicit ExecuteEngine(ExecuteEngine *shared);
+
   ~ExecuteEngine() {
+    if (&dbs_ != &own_dbs_) {
+      return;
+    }
     for (auto it : dbs_) {
       delete it.second;
     }
@@ -40,7 +92,34 @@ public:
    */
   dberr_t Execute(pSyntaxNode ast, ExecuteContext *context);
 
+  /**
+   * parse a single sql statement and execute it
+   * In production mode (the default) this is the whole statement path: no tree dump, no timing.
+   */
+  dberr_t ExecuteSql(const char *sql, ExecuteContext *context);
+
+  /**
+   * debug mode dumps every parsed syntax tree into syntax_tree_<id>.txt and prints the execute time
+   */
+  void SetDebugMode(bool debug_mode);
+
+  /**
+   * format of the select results printed to std::cout
+   */
+  inline void SetResultFormat(ResultFormat format) { result_format_ = format; }
+
+  /**
+   * number of threads filtering a large table in a scan without an index, 1 scans sequentially
+   */
+  inline void SetScanWorkers(uint32_t scan_workers) { scan_workers_ = std::max(scan_workers, 1u); }
+
 private:
+  /**
+   * The database chosen by this session, nullptr if there is none. A database dropped by another
+   * session sharing dbs_ is no longer chosen.
+   */
+  DBStorageEngine *CurrentDatabase();
+
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *context);
@@ -55,6 +134,11 @@ private:
 
   dberr_t ExecuteDropTable(pSyntaxNode ast, ExecuteContext *context);
 
+  /**
+   * remove every row of a table, its pages are freed at once and its indexes and statistics are reset
+   */
+  dberr_t ExecuteTruncateTable(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *context);
@@ -63,6 +147,17 @@ private:
 
   dberr_t ExecuteSelect(pSyntaxNode ast, ExecuteContext *context);
 
+  /**
+   * select with aggregate functions or a group by, the selected tuples are grouped by a HashAggregate
+   */
+  dberr_t ExecuteAggregate(pSyntaxNode ast, ExecuteContext *context);
+
+  /**
+   * select from several tables, joined left-deep in from order by a HashJoin, an IndexNestedLoopJoin
+   * or a MergeJoin each
+   */
+  dberr_t ExecuteJoin(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteInsert(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDelete(pSyntaxNode ast, ExecuteContext *context);
@@ -79,19 +174,174 @@ private:
 
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
+  /**
+   * load a csv file into a table, in batches of LOAD_BATCH_SIZE rows
+   */
+  dberr_t ExecuteLoad(pSyntaxNode ast, ExecuteContext *context);
+
+  /**
+   * gather the statistics of a table: row and page counts, distinct counts and histograms of the columns
+   */
+  dberr_t ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context);
+
+  /**
+   * print the statistics of a table: the row count and per column the null and distinct counts and the range
+   */
+  dberr_t ExecuteShowStats(pSyntaxNode ast, ExecuteContext *context);
+
+  /**
+   * reclaim the space of the deleted rows of a table: its pages are compacted, sparse pages merged and
+   * freed, and the index entries of the moved rows repointed
+   */
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
   //Support function
   dberr_t TransferPks(std::vector<std::string> &in, std::vector<Column *> item, std::vector<Column *> &out);
-  dberr_t GetRowSet(DBStorageEngine *database_now, std::vector<Row> &result, TableInfo *table, std::string &condition,
-                    string compare_column_name, std::string &val,SimpleMemHeap& heap);
-  Field *MakeField(std::string &expect_val, TypeId tmp_type, SimpleMemHeap &heap);
-  void Intersect(std::vector<Row> &a, std::vector<Row> &b, std::vector<Row> &result);
-  void Union(std::vector<Row> &a, std::vector<Row> &b, std::vector<Row> &result);
+  dberr_t ResolveTablePlan(DBStorageEngine *database_now, const std::string &table_name, TablePlan &plan);
+
+  /**
+   * @param name a column of the table of plan, may be qualified as table.column
+   */
+  dberr_t ResolveColumn(const TablePlan &plan, const std::string &name, uint32_t &column);
+
+  /**
+   * Find the table of a column among the tables of a join, an unqualified name must be unique.
+   */
+  dberr_t ResolveJoinColumn(const std::vector<TablePlan> &plans, const std::string &name, uint32_t &table,
+                            uint32_t &column);
 
-  dberr_t Insert(DBStorageEngine *database_now, TableInfo *my_table_info, Row *my_row);
+  /**
+   * Add the tables of the columns compared in condition, a compare or an and/or tree of compares with
+   * constants, to tables.
+   */
+  dberr_t CollectJoinTables(const std::vector<TablePlan> &plans, pSyntaxNode condition, std::set<uint32_t> &tables);
+  Field *MakeField(std::string &expect_val, TypeId tmp_type, MemHeap &heap);
+
+  /**
+   * @return the constant a compare node compares its column of type with, built in heap
+   */
+  Field *MakeCompareValue(pSyntaxNode compare, TypeId type, MemHeap &heap);
+
+  /**
+   * Evaluate a where condition, a compare or an and/or tree of compares, on the table of plan.
+   * @param condition the condition node, nullptr selects every row
+   * @param result ids of the selected rows, grouped by page
+   */
+  dberr_t SelectRowIds(const TablePlan &plan, pSyntaxNode condition, std::vector<RowId> &result, MemHeap &heap);
+
+  /**
+   * @return true if the cheapest access path of condition starts from index lookups instead of a scan,
+   *         see ChooseAccessPath
+   */
+  bool UseIndexScan(const TablePlan &plan, pSyntaxNode condition);
+
+  /**
+   * Pick the cheapest of a scan and the lookups of the most selective equalities on indexed columns
+   * of the and of condition, by the statistics of the last analyze of the table.
+   */
+  void ChooseAccessPath(const TablePlan &plan, pSyntaxNode condition, MemHeap &heap, AccessPath &path);
+
+  /**
+   * Add the probes of condition to lookup.
+   * @return false if condition is not an equality with a constant on a column with a single column
+   *         index, or an or of those
+   */
+  bool MakeLookup(const TablePlan &plan, pSyntaxNode condition, AccessPath::Lookup &lookup);
+
+  /**
+   * @return the estimated share of the rows of the table of plan selected by condition
+   */
+  double EstimateSelectivity(const TablePlan &plan, pSyntaxNode condition, MemHeap &heap);
+
+  /**
+   * @return the estimated row count of the table of plan, from its statistics if it has any
+   */
+  double EstimateRowCount(const TablePlan &plan);
+
+  /**
+   * Compile a where condition into filter, the constants are built in heap. The operands of an and are
+   * compiled most selective first.
+   * @param id the id of the compiled condition in filter
+   */
+  dberr_t CompileFilter(const TablePlan &plan, pSyntaxNode condition, MemHeap &heap, ChunkFilter &filter,
+                        uint32_t &id);
+
+  /**
+   * Batch select: scan the table chunk by chunk, filter every chunk by condition and hand the
+   * selected tuples to the sink, without materializing rows.
+   * @param condition the where condition, nullptr selects every row
+   * @param output the columns the sink prints
+   */
+  dberr_t SelectChunks(const TablePlan &plan, pSyntaxNode condition, const std::vector<uint32_t> &output,
+                       ResultSink &sink, MemHeap &heap);
+
+  /**
+   * Read the order by and the limit of a select.
+   * @param resolve maps an order by column to a column of the selected results
+   * @param limit ExternalSort::NO_LIMIT without a limit
+   */
+  dberr_t ResolveOrderBy(pSyntaxNode ast, const std::function<dberr_t(const std::string &, uint32_t &)> &resolve,
+                         std::vector<SortKey> &keys, uint64_t &limit);
+
+  /**
+   * Select the rows of the table of plan in the key order of index, filtered by condition, so an
+   * order by the key of index needs no sort.
+   */
+  dberr_t SelectInIndexOrder(const TablePlan &plan, IndexInfo *index, pSyntaxNode condition, ResultSink &sink,
+                             MemHeap &heap);
+
+  /**
+   * Remove the entries of tuples from indexes, from every index in its key order.
+   */
+  void RemoveIndexEntries(const std::vector<IndexInfo *> &indexes, const std::vector<TupleView> &tuples);
+
+  /**
+   * Point the entries of tuples, which moved away from old_row_ids, to the row ids of tuples.
+   */
+  void MoveIndexEntries(const std::vector<IndexInfo *> &indexes, const std::vector<TupleView> &tuples,
+                        const std::vector<RowId> &old_row_ids);
+
+  /**
+   * Check that changed_indexes take the new keys of tuples, whose columns are set to values: the new keys
+   * differ from each other and from the keys of the rows which are not updated.
+   */
+  dberr_t CheckUpdateKeys(const TablePlan &plan, const std::vector<IndexInfo *> &changed_indexes,
+                          const std::vector<TupleView> &tuples, const std::vector<uint32_t> &columns,
+                          const std::vector<Field *> &values);
+
+  /**
+   * Replace the tuple old_tuple by new_row, in place if it fits into its page. The entries of old_tuple in
+   * changed_indexes, the indexes whose keys change, are replaced by the new keys. Rejected if a new key is
+   * taken, the row keeps its old entries then.
+   */
+  dberr_t UpdateRow(const TablePlan &plan, const std::vector<IndexInfo *> &changed_indexes,
+                    const TupleView &old_tuple, Row &new_row);
+
+  /**
+   * Insert a row into the table and its indexes. Each index rejects a key it already holds while inserting
+   * it, the row is rolled back from the indexes and the table then.
+   */
+  dberr_t Insert(DBStorageEngine *database_now, const TablePlan &plan, Row *my_row);
+  dberr_t MakeInsertRow(const TablePlan &plan, pSyntaxNode column_value, vector<Field> &my_fields);
+
+  /**
+   * Insert a batch of rows: append them all to the heap, then insert them into every index in key order.
+   * Rows with a key an index already holds are removed again and counted in rejected.
+   */
+  dberr_t BulkInsert(const TablePlan &plan, std::vector<Row> &rows, uint32_t &rejected);
 
 private:
-  std::unordered_map<std::string, DBStorageEngine *> dbs_;  /** all opened databases */
+  static constexpr size_t LOAD_BATCH_SIZE = 10000;
+  std::unordered_map<std::string, DBStorageEngine *> own_dbs_;
+  std::unordered_map<std::string, DBStorageEngine *> &dbs_;  /** all opened databases */
   std::string current_db_;  /** current database */
+  bool debug_mode_{false};
+  ResultFormat result_format_{kResultText};
+  uint32_t scan_workers_;
+  std::unique_ptr<TreeFileManagers> syntax_tree_file_mgr_;  /** only created in debug mode */
+  uint32_t syntax_tree_id_{0};
+  StatementCache statement_cache_;  /** parsed insert/select shapes of this session */
+  ArenaMemHeap query_heap_;  /** temporaries of the running statement, reset when the next one starts */
 };
 
 #endif //MINISQL_EXECUTE_ENGINE_H
@@ -0,0 +1,156 @@
+#ifndef MINISQL_EXTERNAL_SORT_H
+#define MINISQL_EXTERNAL_SORT_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/dberr.h"
+#include "executor/result_sink.h"
+#include "executor/spill_file.h"
+#include "record/tuple_view.h"
+
+/**
+ * A column of an order by, null values come first in ascending order.
+ */
+struct SortKey {
+  uint32_t column_;
+  bool descending_;
+};
+
+/**
+ * Sort of tuples by a list of keys. The tuples are copied into a run in memory, and a run is
+ * sorted as an array of | key prefix(8) | offset(4) | size(4) | entries: the prefix encodes the
+ * first key so that most compares are one integer compare on a contiguous array, only equal
+ * prefixes compare the tuples themselves.
+ *
+ * A run exceeding the memory budget is sorted and written to a temporary page file. Finish merges
+ * the runs with a heap, at most MERGE_FAN_IN at a time, runs beyond that are merged into longer
+ * runs first. With a small limit only the first limit tuples are kept, in a bounded heap, and
+ * nothing is spilled.
+ */
+class ExternalSort {
+public:
+  static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+  static constexpr uint64_t NO_LIMIT = UINT64_MAX;
+  static constexpr uint64_t MAX_TOP_N = 64 * 1024;
+  static constexpr uint32_t MERGE_FAN_IN = 16;
+
+  /**
+   * @param schema schema of the sorted tuples
+   * @param limit number of tuples Finish returns at most
+   * @param bpm buffer pool of the temporary pages
+   */
+  ExternalSort(const Schema *schema, std::vector<SortKey> keys, BufferPoolManager *bpm, uint64_t limit = NO_LIMIT,
+               size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+  /**
+   * Copy tuple into the sort.
+   */
+  void Add(const TupleView &tuple);
+
+  /**
+   * @return false to stop
+   */
+  using Emit = std::function<bool(const TupleView &tuple)>;
+
+  /**
+   * Hand the tuples to emit in key order, tuples with equal keys in no particular order. The sort
+   * is empty afterwards.
+   * @return DB_FAILED if the buffer pool has no page left to merge the runs, the tuples emitted before
+   *         are in order but some are missing
+   */
+  dberr_t Finish(const Emit &emit);
+
+  /**
+   * @return the number of runs written to temporary pages so far
+   */
+  inline uint32_t GetSpilledRunCount() const { return spilled_runs_; }
+
+private:
+  struct Entry {
+    uint64_t prefix_;
+    uint32_t offset_;
+    uint32_t size_;
+  };
+
+  uint64_t Prefix(const TupleView &tuple) const;
+
+  /**
+   * @return < 0, 0 or > 0 as a sorts before, together with or after b
+   */
+  int Compare(const char *a, const char *b) const;
+
+  inline bool Less(uint64_t a_prefix, const char *a, uint64_t b_prefix, const char *b) const {
+    return a_prefix != b_prefix ? a_prefix < b_prefix : Compare(a, b) < 0;
+  }
+
+  void SortRun();
+
+  /**
+   * Write the run in memory to a temporary page file.
+   */
+  void SpillRun();
+
+  /**
+   * Merge runs, and the run in memory if with_memory, handing the tuples to emit in key order until
+   * it returns false.
+   * @return DB_FAILED if the buffer pool has no frame left to read a run
+   */
+  dberr_t Merge(std::vector<std::unique_ptr<SpillFile>> &runs, bool with_memory,
+             const std::function<bool(const char *, uint32_t)> &emit);
+
+  void AddTop(const TupleView &tuple);
+
+  const Schema *schema_;
+  std::vector<SortKey> keys_;
+  BufferPoolManager *bpm_;
+  uint64_t limit_;
+  size_t memory_budget_;
+
+  std::vector<char> data_;
+  std::vector<Entry> entries_;
+  std::vector<std::unique_ptr<SpillFile>> runs_;
+  uint32_t spilled_runs_{0};
+
+  /** top-n: a max heap of the first limit_ tuples, as | prefix(8) | tuple | */
+  bool top_n_;
+  std::vector<std::string> top_;
+};
+
+/**
+ * Applies the order by and the limit of a select to the rows passed to another sink: with sort
+ * keys the rows are collected by an ExternalSort and passed on at End, otherwise they are passed
+ * on right away until the limit is reached.
+ */
+class SortResultSink : public ResultSink {
+public:
+  /**
+   * @param target the sink the rows are passed to, must outlive this sink
+   * @param keys columns of the schema passed to Begin, may be empty
+   */
+  SortResultSink(ResultSink *target, std::vector<SortKey> keys, uint64_t limit, BufferPoolManager *bpm)
+      : target_(target), keys_(std::move(keys)), limit_(limit), bpm_(bpm) {}
+
+  void Begin(const Schema *schema, const std::vector<uint32_t> &columns) override;
+
+  bool Consume(const TupleView &tuple) override;
+
+  bool ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) override;
+
+  void End() override;
+
+  bool HasFailed() const override { return failed_; }
+
+private:
+  ResultSink *target_;
+  std::vector<SortKey> keys_;
+  uint64_t limit_;
+  BufferPoolManager *bpm_;
+  std::unique_ptr<ExternalSort> sort_;
+  uint64_t count_{0};
+  bool failed_{false};
+};
+
+#endif  // MINISQL_EXTERNAL_SORT_H
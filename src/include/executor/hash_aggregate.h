@@ -0,0 +1,162 @@
+#ifndef MINISQL_HASH_AGGREGATE_H
+#define MINISQL_HASH_AGGREGATE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/dberr.h"
+#include "executor/spill_file.h"
+#include "record/data_chunk.h"
+#include "record/field.h"
+#include "record/tuple_view.h"
+
+enum AggregateType {
+  kAggregateCount = 0,
+  kAggregateSum,
+  kAggregateAvg,
+  kAggregateMin,
+  kAggregateMax
+};
+
+/**
+ * One aggregate function of a select, count(*) has column AGGREGATE_ALL_COLUMNS.
+ */
+struct AggregateSpec {
+  static constexpr uint32_t AGGREGATE_ALL_COLUMNS = UINT32_MAX;
+
+  AggregateType type_;
+  uint32_t column_;
+
+  /**
+   * @param name count, sum, avg, min or max
+   * @return false if name is no aggregate function
+   */
+  static bool GetType(const std::string &name, AggregateType &type);
+
+  /**
+   * Count returns an int, sum and avg a float, min and max the type of their column.
+   */
+  TypeId GetResultType(const Schema *schema) const;
+};
+
+/**
+ * Hash aggregation of the tuples of a table: the groups live in an open-addressing table whose
+ * slots hold a hash tag and the index of the group entry, the entries are fixed-size records
+ * | hash(8) | group key | aggregate states | stored back to back, so a probe touches one slot and
+ * one entry. Group keys are encoded with fixed widths, char values zero-padded to the column
+ * length, and compared with memcmp.
+ *
+ * Once the table would exceed the memory budget, no new group is added: a tuple of a new group is
+ * turned into an entry of its own and spilled to one of SPILL_PARTITIONS temporary page files by
+ * the high bits of its hash. The groups in memory and in the partitions are disjoint, Finish
+ * returns the groups in memory, then aggregates every partition on its own, spilling again by the
+ * next bits of the hash if a partition still has too many groups.
+ */
+class HashAggregate {
+public:
+  static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+  static constexpr uint32_t SPILL_PARTITIONS = 16;
+
+  /**
+   * @param schema schema of the consumed tuples
+   * @param bpm buffer pool of the temporary pages
+   * @param memory_budget bytes of the table until partitions are spilled
+   */
+  HashAggregate(const Schema *schema, std::vector<uint32_t> group_columns, std::vector<AggregateSpec> aggregates,
+                BufferPoolManager *bpm, size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+  /**
+   * @return the columns the aggregation reads, each once
+   */
+  std::vector<uint32_t> GetColumns() const;
+
+  /**
+   * Aggregate the tuples of chunk whose bits are set in selection.
+   */
+  void Consume(const DataChunk &chunk, const uint64_t *selection);
+
+  void Consume(const TupleView &tuple);
+
+  /**
+   * A result has the values of the group columns, then the values of the aggregates.
+   * @return false to stop
+   */
+  using Emit = std::function<bool(std::vector<Field> &result)>;
+
+  /**
+   * Hand every group to emit, in no particular order. Without group columns there is exactly one
+   * result, also for no tuples at all. The aggregation is empty afterwards.
+   * @return DB_FAILED if a count does not fit into an int or a spilled partition cannot be read back,
+   *         the results before are emitted
+   */
+  dberr_t Finish(const Emit &emit);
+
+  /**
+   * @return the number of entries written to partitions so far, a spilled tuple is written at
+   * least once
+   */
+  inline uint64_t GetSpilledCount() const { return spilled_count_; }
+
+private:
+  using Partitions = std::vector<std::unique_ptr<SpillFile>>;
+
+  template <typename Tuple>
+  void ConsumeTuple(const Tuple &tuple);
+
+  /**
+   * @return the entry of the group of the key in key_, a new one if the group is unknown, nullptr
+   * if the group is unknown and the table is full
+   */
+  char *FindOrInsert(uint64_t hash);
+
+  void Grow();
+
+  void Reset();
+
+  void InitStates(char *entry);
+
+  template <typename Tuple>
+  void Update(char *entry, const Tuple &tuple);
+
+  void Merge(char *entry, const char *other);
+
+  /**
+   * Spill an entry to the partition of its hash at the current level.
+   */
+  void Spill(const char *entry);
+
+  bool EmitTable(const Emit &emit);
+
+  bool EmitEntry(const char *entry, const Emit &emit);
+
+  /**
+   * Aggregate the spilled entries of every partition, spilling again one level deeper.
+   */
+  bool Drain(Partitions &partitions, uint32_t level, const Emit &emit);
+
+  const Schema *schema_;
+  std::vector<uint32_t> group_columns_;
+  std::vector<AggregateSpec> aggregates_;
+  BufferPoolManager *bpm_;
+  size_t memory_budget_;
+
+  uint32_t key_size_{0};
+  std::vector<uint32_t> key_offsets_;    /** by group column */
+  std::vector<uint32_t> state_offsets_;  /** by aggregate */
+  uint32_t entry_size_{0};
+
+  std::vector<uint64_t> slots_;  /** | hash tag(32) | entry index + 1(32) |, 0 if free */
+  std::vector<char> entries_;
+  uint32_t group_count_{0};
+  std::vector<char> key_;    /** hash and key of the current tuple, laid out as an entry */
+  std::vector<char> single_;  /** an entry of a single spilled tuple */
+
+  Partitions partitions_;
+  uint32_t level_{0};  /** spill level of the groups in the table */
+  uint64_t spilled_count_{0};
+  bool failed_{false};  /** the results could not all be emitted, set until Finish returns */
+};
+
+#endif  // MINISQL_HASH_AGGREGATE_H
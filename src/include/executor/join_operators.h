@@ -0,0 +1,216 @@
+#ifndef MINISQL_JOIN_OPERATORS_H
+#define MINISQL_JOIN_OPERATORS_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalog/indexes.h"
+#include "executor/chunk_filter.h"
+#include "executor/spill_file.h"
+#include "storage/table_heap.h"
+
+/**
+ * A table of a join: its heap, the filter of the where conditions on this table alone and the
+ * columns the join keeps of its tuples, the other ones are null in the joined tuples.
+ */
+struct JoinTable {
+  TableHeap *table_heap_;
+  const Schema *schema_;
+  ChunkFilter *filter_;  /** never null, may be empty */
+  std::vector<uint32_t> columns_;
+};
+
+/**
+ * A joined tuple is passed around as a record: the tuples of the tables joined so far in the
+ * compact row format, in join order, each one as | size(4) | tuple |.
+ */
+class JoinRecord {
+public:
+  static void AppendTuple(std::string &record, const char *tuple, uint32_t size);
+
+  /**
+   * Split record into views of its tuples, the view of table i uses schemas[i].
+   */
+  static void Parse(const char *record, uint32_t size, const std::vector<const Schema *> &schemas,
+                    std::vector<TupleView> &views);
+};
+
+/**
+ * @return false if the consumer wants no more records
+ */
+using JoinConsumer = std::function<bool(const char *record, uint32_t size)>;
+
+/**
+ * Produces the records of a join tree, the operators push their records into the consumer.
+ */
+class JoinSource {
+public:
+  virtual ~JoinSource() = default;
+
+  /**
+   * @return false if the consumer stopped the join
+   */
+  virtual bool Run(const JoinConsumer &consume) = 0;
+
+  /**
+   * @return true if the last run stopped on an error, which is reported on std::cerr, not by the consumer
+   */
+  virtual bool HasFailed() const { return false; }
+
+  /**
+   * @return the schemas of the tables of the records, in join order
+   */
+  inline const std::vector<const Schema *> &GetSchemas() const { return schemas_; }
+
+protected:
+  std::vector<const Schema *> schemas_;
+};
+
+/**
+ * The filtered tuples of a table, scanned a chunk at a time.
+ */
+class TableScanSource : public JoinSource {
+public:
+  explicit TableScanSource(JoinTable table);
+
+  bool Run(const JoinConsumer &consume) override;
+
+private:
+  JoinTable table_;
+};
+
+/**
+ * The join column of the left side: a table of its records and a column of that table.
+ */
+struct JoinKey {
+  uint32_t table_;
+  uint32_t column_;
+};
+
+/**
+ * Equi join of the left records with the filtered tuples of the right table. The right table is
+ * the build side: its tuples go into a chained hash table on the right column, then every left
+ * record probes it.
+ *
+ * If the build side exceeds the memory budget, the join is partitioned: the build tuples and then
+ * the left records are written to PARTITIONS temporary page files by the high bits of the hash of
+ * their key, and each pair of partitions is joined on its own. A partition that is still too large
+ * is joined in memory anyway.
+ *
+ * Null keys match nothing. Without a right column every pair of tuples matches (a cross join).
+ */
+class HashJoin : public JoinSource {
+public:
+  static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+  static constexpr uint32_t PARTITIONS = 16;
+  static constexpr uint32_t NO_KEY = UINT32_MAX;
+
+  /**
+   * @param right_column the join column of the right table, of the type of the left key, or NO_KEY
+   * @param bpm buffer pool of the temporary pages
+   */
+  HashJoin(std::unique_ptr<JoinSource> left, JoinKey left_key, JoinTable right, uint32_t right_column,
+           BufferPoolManager *bpm, size_t memory_budget = DEFAULT_MEMORY_BUDGET);
+
+  bool Run(const JoinConsumer &consume) override;
+
+  /**
+   * A run fails if the buffer pool has no page left for the partitions.
+   */
+  bool HasFailed() const override { return failed_ || left_->HasFailed(); }
+
+  /**
+   * @return true if the last run partitioned its inputs
+   */
+  inline bool IsPartitioned() const { return partitioned_; }
+
+private:
+  /**
+   * Build tuples by hash bucket, an entry is | next(4) | hash(8) | size(4) | tuple |.
+   */
+  void Insert(uint64_t hash, const char *tuple, uint32_t size);
+
+  void ClearTable();
+
+  /**
+   * Move the build tuples in memory to the partitions, which take all the following ones.
+   * @return false if the buffer pool has no page left
+   */
+  bool StartPartitioning();
+
+  /**
+   * Report that a partition has no page left.
+   * @return false, to stop the run
+   */
+  bool Fail();
+
+  bool Probe(const char *record, uint32_t size, const JoinConsumer &consume);
+
+  uint64_t HashLeft(const TupleView &tuple, bool &is_null) const;
+
+  uint64_t HashRight(const TupleView &tuple, bool &is_null) const;
+
+  std::unique_ptr<JoinSource> left_;
+  JoinKey left_key_;
+  JoinTable right_;
+  uint32_t right_column_;
+  BufferPoolManager *bpm_;
+  size_t memory_budget_;
+
+  std::vector<uint32_t> buckets_;  /** offset + 1 of the first entry of a bucket, 0 if empty */
+  std::vector<char> entries_;
+  uint32_t entry_count_{0};
+
+  bool partitioned_{false};
+  bool failed_{false};
+  std::vector<std::unique_ptr<SpillFile>> build_partitions_;
+  std::vector<std::unique_ptr<SpillFile>> probe_partitions_;
+
+  std::vector<TupleView> views_;
+  std::string output_;
+};
+
+/**
+ * Equi join probing an index of the right table with the key of every left record. The matching
+ * tuples are read from the heap and filtered, so it is cheap if the left side has few records.
+ */
+class IndexNestedLoopJoin : public JoinSource {
+public:
+  /**
+   * @param right_index a single column index on the join column of the right table
+   */
+  IndexNestedLoopJoin(std::unique_ptr<JoinSource> left, JoinKey left_key, JoinTable right, IndexInfo *right_index);
+
+  bool Run(const JoinConsumer &consume) override;
+
+  bool HasFailed() const override { return left_->HasFailed(); }
+
+private:
+  std::unique_ptr<JoinSource> left_;
+  JoinKey left_key_;
+  JoinTable right_;
+  IndexInfo *right_index_;
+};
+
+/**
+ * Equi join of two tables which both have a single column index on their join column: the
+ * indexes give both inputs sorted by the key, they are merged without building anything. The
+ * indexes are unique, so a key matches at most one tuple on each side. The records come in key
+ * order.
+ */
+class MergeJoin : public JoinSource {
+public:
+  MergeJoin(JoinTable left, IndexInfo *left_index, JoinTable right, IndexInfo *right_index);
+
+  bool Run(const JoinConsumer &consume) override;
+
+private:
+  JoinTable left_;
+  IndexInfo *left_index_;
+  JoinTable right_;
+  IndexInfo *right_index_;
+};
+
+#endif  // MINISQL_JOIN_OPERATORS_H
@@ -0,0 +1,82 @@
+#ifndef MINISQL_PARALLEL_SCAN_H
+#define MINISQL_PARALLEL_SCAN_H
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "executor/chunk_filter.h"
+#include "executor/result_sink.h"
+#include "storage/table_heap.h"
+
+/**
+ * A filtered scan of a table run by several worker threads.
+ *
+ * The page directory of the table is cut into ranges of PARALLEL_SCAN_RANGE_PAGES pages. Every
+ * worker takes the next range, filters its chunks with its own copy of the filter and keeps what
+ * passed in the buffer of the range: the rids, and the selected tuples in the compact row format
+ * if they are printed. The gather runs in the calling thread and hands the buffers to the consumer
+ * in range order, so the results come in table order, as from a sequential scan. Workers run at
+ * most PARALLEL_SCAN_WINDOW ranges ahead of the gather, which bounds the buffered results.
+ *
+ * The table must not be modified during the scan.
+ */
+class ParallelScan {
+public:
+  static constexpr uint32_t PARALLEL_SCAN_RANGE_PAGES = 16;
+  static constexpr uint32_t PARALLEL_SCAN_WINDOW = 64;
+
+  /**
+   * @param filter the where condition, its constants must outlive the scan
+   * @param workers number of worker threads, at least 1
+   */
+  ParallelScan(const TableHeap *table_heap, const ChunkFilter &filter, uint32_t workers);
+
+  /**
+   * @return true if the table has enough pages to give every worker a range
+   */
+  bool IsWorthwhile() const;
+
+  /**
+   * Send the selected tuples to sink, which is already begun with the output columns.
+   */
+  void Run(const std::vector<uint32_t> &output, ResultSink &sink);
+
+  /**
+   * Append the rids of the selected tuples to result.
+   */
+  void Run(std::vector<RowId> &result);
+
+private:
+  /** results of one range of pages */
+  struct RangeResult {
+    bool done_{false};
+    std::vector<RowId> rids_;
+    std::vector<char> tuples_;       /** the serialized tuples back to back, only if materialized */
+    std::vector<uint32_t> offsets_;  /** where every tuple starts in tuples_ */
+  };
+
+  /**
+   * Start the workers, then call consume(result) for every range in order until it returns false.
+   */
+  template <typename Consume>
+  void Gather(const std::vector<uint32_t> *output, Consume consume);
+
+  void Work(const std::vector<uint32_t> *output);
+
+  const TableHeap *table_heap_;
+  const ChunkFilter &filter_;
+  uint32_t workers_;
+  uint32_t page_count_;
+  uint32_t range_count_;
+
+  std::mutex latch_;  /** protects the members below */
+  std::condition_variable range_done_;
+  std::condition_variable range_consumed_;
+  uint32_t next_range_{0};      /** the next range a worker takes */
+  uint32_t consumed_ranges_{0};  /** ranges the gather is done with */
+  bool stopped_{false};          /** the consumer wants no more results */
+  std::vector<RangeResult> results_;  /** ring of PARALLEL_SCAN_WINDOW buffers by range */
+};
+
+#endif  // MINISQL_PARALLEL_SCAN_H
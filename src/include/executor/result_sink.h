@@ -0,0 +1,186 @@
+#ifndef MINISQL_RESULT_SINK_H
+#define MINISQL_RESULT_SINK_H
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "record/data_chunk.h"
+#include "record/row.h"
+#include "record/schema.h"
+#include "record/tuple_view.h"
+
+enum ResultFormat {
+  kResultText = 0,  /** tab separated text, the shell output */
+  kResultCsv,       /** csv with a header line */
+  kResultBinary     /** column blocks, see BinaryResultSink */
+};
+
+/**
+ * ResultSink receives the result rows of a query while the executor produces them.
+ * Begin is called once before the first row, End once after the last one.
+ */
+class ResultSink {
+public:
+  virtual ~ResultSink() = default;
+
+  /**
+   * @param schema schema of the rows passed to Consume
+   * @param columns indexes of the output columns in schema
+   */
+  virtual void Begin(const Schema *schema, const std::vector<uint32_t> &columns) {
+    schema_ = schema;
+    columns_ = columns;
+  }
+
+  /**
+   * Scans hand in views of the tuples in their pages, the view is only valid during the call.
+   * @return false if the sink wants no more rows, the producer should stop
+   */
+  virtual bool Consume(const TupleView &tuple) = 0;
+
+  /**
+   * Consume a materialized row, it is serialized into a scratch buffer and consumed as a view.
+   */
+  bool ConsumeRow(const Row &row);
+
+  /**
+   * Consume the tuples of a chunk whose bits are set in selection, in slot order. By default every
+   * tuple is serialized and consumed as a view, the writers format the chunk directly.
+   * @return false if the sink wants no more rows
+   */
+  virtual bool ConsumeChunk(const DataChunk &chunk, const uint64_t *selection);
+
+  virtual void End() {}
+
+  /**
+   * @return true if the rows could not all be passed on at End, the error is reported on std::cerr
+   */
+  virtual bool HasFailed() const { return false; }
+
+  /**
+   * Create the writer of a format, writing to out.
+   */
+  static std::unique_ptr<ResultSink> Create(ResultFormat format, std::ostream &out);
+
+protected:
+  const Schema *schema_{nullptr};
+  std::vector<uint32_t> columns_;
+
+private:
+  std::vector<char> scratch_;
+};
+
+/**
+ * Base of the writers, collects the output in a buffer and writes it to the stream in large chunks
+ * instead of flushing every row.
+ */
+class BufferedResultSink : public ResultSink {
+public:
+  explicit BufferedResultSink(std::ostream &out) : out_(out) {}
+
+  void End() override { Flush(); }
+
+protected:
+  inline void MaybeFlush() {
+    if (buffer_.size() >= FLUSH_SIZE) Flush();
+  }
+
+  void Flush();
+
+  std::ostream &out_;
+  std::string buffer_;
+
+private:
+  static constexpr size_t FLUSH_SIZE = 64 * 1024;
+};
+
+/**
+ * Every value followed by a tab, one row per line, null is printed as null.
+ */
+class TextResultSink : public BufferedResultSink {
+public:
+  explicit TextResultSink(std::ostream &out) : BufferedResultSink(out) {}
+
+  bool Consume(const TupleView &tuple) override;
+
+  bool ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) override;
+
+private:
+  /**
+   * Tuple is a TupleView or a ChunkTuple
+   */
+  template <typename Tuple>
+  void AppendTuple(const Tuple &tuple);
+};
+
+/**
+ * A header line with the column names, then one line per row. Char values are quoted,
+ * null values are empty.
+ */
+class CsvResultSink : public BufferedResultSink {
+public:
+  explicit CsvResultSink(std::ostream &out) : BufferedResultSink(out) {}
+
+  void Begin(const Schema *schema, const std::vector<uint32_t> &columns) override;
+
+  bool Consume(const TupleView &tuple) override;
+
+  bool ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) override;
+
+private:
+  template <typename Tuple>
+  void AppendTuple(const Tuple &tuple);
+};
+
+/**
+ * Binary result, all numbers in host byte order:
+ * | column_count(4) | column_count * (type(1) | name_len(4) | name) | block * n | 0(4) |
+ * Rows are buffered and written by blocks of up to BLOCK_ROWS rows, column after column:
+ * | row_count(4) | column_count * (null_bitmap((row_count + 7) / 8) | values of the non-null rows) |
+ * Int and float values take 4 bytes, char values are written as | len(4) | data |.
+ */
+class BinaryResultSink : public BufferedResultSink {
+public:
+  explicit BinaryResultSink(std::ostream &out) : BufferedResultSink(out) {}
+
+  void Begin(const Schema *schema, const std::vector<uint32_t> &columns) override;
+
+  bool Consume(const TupleView &tuple) override;
+
+  bool ConsumeChunk(const DataChunk &chunk, const uint64_t *selection) override;
+
+  void End() override;
+
+  static constexpr uint32_t BLOCK_ROWS = 1024;
+
+private:
+  template <typename Tuple>
+  void AppendTuple(const Tuple &tuple);
+
+  void WriteBlock();
+
+  uint32_t block_rows_{0};
+  std::vector<std::string> column_nulls_;
+  std::vector<std::string> column_values_;
+};
+
+/**
+ * Hands every row to a callback together with the output columns, used when minisql is embedded.
+ * The view is only valid during the call.
+ */
+class CallbackResultSink : public ResultSink {
+public:
+  using Callback = std::function<bool(const TupleView &tuple, const std::vector<uint32_t> &columns)>;
+
+  explicit CallbackResultSink(Callback callback) : callback_(std::move(callback)) {}
+
+  bool Consume(const TupleView &tuple) override;
+
+private:
+  Callback callback_;
+};
+
+#endif  // MINISQL_RESULT_SINK_H
@@ -0,0 +1,81 @@
+#ifndef MINISQL_ROWID_BITMAP_H
+#define MINISQL_ROWID_BITMAP_H
+
+#include <cstdint>
+#include <vector>
+
+#include "common/rowid.h"
+
+/**
+ * A set of row ids in the style of a roaring bitmap, built from the row ids an index lookup found.
+ *
+ * The row ids of one page share a container: a sorted array of their slot numbers while the page
+ * has few of them, a bitset of the slots once that is smaller. Ands and ors merge two bitmaps page
+ * by page, and the pages come out in ascending order, so every heap page of the set is fetched once.
+ * A slot number of a page fits into 16 bits.
+ */
+class RowIdBitmap {
+public:
+  RowIdBitmap() = default;
+
+  /**
+   * @param row_ids in any order, duplicates are dropped. They are sorted by the call.
+   */
+  static RowIdBitmap FromRowIds(std::vector<RowId> &row_ids);
+
+  /**
+   * Keep the row ids which are in other as well.
+   */
+  void And(const RowIdBitmap &other);
+
+  /**
+   * Add the row ids of other.
+   */
+  void Or(const RowIdBitmap &other);
+
+  inline bool IsEmpty() const { return page_ids_.empty(); }
+
+  uint64_t GetCardinality() const;
+
+  /**
+   * @return the pages holding the row ids, ascending
+   */
+  inline const std::vector<page_id_t> &GetPageIds() const { return page_ids_; }
+
+  /**
+   * Set mask to the bits of the slots [first, first + count) of the page GetPageIds()[index], bit i
+   * for slot first + i. first must be a multiple of 64.
+   */
+  void GetSlotBits(uint32_t index, uint32_t first, uint32_t count, uint64_t *mask) const;
+
+  /**
+   * Append the row ids to row_ids, in page order.
+   */
+  void ToRowIds(std::vector<RowId> &row_ids) const;
+
+private:
+  struct Container {
+    std::vector<uint16_t> slots_;  /** sorted, while bits_ is empty */
+    std::vector<uint64_t> bits_;   /** the slots as a bitset, without trailing zero words */
+
+    inline bool IsBitset() const { return !bits_.empty(); }
+
+    uint32_t GetCardinality() const;
+
+    /**
+     * Turn into the smaller of the two forms.
+     */
+    void Optimize();
+
+    void ToBitset();
+  };
+
+  static Container And(const Container &a, const Container &b);
+
+  static Container Or(const Container &a, const Container &b);
+
+  std::vector<page_id_t> page_ids_;  /** ascending, a page without row ids has no container */
+  std::vector<Container> containers_;
+};
+
+#endif  // MINISQL_ROWID_BITMAP_H
@@ -0,0 +1,87 @@
+#ifndef MINISQL_SPILL_FILE_H
+#define MINISQL_SPILL_FILE_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * Records an operator moves out of memory, kept on temporary pages of the buffer pool. The pages
+ * are written once, read back in append order and deleted together with the file. Each page holds
+ * | used_bytes(4) | record * n | with record = | size(4) | data |, a record never spans pages.
+ *
+ * Only the page being written and the page being read are pinned, the buffer pool evicts the other
+ * ones to disk like any dirty page.
+ */
+class SpillFile {
+public:
+  static constexpr uint32_t MAX_RECORD_SIZE = PAGE_SIZE - 2 * sizeof(uint32_t);
+
+  explicit SpillFile(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  ~SpillFile() { Free(); }
+
+  SpillFile(const SpillFile &) = delete;
+
+  SpillFile &operator=(const SpillFile &) = delete;
+
+  /**
+   * @param size at most MAX_RECORD_SIZE
+   * @return false if the buffer pool has no page left, the record is not written
+   */
+  bool Append(const char *data, uint32_t size);
+
+  inline uint64_t GetRecordCount() const { return record_count_; }
+
+  inline bool IsEmpty() const { return record_count_ == 0; }
+
+  /**
+   * Delete all the pages, the file is empty afterwards.
+   */
+  void Free();
+
+  /**
+   * Reads the records of a file in append order, the file must not be appended to meanwhile.
+   */
+  class Reader {
+  public:
+    explicit Reader(SpillFile *file);
+
+    ~Reader();
+
+    Reader(const Reader &) = delete;
+
+    Reader &operator=(const Reader &) = delete;
+
+    /**
+     * @param data set to the next record, valid until the next call
+     * @return false at the end of the file, or if the buffer pool has no frame for the next page
+     */
+    bool Next(const char **data, uint32_t *size);
+
+    /**
+     * @return true if Next stopped before the end of the file, because the buffer pool had no frame left
+     */
+    inline bool HasFailed() const { return failed_; }
+
+  private:
+    SpillFile *file_;
+    uint32_t page_index_{0};
+    Page *page_{nullptr};
+    uint32_t offset_{0};
+    bool failed_{false};
+  };
+
+private:
+  /**
+   * Unpin the page being written, done before the file is read.
+   */
+  void FinishPage();
+
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  Page *write_page_{nullptr};  /** the last page, pinned while records are appended */
+  uint64_t record_count_{0};
+};
+
+#endif  // MINISQL_SPILL_FILE_H
@@ -0,0 +1,83 @@
+#ifndef MINISQL_STATEMENT_CACHE_H
+#define MINISQL_STATEMENT_CACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/instance.h"
+
+extern "C" {
+#include "parser/syntax_tree.h"
+};
+
+/**
+ * Catalog objects an executor resolved for the table of a statement.
+ * A plan stays valid while its database is open and the catalog version is unchanged. Catalog
+ * versions are unique in the process, so a database recreated at the same address never matches.
+ */
+struct TablePlan {
+  DBStorageEngine *database_{nullptr};
+  uint64_t catalog_version_{0};
+  TableInfo *table_{nullptr};
+  std::vector<uint32_t> column_map_;  /** select: indexes of the output columns */
+  std::vector<IndexInfo *> indexes_;  /** every index of the table */
+  IndexInfo *pk_index_{nullptr};
+  std::vector<IndexInfo *> unique_indexes_;  /** the pk index first, then the indexes of unique columns */
+
+  inline bool IsValid(DBStorageEngine *database) const {
+    return table_ != nullptr && database_ == database && catalog_version_ == database->catalog_mgr_->GetVersion();
+  }
+};
+
+/**
+ * A cached statement: a private copy of the syntax tree of one statement shape, the literal nodes
+ * to re-bind on every execution and the plan filled in by its first execution.
+ */
+struct CachedStatement {
+  pSyntaxNode tree_{nullptr};
+  std::vector<pSyntaxNode> params_;  /** literal nodes of tree_, in sql text order */
+  TablePlan plan_;
+
+  /**
+   * Overwrite the literal values of the cached tree with the literals of the current sql text.
+   */
+  void Bind(const std::vector<std::string> &literals);
+};
+
+/**
+ * StatementCache maps the shape of an insert/select statement (its sql text with every number or
+ * string literal replaced by a placeholder) to a CachedStatement, so repeated statements that only
+ * differ in their literals skip flex/bison and the catalog lookups.
+ */
+class StatementCache {
+public:
+  explicit StatementCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+  ~StatementCache() { Clear(); }
+
+  /**
+   * Split sql into its shape and its literal values, tokenizing the same way as the lexer does.
+   * @return false if the sql contains something the lexer would reject
+   */
+  static bool Normalize(const char *sql, std::string &shape, std::vector<std::string> &literals);
+
+  CachedStatement *Lookup(const std::string &shape);
+
+  /**
+   * Cache a copy of a freshly parsed statement.
+   * @return the cached statement, or nullptr if this kind of statement is not cached
+   */
+  CachedStatement *Insert(const std::string &shape, const std::vector<std::string> &literals, pSyntaxNode ast);
+
+  void Clear();
+
+  inline size_t Size() const { return statements_.size(); }
+
+private:
+  static constexpr size_t DEFAULT_CAPACITY = 1024;
+  size_t capacity_;
+  std::unordered_map<std::string, CachedStatement> statements_;
+};
+
+#endif  // MINISQL_STATEMENT_CACHE_H
@@ -57,9 +57,14 @@ public:
   bool Check();
 
   // destroy the b plus tree
-  void Destroy_subtree(page_id_t root);
   void Destroy();
 
+  /**
+   * Free every page of the tree at once, the tree is empty afterwards. Only the internal pages are
+   * read, the leaves are known from their parents.
+   */
+  void Clear();
+
   void PrintTree(std::ofstream &out) {
     if (IsEmpty()) {
       return;
@@ -76,6 +81,11 @@ public:
 private:
   void StartNewTree(const KeyType &key, const ValueType &value);
 
+  /**
+   * Add page_id and the pages below it to pages, height is 1 for a leaf.
+   */
+  void CollectPages(page_id_t page_id, int height, std::vector<page_id_t> &pages);
+
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
@@ -19,6 +19,8 @@ public:
 
   dberr_t Destroy() override;
 
+  dberr_t Clear() override;
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
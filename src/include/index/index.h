@@ -22,6 +22,11 @@ public:
 
   virtual dberr_t Destroy() = 0;
 
+  /**
+   * Remove all the entries at once.
+   */
+  virtual dberr_t Clear() = 0;
+
 protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
@@ -0,0 +1,165 @@
+#ifndef MINISQL_PAX_PAGE_H
+#define MINISQL_PAX_PAGE_H
+/**
+ * PAX page format, the tuples of the page are split by column into minipages:
+ *  --------------------------------------------------------------------------------
+ *  | HEADER | live bitmap | deleted bitmap | minipage-1 | ... | minipage-N |
+ *  --------------------------------------------------------------------------------
+ *  Header format (size in bytes), the first 16 bytes are the same as in TablePage so the page chain
+ *  of a table is walked the same way for both layouts:
+ *  -------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| SlotCount (4)| LiveCount (4) |
+ *  -------------------------------------------------------------------------------------------
+ *  Every minipage holds the null bitmap of its column followed by one fixed size value per slot:
+ *  int/float take 4 bytes, char(n) takes | length(2) | n bytes |. A slot holds a tuple if its live
+ *  bit is set, MarkDelete sets the deleted bit, ApplyDelete frees the slot.
+ *  The positions of the bitmaps and minipages only depend on the schema, see PaxLayout.
+ **/
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "page/page.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Positions of the parts of a PAX page of a schema, computed once per table.
+ */
+struct PaxLayout {
+  explicit PaxLayout(const Schema *schema);
+
+  uint32_t capacity_{0};              /** slots per page */
+  uint32_t live_offset_{0};           /** live bitmap */
+  uint32_t deleted_offset_{0};        /** deleted bitmap */
+  std::vector<TypeId> types_;
+  std::vector<uint32_t> widths_;      /** bytes per value, with the length of chars */
+  std::vector<uint32_t> null_offsets_;
+  std::vector<uint32_t> value_offsets_;
+};
+
+class PaxPage : public Page {
+public:
+  void Init(page_id_t page_id, page_id_t prev_id);
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /**
+   * Insert the tuple into a free slot, the rid of the slot is wrapped in row.
+   * @return false if the page is full or a char value is longer than its column
+   */
+  bool InsertTuple(Row &row, const PaxLayout &layout);
+
+  bool MarkDelete(const RowId &rid, const PaxLayout &layout);
+
+  void ApplyDelete(const RowId &rid, const PaxLayout &layout);
+
+  void RollbackDelete(const RowId &rid, const PaxLayout &layout);
+
+  /**
+   * Overwrite the tuple in place, values have a fixed size so the update always fits.
+   * @return false if there is no such tuple or a char value is longer than its column
+   */
+  bool UpdateTuple(const Row &new_row, const RowId &rid, const PaxLayout &layout);
+
+  /**
+   * Read the tuple of rid into row.
+   */
+  bool GetTuple(Row *row, Schema *schema, const PaxLayout &layout);
+
+  /**
+   * Free the slots of the tuples marked deleted, and move the tuples of the last slots into the free
+   * slots, so the tuples take the slots [0, n).
+   * @param moved (old, new) slot numbers of the tuples which changed their slot are appended
+   * @return true if the page changed
+   */
+  bool CompactSlots(const PaxLayout &layout, std::vector<std::pair<uint32_t, uint32_t>> &moved);
+
+  /**
+   * Write the tuple in slot slot_num into buf in the compact row format.
+   * @param columns only these columns are read from their minipages, the other ones are written as null.
+   *        All the columns if nullptr.
+   * @return the size of the row, buf needs at most Row::SlotOffset(n, n) + the char lengths bytes
+   */
+  uint32_t ReadTuple(uint32_t slot_num, const PaxLayout &layout, const std::vector<uint32_t> *columns, char *buf);
+
+  /**
+   * @return true if slot slot_num holds a tuple which is not deleted
+   */
+  inline bool IsVisible(uint32_t slot_num, const PaxLayout &layout) {
+    return slot_num < GetSlotCount() && GetBit(layout.live_offset_, slot_num) &&
+           !GetBit(layout.deleted_offset_, slot_num);
+  }
+
+  /**
+   * @return the number of slots which may hold a tuple, slots behind it are all free
+   */
+  uint32_t GetSlotCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_SLOT_COUNT); }
+
+  uint32_t GetLiveCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_LIVE_COUNT); }
+
+  /**
+   * @return the minipage values of column, widths_[column] bytes per slot. Int and float values are
+   *         aligned arrays, the value of a slot without a tuple is undefined
+   */
+  const char *GetValues(uint32_t column, const PaxLayout &layout) {
+    return GetData() + layout.value_offsets_[column];
+  }
+
+  /**
+   * Set bit i of valid if slot first + i holds a visible tuple whose value of column is not null,
+   * clear it otherwise, for count slots behind first. first must be a multiple of 64.
+   */
+  void GetValidSlots(uint32_t column, const PaxLayout &layout, uint32_t first, uint32_t count, uint64_t *valid);
+
+  /**
+   * Like GetValidSlots, for slots which hold a visible tuple.
+   */
+  void GetVisibleSlots(const PaxLayout &layout, uint32_t first, uint32_t count, uint64_t *visible);
+
+  static constexpr size_t SIZE_PAX_PAGE_HEADER = 24;
+
+private:
+  void SetSlotCount(uint32_t count) { memcpy(GetData() + OFFSET_SLOT_COUNT, &count, sizeof(uint32_t)); }
+
+  void SetLiveCount(uint32_t count) { memcpy(GetData() + OFFSET_LIVE_COUNT, &count, sizeof(uint32_t)); }
+
+  inline bool GetBit(uint32_t offset, uint32_t idx) { return (GetData()[offset + idx / 8] & (1 << (idx % 8))) != 0; }
+
+  inline void SetBit(uint32_t offset, uint32_t idx, bool value) {
+    char &byte = GetData()[offset + idx / 8];
+    byte = static_cast<char>(value ? (byte | (1 << (idx % 8))) : (byte & ~(1 << (idx % 8))));
+  }
+
+  /**
+   * @return false if a char value does not fit into its column
+   */
+  bool WriteSlot(uint32_t slot_num, const Row &row, const PaxLayout &layout);
+
+  /**
+   * bits = live & ~deleted & ~nulls for count slots behind first, nulls only if not nullptr.
+   */
+  void ReadSlotBits(const PaxLayout &layout, const char *nulls, uint32_t first, uint32_t count, uint64_t *bits);
+
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_SLOT_COUNT = 16;
+  static constexpr size_t OFFSET_LIVE_COUNT = 20;
+};
+
+#endif  // MINISQL_PAX_PAGE_H
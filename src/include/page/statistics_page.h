@@ -0,0 +1,39 @@
+#ifndef MINISQL_STATISTICS_PAGE_H
+#define MINISQL_STATISTICS_PAGE_H
+
+#include <cstring>
+
+#include "common/config.h"
+
+/**
+ * A page of the stored statistics of a table, see TableStatistics::SerializeTo. Statistics larger
+ * than one page continue in the next page.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------
+ * | NextPageId (4) | DataSize (4) | Data ... |
+ *  ------------------------------------------------
+ */
+class StatisticsPage {
+public:
+  static constexpr uint32_t MAX_DATA_SIZE = PAGE_SIZE - 8;
+
+  void Init(page_id_t next_page_id, const char *data, uint32_t size) {
+    next_page_id_ = next_page_id;
+    size_ = size;
+    memcpy(data_, data, size);
+  }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline uint32_t GetDataSize() const { return size_; }
+
+  inline const char *GetData() const { return data_; }
+
+private:
+  page_id_t next_page_id_;
+  uint32_t size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_STATISTICS_PAGE_H
@@ -0,0 +1,44 @@
+#ifndef MINISQL_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_TABLE_DIRECTORY_PAGE_H
+
+#include "common/config.h"
+
+/**
+ * A page of the page directory of a table: the ids of the table pages in chain order, so page K of
+ * the table is found without walking the chain. A directory holding more pages than fit into one
+ * page continues in the next directory page.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------
+ * | PageCount (4) | NextDirectoryPageId (4) | PageId_1 (4) | PageId_2 (4) | ... |
+ *  ----------------------------------------------------------------------------------
+ */
+class TableDirectoryPage {
+public:
+  static constexpr uint32_t MAX_PAGE_COUNT = (PAGE_SIZE - 8) / sizeof(page_id_t);
+
+  void Init() {
+    count_ = 0;
+    next_page_id_ = INVALID_PAGE_ID;
+  }
+
+  /**
+   * @return false if the page is full
+   */
+  bool Append(page_id_t page_id);
+
+  inline uint32_t GetPageCount() const { return count_; }
+
+  inline page_id_t GetPageId(uint32_t index) const { return page_ids_[index]; }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+private:
+  uint32_t count_;
+  page_id_t next_page_id_;
+  page_id_t page_ids_[0];
+};
+
+#endif  // MINISQL_TABLE_DIRECTORY_PAGE_H
@@ -18,10 +18,13 @@
  **/
 
 #include <cstring>
+#include <utility>
+#include <vector>
 #include "common/macros.h"
 #include "common/rowid.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/tuple_view.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
@@ -57,19 +60,68 @@ public:
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Free the space of the tuples marked deleted, and fill the empty slots with the tuples of the last
+   * slots, so the tuples take the slots [0, n). Only the slots move, the tuple data stays in place.
+   * @param moved (old, new) slot numbers of the tuples which changed their slot are appended
+   * @return true if the page changed
+   */
+  bool CompactSlots(std::vector<std::pair<uint32_t, uint32_t>> &moved, Transaction *txn, LogManager *log_manager);
+
+  /**
+   * @return true if the visible tuples fit into the free space of target, sized as they are inserted
+   *         again in the current row format
+   */
+  bool FitsInto(TablePage *target, Schema *schema);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * Point view at the tuple in slot slot_num without copying it, the view is valid while the page stays pinned.
+   * A tuple still stored in the legacy row format is converted into scratch, the view then points there.
+   * @return false if the slot is out of range, empty or deleted
+   */
+  bool GetTupleView(uint32_t slot_num, const Schema *schema, TupleView *view, std::vector<char> *scratch) {
+    if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+      return false;
+    }
+    const char *data = GetData() + GetTupleOffsetAtSlot(slot_num);
+    if (Row::IsLegacyFormat(data)) {
+      ConvertLegacyTuple(data, schema, scratch);
+      data = scratch->data();
+    }
+    view->Reset(data, schema, RowId(GetTablePageId(), slot_num));
+    return true;
+  }
+
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  /**
+   * @return true if slot slot_num holds a tuple which is not deleted
+   */
+  bool HasTuple(uint32_t slot_num) { return slot_num < GetTupleCount() && !IsDeleted(GetTupleSize(slot_num)); }
+
+  /**
+   * @return true if slot slot_num holds a tuple which is not deleted and is stored in the legacy row format
+   */
+  bool IsLegacyTuple(uint32_t slot_num) {
+    return HasTuple(slot_num) && Row::IsLegacyFormat(GetData() + GetTupleOffsetAtSlot(slot_num));
+  }
+
 private:
+  /**
+   * Write the legacy row at data into buf in the compact row format.
+   */
+  static void ConvertLegacyTuple(const char *data, const Schema *schema, std::vector<char> *buf);
+
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
     memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
   }
 
-  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
-
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
   uint32_t GetFreeSpaceRemaining() {
@@ -80,7 +132,7 @@ private:
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
   }
 
-  void x(uint32_t slot_num, uint32_t offset) {
+  void SetTupleOffsetAtSlot(uint32_t slot_num, uint32_t offset) {
     memcpy(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num, &offset, sizeof(uint32_t));
   }
 
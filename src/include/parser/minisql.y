@@ -1,5 +1,7 @@
 %{
   #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -12,7 +14,8 @@
 }
 
 %token <syntax_node> CREATE DROP SELECT INSERT DELETE UPDATE
-%token <syntax_node> TRXBEGIN TRXCOMMIT TRXROLLBACK QUIT EXECFILE SHOW USE USING
+%token <syntax_node> TRXBEGIN TRXCOMMIT TRXROLLBACK QUIT EXECFILE SHOW USE USING LOAD ANALYZE STATS TRUNCATE VACUUM
+%token <syntax_node> GROUP BY ORDER ASC DESC LIMIT
 %token <syntax_node> DATABASE DATABASES TABLE TABLES INDEX INDEXES
 %token <syntax_node> ON FROM WHERE INTO SET VALUES PRIMARY KEY UNIQUE
 %token <syntax_node> CHAR INT FLOAT AND OR NOT IS FLAGNULL
@@ -20,14 +23,16 @@
 
 %type <syntax_node> start sql
 %type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
-%type <syntax_node> sql_show_tables sql_create_table sql_drop_table
+%type <syntax_node> sql_show_tables sql_create_table sql_drop_table sql_truncate_table
 %type <syntax_node> column_definition_list column_definition column_type column_list
-%type <syntax_node> sql_create_index sql_drop_index sql_show_indexes
+%type <syntax_node> sql_create_index sql_drop_index sql_show_indexes sql_show_stats
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
-%type <syntax_node> sql_select select_columns column_values column_value operator
+%type <syntax_node> sql_select select_columns select_list select_item from_tables where_clause group_by column_ref
+%type <syntax_node> order_by order_list order_item limit
+%type <syntax_node> column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
-%type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_insert value_tuples sql_load sql_delete sql_update update_values update_value
+%type <syntax_node> sql_quit sql_exec_file sql_analyze sql_vacuum
 
 %%
 
@@ -46,11 +51,16 @@ sql:
   | sql_show_tables { $$ = $1; }
   | sql_create_table { $$ = $1; }
   | sql_drop_table { $$ = $1; }
+  | sql_truncate_table { $$ = $1; }
   | sql_create_index { $$ = $1; }
   | sql_drop_index { $$ = $1; }
   | sql_show_indexes { $$ = $1; }
+  | sql_show_stats { $$ = $1; }
   | sql_select { $$ = $1; }
   | sql_insert { $$ = $1; }
+  | sql_load { $$ = $1; }
+  | sql_analyze { $$ = $1; }
+  | sql_vacuum { $$ = $1; }
   | sql_delete { $$ = $1; }
   | sql_update { $$ = $1; }
   | sql_trx_begin { $$ = $1; }
@@ -101,6 +111,16 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' USING IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeCreateTable, NULL);
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+    pSyntaxNode layout_node = CreateSyntaxNode(kNodeTableLayout, "table layout");
+    SyntaxNodeAddChildren(layout_node, $8);
+    SyntaxNodeAddChildren($$, layout_node);
+  }
   ;
 
 column_list:
@@ -160,6 +180,13 @@ sql_drop_table:
   }
   ;
 
+sql_truncate_table:
+  TRUNCATE TABLE IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeTruncateTable, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
 sql_create_index:
   CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' {
     $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
@@ -195,19 +222,35 @@ sql_show_indexes:
   }
   ;
 
+sql_show_stats:
+  SHOW STATS IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeShowStats, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
 sql_select:
-  SELECT select_columns FROM IDENTIFIER {
+  SELECT select_columns FROM from_tables where_clause group_by order_by limit {
     $$ = CreateSyntaxNode(kNodeSelect, NULL);
     SyntaxNodeAddChildren($$, $2);
     SyntaxNodeAddChildren($$, $4);
+    if ($5 != NULL) {
+      pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
+      SyntaxNodeAddChildren(condition_node, $5);
+      SyntaxNodeAddChildren($$, condition_node);
+    }
+    SyntaxNodeAddChildren($$, $6);
+    SyntaxNodeAddChildren($$, $7);
+    SyntaxNodeAddChildren($$, $8);
   }
-  | SELECT select_columns FROM IDENTIFIER WHERE where_conditions {
-    $$ = CreateSyntaxNode(kNodeSelect, NULL);
-    SyntaxNodeAddChildren($$, $2);
-    SyntaxNodeAddChildren($$, $4);
-    pSyntaxNode condition_node = CreateSyntaxNode(kNodeConditions, NULL);
-    SyntaxNodeAddChildren(condition_node, $6);
-    SyntaxNodeAddChildren($$, condition_node);
+  ;
+
+where_clause:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | WHERE where_conditions {
+    $$ = $2;
   }
   ;
 
@@ -215,12 +258,114 @@ select_columns:
   '*' {
     $$ = CreateSyntaxNode(kNodeAllColumns, NULL);
   }
-  | column_list {
+  | select_list {
     $$ = CreateSyntaxNode(kNodeColumnList, "select columns");
     SyntaxNodeAddChildren($$, $1);
   }
   ;
 
+select_list:
+  select_item ',' select_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | select_item {
+    $$ = $1;
+  }
+  ;
+
+select_item:
+  column_ref {
+    $$ = $1;
+  }
+  | IDENTIFIER '(' column_ref ')' {
+    $$ = CreateSyntaxNode(kNodeAggregate, $1->val_);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | IDENTIFIER '(' '*' ')' {
+    $$ = CreateSyntaxNode(kNodeAggregate, $1->val_);
+    SyntaxNodeAddChildren($$, CreateSyntaxNode(kNodeAllColumns, NULL));
+  }
+  ;
+
+from_tables:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | IDENTIFIER ',' column_list {
+    $$ = CreateSyntaxNode(kNodeTableList, NULL);
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+column_ref:
+  IDENTIFIER {
+    $$ = $1;
+  }
+  | IDENTIFIER '.' IDENTIFIER {
+    char *name = (char *) malloc(strlen($1->val_) + strlen($3->val_) + 2);
+    sprintf(name, "%s.%s", $1->val_, $3->val_);
+    $$ = CreateSyntaxNode(kNodeIdentifier, name);
+    free(name);
+  }
+  ;
+
+group_by:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | GROUP BY column_list {
+    $$ = CreateSyntaxNode(kNodeColumnList, "group by");
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+order_by:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | ORDER BY order_list {
+    $$ = CreateSyntaxNode(kNodeOrderBy, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
+order_list:
+  order_item ',' order_list {
+    $$ = $1;
+    SyntaxNodeAddSibling($$, $3);
+  }
+  | order_item {
+    $$ = $1;
+  }
+  ;
+
+order_item:
+  column_ref {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "asc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  | column_ref ASC {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "asc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  | column_ref DESC {
+    $$ = CreateSyntaxNode(kNodeOrderItem, "desc");
+    SyntaxNodeAddChildren($$, $1);
+  }
+  ;
+
+limit:
+  /* empty */ {
+    $$ = NULL;
+  }
+  | LIMIT NUMBER {
+    $$ = CreateSyntaxNode(kNodeLimit, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
 where_conditions:
   where_conditions connector where_condition  {
     $$ = $2;
@@ -242,7 +387,12 @@ connector:
   ;
 
 where_condition:
-  IDENTIFIER operator column_value {
+  column_ref operator column_value {
+    $$ = $2;
+    SyntaxNodeAddChildren($$, $1);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  | column_ref operator column_ref {
     $$ = $2;
     SyntaxNodeAddChildren($$, $1);
     SyntaxNodeAddChildren($$, $3);
@@ -289,12 +439,52 @@ operator:
   ;
 
 sql_insert:
-  INSERT INTO IDENTIFIER VALUES '(' column_values ')' {
+  INSERT INTO IDENTIFIER VALUES value_tuples {
     $$ = CreateSyntaxNode(kNodeInsert, NULL);
     SyntaxNodeAddChildren($$, $3);
-    pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, $6);
-    SyntaxNodeAddChildren($$, col_val_node);
+    // value_tuples are chained in reverse order
+    pSyntaxNode tuples = NULL, p = $5;
+    while (p != NULL) {
+      pSyntaxNode next = p->next_;
+      p->next_ = tuples;
+      tuples = p;
+      p = next;
+    }
+    SyntaxNodeAddChildren($$, tuples);
+  }
+  ;
+
+value_tuples:
+  value_tuples ',' '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $4);
+    $$->next_ = $1;
+  }
+  | '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
+sql_load:
+  LOAD STRING INTO IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeLoad, NULL);
+    SyntaxNodeAddChildren($$, $2);
+    SyntaxNodeAddChildren($$, $4);
+  }
+  ;
+
+sql_analyze:
+  ANALYZE IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeAnalyze, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
+sql_vacuum:
+  VACUUM IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    SyntaxNodeAddChildren($$, $2);
   }
   ;
 
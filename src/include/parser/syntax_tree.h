@@ -43,7 +43,18 @@ typedef enum {
   kNodeIndexType, /** type of index */
   kNodeTrxBegin, /** begin transaction command */
   kNodeTrxCommit, /** commit transaction command */
-  kNodeTrxRollback /** rollback transaction command */
+  kNodeTrxRollback, /** rollback transaction command */
+  kNodeLoad, /** load data file into table command */
+  kNodeTableLayout, /** page layout of a table, used in create table */
+  kNodeAggregate, /** aggregate function of a select, the function name with the column or '*' as child */
+  kNodeTableList, /** tables of a join in a select, in from order */
+  kNodeOrderBy, /** order by of a select, contains several order items */
+  kNodeOrderItem, /** column of an order by as child, val_ is "asc" or "desc" */
+  kNodeLimit, /** limit of a select, the number of rows as child */
+  kNodeAnalyze, /** analyze command, gathers the statistics of the table of its child */
+  kNodeShowStats, /** show stats command, prints the statistics of the table of its child */
+  kNodeTruncateTable, /** truncate table command, removes every row of the table of its child */
+  kNodeVacuum /** vacuum command, reclaims the space of the deleted rows of the table of its child */
 } SyntaxNodeType;
 
 /**
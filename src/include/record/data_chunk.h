@@ -0,0 +1,114 @@
+#ifndef MINISQL_DATA_CHUNK_H
+#define MINISQL_DATA_CHUNK_H
+
+#include <memory>
+#include <vector>
+
+#include "common/rowid.h"
+#include "record/filter_kernels.h"
+#include "record/schema.h"
+
+/**
+ * A batch of consecutive slots of a table page, stored by column, the unit of the batch executor:
+ * a scan fills chunks, filters turn them into selection bitmaps and sinks print the selected
+ * tuples. Only the loaded columns hold values, the visible bitmap tells which slots hold a tuple.
+ * Values of a row page point into the page, which the scan keeps pinned while the chunk is current.
+ */
+class DataChunk {
+public:
+  /**
+   * @param columns the columns to load, the other ones are treated as null
+   */
+  DataChunk(const Schema *schema, const std::vector<uint32_t> &columns);
+
+  /**
+   * Start a new batch of count slots of page page_id, from slot first on. The values and the
+   * visible bitmap are filled by the scan.
+   */
+  void Reset(page_id_t page_id, uint32_t first, uint32_t count);
+
+  inline const Schema *GetSchema() const { return schema_; }
+
+  inline const std::vector<uint32_t> &GetColumns() const { return columns_; }
+
+  /**
+   * @return the number of slots, visible or not
+   */
+  inline uint32_t GetSize() const { return size_; }
+
+  inline RowId GetRowId(uint32_t index) const { return RowId(page_id_, first_slot_ + index); }
+
+  inline const uint64_t *GetVisible() const { return visible_; }
+
+  inline uint64_t *GetVisible() { return visible_; }
+
+  inline bool IsLoaded(uint32_t column) const { return vectors_[column] != nullptr; }
+
+  inline const ColumnVector &GetColumn(uint32_t column) const { return *vectors_[column]; }
+
+  inline ColumnVector &GetColumn(uint32_t column) { return *vectors_[column]; }
+
+  inline bool IsNull(uint32_t index, uint32_t column) const {
+    return vectors_[column] == nullptr || (vectors_[column]->valid_[index / 64] & (uint64_t(1) << (index % 64))) == 0;
+  }
+
+  inline int32_t GetInt(uint32_t index, uint32_t column) const { return vectors_[column]->ints_[index]; }
+
+  inline float GetFloat(uint32_t index, uint32_t column) const { return vectors_[column]->floats_[index]; }
+
+  inline const char *GetChars(uint32_t index, uint32_t column) const { return vectors_[column]->chars_[index]; }
+
+  inline uint32_t GetCharLength(uint32_t index, uint32_t column) const { return vectors_[column]->lengths_[index]; }
+
+  /**
+   * Write tuple index into buf in the compact row format, columns which are not loaded are null.
+   */
+  void SerializeTuple(uint32_t index, std::vector<char> &buf) const;
+
+  /**
+   * @return the buffer slot index of a row page is converted into when it is stored in the legacy row format,
+   *         its values point there until the slot is loaded again
+   */
+  inline std::vector<char> &GetScratch(uint32_t index) {
+    if (scratch_.empty()) {
+      scratch_.resize(FILTER_VECTOR_SIZE);
+    }
+    return scratch_[index];
+  }
+
+private:
+  const Schema *schema_;
+  std::vector<uint32_t> columns_;
+  std::vector<std::unique_ptr<ColumnVector>> vectors_;  /** by column index, nullptr if not loaded */
+  page_id_t page_id_{INVALID_PAGE_ID};
+  uint32_t first_slot_{0};
+  uint32_t size_{0};
+  uint64_t visible_[FILTER_VECTOR_SIZE / 64];
+  std::vector<std::vector<char>> scratch_;  /** legacy rows converted to the compact format, by index */
+};
+
+/**
+ * One tuple of a chunk, with the accessors of TupleView, so code formatting tuples is shared.
+ */
+class ChunkTuple {
+public:
+  ChunkTuple(const DataChunk &chunk, uint32_t index) : chunk_(chunk), index_(index) {}
+
+  inline RowId GetRowId() const { return chunk_.GetRowId(index_); }
+
+  inline bool IsNull(uint32_t column) const { return chunk_.IsNull(index_, column); }
+
+  inline int32_t GetInt(uint32_t column) const { return chunk_.GetInt(index_, column); }
+
+  inline float GetFloat(uint32_t column) const { return chunk_.GetFloat(index_, column); }
+
+  inline const char *GetChars(uint32_t column) const { return chunk_.GetChars(index_, column); }
+
+  inline uint32_t GetCharLength(uint32_t column) const { return chunk_.GetCharLength(index_, column); }
+
+private:
+  const DataChunk &chunk_;
+  uint32_t index_;
+};
+
+#endif  // MINISQL_DATA_CHUNK_H
@@ -13,6 +13,10 @@ class Field {
 
   friend class Row;
 
+  friend class TupleView;
+
+  friend struct TableStatistics;
+
   friend class TypeInt;
 
   friend class TypeChar;
@@ -0,0 +1,102 @@
+#ifndef MINISQL_FILTER_KERNELS_H
+#define MINISQL_FILTER_KERNELS_H
+
+#include <cstdint>
+
+#include "record/tuple_view.h"
+
+/**
+ * Vectorized predicates "value op constant" over arrays of decoded column values. A kernel sets
+ * bit i of a selection bitmap (bit i % 64 of word i / 64) if value i passes, the bits behind the
+ * last value are cleared. The results are the same as TupleView::Compare of non-null values.
+ *
+ * Int and float kernels use AVX2 or SSE4.1 if the cpu has them, otherwise a scalar loop, the
+ * instruction set is detected once at runtime. Chars are compared with memcmp.
+ */
+
+/**
+ * Values a scan decodes and filters at a time.
+ */
+static constexpr uint32_t FILTER_VECTOR_SIZE = 1024;
+
+enum FilterIsa {
+  kFilterScalar = 0,
+  kFilterSse41,
+  kFilterAvx2
+};
+
+/**
+ * @return the best instruction set the cpu supports
+ */
+FilterIsa DetectFilterIsa();
+
+/**
+ * @return the instruction set the kernels currently use
+ */
+FilterIsa GetFilterIsa();
+
+/**
+ * Switch the kernels to isa, e.g. to compare the implementations.
+ * @return false if the cpu does not support isa
+ */
+bool SetFilterIsa(FilterIsa isa);
+
+inline uint32_t SelectionWords(uint32_t count) { return (count + 63) / 64; }
+
+void FilterInt(const int32_t *values, uint32_t count, CompareOp op, int32_t value, uint64_t *selection);
+
+void FilterFloat(const float *values, uint32_t count, CompareOp op, float value, uint64_t *selection);
+
+/**
+ * Value i has lengths[i] bytes at values[i], a prefix is less than the longer string.
+ */
+void FilterChar(const char *const *values, const uint16_t *lengths, uint32_t count, CompareOp op, const char *value,
+                uint32_t length, uint64_t *selection);
+
+/**
+ * Decoded values of one column for up to FILTER_VECTOR_SIZE tuples, e.g. the slots of a page.
+ * Int and float values either point into a PAX minipage or at buffer_, char values point at their
+ * bytes in the page. Values whose valid_ bit is clear (null or no tuple) are undefined.
+ */
+struct ColumnVector {
+  TypeId type_{kTypeInvalid};
+  uint32_t count_{0};
+  const int32_t *ints_{nullptr};
+  const float *floats_{nullptr};
+  const char *chars_[FILTER_VECTOR_SIZE];
+  uint16_t lengths_[FILTER_VECTOR_SIZE];
+  uint64_t valid_[FILTER_VECTOR_SIZE / 64];
+  union {
+    int32_t ints[FILTER_VECTOR_SIZE];
+    float floats[FILTER_VECTOR_SIZE];
+  } buffer_;
+};
+
+/**
+ * Evaluate "value op constant" over the vector, value must have the type of the vector. Only valid
+ * values can be selected, a null constant selects nothing.
+ */
+void FilterVector(const ColumnVector &vector, CompareOp op, const Field &value, uint64_t *selection);
+
+/**
+ * selection &= mask, over the words of count bits
+ */
+inline void SelectionAnd(uint64_t *selection, const uint64_t *mask, uint32_t count) {
+  for (uint32_t i = 0; i < SelectionWords(count); i++) {
+    selection[i] &= mask[i];
+  }
+}
+
+/**
+ * Call func(i) for every set bit i of the selection, in increasing order.
+ */
+template <typename Func>
+inline void ForEachSelected(const uint64_t *selection, uint32_t count, Func func) {
+  for (uint32_t w = 0; w < SelectionWords(count); w++) {
+    for (uint64_t word = selection[w]; word != 0; word &= word - 1) {
+      func(w * 64 + static_cast<uint32_t>(__builtin_ctzll(word)));
+    }
+  }
+}
+
+#endif  // MINISQL_FILTER_KERNELS_H
@@ -10,16 +10,17 @@
 #include "utils/mem_heap.h"
 
 /**
- *  Row format:
- * -------------------------------------------
- * | Header | Field-1 | ... | Field-N |
- * -------------------------------------------
- *  Header format:
- * --------------------------------------------
- * | Field Nums |
- * -------------------------------------------
- *  
+ *  Row format (compact, ROW_FORMAT_VERSION):
+ * -----------------------------------------------------------------------
+ * | Version | Null bitmap | Slot-1 | ... | Slot-N | Var data (chars) |
+ * -----------------------------------------------------------------------
+ *  Version is one byte, the null bitmap takes (N + 7) / 8 bytes, bit i set means field i is null.
+ *  Every column has a 4 byte slot at a fixed offset, see SlotOffset:
+ *    int/float: the value, char: | offset(2) | length(2) | of its data counted from the row start.
+ *  Slots of null fields are zero.
  *
+ *  The legacy format | ROW_MAGIC_NUM(4) | Field Nums(4) | bool * n | Field-1 | ... | Field-N |
+ *  is still read, rows are converted when they are written again, see TableHeap::MigrateRowFormat.
  */
 class Row {
 public:
@@ -27,11 +28,10 @@ public:
    * Row used for insert
    * Field integrity should check by upper level
    */
-  explicit Row(std::vector<Field> &fields) : heap_(new SimpleMemHeap) {
+  explicit Row(std::vector<Field> &fields) : heap_(new ArenaMemHeap(ROW_HEAP_BLOCK_SIZE)), own_heap_(true) {
     // deep copy
     for (auto &field : fields) {
-      void *buf = heap_->Allocate(sizeof(Field));
-      fields_.push_back(new(buf)Field(field));
+      fields_.push_back(CopyField(field));
     }
   }
 
@@ -43,27 +43,49 @@ public:
   /**
    * Row used for deserialize and update
    */
-  Row(RowId rid) : rid_(rid), heap_(new SimpleMemHeap) {}
+  Row(RowId rid) : rid_(rid), heap_(new ArenaMemHeap(ROW_HEAP_BLOCK_SIZE)), own_heap_(true) {}
+
+  /**
+   * Row whose fields live in heap, usually an arena of a query or a scan, which must outlive the row.
+   * Nothing is freed when the row is destroyed, the owner of the heap releases all its rows at once.
+   */
+  Row(RowId rid, MemHeap *heap) : rid_(rid), heap_(heap) {}
 
   /**
    * Row copy function
    */
-  Row(const Row &other) : heap_(new SimpleMemHeap) {
-    if (!fields_.empty()) {
-      for (auto &field : fields_) {
-        heap_->Free(field);
-      }
-      fields_.clear();
-    }
-    rid_ = other.rid_;
+  Row(const Row &other) : rid_(other.rid_), heap_(new ArenaMemHeap(ROW_HEAP_BLOCK_SIZE)), own_heap_(true) {
     for (auto &field : other.fields_) {
-      void *buf = heap_->Allocate(sizeof(Field));
-      fields_.push_back(new(buf)Field(*field));
+      fields_.push_back(CopyField(*field));
     }
   }
 
+  /**
+   * Row move function, takes the fields and the heap of other, which is left without fields.
+   */
+  Row(Row &&other) noexcept
+      : rid_(other.rid_), fields_(std::move(other.fields_)), heap_(other.heap_), own_heap_(other.own_heap_) {
+    other.fields_.clear();
+    other.heap_ = nullptr;
+    other.own_heap_ = false;
+  }
+
   virtual ~Row() {
-    delete heap_;
+    DestroyFields();
+    if (own_heap_) {
+      delete heap_;
+    }
+  }
+
+  /**
+   * Drop all the fields, the memory of a row owning its heap is reused by the next deserialize.
+   */
+  void Clear() {
+    DestroyFields();
+    EnsureHeap();
+    if (own_heap_) {
+      static_cast<ArenaMemHeap *>(heap_)->Reset();
+    }
   }
 
   /**
@@ -71,6 +93,9 @@ public:
    */
   uint32_t SerializeTo(char *buf, Schema *schema) const;
 
+  /**
+   * Replaces the fields the row had before.
+   */
   uint32_t DeserializeFrom(char *buf, Schema *schema);
 
   /**
@@ -80,6 +105,25 @@ public:
    */
   uint32_t GetSerializedSize(Schema *schema) const;
 
+  static constexpr uint8_t ROW_FORMAT_VERSION = 2;
+  static constexpr uint32_t SLOT_SIZE = 4;
+
+  /**
+   * @return true if buf holds a row in the legacy format
+   */
+  static inline bool IsLegacyFormat(const char *buf) {
+    return static_cast<uint8_t>(buf[0]) != ROW_FORMAT_VERSION;
+  }
+
+  static inline uint32_t NullBitmapSize(uint32_t column_count) { return (column_count + 7) / 8; }
+
+  /**
+   * Offset of the slot of column idx in a compact row, computed from the schema only.
+   */
+  static inline uint32_t SlotOffset(uint32_t column_count, uint32_t idx) {
+    return sizeof(uint8_t) + NullBitmapSize(column_count) + idx * SLOT_SIZE;
+  }
+
   inline const RowId GetRowId() const { return rid_; }
 
   inline void SetRowId(RowId rid) { rid_ = rid; }
@@ -94,29 +138,86 @@ public:
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
-  Row &operator=(const Row &other) {
-    if (!fields_.empty()) {
-      for (auto &field : fields_) {
-        heap_->Free(field);
-      }
-      fields_.clear();
+  /**
+   * Append a copy of field, allocated in the heap of the row.
+   */
+  inline void AppendField(const Field &field) { fields_.push_back(CopyField(field)); }
+
+  /**
+   * Replace field idx by a copy of field.
+   */
+  inline void SetField(uint32_t idx, const Field &field) {
+    ASSERT(idx < fields_.size(), "Failed to access field");
+    fields_[idx]->~Field();
+    fields_[idx] = CopyField(field);
+  }
+
+  Row &operator=(Row &&other) noexcept {
+    if (this == &other) {
+      return *this;
     }
+    DestroyFields();
+    if (own_heap_) {
+      delete heap_;
+    }
+    rid_ = other.rid_;
+    fields_ = std::move(other.fields_);
+    heap_ = other.heap_;
+    own_heap_ = other.own_heap_;
+    other.fields_.clear();
+    other.heap_ = nullptr;
+    other.own_heap_ = false;
+    return *this;
+  }
 
+  Row &operator=(const Row &other) {
+    if (this == &other) {
+      return *this;
+    }
+    Clear();
     rid_ = other.GetRowId();
-    for (auto i : other.GetFields_read_only()) {
-      fields_.push_back(new (heap_->Allocate(sizeof(*i))) Field(*i));
+    for (auto field : other.fields_) {
+      fields_.push_back(CopyField(*field));
     }
-
     return *this;
   }
 
- private:
-
 private:
+  uint32_t DeserializeLegacy(char *buf, Schema *schema);
+
+  /**
+   * Deep copy field into heap_, char data included.
+   */
+  Field *CopyField(const Field &field);
+
+  /**
+   * @return a char field holding a copy of data, allocated in heap_
+   */
+  Field *AllocCharField(const char *data, uint32_t len);
+
+  /**
+   * A moved-from row has no heap until it is filled again.
+   */
+  inline void EnsureHeap() {
+    if (heap_ == nullptr) {
+      heap_ = new ArenaMemHeap(ROW_HEAP_BLOCK_SIZE);
+      own_heap_ = true;
+    }
+  }
+
+  inline void DestroyFields() {
+    for (auto field : fields_) {
+      field->~Field();
+    }
+    fields_.clear();
+  }
+
   RowId rid_{};
   std::vector<Field *> fields_;   /** Make sure that all fields are created by mem heap */
   MemHeap *heap_{nullptr};
+  bool own_heap_{false};
   static constexpr uint32_t ROW_MAGIC_NUM = 1055820;
+  static constexpr size_t ROW_HEAP_BLOCK_SIZE = 256;  /** fields and chars of a typical row fit in one block */
 };
 
 #endif //MINISQL_TUPLE_H
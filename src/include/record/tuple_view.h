@@ -0,0 +1,98 @@
+#ifndef MINISQL_TUPLE_VIEW_H
+#define MINISQL_TUPLE_VIEW_H
+
+#include <cstring>
+
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Comparison operators of a where condition.
+ */
+enum CompareOp {
+  kCmpEq = 0,
+  kCmpNe,
+  kCmpLt,
+  kCmpLe,
+  kCmpGt,
+  kCmpGe,
+  kCmpInvalid
+};
+
+/**
+ * @return the operator written as "=", "<>", "<", "<=", ">" or ">=", kCmpInvalid otherwise
+ */
+CompareOp GetCompareOp(const std::string &oper);
+
+/**
+ * Read only view of a row in the compact format, pointing into the memory that holds it, usually
+ * a pinned TablePage. Fields are decoded on access from their fixed slots, nothing is copied or
+ * allocated. The view is only valid while the memory it points to is, Materialize the row if it
+ * has to outlive it.
+ */
+class TupleView {
+public:
+  TupleView() = default;
+
+  TupleView(const char *data, const Schema *schema, RowId rid) : data_(data), schema_(schema), rid_(rid) {}
+
+  inline void Reset(const char *data, const Schema *schema, RowId rid) {
+    ASSERT(!Row::IsLegacyFormat(data), "Tuple view needs a compact row.");
+    data_ = data;
+    schema_ = schema;
+    rid_ = rid;
+  }
+
+  inline const char *GetData() const { return data_; }
+
+  inline const Schema *GetSchema() const { return schema_; }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  /**
+   * @return the bytes of the tuple, its slots and its char data
+   */
+  uint32_t GetSize() const;
+
+  inline bool IsNull(uint32_t idx) const {
+    return (data_[sizeof(uint8_t) + idx / 8] & (1 << (idx % 8))) != 0;
+  }
+
+  inline int32_t GetInt(uint32_t idx) const { return MACH_READ_FROM(int32_t, Slot(idx)); }
+
+  inline float GetFloat(uint32_t idx) const { return MACH_READ_FROM(float, Slot(idx)); }
+
+  /**
+   * Char data is not null terminated, see GetCharLength
+   */
+  inline const char *GetChars(uint32_t idx) const { return data_ + MACH_READ_FROM(uint16_t, Slot(idx)); }
+
+  inline uint32_t GetCharLength(uint32_t idx) const { return MACH_READ_FROM(uint16_t, Slot(idx) + sizeof(uint16_t)); }
+
+  /**
+   * Compare field idx with value, which must have the type of the column.
+   * @return kNull if either side is null
+   */
+  CmpBool Compare(uint32_t idx, CompareOp op, const Field &value) const;
+
+  /**
+   * Deep copy the tuple into row, replacing its fields.
+   */
+  void Materialize(Row *row) const;
+
+  /**
+   * Append copies of the fields in columns to row, in that order, e.g. to build an index key.
+   */
+  void Project(const std::vector<uint32_t> &columns, Row *row) const;
+
+private:
+  inline const char *Slot(uint32_t idx) const { return data_ + Row::SlotOffset(schema_->GetColumnCount(), idx); }
+
+  const char *data_{nullptr};
+  const Schema *schema_{nullptr};
+  RowId rid_{};
+};
+
+#endif  // MINISQL_TUPLE_VIEW_H
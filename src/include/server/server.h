@@ -0,0 +1,104 @@
+#ifndef MINISQL_SERVER_H
+#define MINISQL_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "executor/execute_engine.h"
+
+/**
+ * Wire protocol shared by the server and the bundled client.
+ *
+ * Every message is a frame: a 4-byte payload length in network byte order followed by the payload.
+ * A request frame carries exactly one sql statement (terminated by ';').
+ * A reply frame starts with one ReplyStatus byte, the rest is the text output of the statement.
+ */
+enum ReplyStatus : char {
+  kReplyOk = 0,
+  kReplyError = 1,
+  kReplyBye = 2
+};
+
+static constexpr uint32_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+bool SendFrame(int fd, const std::string &payload);
+
+bool RecvFrame(int fd, std::string &payload);
+
+/**
+ * MiniSqlServer accepts client connections on a unix domain socket or a localhost tcp port,
+ * and serves them from a fixed pool of worker threads. A worker serves one connection at a time,
+ * a connection beyond the number of workers gets an error reply and is closed.
+ *
+ * Each connection gets its own session engine (with its own current database), while all
+ * sessions share the databases opened by the root engine. The buffer pool, the catalog and the
+ * parser are not thread-safe, so statements are executed one at a time under execute_latch_;
+ * network io and reply delivery of different sessions overlap.
+ */
+class MiniSqlServer {
+public:
+  MiniSqlServer(ExecuteEngine *engine, uint32_t num_workers);
+
+  ~MiniSqlServer();
+
+  bool ListenTcp(uint16_t port);
+
+  bool ListenUnix(const std::string &path);
+
+  /**
+   * Accept connections until Shutdown is called, then wait for the running sessions to finish.
+   */
+  void Run();
+
+  /**
+   * Stop accepting connections, Run then wakes the sessions waiting for a request. Safe to call from
+   * a signal handler.
+   */
+  void Shutdown();
+
+private:
+  /**
+   * Shut down the open connections of the workers, so a session blocked in RecvFrame returns.
+   */
+  void WakeSessions();
+
+  /**
+   * Serve the pending connections, worker_id is the slot of the worker in session_fds_.
+   */
+  void WorkerLoop(uint32_t worker_id);
+
+  /**
+   * Tell a client that all workers are busy and close its connection.
+   */
+  void RejectSession(int client_fd);
+
+  void ServeSession(int client_fd);
+
+  /**
+   * Run one statement in the given session and collect everything it prints into reply.
+   */
+  ReplyStatus ExecuteStatement(ExecuteEngine &session, const std::string &sql, std::string &reply);
+
+private:
+  ExecuteEngine *engine_;                   // root engine owning the opened databases
+  uint32_t num_workers_;
+  int listen_fd_{-1};
+  std::string unix_path_;                   // removed on shutdown if listening on a unix socket
+  std::atomic<bool> stopped_{false};
+  std::vector<std::thread> workers_;
+  std::vector<int> session_fds_;            // connection served by each worker, -1 if idle
+  std::mutex session_latch_;                // guards session_fds_, a worker closes its connection under it
+  std::atomic<uint32_t> sessions_{0};       // accepted connections which are not closed yet
+  std::queue<int> pending_;                 // accepted connections waiting for a worker
+  std::mutex pending_latch_;
+  std::condition_variable pending_cv_;
+  std::mutex execute_latch_;                // serializes parsing and execution
+};
+
+#endif  // MINISQL_SERVER_H
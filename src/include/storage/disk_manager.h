@@ -6,6 +6,7 @@
 #include <iostream>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
@@ -54,6 +55,12 @@ public:
    */
   void DeAllocatePage(page_id_t logical_page_id);
 
+  /**
+   * Free a batch of pages and reset their bits. The bitmap page of every extent is read and written
+   * once for all its pages, pages which are already free are skipped.
+   */
+  void DeAllocatePages(std::vector<page_id_t> logical_page_ids);
+
   /**
    * Return whether specific logical_page_id is free
    */
@@ -1,26 +1,51 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "page/pax_page.h"
+#include "page/table_directory_page.h"
 #include "page/table_page.h"
+#include "record/data_chunk.h"
+#include "record/filter_kernels.h"
 #include "storage/table_iterator.h"
 #include "transaction/log_manager.h"
 #include "transaction/lock_manager.h"
 
+/**
+ * Page layout of a table, chosen when the table is created.
+ */
+enum TableLayout {
+  kLayoutRow = 0,  /** slotted TablePages holding whole rows */
+  kLayoutPax       /** PaxPages holding a minipage per column, see page/pax_page.h */
+};
+
 class TableHeap {
   friend class TableIterator;
+  friend class TableViewIterator;
+  friend class TableChunkIterator;
 
 public:
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           TableLayout layout = kLayoutRow) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, layout);
   }
 
+  /**
+   * @param directory_page_id first page of the page directory, INVALID_PAGE_ID for a table written
+   *        before tables had one, see BuildPageDirectory
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           TableLayout layout = kLayoutRow, page_id_t directory_page_id = INVALID_PAGE_ID) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, layout,
+                              directory_page_id);
   }
 
   ~TableHeap() {}
@@ -33,6 +58,15 @@ public:
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Append a batch of tuples behind the last page of the table, pinning every page only once and
+   * never probing earlier pages for free space. Used by bulk loads.
+   * @param[in/out] rows Tuples to append, the rid of every appended tuple is wrapped in its row
+   * @param[in] txn The transaction performing the insert
+   * @return true iff all the tuples are appended, otherwise rows before the failed one are appended
+   */
+  bool AppendTuples(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -42,11 +76,12 @@ public:
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
-   * @param[in] row Tuple of new row
+   * Update a tuple in place. If the new tuple is too large to fit in the old page, the tuple is deleted
+   * and inserted again, the new rid is wrapped in row.
+   * @param[in/out] row Tuple of new row
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Transaction performing the update
-   * @return true is update is successful.
+   * @return true is update is successful, otherwise the old tuple is kept.
    */
   bool UpdateTuple(Row &row, const RowId &rid, Transaction *txn);
 
@@ -72,11 +107,34 @@ public:
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Rewrite every tuple of the table which is stored in the legacy row format in the current one. A tuple
+   * stays in its slot if the rewritten row fits, otherwise it moves to another page.
+   * @param[out] moved the old and the new row id of every moved tuple
+   * @return false if a tuple could not be moved and is still stored in the legacy format
+   */
+  bool MigrateRowFormat(std::vector<std::pair<RowId, RowId>> &moved, Transaction *txn);
+
   /**
    * Free table heap and release storage in disk file
    */
   void FreeHeap();
 
+  /**
+   * Remove every tuple of the table. All pages but the first one are freed at once, the first page
+   * and the first directory page are reset in place, so the table metadata stays valid.
+   */
+  void Truncate(Transaction *txn);
+
+  /**
+   * Reclaim the space of deleted tuples. Every kept page moves its tuples to the front of its slot
+   * array, and a page whose tuples fit into the kept page before it is merged into that page and
+   * freed, so are empty pages. The first page is always kept.
+   * @param moved (old, new) row ids of the tuples which moved are appended, for the indexes
+   * @return the number of freed pages
+   */
+  uint32_t Vacuum(std::vector<std::pair<RowId, RowId>> &moved, Transaction *txn);
+
   /**
    * @return the begin iterator of this table
    */
@@ -87,49 +145,178 @@ public:
    */
   TableIterator End();
 
+  /**
+   * @return a scan over TupleViews of the tuples, see TableViewIterator
+   * @param columns the columns the scan reads, all of them if nullptr. Only PAX tables skip the other
+   *        columns, which are null in the views then.
+   */
+  TableViewIterator ViewBegin(const std::vector<uint32_t> *columns = nullptr) const {
+    return TableViewIterator(this, columns);
+  }
+
+  /**
+   * @return a scan over TupleViews of the tuples of row_ids, see TableViewIterator. Sort the row ids
+   *         by page first, then every page is fetched and pinned once for all its tuples. row_ids must
+   *         outlive the scan.
+   */
+  TableViewIterator FetchBegin(const std::vector<RowId> &row_ids, const std::vector<uint32_t> *columns = nullptr) const {
+    return TableViewIterator(this, row_ids.data(), row_ids.size(), columns);
+  }
+
+  /**
+   * @return a scan over DataChunks of the table holding the values of columns, see TableChunkIterator.
+   *         The lazy columns are only loaded when asked for, after a filter selected some tuples.
+   */
+  TableChunkIterator ChunkBegin(const std::vector<uint32_t> &columns,
+                                const std::vector<uint32_t> &lazy_columns = {}) const {
+    return TableChunkIterator(this, columns, lazy_columns);
+  }
+
+  /**
+   * @return a scan over DataChunks of the pages [first, first + count) of the page directory, see
+   *         GetPageIds. Used by parallel scans, every worker scans its own ranges.
+   */
+  TableChunkIterator ChunkBegin(uint32_t first, uint32_t count, const std::vector<uint32_t> &columns,
+                                const std::vector<uint32_t> &lazy_columns = {}) const {
+    return TableChunkIterator(this, page_ids_.data() + first, count, columns, lazy_columns);
+  }
+
+  /**
+   * @return the ids of the pages of the table in chain order. They are read from the page directory
+   *         once and kept up to date by appends. A table without a directory walks the page chain
+   *         instead, later calls only follow the pages appended since.
+   */
+  const std::vector<page_id_t> &GetPageIds() const;
+
+  /**
+   * @return the id of page index of the table, counted from 0 in chain order
+   */
+  inline page_id_t GetPageId(uint32_t index) const { return GetPageIds()[index]; }
+
+  inline uint32_t GetPageCount() const { return GetPageIds().size(); }
+
+  /**
+   * Write the page directory of a table loaded without one.
+   * @return the first page of the directory, to be stored in the table metadata
+   */
+  page_id_t BuildPageDirectory();
+
+  /**
+   * Append the rids of the tuples with "column op value" to result, in table order. The values of
+   * a page are compared in vectors by the filter kernels, PAX minipages are read in place. Null
+   * values never match.
+   */
+  void FilterScan(uint32_t column, CompareOp op, const Field &value, std::vector<RowId> &result) const;
+
   /**
    * @return the id of the first page of this table
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  inline page_id_t GetDirectoryPageId() const { return directory_page_id_; }
+
+  inline TableLayout GetLayout() const { return layout_; }
+
+  inline const Schema *GetSchema() const { return schema_; }
+
 private:
   /**
    * create table heap and initialize first page
    */
  explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn, LogManager *log_manager,
-                    LockManager *lock_manager)
+                    LockManager *lock_manager, TableLayout layout)
      : buffer_pool_manager_(buffer_pool_manager),
        schema_(schema),
        log_manager_(log_manager),
-       lock_manager_(lock_manager) {
-   TablePage *first_page = (TablePage*)buffer_pool_manager->NewPage(first_page_id_);
-   first_page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, txn);
-   first_page->SetNextPageId(INVALID_PAGE_ID);
+       lock_manager_(lock_manager),
+       layout_(layout),
+       pax_layout_(layout == kLayoutPax ? new PaxLayout(schema) : nullptr) {
+   Page *first_page = buffer_pool_manager->NewPage(first_page_id_);
+   InitPage(first_page, first_page_id_, INVALID_PAGE_ID, txn);
    buffer_pool_manager->UnpinPage(first_page_id_, true);
+   BuildPageDirectory();
  };
 
   /**
    * load existing table heap by first_page_id
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout,
+                     page_id_t directory_page_id)
           : buffer_pool_manager_(buffer_pool_manager),
             first_page_id_(first_page_id),
+            directory_page_id_(directory_page_id),
             schema_(schema),
             log_manager_(log_manager),
-            lock_manager_(lock_manager) {}
+            lock_manager_(lock_manager),
+            layout_(layout),
+            pax_layout_(layout == kLayoutPax ? new PaxLayout(schema) : nullptr) {}
  /* 
  * create new page for the tableheap
  */
   page_id_t AllocateNewTablePage(page_id_t last_page_id, BufferPoolManager *buffer_pool_manager, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Format a new page of the table in its layout.
+   */
+  void InitPage(Page *page, page_id_t page_id, page_id_t prev_id, Transaction *txn);
+
+  bool InsertIntoPage(Page *page, Row &row, Transaction *txn);
+
+  /**
+   * Record a page chained behind the last one in the page directory.
+   */
+  void AppendToDirectory(page_id_t page_id);
+
+  /**
+   * Fill the visible bitmap and the given columns of chunk, which is Reset to slots of page.
+   */
+  void LoadChunk(Page *page, DataChunk *chunk, const std::vector<uint32_t> &columns) const;
+
+  /**
+   * @return the number of slots of the page, slots behind it hold no tuple
+   */
+  uint32_t GetSlotCount(Page *page) const;
+
+  /**
+   * @return true if the slot holds a tuple which is not deleted
+   */
+  bool HasTuple(Page *page, uint32_t slot_num) const;
+
+  /**
+   * @return the first tuple at or behind slot slot_num of page page_id, following the page chain,
+   *         INVALID_ROWID if there is none
+   */
+  RowId FindTuple(page_id_t page_id, uint32_t slot_num);
+
+  /**
+   * @return the pages of the page directory in chain order, empty for a table without one
+   */
+  std::vector<page_id_t> GetDirectoryPageIds() const;
+
+  /**
+   * Replace the page directory by page_ids, the directory pages which are not needed any more are freed.
+   */
+  void RewriteDirectory(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * @return true if the visible tuples of page can all be inserted into target, whose slots are compacted
+   */
+  bool FitsInto(Page *page, Page *target);
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};  /** hint of the last page, walked from first_page_id_ if unknown */
+  page_id_t directory_page_id_{INVALID_PAGE_ID};
+  page_id_t last_directory_page_id_{INVALID_PAGE_ID};  /** walked from directory_page_id_ if unknown */
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  TableLayout layout_;
+  std::unique_ptr<PaxLayout> pax_layout_;  /** only for kLayoutPax */
+  mutable std::vector<page_id_t> page_ids_;  /** cached page directory, empty until GetPageIds */
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
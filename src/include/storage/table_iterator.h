@@ -5,6 +5,9 @@
 #include "record/row.h"
 #include "transaction/transaction.h"
 #include "buffer/buffer_pool_manager.h"
+#include "page/table_page.h"
+#include "record/data_chunk.h"
+#include "record/tuple_view.h"
 #include "transaction/log_manager.h"
 #include "transaction/lock_manager.h"
 
@@ -14,9 +17,10 @@ class TableHeap;
 class TableIterator {
 
 public:
-  // you may define your own constructor based on your member variables
- explicit TableIterator(RowId record_id_first, BufferPoolManager *buffer_pool_manager, Schema *schema,
-                        LogManager *log_manager, LockManager *lock_manager);
+  /**
+   * @param rid the tuple the iterator points to, INVALID_ROWID for the end
+   */
+  explicit TableIterator(TableHeap *table_heap, RowId rid);
 
   explicit TableIterator(const TableIterator &other);
 
@@ -39,14 +43,141 @@ public:
   TableIterator operator++(int);
 
 private:
-  // add your own private member variables here
- BufferPoolManager *buffer_pool_manager_;
- Schema *schema_;
- LogManager *log_manager_;
- LockManager *lock_manager_;
- Transaction *txn;
- //RowId record_id_now_;
- Row record_now_;
+  /**
+   * Read the tuple of rid into record_now_, or point at the end if rid is invalid.
+   */
+  void Load(RowId rid);
+
+  TableHeap *table_heap_;
+  Row record_now_;
+};
+
+/**
+ * Scan of a table that hands out TupleViews instead of deserialized rows. The page of the current
+ * tuple stays pinned until the scan moves to the next page, the table must not be modified during
+ * the scan. Usage:
+ *   for (auto it = table_heap->ViewBegin(); !it.IsEnd(); ++it) { it->GetInt(0); ... }
+ * Views of a row table point into the page. A PAX page has no whole rows, the projected columns
+ * of the current tuple are copied from their minipages into a scratch row.
+ */
+class TableViewIterator {
+public:
+  TableViewIterator(const TableHeap *table_heap, const std::vector<uint32_t> *columns);
+
+  /**
+   * Visit only the tuples of the row_count row ids of row_ids, in their order, skipping deleted ones.
+   * A page is fetched once for a run of row ids on it, so row ids grouped by page read every page once.
+   */
+  TableViewIterator(const TableHeap *table_heap, const RowId *row_ids, size_t row_count,
+                    const std::vector<uint32_t> *columns);
+
+  TableViewIterator(const TableViewIterator &other) = delete;
+
+  TableViewIterator &operator=(const TableViewIterator &other) = delete;
+
+  ~TableViewIterator();
+
+  inline bool IsEnd() const { return page_ == nullptr; }
+
+  inline const TupleView &operator*() const { return view_; }
+
+  inline const TupleView *operator->() const { return &view_; }
+
+  TableViewIterator &operator++();
+
+private:
+  /**
+   * Size the scratch row of a PAX table.
+   */
+  void Init();
+
+  /**
+   * Find the first tuple from slot slot_ of page_ on, following the page chain. Sets page_ to
+   * nullptr at the end of the table.
+   */
+  void SeekTuple();
+
+  /**
+   * Find the first tuple of the row ids left, fetching its page if page_ is another one. Sets page_
+   * to nullptr after the last row id.
+   */
+  void SeekRowId();
+
+  /**
+   * @return true if slot slot_ of page_ holds a tuple, which view_ is pointed at
+   */
+  bool ReadSlot();
+
+  const TableHeap *table_heap_;
+  BufferPoolManager *buffer_pool_manager_;
+  const std::vector<uint32_t> *columns_;
+  Page *page_{nullptr};
+  uint32_t slot_{0};
+  const RowId *row_ids_{nullptr};  /** the row ids left to visit, nullptr to follow the page chain */
+  size_t row_count_{0};
+  TupleView view_;
+  std::vector<char> scratch_;  /** row assembled from a PAX page or converted from a legacy row */
+};
+
+/**
+ * Scan of a table that fills a DataChunk per page, or per FILTER_VECTOR_SIZE slots of a page, for
+ * the batch executor. Chunks without visible tuples are skipped. The page of the current chunk
+ * stays pinned, the table must not be modified during the scan. Usage:
+ *   for (auto it = table_heap->ChunkBegin(columns); !it.IsEnd(); ++it) { const DataChunk &chunk = *it; ... }
+ */
+class TableChunkIterator {
+public:
+  TableChunkIterator(const TableHeap *table_heap, const std::vector<uint32_t> &columns,
+                     const std::vector<uint32_t> &lazy_columns = {});
+
+  /**
+   * Scan only the page_count pages of pages instead of following the page chain.
+   */
+  TableChunkIterator(const TableHeap *table_heap, const page_id_t *pages, uint32_t page_count,
+                     const std::vector<uint32_t> &columns, const std::vector<uint32_t> &lazy_columns = {});
+
+  TableChunkIterator(const TableChunkIterator &other) = delete;
+
+  TableChunkIterator &operator=(const TableChunkIterator &other) = delete;
+
+  ~TableChunkIterator();
+
+  inline bool IsEnd() const { return page_ == nullptr; }
+
+  inline const DataChunk &operator*() const { return *chunk_; }
+
+  inline const DataChunk *operator->() const { return chunk_.get(); }
+
+  TableChunkIterator &operator++();
+
+  /**
+   * Load the lazy columns into the current chunk.
+   */
+  void LoadLazyColumns();
+
+private:
+  void Init(const std::vector<uint32_t> &lazy_columns);
+
+  /**
+   * @return the id of the page to scan after page_
+   */
+  page_id_t NextPageId();
+
+  /**
+   * Load the first chunk with a visible tuple from slot slot_ of page_ on, following the page chain.
+   * Sets page_ to nullptr at the end of the table.
+   */
+  void SeekChunk();
+
+  const TableHeap *table_heap_;
+  BufferPoolManager *buffer_pool_manager_;
+  Page *page_{nullptr};
+  uint32_t slot_{0};
+  const page_id_t *pages_{nullptr};  /** the pages left to scan, nullptr to follow the page chain */
+  uint32_t page_count_{0};
+  std::vector<uint32_t> columns_;
+  std::vector<uint32_t> lazy_columns_;  /** not in columns_ */
+  std::unique_ptr<DataChunk> chunk_;
 };
 
 #endif //MINISQL_TABLE_ITERATOR_H
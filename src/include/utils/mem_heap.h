@@ -2,8 +2,10 @@
 #define MINISQL_MEM_HEAP_H
 
 #include <cstdint>
+#include <cstddef>
 #include <cstdlib>
 #include <unordered_set>
+#include <vector>
 #include "common/macros.h"
 
 class MemHeap {
@@ -55,4 +57,78 @@ private:
   std::unordered_set<void *> allocated_;
 };
 
+/**
+ * Bump allocator. Memory is cut from blocks in allocation order and only given back all at once,
+ * by Reset or when the heap is destroyed, Free does nothing. Reset keeps the blocks for reuse and
+ * takes constant time. Destructors of the objects in the heap are not called.
+ */
+class ArenaMemHeap : public MemHeap {
+public:
+  explicit ArenaMemHeap(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+
+  ~ArenaMemHeap() {
+    for (auto &block : blocks_) {
+      free(block.data_);
+    }
+  }
+
+  void *Allocate(size_t size) override {
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (size > static_cast<size_t>(end_ - cursor_)) {
+      NextBlock(size);
+    }
+    void *buf = cursor_;
+    cursor_ += size;
+    return buf;
+  }
+
+  void Free(void *ptr) override {}
+
+  /**
+   * Give back everything allocated so far.
+   */
+  void Reset() {
+    current_ = 0;
+    cursor_ = blocks_.empty() ? nullptr : blocks_[0].data_;
+    end_ = blocks_.empty() ? nullptr : blocks_[0].data_ + blocks_[0].size_;
+  }
+
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+private:
+  struct Block {
+    char *data_;
+    size_t size_;
+  };
+
+  /**
+   * Move to the next block with at least size bytes, reusing the blocks kept by Reset.
+   */
+  void NextBlock(size_t size) {
+    if (!blocks_.empty()) {
+      current_++;
+    }
+    while (current_ < blocks_.size() && blocks_[current_].size_ < size) {
+      current_++;
+    }
+    if (current_ >= blocks_.size()) {
+      size_t block_size = size > block_size_ ? size : block_size_;
+      char *data = static_cast<char *>(malloc(block_size));
+      ASSERT(data != nullptr, "Out of memory exception");
+      blocks_.push_back({data, block_size});
+      current_ = blocks_.size() - 1;
+    }
+    cursor_ = blocks_[current_].data_;
+    end_ = cursor_ + blocks_[current_].size_;
+  }
+
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  size_t current_{0};
+  char *cursor_{nullptr};
+  char *end_{nullptr};
+};
+
 #endif //MINISQL_MEM_HEAP_H
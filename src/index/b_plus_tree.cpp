@@ -32,34 +32,40 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Destroy_subtree(page_id_t root) {
-  if (root == INVALID_PAGE_ID) return;
-
-  BPlusTreePage *root_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root)->GetData());
-  if (root_page->IsLeafPage() == true) {
-    buffer_pool_manager_->UnpinPage(root, false);
-    buffer_pool_manager_->DeletePage(root);
-  } else {
-    InternalPage *this_page = reinterpret_cast<InternalPage *> (root_page);
-    int start=0;
-    int end = this_page->GetSize()-1;
-    for (int i = start; i <= end; i++) {
-      Destroy_subtree(this_page->ValueAt(i));
-    }
-    buffer_pool_manager_->UnpinPage(root, false);
-    buffer_pool_manager_->DeletePage(root);
+void BPLUSTREE_TYPE::CollectPages(page_id_t page_id, int height, std::vector<page_id_t> &pages) {
+  pages.push_back(page_id);
+  if (height == 1) return;
+  auto page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  for (int i = 0; i < page->GetSize(); i++) {
+    CollectPages(page->ValueAt(i), height - 1, pages);
   }
-
+  buffer_pool_manager_->UnpinPage(page_id, false);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Destroy() {
+void BPLUSTREE_TYPE::Clear() {
   if (root_page_id_ == INVALID_PAGE_ID) return;
-
-  BPlusTreePage *root = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-  Destroy_subtree(root->GetPageId());
+  // all the leaves have the same depth, the leftmost path tells the height
+  int height = 1;
+  page_id_t page_id = root_page_id_;
+  while (true) {
+    auto page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t child = page->IsLeafPage() ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(page)->ValueAt(0);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (child == INVALID_PAGE_ID) break;
+    page_id = child;
+    height++;
+  }
+  std::vector<page_id_t> pages;
+  CollectPages(root_page_id_, height, pages);
+  buffer_pool_manager_->DeletePages(pages);
   root_page_id_ = INVALID_PAGE_ID;
+  UpdateRootPageId();
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Destroy() {
+  Clear();
   IndexRootsPage *header_page =
       reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
   header_page->Delete(index_id_);
@@ -219,7 +225,7 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
       //2. check the split
       if (leaf_page->GetSize() <= leaf_page->GetMaxSize()) {
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
       } else {
         new_page = Split(leaf_page);
         //no parent
@@ -632,6 +638,9 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  if (IsEmpty()) {
+    return End();
+  }
   BPlusTreePage *now = nullptr;
   InternalPage *inter_page = nullptr;
   now = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
@@ -656,6 +665,9 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  if (IsEmpty()) {
+    return End();
+  }
   LeafPage *now = FindLeafPage(key);
   int index_now = now->KeyIndex(key,comparator_);
   page_id_t leaf_id = now->GetPageId();
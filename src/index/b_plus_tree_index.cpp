@@ -49,6 +49,12 @@ dberr_t BPLUSTREE_INDEX_TYPE::Destroy() {
   return DB_SUCCESS;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::Clear() {
+  container_.Clear();
+  return DB_SUCCESS;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() {
   return container_.Begin();
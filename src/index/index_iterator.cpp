@@ -9,9 +9,18 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(
   my_buffer_pool_mangaer = bpm;
   leaf_page = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(
       my_buffer_pool_mangaer->FetchPage(first_page_id)->GetData());
+  // the start is behind the last pair of its leaf, e.g. an empty root
+  if (index_now >= leaf_page->GetSize()) {
+    index_now = leaf_page->GetSize() - 1;
+    ++(*this);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::~IndexIterator() {
+  // an iterator dropped before the end still pins its leaf
+  if (valid && leaf_page != nullptr) {
+    my_buffer_pool_mangaer->UnpinPage(leaf_page->GetPageId(), false);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() { 
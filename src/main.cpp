@@ -1,16 +1,12 @@
+#include <unistd.h>
+#include <csignal>
 #include <cstdio>
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
-#include "parser/syntax_tree_printer.h"
-#include "utils/tree_file_mgr.h"
-
-#define ENABLE_PARSER_DEBUG
+#include "server/server.h"
 
 extern "C" {
-int yyparse(void);
 FILE *yyin;
-#include "parser/minisql_lex.h"
-#include "parser/parser.h"
 }
 
 void InitGoogleLog(char *argv) {
@@ -19,73 +15,123 @@ void InitGoogleLog(char *argv) {
   google::InitGoogleLogging(argv);
 }
 
-void InputCommand(char *input, const int len) {
-  memset(input, 0, len);
-  printf("minisql > ");
-  int i = 0;
-  char ch;
-  while ((ch = getchar()) != ';') {
-    input[i++] = ch;
+/**
+ * Read one statement (up to and including ';') from stdin, returns false at end of input.
+ */
+bool InputCommand(std::string &input, bool prompt) {
+  input.clear();
+  if (prompt) {
+    printf("minisql > ");
+    fflush(stdout);
+  }
+  int ch;
+  while ((ch = getchar()) != EOF) {
+    if (input.empty() && isspace(ch)) continue;
+    input.push_back(static_cast<char>(ch));
+    if (ch == ';') return true;
   }
-  input[i] = ch;    // ;
-  getchar();        // remove enter
+  return false;
 }
 
-int main(int argc, char **argv) {
-  InitGoogleLog(argv[0]);
-  // command buffer
-  const int buf_size = 1024;
-  char cmd[buf_size];
-  // execute engine
-  ExecuteEngine engine;
-  // for print syntax tree
-  TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
-  [[maybe_unused]] uint32_t syntax_tree_id = 0;
+/**
+ * usage: main [--debug] [--port <port> | --socket <path>] [--workers <n>] [--format text|csv|binary]
+ *             [--scan-workers <n>]
+ *
+ * --debug dumps the syntax tree of every statement into syntax_tree_<id>.txt and prints the execute time.
+ * Without it the engine runs in production mode and statements go straight from the parser to the executor.
+ * --format selects how select results are written, see executor/result_sink.h.
+ * --scan-workers sets the threads filtering a large table, one per core by default, see executor/parallel_scan.h.
+ */
+struct StartupOptions {
+  bool debug{false};
+  uint16_t port{0};
+  std::string socket_path;
+  uint32_t workers{4};
+  ResultFormat format{kResultText};
+  uint32_t scan_workers{0};  /** 0 keeps the default of the engine */
+};
 
-  while (1) {
-    // read from buffer
-    InputCommand(cmd, buf_size);
-    // create buffer for sql input
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
+StartupOptions ParseOptions(int argc, char **argv) {
+  StartupOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--debug") {
+      options.debug = true;
+    } else if (arg == "--port" && i + 1 < argc) {
+      options.port = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (arg == "--socket" && i + 1 < argc) {
+      options.socket_path = argv[++i];
+    } else if (arg == "--workers" && i + 1 < argc) {
+      options.workers = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (arg == "--scan-workers" && i + 1 < argc) {
+      options.scan_workers = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (arg == "--format" && i + 1 < argc) {
+      std::string format = argv[++i];
+      if (format == "csv") {
+        options.format = kResultCsv;
+      } else if (format == "binary") {
+        options.format = kResultBinary;
+      } else if (format != "text") {
+        LOG(WARNING) << "unknown result format " << format;
+      }
+    } else {
+      LOG(WARNING) << "unknown option " << arg;
     }
-    yy_switch_to_buffer(bp);
+  }
+  return options;
+}
 
-    // init parser module
-    MinisqlParserInit();
+static MiniSqlServer *running_server = nullptr;
 
-    // parse
-    yyparse();
+void StopServer(int) {
+  if (running_server != nullptr) {
+    running_server->Shutdown();
+  }
+}
 
-    // parse result handle
-    if (MinisqlParserGetError()) {
-      // error
-      printf("%s\n", MinisqlParserGetErrorMessage());
-    } else {
-//#ifdef ENABLE_PARSER_DEBUG
-      printf("[INFO] Sql syntax parse ok!\n");
-      SyntaxTreePrinter printer(MinisqlGetParserRootNode());
-      printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
-//#endif
-    }
+/**
+ * Serve clients on a unix socket or a localhost tcp port until SIGINT/SIGTERM.
+ */
+int RunServer(const StartupOptions &options, ExecuteEngine &engine) {
+  MiniSqlServer server(&engine, options.workers);
+  bool tcp = options.socket_path.empty();
+  if (!(tcp ? server.ListenTcp(options.port) : server.ListenUnix(options.socket_path))) {
+    return 1;
+  }
+  running_server = &server;
+  signal(SIGINT, StopServer);
+  signal(SIGTERM, StopServer);
+  LOG(INFO) << "minisql server listening on " << (tcp ? "127.0.0.1:" + std::to_string(options.port) : options.socket_path)
+            << " with " << options.workers << " workers";
+  server.Run();
+  running_server = nullptr;
+  return 0;
+}
 
+int main(int argc, char **argv) {
+  InitGoogleLog(argv[0]);
+  StartupOptions options = ParseOptions(argc, argv);
+  // execute engine
+  ExecuteEngine engine;
+  engine.SetDebugMode(options.debug);
+  engine.SetResultFormat(options.format);
+  if (options.scan_workers != 0) {
+    engine.SetScanWorkers(options.scan_workers);
+  }
+  if (options.port != 0 || !options.socket_path.empty()) {
+    return RunServer(options, engine);
+  }
+  // only prompt when a user is typing, scripts piped into stdin run silently
+  bool prompt = isatty(fileno(stdin));
+  std::string cmd;
+  while (InputCommand(cmd, prompt)) {
     ExecuteContext context;
-    engine.Execute(MinisqlGetParserRootNode(), &context);
-    sleep(1);
-
-    // clean memory after parse
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
-
+    engine.ExecuteSql(cmd.c_str(), &context);
     // quit condition
     if (context.flag_quit_) {
       printf("bye!\n");
       break;
     }
-
   }
   return 0;
-}
\ No newline at end of file
+}
@@ -79,21 +79,18 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::my_lower_bound(const KeyType &key,const KeyComparator &comparator) const {
   if (GetSize() == 0) return 0;
 
-  int place = 0;
-  int i = 0;
-  if (comparator(key, array_[1].first) < 0)
-    place = 0;
-  else {
-    for (i = 1; i <= GetSize() - 2; i++) {
-      if (comparator(key, array_[i + 1].first) >= 0) {
-        continue;
-      } else {
-        break;
-      }
+  // binary search for the last child whose key is not greater than key, the key at 0 is invalid
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparator(key, array_[mid].first) >= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
     }
   }
-  place = i;
-  return place;
+  return low - 1;
 }
 
 /*****************************************************************************
@@ -75,23 +75,18 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
 
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::my_lower_bound(const KeyType& key, const KeyComparator& comparator) const {
-  if (GetSize() == 0) return 0;
-
-  int place = 0;
-  int i = 0;
-  if (comparator(key, array_[0].first) < 0)
-    place = 0;
-  else {
-    for (i = 1; i <= GetSize() - 1; i++) {
-      if (comparator(key, array_[i].first) >= 0) {
-        continue;
-      } else {
-        break;
-      }
+  // binary search for the first key greater than key
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparator(key, array_[mid].first) >= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
     }
   }
-  place = i;
-  return place;
+  return low;
 }
 
 /*****************************************************************************
@@ -103,12 +98,8 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::my_lower_bound(const KeyType& key, const KeyComp
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  if (GetSize() == 0) {
-  } else {
-    ASSERT(my_lower_bound(key, comparator)==0||comparator(array_[my_lower_bound(key, comparator)-1].first, key) != 0, "Already exists");
-  }
-
   int place = my_lower_bound(key, comparator);
+  ASSERT(place == 0 || comparator(array_[place - 1].first, key) != 0, "Already exists");
   int start = place;
   int end = GetSize();
   for (int i = end; i >= start+1; i--) array_[i] = array_[i - 1];
@@ -0,0 +1,240 @@
+#include "page/pax_page.h"
+
+#include <algorithm>
+
+static inline uint32_t BitmapSize(uint32_t bits) { return (bits + 7) / 8; }
+
+static inline uint32_t AlignValues(uint32_t offset) {
+  return (offset + sizeof(int32_t) - 1) / sizeof(int32_t) * sizeof(int32_t);
+}
+
+PaxLayout::PaxLayout(const Schema *schema) {
+  uint32_t column_count = schema->GetColumnCount();
+  uint32_t row_width = 0;
+  for (uint32_t i = 0; i < column_count; i++) {
+    const Column *column = schema->GetColumn(i);
+    uint32_t width = column->GetType() == kTypeChar ? sizeof(uint16_t) + column->GetLength() : sizeof(int32_t);
+    types_.push_back(column->GetType());
+    widths_.push_back(width);
+    row_width += width;
+  }
+  // live and deleted bits, a null bit per column and the values of every slot. The values start
+  // aligned, so the filter kernels read int/float minipages in place.
+  auto layout_size = [&](uint32_t capacity, bool save) {
+    uint32_t offset = PaxPage::SIZE_PAX_PAGE_HEADER + 2 * BitmapSize(capacity);
+    for (uint32_t i = 0; i < column_count; i++) {
+      uint32_t null_offset = offset;
+      offset = AlignValues(offset + BitmapSize(capacity));
+      if (save) {
+        null_offsets_.push_back(null_offset);
+        value_offsets_.push_back(offset);
+      }
+      offset += capacity * widths_[i];
+    }
+    return offset;
+  };
+  uint32_t space = PAGE_SIZE - PaxPage::SIZE_PAX_PAGE_HEADER;
+  capacity_ = space * 8 / ((2 + column_count) + 8 * row_width);
+  while (capacity_ > 0 && layout_size(capacity_, false) > PAGE_SIZE) {
+    capacity_--;
+  }
+  live_offset_ = PaxPage::SIZE_PAX_PAGE_HEADER;
+  deleted_offset_ = live_offset_ + BitmapSize(capacity_);
+  layout_size(capacity_, true);
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_id) {
+  memset(GetData(), 0, PAGE_SIZE);
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetPrevPageId(prev_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetSlotCount(0);
+  SetLiveCount(0);
+}
+
+bool PaxPage::WriteSlot(uint32_t slot_num, const Row &row, const PaxLayout &layout) {
+  for (uint32_t i = 0; i < layout.types_.size(); i++) {
+    Field *field = i < row.GetFieldCount() ? row.GetField(i) : nullptr;
+    if (field != nullptr && !field->IsNull() && layout.types_[i] == kTypeChar &&
+        field->GetLength() + sizeof(uint16_t) > layout.widths_[i]) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < layout.types_.size(); i++) {
+    Field *field = i < row.GetFieldCount() ? row.GetField(i) : nullptr;
+    char *value = GetData() + layout.value_offsets_[i] + slot_num * layout.widths_[i];
+    bool is_null = field == nullptr || field->IsNull();
+    SetBit(layout.null_offsets_[i], slot_num, is_null);
+    if (is_null) {
+      memset(value, 0, layout.widths_[i]);
+    } else if (layout.types_[i] == kTypeChar) {
+      MACH_WRITE_TO(uint16_t, value, static_cast<uint16_t>(field->GetLength()));
+      memcpy(value + sizeof(uint16_t), field->GetData(), field->GetLength());
+    } else {
+      field->SerializeTo(value);
+    }
+  }
+  return true;
+}
+
+bool PaxPage::InsertTuple(Row &row, const PaxLayout &layout) {
+  if (GetLiveCount() >= layout.capacity_) {
+    return false;
+  }
+  // reuse a freed slot before taking a new one
+  uint32_t slot_num = GetSlotCount();
+  if (GetLiveCount() < GetSlotCount()) {
+    for (slot_num = 0; slot_num < GetSlotCount(); slot_num++) {
+      if (!GetBit(layout.live_offset_, slot_num)) break;
+    }
+  }
+  if (!WriteSlot(slot_num, row, layout)) {
+    return false;
+  }
+  SetBit(layout.live_offset_, slot_num, true);
+  SetBit(layout.deleted_offset_, slot_num, false);
+  SetLiveCount(GetLiveCount() + 1);
+  if (slot_num == GetSlotCount()) {
+    SetSlotCount(slot_num + 1);
+  }
+  row.SetRowId(RowId(GetTablePageId(), slot_num));
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RowId &rid, const PaxLayout &layout) {
+  if (!IsVisible(rid.GetSlotNum(), layout)) {
+    return false;
+  }
+  SetBit(layout.deleted_offset_, rid.GetSlotNum(), true);
+  return true;
+}
+
+void PaxPage::ApplyDelete(const RowId &rid, const PaxLayout &layout) {
+  uint32_t slot_num = rid.GetSlotNum();
+  ASSERT(slot_num < GetSlotCount(), "Cannot have more slots than tuples.");
+  if (!GetBit(layout.live_offset_, slot_num)) {
+    return;
+  }
+  SetBit(layout.live_offset_, slot_num, false);
+  SetBit(layout.deleted_offset_, slot_num, false);
+  SetLiveCount(GetLiveCount() - 1);
+}
+
+bool PaxPage::CompactSlots(const PaxLayout &layout, std::vector<std::pair<uint32_t, uint32_t>> &moved) {
+  uint32_t slot_count = GetSlotCount();
+  bool changed = false;
+  for (uint32_t i = 0; i < slot_count; i++) {
+    if (GetBit(layout.live_offset_, i) && GetBit(layout.deleted_offset_, i)) {
+      ApplyDelete(RowId(GetTablePageId(), i), layout);
+      changed = true;
+    }
+  }
+  // the first free slot takes the tuple of the last live one
+  uint32_t first = 0;
+  uint32_t last = slot_count;
+  while (true) {
+    while (first < last && GetBit(layout.live_offset_, first)) first++;
+    while (last > first && !GetBit(layout.live_offset_, last - 1)) last--;
+    if (first == last) break;
+    last--;
+    for (uint32_t i = 0; i < layout.types_.size(); i++) {
+      char *values = GetData() + layout.value_offsets_[i];
+      memcpy(values + first * layout.widths_[i], values + last * layout.widths_[i], layout.widths_[i]);
+      SetBit(layout.null_offsets_[i], first, GetBit(layout.null_offsets_[i], last));
+    }
+    SetBit(layout.live_offset_, first, true);
+    SetBit(layout.live_offset_, last, false);
+    moved.emplace_back(last, first);
+  }
+  if (first != slot_count) {
+    SetSlotCount(first);
+    changed = true;
+  }
+  return changed;
+}
+
+void PaxPage::RollbackDelete(const RowId &rid, const PaxLayout &layout) {
+  ASSERT(rid.GetSlotNum() < GetSlotCount(), "We can't have more slots than tuples.");
+  SetBit(layout.deleted_offset_, rid.GetSlotNum(), false);
+}
+
+bool PaxPage::UpdateTuple(const Row &new_row, const RowId &rid, const PaxLayout &layout) {
+  if (!IsVisible(rid.GetSlotNum(), layout)) {
+    return false;
+  }
+  return WriteSlot(rid.GetSlotNum(), new_row, layout);
+}
+
+bool PaxPage::GetTuple(Row *row, Schema *schema, const PaxLayout &layout) {
+  uint32_t slot_num = row->GetRowId().GetSlotNum();
+  if (!IsVisible(slot_num, layout)) {
+    return false;
+  }
+  char buf[PAGE_SIZE];
+  ReadTuple(slot_num, layout, nullptr, buf);
+  row->DeserializeFrom(buf, schema);
+  return true;
+}
+
+uint32_t PaxPage::ReadTuple(uint32_t slot_num, const PaxLayout &layout, const std::vector<uint32_t> *columns,
+                            char *buf) {
+  uint32_t column_count = layout.types_.size();
+  uint32_t var_offset = Row::SlotOffset(column_count, column_count);
+  MACH_WRITE_TO(uint8_t, buf, Row::ROW_FORMAT_VERSION);
+  // everything is null until read from its minipage
+  char *null_bitmap = buf + sizeof(uint8_t);
+  memset(null_bitmap, 0xff, Row::NullBitmapSize(column_count));
+  memset(buf + Row::SlotOffset(column_count, 0), 0, column_count * Row::SLOT_SIZE);
+  uint32_t count = columns == nullptr ? column_count : columns->size();
+  for (uint32_t j = 0; j < count; j++) {
+    uint32_t i = columns == nullptr ? j : (*columns)[j];
+    if (GetBit(layout.null_offsets_[i], slot_num)) {
+      continue;
+    }
+    null_bitmap[i / 8] = static_cast<char>(null_bitmap[i / 8] & ~(1 << (i % 8)));
+    const char *value = GetData() + layout.value_offsets_[i] + slot_num * layout.widths_[i];
+    char *slot = buf + Row::SlotOffset(column_count, i);
+    if (layout.types_[i] == kTypeChar) {
+      uint16_t len = MACH_READ_FROM(uint16_t, value);
+      MACH_WRITE_TO(uint16_t, slot, static_cast<uint16_t>(var_offset));
+      MACH_WRITE_TO(uint16_t, slot + sizeof(uint16_t), len);
+      memcpy(buf + var_offset, value + sizeof(uint16_t), len);
+      var_offset += len;
+    } else {
+      memcpy(slot, value, Row::SLOT_SIZE);
+    }
+  }
+  return var_offset;
+}
+
+void PaxPage::ReadSlotBits(const PaxLayout &layout, const char *nulls, uint32_t first, uint32_t count,
+                           uint64_t *bits) {
+  ASSERT(first % 64 == 0, "Slots are read in whole words.");
+  uint32_t end_byte = BitmapSize(first + count);
+  for (uint32_t w = 0; w * 64 < count; w++) {
+    // the bitmaps are little endian, byte i / 8 holds bit i
+    uint32_t byte = first / 8 + w * 8;
+    uint32_t bytes = std::min<uint32_t>(8, end_byte - byte);
+    uint64_t live = 0;
+    uint64_t deleted = 0;
+    uint64_t null_bits = 0;
+    memcpy(&live, GetData() + layout.live_offset_ + byte, bytes);
+    memcpy(&deleted, GetData() + layout.deleted_offset_ + byte, bytes);
+    if (nulls != nullptr) {
+      memcpy(&null_bits, nulls + byte, bytes);
+    }
+    bits[w] = live & ~deleted & ~null_bits;
+    if (count - w * 64 < 64) {
+      bits[w] &= (uint64_t(1) << (count - w * 64)) - 1;
+    }
+  }
+}
+
+void PaxPage::GetValidSlots(uint32_t column, const PaxLayout &layout, uint32_t first, uint32_t count,
+                            uint64_t *valid) {
+  ReadSlotBits(layout, GetData() + layout.null_offsets_[column], first, count, valid);
+}
+
+void PaxPage::GetVisibleSlots(const PaxLayout &layout, uint32_t first, uint32_t count, uint64_t *visible) {
+  ReadSlotBits(layout, nullptr, first, count, visible);
+}
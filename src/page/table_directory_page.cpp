@@ -0,0 +1,10 @@
+#include "page/table_directory_page.h"
+
+bool TableDirectoryPage::Append(page_id_t page_id) {
+  if (count_ >= MAX_PAGE_COUNT) {
+    return false;
+  }
+  page_ids_[count_] = page_id;
+  count_++;
+  return true;
+}
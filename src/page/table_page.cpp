@@ -96,7 +96,7 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - serialized_size);
     }
   }
   return true;
@@ -131,6 +131,55 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   }
 }
 
+bool TablePage::CompactSlots(std::vector<std::pair<uint32_t, uint32_t>> &moved, Transaction *txn,
+                             LogManager *log_manager) {
+  uint32_t tuple_count = GetTupleCount();
+  bool changed = false;
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    if (GetTupleSize(i) != 0 && IsDeleted(GetTupleSize(i))) {
+      ApplyDelete(RowId(GetTablePageId(), i), txn, log_manager);
+      changed = true;
+    }
+  }
+  // the first empty slot takes the tuple of the last used one
+  uint32_t first = 0;
+  uint32_t last = tuple_count;
+  while (true) {
+    while (first < last && GetTupleSize(first) != 0) first++;
+    while (last > first && GetTupleSize(last - 1) == 0) last--;
+    if (first == last) break;
+    last--;
+    SetTupleOffsetAtSlot(first, GetTupleOffsetAtSlot(last));
+    SetTupleSize(first, GetTupleSize(last));
+    SetTupleOffsetAtSlot(last, 0);
+    SetTupleSize(last, 0);
+    moved.emplace_back(last, first);
+  }
+  if (first != tuple_count) {
+    SetTupleCount(first);
+    changed = true;
+  }
+  return changed;
+}
+
+bool TablePage::FitsInto(TablePage *target, Schema *schema) {
+  uint32_t space = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (IsDeleted(GetTupleSize(i))) {
+      continue;
+    }
+    uint32_t size = GetTupleSize(i);
+    if (Row::IsLegacyFormat(GetData() + GetTupleOffsetAtSlot(i))) {
+      // a legacy row is written in the compact format, which can be larger if it has nulls
+      Row row(INVALID_ROWID);
+      row.DeserializeFrom(GetData() + GetTupleOffsetAtSlot(i), schema);
+      size = row.GetSerializedSize(schema);
+    }
+    space += size + SIZE_TUPLE;
+  }
+  return space <= target->GetFreeSpaceRemaining();
+}
+
 void TablePage::RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
@@ -188,3 +237,10 @@ bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+void TablePage::ConvertLegacyTuple(const char *data, const Schema *schema, std::vector<char> *buf) {
+  Row row(INVALID_ROWID);
+  row.DeserializeFrom(const_cast<char *>(data), const_cast<Schema *>(schema));
+  buf->resize(row.GetSerializedSize(const_cast<Schema *>(schema)));
+  row.SerializeTo(buf->data(), const_cast<Schema *>(schema));
+}
@@ -598,6 +598,33 @@ char *yytext;
 int yywrap();
 
 extern YYSTYPE yylval;
+
+/**
+ * Keywords matched through the identifier rule instead of a rule of their own,
+ * returns 0 if text is an ordinary identifier.
+ */
+static int MinisqlKeywordToken(const char *text) {
+  static const struct {
+    const char *name;
+    int token;
+  } keywords[] = {
+      {"load", LOAD},
+      {"analyze", ANALYZE},
+      {"stats", STATS},
+      {"truncate", TRUNCATE},
+      {"vacuum", VACUUM},
+      {"group", GROUP},
+      {"by", BY},
+      {"order", ORDER},
+      {"asc", ASC},
+      {"desc", DESC},
+      {"limit", LIMIT},
+  };
+  for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+    if (strcmp(text, keywords[i].name) == 0) return keywords[i].token;
+  }
+  return 0;
+}
 #line 585 "../../parser/minisql_lex.c"
 
 #define INITIAL 0
@@ -1182,6 +1209,10 @@ YY_DECL {
 #line 208 "minisql.l"
       {
         MinisqlParserMovePos(yylineno, yytext);
+        int keyword = MinisqlKeywordToken(yytext);
+        if (keyword != 0) {
+          return keyword;
+        }
         yylval.syntax_node = CreateSyntaxNode(kNodeIdentifier, yytext);
         return IDENTIFIER;
       }
@@ -1312,6 +1343,11 @@ YY_DECL {
         YY_RULE_SETUP
 #line 290 "minisql.l"
       {
+        /* the dot of a qualified column, e.g. t.id */
+        if (yytext[0] == '.') {
+          MinisqlParserMovePos(yylineno, yytext);
+          return ('.');
+        }
         char str[128] = {0};
         sprintf(str, "Unrecognized token [%s] in input sql.", yytext);
         MinisqlParserSetError(str);
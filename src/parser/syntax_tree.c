@@ -169,6 +169,28 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeLoad:
+      return "kNodeLoad";
+    case kNodeTableLayout:
+      return "kNodeTableLayout";
+    case kNodeAggregate:
+      return "kNodeAggregate";
+    case kNodeTableList:
+      return "kNodeTableList";
+    case kNodeOrderBy:
+      return "kNodeOrderBy";
+    case kNodeOrderItem:
+      return "kNodeOrderItem";
+    case kNodeLimit:
+      return "kNodeLimit";
+    case kNodeAnalyze:
+      return "kNodeAnalyze";
+    case kNodeShowStats:
+      return "kNodeShowStats";
+    case kNodeTruncateTable:
+      return "kNodeTruncateTable";
+    case kNodeVacuum:
+      return "kNodeVacuum";
     default:
       return "error type";
   }
@@ -0,0 +1,59 @@
+#include "record/data_chunk.h"
+
+#include <cstring>
+
+#include "record/row.h"
+
+DataChunk::DataChunk(const Schema *schema, const std::vector<uint32_t> &columns)
+    : schema_(schema), vectors_(schema->GetColumnCount()) {
+  for (auto column : columns) {
+    if (vectors_[column] != nullptr) continue;
+    columns_.push_back(column);
+    vectors_[column].reset(new ColumnVector());
+    vectors_[column]->type_ = schema->GetColumn(column)->GetType();
+  }
+  memset(visible_, 0, sizeof(visible_));
+}
+
+void DataChunk::Reset(page_id_t page_id, uint32_t first, uint32_t count) {
+  ASSERT(count <= FILTER_VECTOR_SIZE, "A chunk holds at most FILTER_VECTOR_SIZE slots.");
+  page_id_ = page_id;
+  first_slot_ = first;
+  size_ = count;
+  for (auto column : columns_) {
+    vectors_[column]->count_ = count;
+  }
+}
+
+void DataChunk::SerializeTuple(uint32_t index, std::vector<char> &buf) const {
+  uint32_t column_count = schema_->GetColumnCount();
+  uint32_t var_offset = Row::SlotOffset(column_count, column_count);
+  uint32_t size = var_offset;
+  for (auto column : columns_) {
+    if (!IsNull(index, column) && vectors_[column]->type_ == kTypeChar) {
+      size += GetCharLength(index, column);
+    }
+  }
+  buf.resize(size);
+  char *data = buf.data();
+  MACH_WRITE_TO(uint8_t, data, Row::ROW_FORMAT_VERSION);
+  char *null_bitmap = data + sizeof(uint8_t);
+  memset(null_bitmap, 0xff, Row::NullBitmapSize(column_count));
+  memset(data + Row::SlotOffset(column_count, 0), 0, column_count * Row::SLOT_SIZE);
+  for (auto column : columns_) {
+    if (IsNull(index, column)) continue;
+    null_bitmap[column / 8] = static_cast<char>(null_bitmap[column / 8] & ~(1 << (column % 8)));
+    char *slot = data + Row::SlotOffset(column_count, column);
+    if (vectors_[column]->type_ == kTypeChar) {
+      uint32_t len = GetCharLength(index, column);
+      MACH_WRITE_TO(uint16_t, slot, static_cast<uint16_t>(var_offset));
+      MACH_WRITE_TO(uint16_t, slot + sizeof(uint16_t), static_cast<uint16_t>(len));
+      memcpy(data + var_offset, GetChars(index, column), len);
+      var_offset += len;
+    } else if (vectors_[column]->type_ == kTypeInt) {
+      MACH_WRITE_TO(int32_t, slot, GetInt(index, column));
+    } else {
+      MACH_WRITE_TO(float, slot, GetFloat(index, column));
+    }
+  }
+}
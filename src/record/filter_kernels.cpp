@@ -0,0 +1,297 @@
+#include "record/filter_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MINISQL_FILTER_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * The predicates only use <, like the ThreeWay comparison of TupleView, so a NaN float is equal to
+ * everything on every path.
+ */
+template <typename T>
+static void ScalarFilter(const T *values, uint32_t count, CompareOp op, T value, uint64_t *selection) {
+  auto loop = [&](auto pred) {
+    for (uint32_t base = 0; base < count; base += 64) {
+      uint32_t n = std::min(64u, count - base);
+      uint64_t word = 0;
+      for (uint32_t i = 0; i < n; i++) {
+        word |= static_cast<uint64_t>(pred(values[base + i])) << i;
+      }
+      selection[base / 64] = word;
+    }
+  };
+  switch (op) {
+    case kCmpEq:
+      loop([value](T v) { return !(v < value) && !(value < v); });
+      break;
+    case kCmpNe:
+      loop([value](T v) { return v < value || value < v; });
+      break;
+    case kCmpLt:
+      loop([value](T v) { return v < value; });
+      break;
+    case kCmpLe:
+      loop([value](T v) { return !(value < v); });
+      break;
+    case kCmpGt:
+      loop([value](T v) { return value < v; });
+      break;
+    case kCmpGe:
+      loop([value](T v) { return !(v < value); });
+      break;
+    default:
+      memset(selection, 0, SelectionWords(count) * sizeof(uint64_t));
+  }
+}
+
+#ifdef MINISQL_FILTER_X86
+
+/**
+ * Compare lanes x with v, the mask has the bit of every lane which passes. Lt and Nlt are the only
+ * float comparisons, see ScalarFilter.
+ */
+template <CompareOp OP>
+__attribute__((target("avx2"))) static inline int Avx2MaskInt(__m256i x, __m256i v) {
+  if constexpr (OP == kCmpEq) return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, v)));
+  if constexpr (OP == kCmpNe) return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(x, v))) ^ 0xff;
+  if constexpr (OP == kCmpLt) return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, x)));
+  if constexpr (OP == kCmpLe) return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, v))) ^ 0xff;
+  if constexpr (OP == kCmpGt) return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(x, v)));
+  return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, x))) ^ 0xff;
+}
+
+template <CompareOp OP>
+__attribute__((target("avx2"))) static inline int Avx2MaskFloat(__m256 x, __m256 v) {
+  if constexpr (OP == kCmpEq) return _mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_EQ_UQ));
+  if constexpr (OP == kCmpNe) return _mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_NEQ_OQ));
+  if constexpr (OP == kCmpLt) return _mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_LT_OQ));
+  if constexpr (OP == kCmpLe) return _mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_NGT_UQ));
+  if constexpr (OP == kCmpGt) return _mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_GT_OQ));
+  return _mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_NLT_UQ));
+}
+
+template <CompareOp OP>
+__attribute__((target("avx2"))) static void Avx2FilterInt(const int32_t *values, uint32_t count, int32_t value,
+                                                          uint64_t *selection) {
+  __m256i v = _mm256_set1_epi32(value);
+  uint32_t full = count / 64 * 64;
+  for (uint32_t base = 0; base < full; base += 64) {
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < 64; i += 8) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + base + i));
+      word |= static_cast<uint64_t>(Avx2MaskInt<OP>(x, v)) << i;
+    }
+    selection[base / 64] = word;
+  }
+  if (full < count) {
+    ScalarFilter(values + full, count - full, OP, value, selection + full / 64);
+  }
+}
+
+template <CompareOp OP>
+__attribute__((target("avx2"))) static void Avx2FilterFloat(const float *values, uint32_t count, float value,
+                                                            uint64_t *selection) {
+  __m256 v = _mm256_set1_ps(value);
+  uint32_t full = count / 64 * 64;
+  for (uint32_t base = 0; base < full; base += 64) {
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < 64; i += 8) {
+      word |= static_cast<uint64_t>(Avx2MaskFloat<OP>(_mm256_loadu_ps(values + base + i), v)) << i;
+    }
+    selection[base / 64] = word;
+  }
+  if (full < count) {
+    ScalarFilter(values + full, count - full, OP, value, selection + full / 64);
+  }
+}
+
+template <CompareOp OP>
+__attribute__((target("sse4.1"))) static inline int Sse41MaskInt(__m128i x, __m128i v) {
+  if constexpr (OP == kCmpEq) return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, v)));
+  if constexpr (OP == kCmpNe) return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, v))) ^ 0xf;
+  if constexpr (OP == kCmpLt) return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(x, v)));
+  if constexpr (OP == kCmpLe) return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, v))) ^ 0xf;
+  if constexpr (OP == kCmpGt) return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, v)));
+  return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(x, v))) ^ 0xf;
+}
+
+template <CompareOp OP>
+__attribute__((target("sse4.1"))) static inline int Sse41MaskFloat(__m128 x, __m128 v) {
+  if constexpr (OP == kCmpEq) return _mm_movemask_ps(_mm_and_ps(_mm_cmpnlt_ps(x, v), _mm_cmpnlt_ps(v, x)));
+  if constexpr (OP == kCmpNe) return _mm_movemask_ps(_mm_or_ps(_mm_cmplt_ps(x, v), _mm_cmplt_ps(v, x)));
+  if constexpr (OP == kCmpLt) return _mm_movemask_ps(_mm_cmplt_ps(x, v));
+  if constexpr (OP == kCmpLe) return _mm_movemask_ps(_mm_cmpnlt_ps(v, x));
+  if constexpr (OP == kCmpGt) return _mm_movemask_ps(_mm_cmplt_ps(v, x));
+  return _mm_movemask_ps(_mm_cmpnlt_ps(x, v));
+}
+
+template <CompareOp OP>
+__attribute__((target("sse4.1"))) static void Sse41FilterInt(const int32_t *values, uint32_t count, int32_t value,
+                                                             uint64_t *selection) {
+  __m128i v = _mm_set1_epi32(value);
+  uint32_t full = count / 64 * 64;
+  for (uint32_t base = 0; base < full; base += 64) {
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < 64; i += 4) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + base + i));
+      word |= static_cast<uint64_t>(Sse41MaskInt<OP>(x, v)) << i;
+    }
+    selection[base / 64] = word;
+  }
+  if (full < count) {
+    ScalarFilter(values + full, count - full, OP, value, selection + full / 64);
+  }
+}
+
+template <CompareOp OP>
+__attribute__((target("sse4.1"))) static void Sse41FilterFloat(const float *values, uint32_t count, float value,
+                                                               uint64_t *selection) {
+  __m128 v = _mm_set1_ps(value);
+  uint32_t full = count / 64 * 64;
+  for (uint32_t base = 0; base < full; base += 64) {
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < 64; i += 4) {
+      word |= static_cast<uint64_t>(Sse41MaskFloat<OP>(_mm_loadu_ps(values + base + i), v)) << i;
+    }
+    selection[base / 64] = word;
+  }
+  if (full < count) {
+    ScalarFilter(values + full, count - full, OP, value, selection + full / 64);
+  }
+}
+
+/**
+ * Instantiate kernel<OP> for the operator known at runtime.
+ */
+#define DISPATCH_COMPARE_OP(kernel, op, ...)      \
+  switch (op) {                                   \
+    case kCmpEq:                                  \
+      return kernel<kCmpEq>(__VA_ARGS__);         \
+    case kCmpNe:                                  \
+      return kernel<kCmpNe>(__VA_ARGS__);         \
+    case kCmpLt:                                  \
+      return kernel<kCmpLt>(__VA_ARGS__);         \
+    case kCmpLe:                                  \
+      return kernel<kCmpLe>(__VA_ARGS__);         \
+    case kCmpGt:                                  \
+      return kernel<kCmpGt>(__VA_ARGS__);         \
+    case kCmpGe:                                  \
+      return kernel<kCmpGe>(__VA_ARGS__);         \
+    default:                                      \
+      break;                                      \
+  }
+
+#endif  // MINISQL_FILTER_X86
+
+FilterIsa DetectFilterIsa() {
+#ifdef MINISQL_FILTER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return kFilterAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return kFilterSse41;
+  }
+#endif
+  return kFilterScalar;
+}
+
+static FilterIsa &CurrentFilterIsa() {
+  static FilterIsa isa = DetectFilterIsa();
+  return isa;
+}
+
+FilterIsa GetFilterIsa() { return CurrentFilterIsa(); }
+
+bool SetFilterIsa(FilterIsa isa) {
+  if (isa > DetectFilterIsa()) {
+    return false;
+  }
+  CurrentFilterIsa() = isa;
+  return true;
+}
+
+void FilterInt(const int32_t *values, uint32_t count, CompareOp op, int32_t value, uint64_t *selection) {
+#ifdef MINISQL_FILTER_X86
+  if (CurrentFilterIsa() == kFilterAvx2) {
+    DISPATCH_COMPARE_OP(Avx2FilterInt, op, values, count, value, selection)
+  } else if (CurrentFilterIsa() == kFilterSse41) {
+    DISPATCH_COMPARE_OP(Sse41FilterInt, op, values, count, value, selection)
+  }
+#endif
+  ScalarFilter(values, count, op, value, selection);
+}
+
+void FilterFloat(const float *values, uint32_t count, CompareOp op, float value, uint64_t *selection) {
+#ifdef MINISQL_FILTER_X86
+  if (CurrentFilterIsa() == kFilterAvx2) {
+    DISPATCH_COMPARE_OP(Avx2FilterFloat, op, values, count, value, selection)
+  } else if (CurrentFilterIsa() == kFilterSse41) {
+    DISPATCH_COMPARE_OP(Sse41FilterFloat, op, values, count, value, selection)
+  }
+#endif
+  ScalarFilter(values, count, op, value, selection);
+}
+
+void FilterChar(const char *const *values, const uint16_t *lengths, uint32_t count, CompareOp op, const char *value,
+                uint32_t length, uint64_t *selection) {
+  memset(selection, 0, SelectionWords(count) * sizeof(uint64_t));
+  for (uint32_t i = 0; i < count; i++) {
+    int cmp;
+    if (op == kCmpEq || op == kCmpNe) {
+      // no need to order strings of different lengths
+      cmp = lengths[i] != length || memcmp(values[i], value, length) != 0;
+    } else {
+      cmp = memcmp(values[i], value, std::min<uint32_t>(lengths[i], length));
+      if (cmp == 0) cmp = lengths[i] < length ? -1 : (lengths[i] > length ? 1 : 0);
+    }
+    bool pass;
+    switch (op) {
+      case kCmpEq:
+        pass = cmp == 0;
+        break;
+      case kCmpNe:
+        pass = cmp != 0;
+        break;
+      case kCmpLt:
+        pass = cmp < 0;
+        break;
+      case kCmpLe:
+        pass = cmp <= 0;
+        break;
+      case kCmpGt:
+        pass = cmp > 0;
+        break;
+      case kCmpGe:
+        pass = cmp >= 0;
+        break;
+      default:
+        pass = false;
+    }
+    selection[i / 64] |= static_cast<uint64_t>(pass) << (i % 64);
+  }
+}
+
+void FilterVector(const ColumnVector &vector, CompareOp op, const Field &value, uint64_t *selection) {
+  if (value.IsNull()) {
+    memset(selection, 0, SelectionWords(vector.count_) * sizeof(uint64_t));
+    return;
+  }
+  if (vector.type_ == kTypeChar) {
+    FilterChar(vector.chars_, vector.lengths_, vector.count_, op, value.GetData(), value.GetLength(), selection);
+  } else {
+    // int and float constants are serialized as their 4 bytes
+    char constant[sizeof(int32_t)];
+    value.SerializeTo(constant);
+    if (vector.type_ == kTypeInt) {
+      FilterInt(vector.ints_, vector.count_, op, MACH_READ_FROM(int32_t, constant), selection);
+    } else {
+      FilterFloat(vector.floats_, vector.count_, op, MACH_READ_FROM(float, constant), selection);
+    }
+  }
+  SelectionAnd(selection, vector.valid_, vector.count_);
+}
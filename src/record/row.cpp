@@ -1,46 +1,62 @@
 #include "record/row.h"
 #include <iostream>
-/**
- *  Row format:
- * -------------------------------------------
- * | Header | Field | ... | Field-N |
- * -------------------------------------------
- *  Header format:
- * --------------------------------------------
- * | Field Nums | bool * n |
- * -------------------------------------------
- *
- *
- */
 
 uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
-  // replace with your code here
-  char *tmp = buf;
-  //magic_num
-  MACH_WRITE_UINT32(tmp, ROW_MAGIC_NUM);
-  tmp += sizeof(uint32_t);
-  //header
-  MACH_WRITE_UINT32(tmp, fields_.size());
-  tmp += sizeof(uint32_t);
-  size_t i = 0;
+  uint32_t column_count = schema->GetColumnCount();
+  uint32_t var_offset = SlotOffset(column_count, column_count);
+  memset(buf, 0, var_offset);
+  MACH_WRITE_TO(uint8_t, buf, ROW_FORMAT_VERSION);
+  char *null_bitmap = buf + sizeof(uint8_t);
+  for (uint32_t i = 0; i < column_count; i++) {
+    char *slot = buf + SlotOffset(column_count, i);
+    // fields missing from the row are null
+    if (i >= fields_.size() || fields_[i]->IsNull()) {
+      null_bitmap[i / 8] |= static_cast<char>(1 << (i % 8));
+    } else if (schema->GetColumn(i)->GetType() == kTypeChar) {
+      uint16_t len = static_cast<uint16_t>(fields_[i]->GetLength());
+      MACH_WRITE_TO(uint16_t, slot, static_cast<uint16_t>(var_offset));
+      MACH_WRITE_TO(uint16_t, slot + sizeof(uint16_t), len);
+      memcpy(buf + var_offset, fields_[i]->GetData(), len);
+      var_offset += len;
+    } else {
+      fields_[i]->SerializeTo(slot);
+    }
+  }
+  return var_offset;
+}
 
-  for (i = 0; i < fields_.size(); i++) {
-    MACH_WRITE_TO(bool, tmp, fields_[i]->IsNull());
-    tmp += sizeof(bool);
+uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
+  Clear();
+  if (IsLegacyFormat(buf)) {
+    return DeserializeLegacy(buf, schema);
   }
-  //fields
-  for (i = 0; i < fields_.size(); i++) {
-    if (fields_[i]->IsNull() == false) {
-      fields_[i]->SerializeTo(tmp);
-      tmp += fields_[i]->GetSerializedSize();
+  uint32_t column_count = schema->GetColumnCount();
+  uint32_t size = SlotOffset(column_count, column_count);
+  const char *null_bitmap = buf + sizeof(uint8_t);
+  for (uint32_t i = fields_.size(); i < column_count; i++) {
+    fields_.push_back(nullptr);
+  }
+  for (uint32_t i = 0; i < column_count; i++) {
+    TypeId type = schema->GetColumn(i)->GetType();
+    char *slot = buf + SlotOffset(column_count, i);
+    if (null_bitmap[i / 8] & (1 << (i % 8))) {
+      fields_[i] = ALLOC_P(heap_, Field)(type);
+    } else if (type == kTypeChar) {
+      uint16_t offset = MACH_READ_FROM(uint16_t, slot);
+      uint16_t len = MACH_READ_FROM(uint16_t, slot + sizeof(uint16_t));
+      fields_[i] = AllocCharField(buf + offset, len);
+      size += len;
+    } else {
+      Field::DeserializeFrom(slot, type, &fields_[i], false, heap_);
     }
   }
-
-  return tmp - buf;
+  return size;
 }
 
-uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
-  // replace with your code here
+/**
+ * Read a row written before the compact format.
+ */
+uint32_t Row::DeserializeLegacy(char *buf, Schema *schema) {
   char *tmp = buf;
   // magic_num
   if (MACH_READ_UINT32(tmp) != ROW_MAGIC_NUM) std::cerr << "Magic Num vertification failed" << std::endl;
@@ -75,11 +91,32 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
 }
 
 uint32_t Row::GetSerializedSize(Schema *schema) const {
-  // replace with your code here
-  uint32_t ret_val = sizeof(uint32_t) * 2 + sizeof(bool) * fields_.size();
-  size_t i = 0;
-  for (; i < fields_.size();i++) {
-    if (fields_[i]->IsNull() == false) ret_val += fields_[i]->GetSerializedSize();
+  uint32_t column_count = schema->GetColumnCount();
+  uint32_t ret_val = SlotOffset(column_count, column_count);
+  for (uint32_t i = 0; i < column_count && i < fields_.size(); i++) {
+    if (!fields_[i]->IsNull() && schema->GetColumn(i)->GetType() == kTypeChar) {
+      ret_val += fields_[i]->GetLength();
+    }
   }
   return ret_val;
 }
+
+Field *Row::CopyField(const Field &field) {
+  EnsureHeap();
+  if (field.type_id_ == kTypeChar && !field.is_null_) {
+    return AllocCharField(field.value_.chars_, field.len_);
+  }
+  Field *copy = ALLOC_P(heap_, Field)(field.type_id_);
+  copy->value_ = field.value_;
+  copy->len_ = field.len_;
+  copy->is_null_ = field.is_null_;
+  return copy;
+}
+
+Field *Row::AllocCharField(const char *data, uint32_t len) {
+  EnsureHeap();
+  // the heap may hand out nullptr for empty allocations, which would be read as a null field
+  char *chars = static_cast<char *>(heap_->Allocate(len > 0 ? len : 1));
+  memcpy(chars, data, len);
+  return ALLOC_P(heap_, Field)(kTypeChar, chars, len, false);
+}
@@ -0,0 +1,90 @@
+#include "record/tuple_view.h"
+
+#include <algorithm>
+
+CompareOp GetCompareOp(const std::string &oper) {
+  if (oper == "=") return kCmpEq;
+  if (oper == "<>") return kCmpNe;
+  if (oper == "<") return kCmpLt;
+  if (oper == "<=") return kCmpLe;
+  if (oper == ">") return kCmpGt;
+  if (oper == ">=") return kCmpGe;
+  return kCmpInvalid;
+}
+
+template <typename T>
+static inline int ThreeWay(T left, T right) {
+  return left < right ? -1 : (right < left ? 1 : 0);
+}
+
+static inline CmpBool Apply(CompareOp op, int cmp) {
+  switch (op) {
+    case kCmpEq:
+      return GetCmpBool(cmp == 0);
+    case kCmpNe:
+      return GetCmpBool(cmp != 0);
+    case kCmpLt:
+      return GetCmpBool(cmp < 0);
+    case kCmpLe:
+      return GetCmpBool(cmp <= 0);
+    case kCmpGt:
+      return GetCmpBool(cmp > 0);
+    case kCmpGe:
+      return GetCmpBool(cmp >= 0);
+    default:
+      return kNull;
+  }
+}
+
+CmpBool TupleView::Compare(uint32_t idx, CompareOp op, const Field &value) const {
+  if (IsNull(idx) || value.IsNull()) {
+    return kNull;
+  }
+  switch (value.type_id_) {
+    case kTypeInt:
+      return Apply(op, ThreeWay(GetInt(idx), value.value_.integer_));
+    case kTypeFloat:
+      return Apply(op, ThreeWay(GetFloat(idx), value.value_.float_));
+    case kTypeChar: {
+      // same order as TypeChar, a prefix is less than the longer string
+      uint32_t len = GetCharLength(idx);
+      int cmp = memcmp(GetChars(idx), value.value_.chars_, std::min(len, value.len_));
+      if (cmp == 0) cmp = ThreeWay(len, value.len_);
+      return Apply(op, cmp);
+    }
+    default:
+      return kNull;
+  }
+}
+
+uint32_t TupleView::GetSize() const {
+  uint32_t column_count = schema_->GetColumnCount();
+  uint32_t size = Row::SlotOffset(column_count, column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    if (schema_->GetColumn(i)->GetType() == kTypeChar && !IsNull(i)) {
+      size += GetCharLength(i);
+    }
+  }
+  return size;
+}
+
+void TupleView::Materialize(Row *row) const {
+  row->SetRowId(rid_);
+  row->DeserializeFrom(const_cast<char *>(data_), const_cast<Schema *>(schema_));
+}
+
+void TupleView::Project(const std::vector<uint32_t> &columns, Row *row) const {
+  for (auto column : columns) {
+    TypeId type = schema_->GetColumn(column)->GetType();
+    if (IsNull(column)) {
+      row->AppendField(Field(type));
+    } else if (type == kTypeInt) {
+      row->AppendField(Field(type, GetInt(column)));
+    } else if (type == kTypeFloat) {
+      row->AppendField(Field(type, GetFloat(column)));
+    } else {
+      // points into the page, copied by AppendField
+      row->AppendField(Field(type, const_cast<char *>(GetChars(column)), GetCharLength(column), false));
+    }
+  }
+}
@@ -0,0 +1,230 @@
+#include "server/server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "glog/logging.h"
+
+static bool WriteAll(int fd, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+static bool ReadAll(int fd, char *data, size_t size) {
+  while (size > 0) {
+    ssize_t n = recv(fd, data, size, 0);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+bool SendFrame(int fd, const std::string &payload) {
+  uint32_t len = htonl(static_cast<uint32_t>(payload.size()));
+  return WriteAll(fd, reinterpret_cast<char *>(&len), sizeof(len)) && WriteAll(fd, payload.data(), payload.size());
+}
+
+bool RecvFrame(int fd, std::string &payload) {
+  uint32_t len;
+  if (!ReadAll(fd, reinterpret_cast<char *>(&len), sizeof(len))) {
+    return false;
+  }
+  len = ntohl(len);
+  if (len > MAX_FRAME_SIZE) {
+    return false;
+  }
+  payload.resize(len);
+  return ReadAll(fd, &payload[0], len);
+}
+
+MiniSqlServer::MiniSqlServer(ExecuteEngine *engine, uint32_t num_workers)
+    : engine_(engine),
+      num_workers_(num_workers == 0 ? 1 : num_workers),
+      session_fds_(num_workers_, -1) {}
+
+MiniSqlServer::~MiniSqlServer() {
+  Shutdown();
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+  }
+  if (!unix_path_.empty()) {
+    unlink(unix_path_.c_str());
+  }
+}
+
+bool MiniSqlServer::ListenTcp(uint16_t port) {
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    LOG(ERROR) << "socket: " << strerror(errno);
+    return false;
+  }
+  int on = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, 64) < 0) {
+    LOG(ERROR) << "listen on 127.0.0.1:" << port << ": " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool MiniSqlServer::ListenUnix(const std::string &path) {
+  sockaddr_un addr{};
+  if (path.size() >= sizeof(addr.sun_path)) {
+    LOG(ERROR) << "socket path too long: " << path;
+    return false;
+  }
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd_ < 0) {
+    LOG(ERROR) << "socket: " << strerror(errno);
+    return false;
+  }
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  unlink(path.c_str());
+  if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, 64) < 0) {
+    LOG(ERROR) << "listen on " << path << ": " << strerror(errno);
+    return false;
+  }
+  unix_path_ = path;
+  return true;
+}
+
+void MiniSqlServer::Run() {
+  for (uint32_t i = 0; i < num_workers_; i++) {
+    workers_.emplace_back(&MiniSqlServer::WorkerLoop, this, i);
+  }
+  while (!stopped_) {
+    int client_fd = accept(listen_fd_, nullptr, nullptr);
+    if (client_fd < 0) {
+      if (errno == EINTR && !stopped_) continue;
+      break;
+    }
+    // only the accepting thread adds sessions, the count can only drop behind the check
+    if (sessions_ >= num_workers_) {
+      RejectSession(client_fd);
+      continue;
+    }
+    sessions_++;
+    std::lock_guard<std::mutex> guard(pending_latch_);
+    pending_.push(client_fd);
+    pending_cv_.notify_one();
+  }
+  stopped_ = true;
+  pending_cv_.notify_all();
+  WakeSessions();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void MiniSqlServer::Shutdown() {
+  stopped_ = true;
+  // accept returns, the sessions are woken by Run: taking session_latch_ is not safe in a signal handler
+  if (listen_fd_ >= 0) {
+    shutdown(listen_fd_, SHUT_RDWR);
+  }
+}
+
+void MiniSqlServer::WakeSessions() {
+  // the fds are still open under the latch, sessions picked up later see stopped_
+  std::lock_guard<std::mutex> guard(session_latch_);
+  for (auto client_fd : session_fds_) {
+    if (client_fd >= 0) {
+      shutdown(client_fd, SHUT_RDWR);
+    }
+  }
+}
+
+void MiniSqlServer::RejectSession(int client_fd) {
+  std::string reply(1, kReplyError);
+  reply += "Too many sessions, the server serves at most " + std::to_string(num_workers_) + " at a time\n";
+  SendFrame(client_fd, reply);
+  // the client reads the reply after sending its first request, which is dropped unread
+  shutdown(client_fd, SHUT_WR);
+  close(client_fd);
+}
+
+void MiniSqlServer::WorkerLoop(uint32_t worker_id) {
+  while (true) {
+    int client_fd;
+    {
+      std::unique_lock<std::mutex> lock(pending_latch_);
+      pending_cv_.wait(lock, [this] { return stopped_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        return;
+      }
+      client_fd = pending_.front();
+      pending_.pop();
+    }
+    {
+      std::lock_guard<std::mutex> guard(session_latch_);
+      session_fds_[worker_id] = client_fd;
+    }
+    ServeSession(client_fd);
+    {
+      // closed under the latch, WakeSessions never shuts down an fd number reused by another connection
+      std::lock_guard<std::mutex> guard(session_latch_);
+      session_fds_[worker_id] = -1;
+      close(client_fd);
+    }
+    sessions_--;
+  }
+}
+
+void MiniSqlServer::ServeSession(int client_fd) {
+  ExecuteEngine session(engine_);
+  std::string request;
+  std::string reply;
+  while (!stopped_ && RecvFrame(client_fd, request)) {
+    reply.clear();
+    reply.push_back(kReplyOk);
+    ReplyStatus status = ExecuteStatement(session, request, reply);
+    reply[0] = status;
+    if (!SendFrame(client_fd, reply) || status == kReplyBye) {
+      break;
+    }
+  }
+}
+
+ReplyStatus MiniSqlServer::ExecuteStatement(ExecuteEngine &session, const std::string &sql, std::string &reply) {
+  std::ostringstream output;
+  ExecuteContext context;
+  dberr_t ret;
+  {
+    std::lock_guard<std::mutex> guard(execute_latch_);
+    // executors report to the standard streams, redirect them into this session's reply
+    auto *old_out = std::cout.rdbuf(output.rdbuf());
+    auto *old_err = std::cerr.rdbuf(output.rdbuf());
+    ret = session.ExecuteSql(sql.c_str(), &context);
+    std::cout.rdbuf(old_out);
+    std::cerr.rdbuf(old_err);
+  }
+  reply += output.str();
+  if (context.flag_quit_) {
+    return kReplyBye;
+  }
+  return ret == DB_SUCCESS ? kReplyOk : kReplyError;
+}
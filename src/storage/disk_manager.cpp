@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 #include <sys/stat.h>
 
@@ -88,13 +89,44 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
   inner_offset = logical_page_id % BITMAP_SIZE;
   bitmap_phy_id = 1 + i * (BITMAP_SIZE + 1);
   ReadPhysicalPage(bitmap_phy_id, (char *)&page);
-  page.DeAllocatePage(inner_offset);
+  if (!page.DeAllocatePage(inner_offset)) {
+    return;
+  }
   WritePhysicalPage(bitmap_phy_id, (char *)&page);
-  // edit the file meta-data
+  // edit the file meta-data, an empty extent keeps its bitmap page and stays counted
   (meta->extent_used_page_[i])--;
   (meta->num_allocated_pages_)--;
-  if (meta->extent_used_page_[i]==0) meta->num_extents_--;
+}
 
+void DiskManager::DeAllocatePages(std::vector<page_id_t> logical_page_ids) {
+  DiskFileMetaPage *meta = (DiskFileMetaPage *)meta_data_;
+  BitmapPage<PAGE_SIZE> page;
+  std::sort(logical_page_ids.begin(), logical_page_ids.end());
+  size_t begin = 0;
+  while (begin < logical_page_ids.size() && logical_page_ids[begin] < 0) {
+    begin++;
+  }
+  while (begin < logical_page_ids.size()) {
+    // the pages of one extent
+    uint32_t i = logical_page_ids[begin] / BITMAP_SIZE;
+    size_t end = begin;
+    while (end < logical_page_ids.size() && logical_page_ids[end] / BITMAP_SIZE == i) {
+      end++;
+    }
+    page_id_t bitmap_phy_id = 1 + i * (BITMAP_SIZE + 1);
+    ReadPhysicalPage(bitmap_phy_id, (char *)&page);
+    uint32_t freed = 0;
+    for (; begin < end; begin++) {
+      freed += page.DeAllocatePage(logical_page_ids[begin] % BITMAP_SIZE) ? 1 : 0;
+    }
+    if (freed == 0) {
+      continue;
+    }
+    WritePhysicalPage(bitmap_phy_id, (char *)&page);
+    // edit the extent and file meta-data
+    meta->extent_used_page_[i] -= freed;
+    meta->num_allocated_pages_ -= freed;
+  }
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
@@ -4,14 +4,119 @@
 page_id_t TableHeap::AllocateNewTablePage(page_id_t last_page_id, BufferPoolManager *buffer_pool_manager_, Transaction *txn,
                           LockManager *lock_manager, LogManager *log_manager) {
   page_id_t new_page_id = INVALID_PAGE_ID;
-  TablePage *new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
-  new_page->Init(new_page_id, last_page_id, log_manager, txn);
-  new_page->SetNextPageId(INVALID_PAGE_ID);
+  Page *new_page = buffer_pool_manager_->NewPage(new_page_id);
+  InitPage(new_page, new_page_id, last_page_id, txn);
+  // both layouts keep the next page id at the same place
   ((TablePage *)buffer_pool_manager_->FetchPage(last_page_id))->SetNextPageId(new_page_id);
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
   buffer_pool_manager_->UnpinPage(new_page_id, true);
+  last_page_id_ = new_page_id;
+  AppendToDirectory(new_page_id);
   return new_page_id;
 }
 
+void TableHeap::AppendToDirectory(page_id_t page_id) {
+  // a table without a directory finds its pages by walking the chain
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  if (!page_ids_.empty()) {
+    page_ids_.push_back(page_id);
+  }
+  if (last_directory_page_id_ == INVALID_PAGE_ID) {
+    last_directory_page_id_ = directory_page_id_;
+    while (true) {
+      auto directory =
+          reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(last_directory_page_id_)->GetData());
+      page_id_t next_page_id = directory->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(last_directory_page_id_, false);
+      if (next_page_id == INVALID_PAGE_ID) break;
+      last_directory_page_id_ = next_page_id;
+    }
+  }
+  auto directory =
+      reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(last_directory_page_id_)->GetData());
+  if (!directory->Append(page_id)) {
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    auto new_directory =
+        reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->NewPage(new_page_id)->GetData());
+    new_directory->Init();
+    new_directory->Append(page_id);
+    directory->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    buffer_pool_manager_->UnpinPage(last_directory_page_id_, true);
+    last_directory_page_id_ = new_page_id;
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(last_directory_page_id_, true);
+}
+
+page_id_t TableHeap::BuildPageDirectory() {
+  directory_page_id_ = INVALID_PAGE_ID;
+  page_ids_.clear();
+  std::vector<page_id_t> page_ids = GetPageIds();
+  auto directory = reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->NewPage(directory_page_id_)->GetData());
+  directory->Init();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  last_directory_page_id_ = directory_page_id_;
+  page_ids_.clear();
+  for (auto page_id : page_ids) {
+    AppendToDirectory(page_id);
+  }
+  page_ids_ = std::move(page_ids);
+  return directory_page_id_;
+}
+
+void TableHeap::InitPage(Page *page, page_id_t page_id, page_id_t prev_id, Transaction *txn) {
+  if (layout_ == kLayoutPax) {
+    reinterpret_cast<PaxPage *>(page)->Init(page_id, prev_id);
+  } else {
+    reinterpret_cast<TablePage *>(page)->Init(page_id, prev_id, log_manager_, txn);
+  }
+}
+
+bool TableHeap::InsertIntoPage(Page *page, Row &row, Transaction *txn) {
+  if (layout_ == kLayoutPax) {
+    return reinterpret_cast<PaxPage *>(page)->InsertTuple(row, *pax_layout_);
+  }
+  return reinterpret_cast<TablePage *>(page)->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+}
+
+uint32_t TableHeap::GetSlotCount(Page *page) const {
+  if (layout_ == kLayoutPax) {
+    return reinterpret_cast<PaxPage *>(page)->GetSlotCount();
+  }
+  return reinterpret_cast<TablePage *>(page)->GetTupleCount();
+}
+
+bool TableHeap::HasTuple(Page *page, uint32_t slot_num) const {
+  if (layout_ == kLayoutPax) {
+    return reinterpret_cast<PaxPage *>(page)->IsVisible(slot_num, *pax_layout_);
+  }
+  return reinterpret_cast<TablePage *>(page)->HasTuple(slot_num);
+}
+
+RowId TableHeap::FindTuple(page_id_t page_id, uint32_t slot_num) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      break;
+    }
+    uint32_t slot_count = GetSlotCount(page);
+    for (; slot_num < slot_count; slot_num++) {
+      if (HasTuple(page, slot_num)) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return RowId(page_id, slot_num);
+      }
+    }
+    page_id_t next_page_id = reinterpret_cast<TablePage *>(page)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    slot_num = 0;
+  }
+  return INVALID_ROWID;
+}
+
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
   //first edition. not take the transaction into consideration
   //first edition. suppose one record can be stored into one page
@@ -21,8 +126,7 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
   page_id_t page_old = INVALID_PAGE_ID;
   page_id_t page_now = first_page_id_;
   while (page_now!=INVALID_PAGE_ID) {
-    if (reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_now))
-            ->InsertTuple(row, schema_, txn, lock_manager_, log_manager_) == false) {
+    if (InsertIntoPage(buffer_pool_manager_->FetchPage(page_now), row, txn) == false) {
       page_old = page_now;
       page_now = ((TablePage *)buffer_pool_manager_->FetchPage(page_now))->GetNextPageId();
       buffer_pool_manager_->UnpinPage(page_old, false);
@@ -36,9 +140,8 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
   //allocate new page
   if (page_now==INVALID_PAGE_ID) {
     page_now = AllocateNewTablePage(page_old, buffer_pool_manager_, txn, lock_manager_, log_manager_);
-    if (((TablePage *)buffer_pool_manager_->FetchPage(page_now))
-            ->InsertTuple(row, schema_, txn, lock_manager_, log_manager_) == false) {
-      buffer_pool_manager_->UnpinPage(page_old, false);
+    if (InsertIntoPage(buffer_pool_manager_->FetchPage(page_now), row, txn) == false) {
+      buffer_pool_manager_->UnpinPage(page_now, false);
       return false;
     }
   }
@@ -47,6 +150,47 @@ bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
   return true;
 }
 
+bool TableHeap::AppendTuples(std::vector<Row> &rows, Transaction *txn) {
+  // the hint may be stale if another page was chained behind it
+  page_id_t page_id = last_page_id_ == INVALID_PAGE_ID ? first_page_id_ : last_page_id_;
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  while (page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  }
+  bool page_dirty = false;
+  for (auto &row : rows) {
+    if (InsertIntoPage(page, row, txn)) {
+      page_dirty = true;
+      continue;
+    }
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+    if (new_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, page_dirty);
+      return false;
+    }
+    InitPage(new_page, new_page_id, page_id, txn);
+    page->SetNextPageId(new_page_id);
+    AppendToDirectory(new_page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page_id = new_page_id;
+    page = new_page;
+    page_dirty = true;
+    if (!InsertIntoPage(page, row, txn)) {
+      // the tuple does not fit into an empty page
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      last_page_id_ = page_id;
+      return false;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, page_dirty);
+  last_page_id_ = page_id;
+  return true;
+}
+
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -56,20 +200,41 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (layout_ == kLayoutPax) {
+    reinterpret_cast<PaxPage *>(page)->MarkDelete(rid, *pax_layout_);
+  } else {
+    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   return true;
 }
 
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
+  if (layout_ == kLayoutPax) {
+    // values have a fixed size, a valid update always stays in place
+    auto page = reinterpret_cast<PaxPage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    bool updated = page->UpdateTuple(row, rid, *pax_layout_);
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), updated);
+    if (updated) {
+      row.SetRowId(rid);
+    }
+    return updated;
+  }
   Row old_row(rid);
 
   if (((TablePage *)buffer_pool_manager_->FetchPage(rid.GetPageId()))
           ->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_) == false) {
-
-    MarkDelete(rid, txn); //this will call unpin
-    return InsertTuple(row, txn); // this will call unpin
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    // the tuple moves to a page with room for it, or stays as it is if there is none
+    if (!MarkDelete(rid, txn)) {
+      return false;
+    }
+    if (!InsertTuple(row, txn)) {
+      RollbackDelete(rid, txn);
+      return false;
+    }
+    return true;
   }
 
   //update success
@@ -82,7 +247,12 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step1: Find the page which contains the tuple.
   TablePage *the_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // Step2: Delete the tuple from the page.
-  the_page->ApplyDelete(rid, txn, log_manager_);
+  if (layout_ == kLayoutPax) {
+    reinterpret_cast<PaxPage *>(the_page)->ApplyDelete(rid, *pax_layout_);
+  } else {
+    the_page->ApplyDelete(rid, txn, log_manager_);
+  }
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
 
   /*
   * //not to delete the page
@@ -128,41 +298,322 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   assert(page != nullptr);
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  if (layout_ == kLayoutPax) {
+    reinterpret_cast<PaxPage *>(page)->RollbackDelete(rid, *pax_layout_);
+  } else {
+    page->RollbackDelete(rid, txn, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
+bool TableHeap::MigrateRowFormat(std::vector<std::pair<RowId, RowId>> &moved, Transaction *txn) {
+  // PAX pages are always read into compact rows
+  if (layout_ == kLayoutPax) {
+    return true;
+  }
+  std::vector<RowId> grown;  // rows which no longer fit into their slot once rewritten
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    bool page_dirty = false;
+    RowId rid;
+    for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+      if (!page->IsLegacyTuple(rid.GetSlotNum())) continue;
+      Row row(rid);
+      Row old_row(rid);
+      page->GetTuple(&row, schema_, txn, lock_manager_);
+      if (page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_)) {
+        page_dirty = true;
+      } else {
+        grown.push_back(rid);
+      }
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, page_dirty);
+    page_id = next_page_id;
+  }
+  for (auto &rid : grown) {
+    Row row(rid);
+    GetTuple(&row, txn);
+    // the normal update path moves the row to a page with room for it
+    if (!UpdateTuple(row, rid, txn)) {
+      return false;
+    }
+    if (!(row.GetRowId() == rid)) {
+      ApplyDelete(rid, txn);
+      moved.emplace_back(rid, row.GetRowId());
+    }
+  }
+  return true;
+}
+
 void TableHeap::FreeHeap() {
-  page_id_t page_now = first_page_id_;
-  page_id_t page_old = INVALID_PAGE_ID;
-  TablePage *the_page = nullptr;
-  while (page_now != INVALID_PAGE_ID) {
-    page_old = page_now;
-    the_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_old));
-    page_now = the_page->GetNextPageId();
-    buffer_pool_manager_->UnpinPage(page_old, true);
-    buffer_pool_manager_->DeletePage(page_old);
+  std::vector<page_id_t> pages = GetPageIds();
+  std::vector<page_id_t> directory_pages = GetDirectoryPageIds();
+  pages.insert(pages.end(), directory_pages.begin(), directory_pages.end());
+  buffer_pool_manager_->DeletePages(pages);
+  last_page_id_ = INVALID_PAGE_ID;
+  page_ids_.clear();
+  directory_page_id_ = INVALID_PAGE_ID;
+  last_directory_page_id_ = INVALID_PAGE_ID;
+}
+
+void TableHeap::Truncate(Transaction *txn) {
+  std::vector<page_id_t> pages(GetPageIds().begin() + 1, GetPageIds().end());
+  buffer_pool_manager_->DeletePages(pages);
+  // the first page and the first directory page stay, the table metadata does not change
+  InitPage(buffer_pool_manager_->FetchPage(first_page_id_), first_page_id_, INVALID_PAGE_ID, txn);
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  RewriteDirectory({first_page_id_});
+}
+
+uint32_t TableHeap::Vacuum(std::vector<std::pair<RowId, RowId>> &moved, Transaction *txn) {
+  std::vector<page_id_t> page_ids = GetPageIds();
+  std::vector<page_id_t> kept;
+  std::vector<page_id_t> freed;
+  std::vector<std::pair<uint32_t, uint32_t>> slots;
+  // the last kept page, which takes the tuples of the pages behind it while they fit
+  Page *target = nullptr;
+  bool target_dirty = false;
+  for (auto page_id : page_ids) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (target != nullptr && FitsInto(page, target)) {
+      size_t first_moved = moved.size();
+      bool merged = true;
+      uint32_t slot_count = GetSlotCount(page);
+      for (uint32_t slot = 0; slot < slot_count && merged; slot++) {
+        if (!HasTuple(page, slot)) continue;
+        Row row(RowId(page_id, slot));
+        GetTuple(&row, txn);
+        merged = InsertIntoPage(target, row, txn);
+        if (merged) {
+          moved.emplace_back(RowId(page_id, slot), row.GetRowId());
+        }
+      }
+      target_dirty = target_dirty || moved.size() > first_moved;
+      if (merged) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        freed.push_back(page_id);
+        continue;
+      }
+      // the page is kept after all, the copies of its tuples are removed from target again
+      for (size_t i = first_moved; i < moved.size(); i++) {
+        if (layout_ == kLayoutPax) {
+          reinterpret_cast<PaxPage *>(target)->ApplyDelete(moved[i].second, *pax_layout_);
+        } else {
+          reinterpret_cast<TablePage *>(target)->ApplyDelete(moved[i].second, txn, log_manager_);
+        }
+      }
+      moved.erase(moved.begin() + first_moved, moved.end());
+    }
+    // the page is kept, its tuples move to the front of its slot array
+    slots.clear();
+    bool dirty = layout_ == kLayoutPax ? reinterpret_cast<PaxPage *>(page)->CompactSlots(*pax_layout_, slots)
+                                       : reinterpret_cast<TablePage *>(page)->CompactSlots(slots, txn, log_manager_);
+    for (auto &slot : slots) {
+      moved.emplace_back(RowId(page_id, slot.first), RowId(page_id, slot.second));
+    }
+    if (target != nullptr) {
+      buffer_pool_manager_->UnpinPage(kept.back(), target_dirty);
+    }
+    target = page;
+    target_dirty = dirty;
+    kept.push_back(page_id);
+  }
+  buffer_pool_manager_->UnpinPage(kept.back(), target_dirty);
+  if (freed.empty()) {
+    return 0;
+  }
+  // chain the kept pages, both layouts keep the page ids at the same place
+  for (size_t i = 0; i < kept.size(); i++) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(kept[i]));
+    page_id_t prev_page_id = i == 0 ? INVALID_PAGE_ID : kept[i - 1];
+    page_id_t next_page_id = i + 1 == kept.size() ? INVALID_PAGE_ID : kept[i + 1];
+    bool relinked = page->GetPrevPageId() != prev_page_id || page->GetNextPageId() != next_page_id;
+    page->SetPrevPageId(prev_page_id);
+    page->SetNextPageId(next_page_id);
+    buffer_pool_manager_->UnpinPage(kept[i], relinked);
+  }
+  buffer_pool_manager_->DeletePages(freed);
+  RewriteDirectory(kept);
+  return freed.size();
+}
+
+bool TableHeap::FitsInto(Page *page, Page *target) {
+  if (layout_ == kLayoutPax) {
+    uint32_t count = 0;
+    for (uint32_t slot = 0; slot < GetSlotCount(page); slot++) {
+      count += HasTuple(page, slot) ? 1 : 0;
+    }
+    return count + reinterpret_cast<PaxPage *>(target)->GetLiveCount() <= pax_layout_->capacity_;
   }
+  return reinterpret_cast<TablePage *>(page)->FitsInto(reinterpret_cast<TablePage *>(target), schema_);
+}
+
+void TableHeap::RewriteDirectory(const std::vector<page_id_t> &page_ids) {
+  last_page_id_ = page_ids.back();
+  page_ids_.clear();
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  std::vector<page_id_t> directory_pages = GetDirectoryPageIds();
+  buffer_pool_manager_->DeletePages(std::vector<page_id_t>(directory_pages.begin() + 1, directory_pages.end()));
+  auto directory =
+      reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+  directory->Init();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  last_directory_page_id_ = directory_page_id_;
+  for (auto page_id : page_ids) {
+    AppendToDirectory(page_id);
+  }
+}
+
+std::vector<page_id_t> TableHeap::GetDirectoryPageIds() const {
+  std::vector<page_id_t> pages;
+  for (page_id_t page_id = directory_page_id_; page_id != INVALID_PAGE_ID;) {
+    pages.push_back(page_id);
+    page_id = reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData())
+                  ->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(pages.back(), false);
+  }
+  return pages;
+}
+
+const std::vector<page_id_t> &TableHeap::GetPageIds() const {
+  if (directory_page_id_ != INVALID_PAGE_ID) {
+    // appends keep the loaded directory up to date
+    for (page_id_t page_id = page_ids_.empty() ? directory_page_id_ : INVALID_PAGE_ID; page_id != INVALID_PAGE_ID;) {
+      auto directory =
+          reinterpret_cast<TableDirectoryPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+      for (uint32_t i = 0; i < directory->GetPageCount(); i++) {
+        page_ids_.push_back(directory->GetPageId(i));
+      }
+      page_id_t next_page_id = directory->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    return page_ids_;
+  }
+  page_id_t page_id = first_page_id_;
+  if (!page_ids_.empty()) {
+    // pages are only ever appended behind the last one
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids_.back()));
+    page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_ids_.back(), false);
+  }
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids_.push_back(page_id);
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_ids_.back(), false);
+  }
+  return page_ids_;
 }
 
 bool TableHeap::GetTuple(Row *row, Transaction *txn) {
-  TablePage *tp_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
-  tp_ptr->GetTuple(row, schema_, txn, lock_manager_);
+  Page *page = buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId());
+  if (page == nullptr) {
+    return false;
+  }
+  bool found = layout_ == kLayoutPax
+                   ? reinterpret_cast<PaxPage *>(page)->GetTuple(row, schema_, *pax_layout_)
+                   : reinterpret_cast<TablePage *>(page)->GetTuple(row, schema_, txn, lock_manager_);
   //will not edit the page
   buffer_pool_manager_->UnpinPage(row->GetRowId().GetPageId(), false);
-  return true;
+  return found;
+}
+
+void TableHeap::LoadChunk(Page *page, DataChunk *chunk, const std::vector<uint32_t> &columns) const {
+  uint32_t first = chunk->GetRowId(0).GetSlotNum();
+  uint32_t count = chunk->GetSize();
+  if (layout_ == kLayoutPax) {
+    // int and float minipages are used in place
+    auto pax_page = reinterpret_cast<PaxPage *>(page);
+    pax_page->GetVisibleSlots(*pax_layout_, first, count, chunk->GetVisible());
+    for (auto column : columns) {
+      ColumnVector &vector = chunk->GetColumn(column);
+      const char *values = pax_page->GetValues(column, *pax_layout_) + first * pax_layout_->widths_[column];
+      pax_page->GetValidSlots(column, *pax_layout_, first, count, vector.valid_);
+      if (vector.type_ == kTypeInt) {
+        vector.ints_ = reinterpret_cast<const int32_t *>(values);
+      } else if (vector.type_ == kTypeFloat) {
+        vector.floats_ = reinterpret_cast<const float *>(values);
+      } else {
+        for (uint32_t i = 0; i < count; i++, values += pax_layout_->widths_[column]) {
+          vector.lengths_[i] = MACH_READ_FROM(uint16_t, values);
+          vector.chars_[i] = values + sizeof(uint16_t);
+        }
+      }
+    }
+    return;
+  }
+  // one pass over the tuples of the row page decodes all the columns, the slot offset and the
+  // null bit of every column are looked up once per chunk
+  struct Target {
+    ColumnVector *vector_;
+    uint32_t null_byte_;
+    uint8_t null_mask_;
+    uint32_t slot_;
+  };
+  uint32_t column_count = schema_->GetColumnCount();
+  std::vector<Target> targets;
+  targets.reserve(columns.size());
+  for (auto column : columns) {
+    ColumnVector &vector = chunk->GetColumn(column);
+    vector.ints_ = vector.buffer_.ints;
+    vector.floats_ = vector.buffer_.floats;
+    memset(vector.valid_, 0, SelectionWords(count) * sizeof(uint64_t));
+    targets.push_back({&vector, static_cast<uint32_t>(sizeof(uint8_t) + column / 8),
+                       static_cast<uint8_t>(1 << (column % 8)), Row::SlotOffset(column_count, column)});
+  }
+  auto table_page = reinterpret_cast<TablePage *>(page);
+  uint64_t *visible = chunk->GetVisible();
+  memset(visible, 0, SelectionWords(count) * sizeof(uint64_t));
+  TupleView view;
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t bit = uint64_t(1) << (i % 64);
+    if (!table_page->GetTupleView(first + i, schema_, &view, &chunk->GetScratch(i))) {
+      for (auto &target : targets) {
+        target.vector_->buffer_.ints[i] = 0;
+        target.vector_->lengths_[i] = 0;
+      }
+      continue;
+    }
+    visible[i / 64] |= bit;
+    const char *data = view.GetData();
+    for (auto &target : targets) {
+      ColumnVector *vector = target.vector_;
+      const char *slot = data + target.slot_;
+      if ((static_cast<uint8_t>(data[target.null_byte_]) & target.null_mask_) != 0) {
+        vector->buffer_.ints[i] = 0;
+        vector->lengths_[i] = 0;
+      } else if (vector->type_ == kTypeChar) {
+        vector->valid_[i / 64] |= bit;
+        vector->chars_[i] = data + MACH_READ_FROM(uint16_t, slot);
+        vector->lengths_[i] = MACH_READ_FROM(uint16_t, slot + sizeof(uint16_t));
+      } else {
+        // int and float have the same 4 byte slot
+        vector->valid_[i / 64] |= bit;
+        vector->buffer_.ints[i] = MACH_READ_FROM(int32_t, slot);
+      }
+    }
+  }
+}
+
+void TableHeap::FilterScan(uint32_t column, CompareOp op, const Field &value, std::vector<RowId> &result) const {
+  uint64_t selection[FILTER_VECTOR_SIZE / 64];
+  for (auto iter = ChunkBegin({column}); !iter.IsEnd(); ++iter) {
+    const DataChunk &chunk = *iter;
+    FilterVector(chunk.GetColumn(column), op, value, selection);
+    ForEachSelected(selection, chunk.GetSize(), [&](uint32_t i) { result.push_back(chunk.GetRowId(i)); });
+  }
 }
 
 TableIterator TableHeap::Begin(Transaction *txn) {
-  RowId tmp = INVALID_ROWID;
-  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_))->GetFirstTupleRid(&tmp);
-  if (tmp.GetPageId() != INVALID_PAGE_ID)
-    buffer_pool_manager_->UnpinPage(tmp.GetPageId(), false);
-  return TableIterator(tmp, buffer_pool_manager_, schema_, log_manager_, lock_manager_);
+  return TableIterator(this, FindTuple(first_page_id_, 0));
 }
 
 TableIterator TableHeap::End() {
-  RowId tmp = INVALID_ROWID;
-  return TableIterator(tmp, buffer_pool_manager_, schema_, log_manager_, lock_manager_);
+  return TableIterator(this, INVALID_ROWID);
 }
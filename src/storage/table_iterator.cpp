@@ -1,135 +1,233 @@
+#include <algorithm>
+
 #include "common/macros.h"
 #include "storage/table_iterator.h"
 #include "storage/table_heap.h"
 
-TableIterator::TableIterator(RowId record_id_first, BufferPoolManager *buffer_pool_manager, Schema *schema,
-                             LogManager *log_manager, LockManager *lock_manager)
-    : buffer_pool_manager_(buffer_pool_manager),
-      schema_(schema),
-      log_manager_(log_manager),
-      lock_manager_(lock_manager),
-      record_now_(record_id_first) {
-  if (!(record_id_first==INVALID_ROWID))
-  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-      ->GetTuple(&record_now_, schema_, txn, lock_manager_);
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid) : table_heap_(table_heap), record_now_(INVALID_ROWID) {
+  Load(rid);
 }
 
 TableIterator::TableIterator(const TableIterator &other)
-    : buffer_pool_manager_(other.buffer_pool_manager_),
-      schema_(other.schema_),
-      log_manager_(other.log_manager_),
-      lock_manager_(other.lock_manager_),
-      record_now_(other.record_now_)
-       {
-  
-  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-      ->GetTuple(&record_now_, schema_, txn, lock_manager_);
-      
-  //i don't know whether the page is edited or not
-  //except add a mark when * it
-  buffer_pool_manager_->UnpinPage(record_now_.GetRowId().GetPageId(), true);
-}
+    : table_heap_(other.table_heap_), record_now_(other.record_now_) {}
 
 TableIterator::~TableIterator() {}
 
-/*
-inline bool TableIterator::operator==(const TableIterator &itr) const { return (this->record_id_now_ == itr.record_id_now_); }
-
-inline bool TableIterator::operator!=(const TableIterator &itr) const {
-  return (this->record_id_now_.Get() != itr.record_id_now_.Get());
-}
-*/
-
-TableIterator& TableIterator::operator=(const TableIterator& other) {
-  buffer_pool_manager_ = other.buffer_pool_manager_;
-  schema_ = other.schema_;
-  log_manager_ = other.log_manager_;
-  lock_manager_ = other.lock_manager_;
-  txn = other.txn;
-  record_now_.SetRowId(other.record_now_.GetRowId());
-  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(other.record_now_.GetRowId().GetPageId()))
-      ->GetTuple(&record_now_, schema_, txn, lock_manager_);
+TableIterator &TableIterator::operator=(const TableIterator &other) {
+  table_heap_ = other.table_heap_;
+  record_now_ = other.record_now_;
   return *this;
 }
 
 const Row &TableIterator::operator*() {
-  // ASSERT(false, "Not implemented yet.");
   return record_now_;
 }
 
 Row *TableIterator::operator->() { return &record_now_; }
 
 TableIterator &TableIterator::operator++() {
-  // point to the next slot
-  RowId tmp_row = record_now_.GetRowId();
-  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-      ->GetNextTupleRid(tmp_row, &tmp_row);
-
-  if (tmp_row.GetPageId() != INVALID_PAGE_ID) {
-    record_now_.SetRowId(tmp_row);
-    reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-        ->GetTuple(&record_now_, schema_, txn, lock_manager_);
-    buffer_pool_manager_->UnpinPage(record_now_.GetRowId().GetPageId(), true);
-  } else {
-    // try to get the first tuple in next page
-    RowId old_row = record_now_.GetRowId();
-    RowId tmp_row = record_now_.GetRowId();
-    page_id_t the_page_id =
-        reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(tmp_row.GetPageId()))->GetNextPageId();
-
-    if (the_page_id == INVALID_PAGE_ID) {
-      buffer_pool_manager_->UnpinPage(old_row.GetPageId(), true);
-      record_now_.SetRowId(INVALID_ROWID);
-      return *this;
+  // point to the next slot, in this page or the following ones
+  RowId rid = record_now_.GetRowId();
+  Load(table_heap_->FindTuple(rid.GetPageId(), rid.GetSlotNum() + 1));
+  return *this;
+}
+
+TableIterator TableIterator::operator++(int) {
+  TableIterator tmp(*this);
+  ++(*this);
+  return TableIterator(tmp);
+}
+
+void TableIterator::Load(RowId rid) {
+  record_now_.SetRowId(rid);
+  if (rid == INVALID_ROWID) {
+    record_now_.Clear();
+    return;
+  }
+  table_heap_->GetTuple(&record_now_, nullptr);
+}
+
+TableViewIterator::TableViewIterator(const TableHeap *table_heap, const std::vector<uint32_t> *columns)
+    : table_heap_(table_heap), buffer_pool_manager_(table_heap->buffer_pool_manager_), columns_(columns) {
+  Init();
+  if (table_heap_->first_page_id_ != INVALID_PAGE_ID) {
+    page_ = buffer_pool_manager_->FetchPage(table_heap_->first_page_id_);
+    SeekTuple();
+  }
+}
+
+TableViewIterator::TableViewIterator(const TableHeap *table_heap, const RowId *row_ids, size_t row_count,
+                                     const std::vector<uint32_t> *columns)
+    : table_heap_(table_heap),
+      buffer_pool_manager_(table_heap->buffer_pool_manager_),
+      columns_(columns),
+      row_ids_(row_ids),
+      row_count_(row_count) {
+  Init();
+  SeekRowId();
+}
+
+void TableViewIterator::Init() {
+  if (table_heap_->layout_ == kLayoutPax) {
+    uint32_t column_count = table_heap_->schema_->GetColumnCount();
+    uint32_t size = Row::SlotOffset(column_count, column_count);
+    for (auto width : table_heap_->pax_layout_->widths_) {
+      size += width;
     }
+    scratch_.resize(size);
+  }
+}
 
-    reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(the_page_id))->GetFirstTupleRid(&tmp_row);
-    record_now_.SetRowId(tmp_row);
-    // get the tuple
-    reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-        ->GetTuple(&record_now_, schema_, txn, lock_manager_);
+TableViewIterator::~TableViewIterator() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  }
+}
 
-    buffer_pool_manager_->UnpinPage(old_row.GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(record_now_.GetRowId().GetPageId(), true);
+TableViewIterator &TableViewIterator::operator++() {
+  if (row_ids_ != nullptr) {
+    SeekRowId();
+    return *this;
   }
+  slot_++;
+  SeekTuple();
   return *this;
 }
 
-TableIterator TableIterator::operator++(int) { // point to the next slot
-  TableIterator tmp(*this);
-  // point to the next slot
-  RowId tmp_row = record_now_.GetRowId();
-  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-      ->GetNextTupleRid(tmp_row, &tmp_row);
-
-  if (tmp_row.GetPageId() != INVALID_PAGE_ID) {
-    record_now_.SetRowId(tmp_row);
-    reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-        ->GetTuple(&record_now_, schema_, txn, lock_manager_);
-    buffer_pool_manager_->UnpinPage(record_now_.GetRowId().GetPageId(), true);
-  } else {
-    // try to get the first tuple in next page
-    RowId old_row = record_now_.GetRowId();
-    RowId tmp_row = record_now_.GetRowId();
-    page_id_t the_page_id = 
-        reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(tmp_row.GetPageId()))->GetNextPageId();
-
-
-    if (the_page_id==INVALID_PAGE_ID) {
-      buffer_pool_manager_->UnpinPage(old_row.GetPageId(), true);
-      record_now_.SetRowId(INVALID_ROWID);
-      return TableIterator(tmp);
-    } 
-
-
-    reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(the_page_id))->GetFirstTupleRid(&tmp_row);
-    record_now_.SetRowId(tmp_row);
-    // get the tuple
-    reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(record_now_.GetRowId().GetPageId()))
-        ->GetTuple(&record_now_, schema_, txn, lock_manager_);
-
-    buffer_pool_manager_->UnpinPage(old_row.GetPageId(), true);
-    buffer_pool_manager_->UnpinPage(record_now_.GetRowId().GetPageId(), true);
+bool TableViewIterator::ReadSlot() {
+  const Schema *schema = table_heap_->schema_;
+  if (table_heap_->layout_ == kLayoutPax) {
+    auto page = reinterpret_cast<PaxPage *>(page_);
+    const PaxLayout &layout = *table_heap_->pax_layout_;
+    if (slot_ >= page->GetSlotCount() || !page->IsVisible(slot_, layout)) {
+      return false;
+    }
+    page->ReadTuple(slot_, layout, columns_, scratch_.data());
+    view_.Reset(scratch_.data(), schema, RowId(page->GetTablePageId(), slot_));
+    return true;
+  }
+  return reinterpret_cast<TablePage *>(page_)->GetTupleView(slot_, schema, &view_, &scratch_);
+}
+
+void TableViewIterator::SeekTuple() {
+  while (page_ != nullptr) {
+    uint32_t slot_count = table_heap_->layout_ == kLayoutPax ? reinterpret_cast<PaxPage *>(page_)->GetSlotCount()
+                                                             : reinterpret_cast<TablePage *>(page_)->GetTupleCount();
+    for (; slot_ < slot_count; slot_++) {
+      if (ReadSlot()) {
+        return;
+      }
+    }
+    page_id_t next_page_id = reinterpret_cast<TablePage *>(page_)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    slot_ = 0;
+  }
+}
+
+void TableViewIterator::SeekRowId() {
+  for (; row_count_ > 0; row_ids_++, row_count_--) {
+    if (page_ != nullptr && page_->GetPageId() != row_ids_->GetPageId()) {
+      buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+      page_ = nullptr;
+    }
+    if (page_ == nullptr && (page_ = buffer_pool_manager_->FetchPage(row_ids_->GetPageId())) == nullptr) {
+      continue;
+    }
+    slot_ = row_ids_->GetSlotNum();
+    if (ReadSlot()) {
+      row_ids_++;
+      row_count_--;
+      return;
+    }
+  }
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+}
+
+TableChunkIterator::TableChunkIterator(const TableHeap *table_heap, const std::vector<uint32_t> &columns,
+                                       const std::vector<uint32_t> &lazy_columns)
+    : table_heap_(table_heap), buffer_pool_manager_(table_heap->buffer_pool_manager_), columns_(columns) {
+  Init(lazy_columns);
+  if (table_heap_->first_page_id_ != INVALID_PAGE_ID) {
+    page_ = buffer_pool_manager_->FetchPage(table_heap_->first_page_id_);
+    SeekChunk();
+  }
+}
+
+TableChunkIterator::TableChunkIterator(const TableHeap *table_heap, const page_id_t *pages, uint32_t page_count,
+                                       const std::vector<uint32_t> &columns,
+                                       const std::vector<uint32_t> &lazy_columns)
+    : table_heap_(table_heap),
+      buffer_pool_manager_(table_heap->buffer_pool_manager_),
+      pages_(pages),
+      page_count_(page_count),
+      columns_(columns) {
+  Init(lazy_columns);
+  page_id_t page_id = NextPageId();
+  if (page_id != INVALID_PAGE_ID) {
+    page_ = buffer_pool_manager_->FetchPage(page_id);
+    SeekChunk();
+  }
+}
+
+void TableChunkIterator::Init(const std::vector<uint32_t> &lazy_columns) {
+  for (auto column : lazy_columns) {
+    if (std::find(columns_.begin(), columns_.end(), column) == columns_.end()) {
+      lazy_columns_.push_back(column);
+    }
+  }
+  std::vector<uint32_t> all_columns = columns_;
+  all_columns.insert(all_columns.end(), lazy_columns_.begin(), lazy_columns_.end());
+  chunk_.reset(new DataChunk(table_heap_->schema_, all_columns));
+}
+
+page_id_t TableChunkIterator::NextPageId() {
+  if (pages_ == nullptr) {
+    return reinterpret_cast<TablePage *>(page_)->GetNextPageId();
+  }
+  if (page_count_ == 0) {
+    return INVALID_PAGE_ID;
+  }
+  page_count_--;
+  return *pages_++;
+}
+
+TableChunkIterator::~TableChunkIterator() {
+  if (page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+  }
+}
+
+TableChunkIterator &TableChunkIterator::operator++() {
+  slot_ += chunk_->GetSize();
+  SeekChunk();
+  return *this;
+}
+
+void TableChunkIterator::LoadLazyColumns() {
+  if (!lazy_columns_.empty()) {
+    table_heap_->LoadChunk(page_, chunk_.get(), lazy_columns_);
+  }
+}
+
+void TableChunkIterator::SeekChunk() {
+  while (page_ != nullptr) {
+    uint32_t slot_count = table_heap_->GetSlotCount(page_);
+    while (slot_ < slot_count) {
+      chunk_->Reset(page_->GetPageId(), slot_, std::min(FILTER_VECTOR_SIZE, slot_count - slot_));
+      table_heap_->LoadChunk(page_, chunk_.get(), columns_);
+      const uint64_t *visible = chunk_->GetVisible();
+      for (uint32_t w = 0; w < SelectionWords(chunk_->GetSize()); w++) {
+        if (visible[w] != 0) return;
+      }
+      slot_ += chunk_->GetSize();
+    }
+    page_id_t next_page_id = NextPageId();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    slot_ = 0;
   }
-  return TableIterator(tmp);
 }
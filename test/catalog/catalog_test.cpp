@@ -293,4 +293,158 @@ TEST(CatalogTest, CatalogIndexDeleteTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+/**
+ * A row in the format before the row format version: magic, field count, null flags, then the non-null fields.
+ */
+static uint32_t SerializeLegacyRow(const std::vector<Field> &fields, char *buf) {
+  char *p = buf;
+  MACH_WRITE_UINT32(p, 1055820);
+  MACH_WRITE_UINT32(p + 4, fields.size());
+  p += 8;
+  for (auto &field : fields) {
+    MACH_WRITE_TO(bool, p, field.IsNull());
+    p += sizeof(bool);
+  }
+  for (auto &field : fields) {
+    if (!field.IsNull()) p += field.SerializeTo(p);
+  }
+  return p - buf;
+}
+
+/**
+ * Append a tuple to a table page as an old database has it: the tuples grow from the end of the page, the
+ * header (free space pointer at 16, tuple count at 20) is followed by a slot of offset and size per tuple.
+ */
+static bool AppendTuple(Page *page, const char *tuple, uint32_t size) {
+  char *data = page->GetData();
+  uint32_t free_space = MACH_READ_UINT32(data + 16);
+  uint32_t count = MACH_READ_UINT32(data + 20);
+  if (free_space < 24 + 8 * (count + 1) + size) {
+    return false;
+  }
+  free_space -= size;
+  memcpy(data + free_space, tuple, size);
+  MACH_WRITE_UINT32(data + 16, free_space);
+  MACH_WRITE_UINT32(data + 24 + 8 * count, free_space);
+  MACH_WRITE_UINT32(data + 28 + 8 * count, size);
+  MACH_WRITE_UINT32(data + 20, count + 1);
+  return true;
+}
+
+static uint32_t ReadRowFormatVersion(SimpleMemHeap &heap) {
+  DiskManager disk_mgr(db_file_name);
+  char buf[PAGE_SIZE];
+  disk_mgr.ReadPage(CATALOG_META_PAGE_ID, buf);
+  return *CatalogMeta::DeserializeFrom(buf, &heap)->GetRowFormatVersion();
+}
+
+TEST(CatalogTest, CatalogRowFormatMigrationTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  // a legacy row takes a byte for a null column, a compact row a slot of 4 bytes
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 2000, 1, true, false),
+                                   ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 2000, 2, true, false)};
+  for (uint32_t i = 3; i < 103; i++) {
+    columns.push_back(ALLOC_COLUMN(heap)("c" + std::to_string(i), TypeId::kTypeInt, i, true, false));
+  }
+  auto schema = std::make_shared<Schema>(columns, std::vector<Column *>{columns[0]});
+  Transaction txn;
+  TableInfo *small_table = nullptr;
+  TableInfo *big_table = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("small", schema.get(), &txn, small_table));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("big", schema.get(), &txn, big_table));
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->GetIndex("small", PKINDEX, index_info));
+
+  // fill the first page of small with legacy rows, which all grow when they are rewritten
+  char buf[PAGE_SIZE];
+  page_id_t small_page_id = small_table->GetTableHeap()->GetFirstPageId();
+  Page *page = db_01->bpm_->FetchPage(small_page_id);
+  int row_nums = 0;
+  for (;; row_nums++) {
+    std::vector<Field> fields = {Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar), Field(TypeId::kTypeChar)};
+    while (fields.size() < schema->GetColumnCount()) {
+      fields.emplace_back(TypeId::kTypeInt);
+    }
+    if (!AppendTuple(page, buf, SerializeLegacyRow(fields, buf))) break;
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, row_nums)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key, RowId(small_page_id, row_nums), nullptr));
+  }
+  ASSERT_GT(row_nums, 1);
+  db_01->bpm_->UnpinPage(small_page_id, true);
+  // a legacy row of big, whose compact form is larger than a page
+  std::string name(1950, 'x');
+  std::vector<Field> big_fields = {Field(TypeId::kTypeInt, 1000),
+                                   Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false),
+                                   Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false)};
+  while (big_fields.size() < schema->GetColumnCount()) {
+    big_fields.emplace_back(TypeId::kTypeInt);
+  }
+  ASSERT_GT(Row(big_fields).GetSerializedSize(schema.get()), TablePage::SIZE_MAX_ROW);
+  page_id_t big_page_id = big_table->GetTableHeap()->GetFirstPageId();
+  page = db_01->bpm_->FetchPage(big_page_id);
+  ASSERT_TRUE(AppendTuple(page, buf, SerializeLegacyRow(big_fields, buf)));
+  db_01->bpm_->UnpinPage(big_page_id, true);
+  delete db_01;
+  // mark the database as written with the legacy format
+  {
+    DiskManager disk_mgr(db_file_name);
+    disk_mgr.ReadPage(CATALOG_META_PAGE_ID, buf);
+    CatalogMeta *meta = CatalogMeta::DeserializeFrom(buf, &heap);
+    *meta->GetRowFormatVersion() = 0;
+    meta->SerializeTo(buf);
+    disk_mgr.WritePage(CATALOG_META_PAGE_ID, buf);
+  }
+
+  /** Stage 2: the rows of small are rewritten and moved, the row of big can not be */
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("small", small_table));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("small", PKINDEX, index_info));
+  int moved = 0;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<RowId> ret;
+    std::vector<Field> key_fields = {Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    moved += ret[0].GetPageId() != small_page_id;
+    Row row(ret[0]);
+    ASSERT_TRUE(small_table->GetTableHeap()->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    ASSERT_TRUE(row.GetField(1)->IsNull());
+    page = db_02->bpm_->FetchPage(ret[0].GetPageId());
+    ASSERT_FALSE(reinterpret_cast<TablePage *>(page)->IsLegacyTuple(ret[0].GetSlotNum()));
+    db_02->bpm_->UnpinPage(ret[0].GetPageId(), false);
+  }
+  ASSERT_GT(moved, 0);
+  int scanned = 0;
+  for (auto it = small_table->GetTableHeap()->Begin(nullptr); it != small_table->GetTableHeap()->End(); it++) {
+    scanned++;
+  }
+  ASSERT_EQ(row_nums, scanned);
+  // the row of big is still read in the legacy format
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("big", big_table));
+  page = db_02->bpm_->FetchPage(big_page_id);
+  ASSERT_TRUE(reinterpret_cast<TablePage *>(page)->IsLegacyTuple(0));
+  db_02->bpm_->UnpinPage(big_page_id, false);
+  Row big_row(RowId(big_page_id, 0));
+  ASSERT_TRUE(big_table->GetTableHeap()->GetTuple(&big_row, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, big_row.GetField(1)->CompareEquals(big_fields[1]));
+  delete db_02;
+  // the version is kept while a legacy row is left
+  ASSERT_EQ(0, ReadRowFormatVersion(heap));
+
+  /** Stage 3: without the row of big the migration completes */
+  auto db_03 = new DBStorageEngine(db_file_name, false);
+  ASSERT_EQ(DB_SUCCESS, db_03->catalog_mgr_->DropTable("big"));
+  delete db_03;
+  ASSERT_EQ(0, ReadRowFormatVersion(heap));
+  auto db_04 = new DBStorageEngine(db_file_name, false);
+  delete db_04;
+  ASSERT_EQ(Row::ROW_FORMAT_VERSION, ReadRowFormatVersion(heap));
+}
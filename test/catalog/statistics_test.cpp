@@ -0,0 +1,125 @@
+#include <cmath>
+
+#include "catalog/statistics.h"
+#include "common/instance.h"
+#include "gtest/gtest.h"
+
+static const std::string db_file_name = "statistics_test.db";
+
+TEST(StatisticsTest, AnalyzeTest) {
+  DBStorageEngine engine(db_file_name, true);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                   ALLOC_COLUMN(heap)("k", TypeId::kTypeInt, 1, true, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 8, 2, true, false)};
+  Schema schema(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("t", &schema, nullptr, table_info));
+  const int rows = 10000;
+  for (int i = 0; i < rows; i++) {
+    // k is null for every tenth row, otherwise one of 100 values; name one of 2 values
+    std::string name = i % 2 == 0 ? "even" : "odd";
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, i);
+    fields.emplace_back(i % 10 == 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, i % 100));
+    fields.emplace_back(TypeId::kTypeChar, &name[0], name.size(), true);
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+  }
+  // one deleted row is not counted
+  RowId deleted;
+  {
+    auto iter = table_info->GetTableHeap()->Begin(nullptr);
+    deleted = iter->GetRowId();
+  }
+  ASSERT_TRUE(table_info->GetTableHeap()->MarkDelete(deleted, nullptr));
+
+  StatisticsBuilder builder(&schema);
+  TableHeap *table_heap = table_info->GetTableHeap();
+  for (auto iter = table_heap->ChunkBegin({0, 1, 2}); !iter.IsEnd(); ++iter) {
+    builder.AddChunk(*iter);
+  }
+  TableStatistics statistics = builder.Finish(table_heap->GetPageCount());
+  ASSERT_EQ(rows - 1, statistics.row_count_);
+  ASSERT_EQ(table_heap->GetPageCount(), statistics.page_count_);
+  // the distinct counts are estimated by the sketches
+  ASSERT_NEAR(rows - 1, statistics.columns_[0].distinct_count_, rows * 0.05);
+  ASSERT_EQ(0, statistics.columns_[0].null_count_);
+  ASSERT_NEAR(90, statistics.columns_[1].distinct_count_, 5);
+  ASSERT_EQ(rows / 10 - 1, statistics.columns_[1].null_count_);
+  ASSERT_EQ(2, statistics.columns_[2].distinct_count_);
+  ASSERT_EQ(TableStatistics::HISTOGRAM_BUCKETS + 1, statistics.columns_[0].bounds_.size());
+  ASSERT_EQ(1, statistics.columns_[0].bounds_.front());
+  ASSERT_EQ(rows - 1, statistics.columns_[0].bounds_.back());
+
+  // the estimates of uniform columns are close to the real shares
+  auto near = [](double expected, double estimate) { return std::fabs(expected - estimate) < 0.02; };
+  ASSERT_TRUE(near(0.25, statistics.Selectivity(0, kCmpLt, Field(TypeId::kTypeInt, rows / 4))));
+  ASSERT_TRUE(near(0.75, statistics.Selectivity(0, kCmpGe, Field(TypeId::kTypeInt, rows / 4))));
+  ASSERT_TRUE(near(0.0001, statistics.Selectivity(0, kCmpEq, Field(TypeId::kTypeInt, 7))));
+  ASSERT_EQ(0, statistics.Selectivity(0, kCmpEq, Field(TypeId::kTypeInt, rows * 2)));
+  ASSERT_EQ(0, statistics.Selectivity(0, kCmpGt, Field(TypeId::kTypeInt, rows * 2)));
+  ASSERT_TRUE(near(0.01, statistics.Selectivity(1, kCmpEq, Field(TypeId::kTypeInt, 42))));
+  // null values satisfy no compare
+  ASSERT_TRUE(near(0.9, statistics.Selectivity(1, kCmpGe, Field(TypeId::kTypeInt, 0))));
+  ASSERT_EQ(0, statistics.Selectivity(1, kCmpEq, Field(TypeId::kTypeInt)));
+  std::string even = "even";
+  ASSERT_TRUE(near(0.5, statistics.Selectivity(2, kCmpEq, Field(TypeId::kTypeChar, &even[0], even.size(), false))));
+
+  // stored and read back unchanged
+  std::vector<char> buf;
+  statistics.SerializeTo(buf);
+  TableStatistics read;
+  ASSERT_TRUE(TableStatistics::DeserializeFrom(buf.data(), buf.size(), read));
+  ASSERT_EQ(statistics.row_count_, read.row_count_);
+  ASSERT_EQ(statistics.columns_[0].bounds_, read.columns_[0].bounds_);
+  ASSERT_EQ(statistics.columns_[1].sample_, read.columns_[1].sample_);
+  ASSERT_EQ(statistics.columns_[2].distinct_count_, read.columns_[2].distinct_count_);
+  ASSERT_FALSE(TableStatistics::DeserializeFrom(buf.data(), buf.size() / 2, read));
+}
+
+TEST(StatisticsTest, MaintainTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                   ALLOC_COLUMN(heap)("k", TypeId::kTypeInt, 1, true, false)};
+  Schema schema(columns);
+  TableStatistics statistics(schema.GetColumnCount());
+  auto make_row = [](int i) {
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, i);
+    fields.emplace_back(i % 10 == 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, i % 100));
+    return Row(fields);
+  };
+  // a table growing without an analyze
+  const int rows = 20000;
+  for (int i = 0; i < rows; i++) {
+    statistics.InsertRow(make_row(i));
+  }
+  statistics.Refresh();
+  ASSERT_EQ(rows, statistics.row_count_);
+  ASSERT_TRUE(statistics.dirty_);
+  ASSERT_EQ(ColumnStatistics::SAMPLE_SIZE, statistics.columns_[0].sample_.size());
+  ASSERT_NEAR(rows, statistics.columns_[0].distinct_count_, rows * 0.05);
+  ASSERT_NEAR(90, statistics.columns_[1].distinct_count_, 5);
+  ASSERT_EQ(rows / 10, statistics.columns_[1].null_count_);
+  ASSERT_EQ(0, statistics.columns_[0].bounds_.front());
+  ASSERT_EQ(rows - 1, statistics.columns_[0].bounds_.back());
+  // the sample keeps the histogram of a uniform column close
+  auto near = [](double expected, double estimate) { return std::fabs(expected - estimate) < 0.05; };
+  ASSERT_TRUE(near(0.5, statistics.Selectivity(0, kCmpLt, Field(TypeId::kTypeInt, rows / 2))));
+  // a new value out of the range is not taken as absent
+  statistics.InsertRow(make_row(rows * 2 + 1));
+  ASSERT_LT(0, statistics.Selectivity(0, kCmpGe, Field(TypeId::kTypeInt, rows * 2 + 1)));
+
+  // deleting the upper half moves the histogram
+  for (int i = rows / 2; i < rows; i++) {
+    statistics.RemoveRow(make_row(i));
+  }
+  statistics.Refresh();
+  ASSERT_EQ(rows / 2 + 1, statistics.row_count_);
+  ASSERT_EQ(rows / 20, statistics.columns_[1].null_count_);
+  ASSERT_TRUE(near(0.5, statistics.Selectivity(0, kCmpLt, Field(TypeId::kTypeInt, rows / 4))));
+  ASSERT_TRUE(near(0, statistics.Selectivity(0, kCmpGt, Field(TypeId::kTypeInt, rows / 2))));
+  // the sketch cannot forget a value, the non-null count caps it
+  ASSERT_GE(rows / 2 + 1, statistics.columns_[0].distinct_count_);
+}
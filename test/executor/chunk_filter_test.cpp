@@ -0,0 +1,80 @@
+#include <cstring>
+#include <sstream>
+
+#include "common/instance.h"
+#include "executor/chunk_filter.h"
+#include "executor/result_sink.h"
+#include "gtest/gtest.h"
+#include "storage/table_heap.h"
+
+static const std::string db_file_name = "chunk_filter_test.db";
+
+using Fields = std::vector<Field>;
+
+TEST(ChunkFilterTest, ScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 3000;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  for (auto layout : {kLayoutRow, kLayoutPax}) {
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap, layout);
+    std::vector<std::string> names;
+    std::vector<RowId> rids;
+    for (int i = 0; i < row_nums; i++) {
+      names.push_back("n" + std::to_string(i % 100));
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names.back()[0], names.back().size(), true),
+                    i % 3 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, (i % 50) * 0.5f)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      rids.push_back(row.GetRowId());
+    }
+    for (int i = 0; i < row_nums; i += 7) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+    }
+    // (id < 1000 and account >= 10) or name = "n42"
+    std::string name = "n42";
+    Field id_value(TypeId::kTypeInt, 1000);
+    Field account_value(TypeId::kTypeFloat, 10.0f);
+    Field name_value(TypeId::kTypeChar, &name[0], name.size(), false);
+    ChunkFilter filter;
+    uint32_t left = filter.AddCompare(0, kCmpLt, &id_value);
+    uint32_t right = filter.AddCompare(2, kCmpGe, &account_value);
+    uint32_t id = filter.AddConnector(true, left, right);
+    filter.AddConnector(false, id, filter.AddCompare(1, kCmpEq, &name_value));
+    ASSERT_EQ(3, filter.GetColumns().size());
+
+    std::ostringstream expected;
+    TextResultSink expected_sink(expected);
+    expected_sink.Begin(schema.get(), {1, 0});
+    for (auto iter = table_heap->ViewBegin(); !iter.IsEnd(); ++iter) {
+      if ((iter->Compare(0, kCmpLt, id_value) == kTrue && iter->Compare(2, kCmpGe, account_value) == kTrue) ||
+          iter->Compare(1, kCmpEq, name_value) == kTrue) {
+        expected_sink.Consume(*iter);
+      }
+    }
+    expected_sink.End();
+
+    // the name is a lazy column, loaded before the filter reads it
+    std::ostringstream out;
+    TextResultSink sink(out);
+    sink.Begin(schema.get(), {1, 0});
+    uint64_t selection[FILTER_VECTOR_SIZE / 64];
+    for (auto iter = table_heap->ChunkBegin({0, 2}, {1, 0}); !iter.IsEnd(); ++iter) {
+      ASSERT_TRUE(iter->IsLoaded(1));
+      ChunkFilter empty;
+      empty.Evaluate(*iter, selection);
+      ASSERT_EQ(0, memcmp(selection, iter->GetVisible(), SelectionWords(iter->GetSize()) * sizeof(uint64_t)));
+      iter.LoadLazyColumns();
+      filter.Evaluate(*iter, selection);
+      ASSERT_TRUE(sink.ConsumeChunk(*iter, selection));
+    }
+    sink.End();
+    ASSERT_FALSE(expected.str().empty());
+    ASSERT_EQ(expected.str(), out.str());
+    table_heap->FreeHeap();
+  }
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "executor/execute_engine.h"
+#include "gtest/gtest.h"
+
+static const std::string db_name = "execute_engine_test_db";
+
+static dberr_t Execute(ExecuteEngine &engine, const std::string &sql) {
+  ExecuteContext context;
+  return engine.ExecuteSql(sql.c_str(), &context);
+}
+
+/**
+ * The rows of a select over int columns, each as its values separated by ",", sorted.
+ */
+static std::vector<std::string> Query(ExecuteEngine &engine, const std::string &sql) {
+  std::vector<std::string> rows;
+  CallbackResultSink sink([&rows](const TupleView &tuple, const std::vector<uint32_t> &columns) {
+    std::string row;
+    for (auto column : columns) {
+      row += (row.empty() ? "" : ",") + (tuple.IsNull(column) ? "null" : std::to_string(tuple.GetInt(column)));
+    }
+    rows.push_back(row);
+    return true;
+  });
+  ExecuteContext context;
+  context.sink_ = &sink;
+  EXPECT_EQ(DB_SUCCESS, engine.ExecuteSql(sql.c_str(), &context));
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+using Rows = std::vector<std::string>;
+
+/**
+ * A database with t(id pk, u unique, w unique, g), every column an int.
+ */
+static void CreateTable(ExecuteEngine &engine) {
+  remove(db_name.c_str());
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "create database " + db_name + ";"));
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "use " + db_name + ";"));
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "create table t(id int, u int unique, w int unique, g int, primary key(id));"));
+}
+
+static void DropDatabase(ExecuteEngine &engine) {
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "drop database " + db_name + ";"));
+}
+
+TEST(ExecuteEngineTest, UpdateTest) {
+  ExecuteEngine engine;
+  CreateTable(engine);
+  for (int i = 1; i <= 4; i++) {
+    std::string values = std::to_string(i) + ", " + std::to_string(10 + i) + ", " + std::to_string(20 + i);
+    ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into t values(" + values + ", " + std::to_string(i % 2) + ");"));
+  }
+
+  // only the index of u changes, the pk and w indexes still find the row
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "update t set u = 50, g = 7 where id = 1;"));
+  ASSERT_EQ(Rows({"1,50,21,7"}), Query(engine, "select * from t where u = 50;"));
+  ASSERT_EQ(Rows(), Query(engine, "select * from t where u = 11;"));
+  ASSERT_EQ(Rows({"1,50,21,7"}), Query(engine, "select * from t where w = 21;"));
+  ASSERT_EQ(Rows({"1,50,21,7"}), Query(engine, "select * from t where id = 1;"));
+  // a row may keep its own key
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "update t set u = 12 where id = 2;"));
+  ASSERT_EQ(Rows({"2,12,22,0"}), Query(engine, "select * from t where u = 12;"));
+
+  // a key held by a row which is not updated
+  ASSERT_EQ(DB_FAILED, Execute(engine, "update t set w = 24 where id = 3;"));
+  // two updated rows would get the same key, whichever comes first
+  ASSERT_EQ(DB_FAILED, Execute(engine, "update t set u = 13 where g = 0;"));
+  ASSERT_EQ(DB_FAILED, Execute(engine, "update t set id = 2 where g = 0;"));
+  ASSERT_EQ(DB_FAILED, Execute(engine, "update t set id = 4 where g = 0;"));
+  // nothing changed, in the heap or in any index
+  Rows rows = {"1,50,21,7", "2,12,22,0", "3,13,23,1", "4,14,24,0"};
+  ASSERT_EQ(rows, Query(engine, "select * from t;"));
+  for (auto &row : rows) {
+    int id = row[0] - '0';
+    ASSERT_EQ(Rows({row}), Query(engine, "select * from t where id = " + std::to_string(id) + ";"));
+    ASSERT_EQ(Rows({row}), Query(engine, "select * from t where w = " + std::to_string(20 + id) + ";"));
+  }
+  ASSERT_EQ(Rows({"2,12,22,0"}), Query(engine, "select * from t where u = 12;"));
+  ASSERT_EQ(Rows({"4,14,24,0"}), Query(engine, "select * from t where u = 14;"));
+  DropDatabase(engine);
+}
+
+TEST(ExecuteEngineTest, DeleteTest) {
+  ExecuteEngine engine;
+  CreateTable(engine);
+  const int rows = 300;
+  for (int i = 0; i < rows; i++) {
+    ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into t values(" + std::to_string(i) + ", " + std::to_string(1000 + i) +
+                                          ", " + std::to_string(2000 + i) + ", " + std::to_string(i % 3) + ");"));
+  }
+  // the rows are removed from the heap and from every index in one batch
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "delete from t where g = 1;"));
+  ASSERT_EQ(rows - rows / 3, Query(engine, "select * from t;").size());
+  for (int i = 0; i < rows; i++) {
+    size_t expected = i % 3 == 1 ? 0 : 1;
+    ASSERT_EQ(expected, Query(engine, "select * from t where id = " + std::to_string(i) + ";").size());
+    ASSERT_EQ(expected, Query(engine, "select * from t where u = " + std::to_string(1000 + i) + ";").size());
+    ASSERT_EQ(expected, Query(engine, "select * from t where w = " + std::to_string(2000 + i) + ";").size());
+  }
+  // the keys of the deleted rows can be taken again
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into t values(1, 1001, 2001, 5);"));
+  ASSERT_EQ(Rows({"1,1001,2001,5"}), Query(engine, "select * from t where u = 1001;"));
+  DropDatabase(engine);
+}
+
+TEST(ExecuteEngineTest, InsertTest) {
+  ExecuteEngine engine;
+  CreateTable(engine);
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into t values(1, 11, 21, 0);"));
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into t values(2, 12, 22, 0);"));
+  // a duplicate pk
+  ASSERT_EQ(DB_FAILED, Execute(engine, "insert into t values(1, 13, 23, 0);"));
+  // a duplicate on a unique column rejected after the pk index took the row, the row is gone again
+  ASSERT_EQ(DB_FAILED, Execute(engine, "insert into t values(3, 11, 23, 0);"));
+  ASSERT_EQ(DB_FAILED, Execute(engine, "insert into t values(3, 13, 22, 0);"));
+  Rows rows = {"1,11,21,0", "2,12,22,0"};
+  ASSERT_EQ(rows, Query(engine, "select * from t;"));
+  ASSERT_EQ(Rows(), Query(engine, "select * from t where id = 3;"));
+  ASSERT_EQ(Rows(), Query(engine, "select * from t where u = 13;"));
+  ASSERT_EQ(Rows({"1,11,21,0"}), Query(engine, "select * from t where u = 11;"));
+  ASSERT_EQ(Rows({"2,12,22,0"}), Query(engine, "select * from t where w = 22;"));
+  // the rejected keys are free
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into t values(3, 13, 23, 0);"));
+  ASSERT_EQ(Rows({"3,13,23,0"}), Query(engine, "select * from t where id = 3;"));
+
+  // an index on several columns keeps one row per key as well
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "create table s(id int, a int, b int, primary key(id));"));
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "create index s_ab on s(a, b);"));
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into s values(1, 5, 6);"));
+  ASSERT_EQ(DB_SUCCESS, Execute(engine, "insert into s values(2, 5, 7);"));
+  ASSERT_EQ(DB_FAILED, Execute(engine, "insert into s values(3, 5, 6);"));
+  ASSERT_EQ(Rows({"1,5,6", "2,5,7"}), Query(engine, "select * from s;"));
+  ASSERT_EQ(Rows(), Query(engine, "select * from s where id = 3;"));
+  ASSERT_EQ(DB_FAILED, Execute(engine, "update s set b = 6 where id = 2;"));
+  ASSERT_EQ(Rows({"2,5,7"}), Query(engine, "select * from s where id = 2;"));
+  DropDatabase(engine);
+}
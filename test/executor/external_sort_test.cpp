@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <random>
+#include <utility>
+
+#include "common/instance.h"
+#include "executor/external_sort.h"
+#include "gtest/gtest.h"
+
+static const std::string db_file_name = "external_sort_test.db";
+
+using Keys = std::vector<std::pair<int32_t, std::string>>;
+
+/**
+ * Serialize the tuple | k | name | into buf, a negative k is null.
+ */
+static TupleView MakeTuple(const Schema *schema, int32_t k, const std::string &name, std::vector<char> &buf) {
+  std::vector<Field> fields;
+  fields.emplace_back(k < 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, k));
+  fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(name.data()), name.size(), true);
+  Row row(fields);
+  buf.resize(row.GetSerializedSize(const_cast<Schema *>(schema)));
+  row.SerializeTo(buf.data(), const_cast<Schema *>(schema));
+  return TupleView(buf.data(), schema, INVALID_ROWID);
+}
+
+static Keys RunSort(ExternalSort &sort) {
+  Keys keys;
+  dberr_t finished = sort.Finish([&](const TupleView &tuple) {
+    keys.emplace_back(tuple.IsNull(0) ? -1 : tuple.GetInt(0), std::string(tuple.GetChars(1), tuple.GetCharLength(1)));
+    return true;
+  });
+  EXPECT_EQ(DB_SUCCESS, finished);
+  return keys;
+}
+
+TEST(ExternalSortTest, SortTest) {
+  DBStorageEngine engine(db_file_name, true);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("k", TypeId::kTypeInt, 0, true, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)};
+  Schema schema(columns);
+  std::mt19937 rng(42);
+  Keys input;
+  for (int i = 0; i < 20000; i++) {
+    // some nulls, many duplicate k and names sharing a long prefix
+    int32_t k = i % 97 == 0 ? -1 : static_cast<int32_t>(rng() % 5000);
+    input.emplace_back(k, "name_" + std::to_string(rng() % 100000));
+  }
+  // nulls first, then k ascending and name descending
+  Keys expected = input;
+  std::sort(expected.begin(), expected.end(), [](const std::pair<int32_t, std::string> &a,
+                                                 const std::pair<int32_t, std::string> &b) {
+    return a.first != b.first ? a.first < b.first : a.second > b.second;
+  });
+  std::vector<SortKey> keys = {{0, false}, {1, true}};
+  std::vector<char> buf;
+
+  // a small budget spills more runs than one merge takes
+  ExternalSort sort(&schema, keys, engine.bpm_, ExternalSort::NO_LIMIT, 16 * 1024);
+  for (auto &item : input) {
+    sort.Add(MakeTuple(&schema, item.first, item.second, buf));
+  }
+  ASSERT_GT(sort.GetSpilledRunCount(), ExternalSort::MERGE_FAN_IN);
+  ASSERT_EQ(expected, RunSort(sort));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  // everything in memory
+  ExternalSort memory_sort(&schema, keys, engine.bpm_);
+  for (auto &item : input) {
+    memory_sort.Add(MakeTuple(&schema, item.first, item.second, buf));
+  }
+  ASSERT_EQ(expected, RunSort(memory_sort));
+  ASSERT_EQ(0, memory_sort.GetSpilledRunCount());
+
+  // a limit keeps the first tuples in a bounded heap
+  ExternalSort top_sort(&schema, keys, engine.bpm_, 100);
+  for (auto &item : input) {
+    top_sort.Add(MakeTuple(&schema, item.first, item.second, buf));
+  }
+  ASSERT_EQ(Keys(expected.begin(), expected.begin() + 100), RunSort(top_sort));
+
+  // descending on the first key puts the nulls last
+  ExternalSort desc_sort(&schema, {{0, true}}, engine.bpm_, ExternalSort::NO_LIMIT, 16 * 1024);
+  for (auto &item : input) {
+    desc_sort.Add(MakeTuple(&schema, item.first, item.second, buf));
+  }
+  Keys result = RunSort(desc_sort);
+  ASSERT_EQ(input.size(), result.size());
+  for (size_t i = 1; i < result.size(); i++) {
+    ASSERT_TRUE(result[i].first == -1 || result[i - 1].first >= result[i].first);
+  }
+  ASSERT_EQ(-1, result.back().first);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  // with every frame pinned the runs cannot be read back, the sort fails
+  ExternalSort failed_sort(&schema, keys, engine.bpm_, ExternalSort::NO_LIMIT, 16 * 1024);
+  for (auto &item : input) {
+    failed_sort.Add(MakeTuple(&schema, item.first, item.second, buf));
+  }
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (engine.bpm_->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  ASSERT_EQ(DB_FAILED, failed_sort.Finish([](const TupleView &) { return true; }));
+  for (auto id : pinned) {
+    engine.bpm_->UnpinPage(id, false);
+    engine.bpm_->DeletePage(id);
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+class CollectSink : public ResultSink {
+public:
+  bool Consume(const TupleView &tuple) override {
+    values_.push_back(tuple.GetInt(0));
+    return true;
+  }
+
+  std::vector<int32_t> values_;
+};
+
+TEST(ExternalSortTest, SortResultSinkTest) {
+  DBStorageEngine engine(db_file_name, true);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("k", TypeId::kTypeInt, 0, true, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)};
+  Schema schema(columns);
+  std::vector<char> buf;
+
+  // a limit alone passes the first rows on and stops the producer
+  CollectSink limited;
+  SortResultSink limit_sink(&limited, {}, 3, engine.bpm_);
+  limit_sink.Begin(&schema, {0, 1});
+  ASSERT_TRUE(limit_sink.Consume(MakeTuple(&schema, 5, "a", buf)));
+  ASSERT_TRUE(limit_sink.Consume(MakeTuple(&schema, 4, "b", buf)));
+  ASSERT_FALSE(limit_sink.Consume(MakeTuple(&schema, 3, "c", buf)));
+  limit_sink.End();
+  ASSERT_EQ(std::vector<int32_t>({5, 4, 3}), limited.values_);
+
+  CollectSink sorted;
+  SortResultSink sort_sink(&sorted, {{0, true}}, 2, engine.bpm_);
+  sort_sink.Begin(&schema, {0, 1});
+  for (int32_t k : {3, 9, 1, 7}) {
+    ASSERT_TRUE(sort_sink.Consume(MakeTuple(&schema, k, "x", buf)));
+  }
+  ASSERT_TRUE(sorted.values_.empty());
+  sort_sink.End();
+  ASSERT_EQ(std::vector<int32_t>({9, 7}), sorted.values_);
+}
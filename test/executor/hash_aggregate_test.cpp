@@ -0,0 +1,105 @@
+#include <map>
+#include <set>
+#include <tuple>
+
+#include "common/instance.h"
+#include "executor/hash_aggregate.h"
+#include "gtest/gtest.h"
+#include "storage/table_heap.h"
+
+static const std::string db_file_name = "hash_aggregate_test.db";
+
+using Fields = std::vector<Field>;
+
+TEST(HashAggregateTest, SpillFileTest) {
+  DBStorageEngine engine(db_file_name);
+  SpillFile file(engine.bpm_);
+  std::vector<std::string> records;
+  for (uint32_t i = 0; i < 5000; i++) {
+    records.push_back(std::string(i % 300, 'a' + i % 26) + std::to_string(i));
+    ASSERT_TRUE(file.Append(records.back().data(), records.back().size()));
+  }
+  ASSERT_EQ(records.size(), file.GetRecordCount());
+  SpillFile::Reader reader(&file);
+  const char *data;
+  uint32_t size;
+  for (auto &record : records) {
+    ASSERT_TRUE(reader.Next(&data, &size));
+    ASSERT_EQ(record, std::string(data, size));
+  }
+  ASSERT_FALSE(reader.Next(&data, &size));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(HashAggregateTest, GroupTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  // name -> count(*), count(account), sum(id), max(account)
+  std::map<std::string, std::tuple<int32_t, int32_t, int64_t, float>> expected;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name = "n" + std::to_string(i % 3000);
+    bool null_account = i % 7 == 0;
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &name[0], name.size(), true),
+                  null_account ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, (i % 50) * 0.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    auto &group = expected[name];
+    std::get<0>(group)++;
+    std::get<2>(group) += i;
+    if (!null_account) {
+      std::get<1>(group)++;
+      std::get<3>(group) = std::max(std::get<3>(group), (i % 50) * 0.5f);
+    }
+  }
+  std::vector<AggregateSpec> aggregates = {{kAggregateCount, AggregateSpec::AGGREGATE_ALL_COLUMNS},
+                                           {kAggregateCount, 2},
+                                           {kAggregateSum, 0},
+                                           {kAggregateMax, 2}};
+  // a small budget spills most groups, the results are the same
+  for (size_t budget : {HashAggregate::DEFAULT_MEMORY_BUDGET, size_t(16 * 1024)}) {
+    HashAggregate aggregate(schema.get(), {1}, aggregates, engine.bpm_, budget);
+    for (auto iter = table_heap->ChunkBegin(aggregate.GetColumns()); !iter.IsEnd(); ++iter) {
+      aggregate.Consume(*iter, iter->GetVisible());
+    }
+    if (budget == HashAggregate::DEFAULT_MEMORY_BUDGET) {
+      ASSERT_EQ(0, aggregate.GetSpilledCount());
+    } else {
+      ASSERT_LT(0, aggregate.GetSpilledCount());
+    }
+    std::set<std::string> names;
+    dberr_t finished = aggregate.Finish([&](std::vector<Field> &fields) {
+      EXPECT_EQ(5, fields.size());
+      std::string name(fields[0].GetData(), fields[0].GetLength());
+      EXPECT_TRUE(names.insert(name).second);
+      auto &group = expected[name];
+      EXPECT_EQ(kTrue, fields[1].CompareEquals(Field(TypeId::kTypeInt, std::get<0>(group))));
+      EXPECT_EQ(kTrue, fields[2].CompareEquals(Field(TypeId::kTypeInt, std::get<1>(group))));
+      EXPECT_EQ(kTrue, fields[3].CompareEquals(Field(TypeId::kTypeFloat, static_cast<float>(std::get<2>(group)))));
+      EXPECT_EQ(kTrue, fields[4].CompareEquals(Field(TypeId::kTypeFloat, std::get<3>(group))));
+      return true;
+    });
+    ASSERT_EQ(DB_SUCCESS, finished);
+    ASSERT_EQ(expected.size(), names.size());
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  }
+
+  // without a group, no tuple still gives a result
+  HashAggregate aggregate(schema.get(), {}, {{kAggregateCount, AggregateSpec::AGGREGATE_ALL_COLUMNS}, {kAggregateMin, 1}},
+                          engine.bpm_);
+  uint32_t results = 0;
+  dberr_t finished = aggregate.Finish([&results](std::vector<Field> &fields) {
+    EXPECT_EQ(kTrue, fields[0].CompareEquals(Field(TypeId::kTypeInt, 0)));
+    EXPECT_TRUE(fields[1].IsNull());
+    results++;
+    return true;
+  });
+  ASSERT_EQ(DB_SUCCESS, finished);
+  ASSERT_EQ(1, results);
+  table_heap->FreeHeap();
+}
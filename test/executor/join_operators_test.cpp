@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <utility>
+
+#include "common/instance.h"
+#include "executor/join_operators.h"
+#include "gtest/gtest.h"
+
+static const std::string db_file_name = "join_operators_test.db";
+
+using Pairs = std::vector<std::pair<int32_t, int32_t>>;
+
+/**
+ * The ids of the tuples of the joined records, sorted.
+ */
+static Pairs RunJoin(JoinSource &join) {
+  Pairs pairs;
+  std::vector<TupleView> views;
+  join.Run([&](const char *record, uint32_t size) {
+    JoinRecord::Parse(record, size, join.GetSchemas(), views);
+    EXPECT_EQ(2, views.size());
+    pairs.emplace_back(views[0].GetInt(0), views[1].GetInt(0));
+    return true;
+  });
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+static void InsertRow(TableInfo *table, IndexInfo *index, std::vector<Field> fields) {
+  Row row(fields);
+  ASSERT_TRUE(table->GetTableHeap()->InsertTuple(row, nullptr));
+  std::vector<Field> key_fields;
+  key_fields.emplace_back(fields[0]);
+  Row key(key_fields);
+  ASSERT_EQ(DB_SUCCESS, index->GetIndex()->InsertEntry(key, row.GetRowId(), nullptr));
+}
+
+TEST(JoinOperatorsTest, JoinTest) {
+  DBStorageEngine engine(db_file_name, true);
+  SimpleMemHeap heap;
+  std::vector<Column *> left_columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                        ALLOC_COLUMN(heap)("k", TypeId::kTypeInt, 1, true, false),
+                                        ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 8, 2, true, false)};
+  std::vector<Column *> right_columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                         ALLOC_COLUMN(heap)("v", TypeId::kTypeInt, 1, true, false)};
+  Schema left_schema(left_columns);
+  Schema right_schema(right_columns);
+  TableInfo *left_info = nullptr, *right_info = nullptr;
+  IndexInfo *left_index = nullptr, *right_index = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("l", &left_schema, nullptr, left_info));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateTable("r", &right_schema, nullptr, right_info));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("l", "l_id", {"id"}, nullptr, left_index));
+  ASSERT_EQ(DB_SUCCESS, engine.catalog_mgr_->CreateIndex("r", "r_id", {"id"}, nullptr, right_index));
+  const int left_rows = 3000, right_rows = 800;
+  for (int i = 0; i < left_rows; i++) {
+    std::string name = "n" + std::to_string(i);
+    InsertRow(left_info, left_index,
+              {Field(TypeId::kTypeInt, i), i % 13 == 0 ? Field(TypeId::kTypeInt) : Field(TypeId::kTypeInt, i % 1000),
+               Field(TypeId::kTypeChar, &name[0], name.size(), true)});
+  }
+  for (int i = 0; i < right_rows; i++) {
+    InsertRow(right_info, right_index, {Field(TypeId::kTypeInt, i * 2), Field(TypeId::kTypeInt, i)});
+  }
+  // the right tuples with v < 600
+  Field bound(TypeId::kTypeInt, 600);
+  ChunkFilter no_filter, right_filter;
+  right_filter.AddCompare(1, kCmpLt, &bound);
+  JoinTable left{left_info->GetTableHeap(), left_info->GetSchema(), &no_filter, {0, 1}};
+  JoinTable right{right_info->GetTableHeap(), right_info->GetSchema(), &right_filter, {0, 1}};
+
+  // l.k = r.id, and l.id = r.id, by nested loops
+  Pairs expected_k, expected_id;
+  for (int i = 0; i < left_rows; i++) {
+    for (int j = 0; j < 600; j++) {
+      if (i % 13 != 0 && i % 1000 == j * 2) expected_k.emplace_back(i, j * 2);
+      if (i == j * 2) expected_id.emplace_back(i, j * 2);
+    }
+  }
+  ASSERT_FALSE(expected_k.empty());
+
+  HashJoin hash_join(std::make_unique<TableScanSource>(left), {0, 1}, right, 0, engine.bpm_);
+  ASSERT_EQ(expected_k, RunJoin(hash_join));
+  ASSERT_FALSE(hash_join.IsPartitioned());
+  // a small budget partitions both sides, the results are the same
+  HashJoin partitioned_join(std::make_unique<TableScanSource>(left), {0, 1}, right, 0, engine.bpm_, 1024);
+  ASSERT_EQ(expected_k, RunJoin(partitioned_join));
+  ASSERT_TRUE(partitioned_join.IsPartitioned());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  ASSERT_FALSE(partitioned_join.HasFailed());
+
+  // with all but a few frames pinned the partitions run out of pages, the join fails
+  std::vector<page_id_t> pinned;
+  page_id_t page_id;
+  while (engine.bpm_->NewPage(page_id) != nullptr) {
+    pinned.push_back(page_id);
+  }
+  for (int i = 0; i < 5; i++) {
+    engine.bpm_->UnpinPage(pinned.back(), false);
+    engine.bpm_->DeletePage(pinned.back());
+    pinned.pop_back();
+  }
+  ASSERT_FALSE(partitioned_join.Run([](const char *, uint32_t) { return true; }));
+  ASSERT_TRUE(partitioned_join.HasFailed());
+  for (auto id : pinned) {
+    engine.bpm_->UnpinPage(id, false);
+    engine.bpm_->DeletePage(id);
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  IndexNestedLoopJoin index_join(std::make_unique<TableScanSource>(left), {0, 1}, right, right_index);
+  ASSERT_EQ(expected_k, RunJoin(index_join));
+
+  MergeJoin merge_join(left, left_index, right, right_index);
+  ASSERT_EQ(expected_id, RunJoin(merge_join));
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+
+  // without a key every pair of tuples is joined
+  Field small(TypeId::kTypeInt, 5);
+  ChunkFilter left_filter;
+  left_filter.AddCompare(0, kCmpLt, &small);
+  JoinTable small_left{left_info->GetTableHeap(), left_info->GetSchema(), &left_filter, {0}};
+  HashJoin cross_join(std::make_unique<TableScanSource>(small_left), {0, 0}, right, HashJoin::NO_KEY, engine.bpm_);
+  ASSERT_EQ(5 * 600, RunJoin(cross_join).size());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
@@ -0,0 +1,76 @@
+#include "common/instance.h"
+#include "executor/parallel_scan.h"
+#include "gtest/gtest.h"
+
+static const std::string db_file_name = "parallel_scan_test.db";
+
+using Fields = std::vector<Field>;
+
+TEST(ParallelScanTest, ScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  for (auto layout : {kLayoutRow, kLayoutPax}) {
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap, layout);
+    std::vector<std::string> names;
+    names.reserve(row_nums);
+    for (int i = 0; i < row_nums; i++) {
+      if (i == row_nums / 2) {
+        ASSERT_LT(1, table_heap->GetPageIds().size());
+      }
+      names.push_back("n" + std::to_string(i % 100));
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names.back()[0], names.back().size(), true),
+                    i % 3 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, (i % 50) * 0.5f)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    // the directory lists the page chain, and picks up pages appended later
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+      page_ids.push_back(page_id);
+      page_id = reinterpret_cast<TablePage *>(engine.bpm_->FetchPage(page_id))->GetNextPageId();
+      engine.bpm_->UnpinPage(page_ids.back(), false);
+    }
+    ASSERT_EQ(page_ids, table_heap->GetPageIds());
+
+    // account >= 10 and name <> "n42"
+    std::string name = "n42";
+    Field account_value(TypeId::kTypeFloat, 10.0f);
+    Field name_value(TypeId::kTypeChar, &name[0], name.size(), false);
+    ChunkFilter filter;
+    uint32_t left = filter.AddCompare(2, kCmpGe, &account_value);
+    filter.AddConnector(true, left, filter.AddCompare(1, kCmpNe, &name_value));
+    std::vector<RowId> expected;
+    std::vector<int32_t> expected_ids;
+    for (auto iter = table_heap->ViewBegin(); !iter.IsEnd(); ++iter) {
+      if (iter->Compare(2, kCmpGe, account_value) == kTrue && iter->Compare(1, kCmpNe, name_value) == kTrue) {
+        expected.push_back(iter->GetRowId());
+        expected_ids.push_back(iter->GetInt(0));
+      }
+    }
+    ASSERT_FALSE(expected.empty());
+
+    ParallelScan scan(table_heap, filter, 4);
+    ASSERT_TRUE(scan.IsWorthwhile());
+    std::vector<RowId> result;
+    scan.Run(result);
+    ASSERT_EQ(expected, result);
+
+    // the tuples come in table order, the consumer can stop the scan
+    std::vector<int32_t> ids;
+    CallbackResultSink sink([&ids](const TupleView &tuple, const std::vector<uint32_t> &columns) {
+      ids.push_back(tuple.GetInt(columns[0]));
+      return ids.size() < 1000;
+    });
+    sink.Begin(schema.get(), {0});
+    scan.Run({0}, sink);
+    sink.End();
+    expected_ids.resize(1000);
+    ASSERT_EQ(expected_ids, ids);
+    table_heap->FreeHeap();
+  }
+}
@@ -0,0 +1,94 @@
+#include <cstring>
+#include <sstream>
+
+#include "common/instance.h"
+#include "executor/result_sink.h"
+#include "gtest/gtest.h"
+
+using Fields = std::vector<Field>;
+
+class ResultSinkTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::vector<Column *> columns = {ALLOC_COLUMN(heap_)("id", TypeId::kTypeInt, 0, false, false),
+                                     ALLOC_COLUMN(heap_)("name", TypeId::kTypeChar, 16, 1, true, false),
+                                     ALLOC_COLUMN(heap_)("score", TypeId::kTypeFloat, 2, true, false)};
+    schema_ = std::make_shared<Schema>(columns);
+    char name[] = {'a', '"', 'b', 'X'};  // not null terminated
+    Fields row_1{Field(kTypeInt, 1), Field(kTypeChar, name, 3, true), Field(kTypeFloat, 0.5f)};
+    Fields row_2{Field(kTypeInt, -2), Field(kTypeChar), Field(kTypeFloat)};
+    rows_.emplace_back(row_1);
+    rows_.emplace_back(row_2);
+  }
+
+  void Run(ResultSink &sink, const std::vector<uint32_t> &columns) {
+    sink.Begin(schema_.get(), columns);
+    for (auto &row : rows_) {
+      if (!sink.ConsumeRow(row)) break;
+    }
+    sink.End();
+  }
+
+  SimpleMemHeap heap_;
+  std::shared_ptr<Schema> schema_;
+  std::vector<Row> rows_;
+};
+
+TEST_F(ResultSinkTest, TextTest) {
+  std::ostringstream out;
+  TextResultSink sink(out);
+  Run(sink, {0, 1, 2});
+  EXPECT_EQ("1\ta\"b\t0.500000\t\n-2\tnull\tnull\t\n", out.str());
+}
+
+TEST_F(ResultSinkTest, CsvTest) {
+  std::ostringstream out;
+  CsvResultSink sink(out);
+  Run(sink, {1, 0});
+  EXPECT_EQ("\"name\",\"id\"\n\"a\"\"b\",1\n,-2\n", out.str());
+}
+
+TEST_F(ResultSinkTest, BinaryTest) {
+  std::ostringstream out;
+  BinaryResultSink sink(out);
+  Run(sink, {0, 1});
+  std::string data = out.str();
+  const char *p = data.data();
+  auto read_u32 = [&p]() {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return value;
+  };
+  ASSERT_EQ(2, read_u32());
+  EXPECT_EQ(kTypeInt, *p++);
+  ASSERT_EQ(2, read_u32());
+  EXPECT_EQ("id", std::string(p, 2));
+  p += 2;
+  EXPECT_EQ(kTypeChar, *p++);
+  ASSERT_EQ(4, read_u32());
+  p += 4;
+  // one block of two rows
+  ASSERT_EQ(2, read_u32());
+  EXPECT_EQ(0, *p++);  // id: no nulls
+  EXPECT_EQ(1, static_cast<int32_t>(read_u32()));
+  EXPECT_EQ(-2, static_cast<int32_t>(read_u32()));
+  EXPECT_EQ(2, *p++);  // name: the second row is null
+  ASSERT_EQ(3, read_u32());
+  EXPECT_EQ("a\"b", std::string(p, 3));
+  p += 3;
+  EXPECT_EQ(0, read_u32());
+  EXPECT_EQ(data.data() + data.size(), p);
+}
+
+TEST_F(ResultSinkTest, CallbackTest) {
+  std::vector<int32_t> ids;
+  CallbackResultSink sink([&ids](const TupleView &tuple, const std::vector<uint32_t> &columns) {
+    EXPECT_EQ(1, columns.size());
+    ids.push_back(tuple.GetInt(columns[0]));
+    return false;  // stop after the first row
+  });
+  Run(sink, {0});
+  ASSERT_EQ(1, ids.size());
+  EXPECT_EQ(1, ids[0]);
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <utility>
+
+#include "executor/rowid_bitmap.h"
+#include "gtest/gtest.h"
+
+using RowIdSet = std::set<std::pair<page_id_t, uint32_t>>;
+
+/**
+ * Random row ids of the pages [0, 40): the even pages get few slots, the odd ones most of their slots.
+ */
+static std::vector<RowId> MakeRowIds(std::mt19937 &random, RowIdSet &set) {
+  std::vector<RowId> row_ids;
+  for (page_id_t page_id = 0; page_id < 40; page_id++) {
+    uint32_t count = page_id % 2 == 0 ? random() % 8 : 300 + random() % 200;
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t slot = random() % 600;
+      row_ids.emplace_back(page_id, slot);
+      set.insert({page_id, slot});
+    }
+  }
+  std::shuffle(row_ids.begin(), row_ids.end(), random);
+  return row_ids;
+}
+
+static RowIdSet ToSet(const RowIdBitmap &bitmap) {
+  std::vector<RowId> row_ids;
+  bitmap.ToRowIds(row_ids);
+  RowIdSet set;
+  for (size_t i = 0; i < row_ids.size(); i++) {
+    if (i > 0) {
+      // in page order
+      EXPECT_TRUE(row_ids[i - 1].GetPageId() < row_ids[i].GetPageId() ||
+                  (row_ids[i - 1].GetPageId() == row_ids[i].GetPageId() &&
+                   row_ids[i - 1].GetSlotNum() < row_ids[i].GetSlotNum()));
+    }
+    set.insert({row_ids[i].GetPageId(), row_ids[i].GetSlotNum()});
+  }
+  return set;
+}
+
+TEST(RowIdBitmapTest, AndOrTest) {
+  std::mt19937 random(7);
+  RowIdSet a_set, b_set, both, either;
+  std::vector<RowId> a_ids = MakeRowIds(random, a_set);
+  std::vector<RowId> b_ids = MakeRowIds(random, b_set);
+  RowIdBitmap a = RowIdBitmap::FromRowIds(a_ids);
+  RowIdBitmap b = RowIdBitmap::FromRowIds(b_ids);
+  ASSERT_EQ(a_set, ToSet(a));
+  ASSERT_EQ(a_set.size(), a.GetCardinality());
+  ASSERT_EQ(b_set, ToSet(b));
+  for (auto &row_id : a_set) {
+    if (b_set.count(row_id) != 0) both.insert(row_id);
+    either.insert(row_id);
+  }
+  either.insert(b_set.begin(), b_set.end());
+  RowIdBitmap a_and_b = a;
+  a_and_b.And(b);
+  ASSERT_EQ(both, ToSet(a_and_b));
+  ASSERT_EQ(both.size(), a_and_b.GetCardinality());
+  RowIdBitmap a_or_b = a;
+  a_or_b.Or(b);
+  ASSERT_EQ(either, ToSet(a_or_b));
+  ASSERT_EQ(either.size(), a_or_b.GetCardinality());
+  // disjoint pages
+  std::vector<RowId> c_ids = {RowId(100, 1), RowId(100, 0), RowId(101, 5), RowId(100, 1)};
+  RowIdBitmap c = RowIdBitmap::FromRowIds(c_ids);
+  ASSERT_EQ(3, c.GetCardinality());
+  ASSERT_EQ(std::vector<page_id_t>({100, 101}), c.GetPageIds());
+  RowIdBitmap empty = c;
+  empty.And(a);
+  ASSERT_TRUE(empty.IsEmpty());
+  c.Or(a);
+  ASSERT_EQ(a_set.size() + 3, c.GetCardinality());
+  ASSERT_EQ(101, c.GetPageIds().back());
+}
+
+TEST(RowIdBitmapTest, SlotBitsTest) {
+  std::mt19937 random(11);
+  RowIdSet set;
+  std::vector<RowId> row_ids = MakeRowIds(random, set);
+  RowIdBitmap bitmap = RowIdBitmap::FromRowIds(row_ids);
+  const std::vector<page_id_t> &pages = bitmap.GetPageIds();
+  uint64_t mask[8];
+  for (uint32_t k = 0; k < pages.size(); k++) {
+    for (uint32_t first : {0u, 512u}) {
+      bitmap.GetSlotBits(k, first, 500, mask);
+      for (uint32_t i = 0; i < 512; i++) {
+        bool expected = i < 500 && set.count({pages[k], first + i}) != 0;
+        ASSERT_EQ(expected, (mask[i / 64] >> (i % 64) & 1) != 0) << pages[k] << " " << first + i;
+      }
+    }
+  }
+}
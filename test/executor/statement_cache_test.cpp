@@ -0,0 +1,101 @@
+#include <cstring>
+
+#include "executor/statement_cache.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+int yyparse(void);
+#include "parser/minisql_lex.h"
+#include "parser/parser.h"
+}
+
+static pSyntaxNode Parse(const char *sql, YY_BUFFER_STATE &bp) {
+  bp = yy_scan_string(sql);
+  yy_switch_to_buffer(bp);
+  MinisqlParserInit();
+  yyparse();
+  return MinisqlParserGetError() ? nullptr : MinisqlGetParserRootNode();
+}
+
+static void ParseFinish(YY_BUFFER_STATE bp) {
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+}
+
+TEST(StatementCacheTest, NormalizeTest) {
+  std::string shape_1, shape_2;
+  std::vector<std::string> literals_1, literals_2;
+  ASSERT_TRUE(StatementCache::Normalize("insert into t1 values(1, \"a b\", -2.5);", shape_1, literals_1));
+  ASSERT_TRUE(StatementCache::Normalize("insert  into t1 values (42,\"x\\\"y\",.5) ;", shape_2, literals_2));
+  EXPECT_EQ(shape_1, shape_2);
+  ASSERT_EQ(3, literals_1.size());
+  EXPECT_EQ("1", literals_1[0]);
+  EXPECT_EQ("a b", literals_1[1]);
+  EXPECT_EQ("-2.5", literals_1[2]);
+  EXPECT_EQ("x\\\"y", literals_2[1]);
+  // a string literal and a number literal give different shapes
+  ASSERT_TRUE(StatementCache::Normalize("select * from t where a = \"1\";", shape_1, literals_1));
+  ASSERT_TRUE(StatementCache::Normalize("select * from t where a = 1;", shape_2, literals_2));
+  EXPECT_NE(shape_1, shape_2);
+  ASSERT_TRUE(StatementCache::Normalize("select * from t where a <> 1;", shape_1, literals_1));
+  EXPECT_NE(shape_1, shape_2);
+  // unterminated string
+  ASSERT_FALSE(StatementCache::Normalize("select * from t where a = \"1;", shape_1, literals_1));
+}
+
+TEST(StatementCacheTest, BindTest) {
+  StatementCache cache;
+  std::string shape;
+  std::vector<std::string> literals;
+  const char *sql = "select * from t where a = 1 and b = \"x\";";
+  ASSERT_TRUE(StatementCache::Normalize(sql, shape, literals));
+  YY_BUFFER_STATE bp;
+  pSyntaxNode ast = Parse(sql, bp);
+  ASSERT_NE(nullptr, ast);
+  CachedStatement *statement = cache.Insert(shape, literals, ast);
+  ParseFinish(bp);
+  ASSERT_NE(nullptr, statement);
+  ASSERT_EQ(statement, cache.Lookup(shape));
+  ASSERT_EQ(2, statement->params_.size());
+
+  ASSERT_TRUE(StatementCache::Normalize("select * from t where a = 77 and b = \"yy\";", shape, literals));
+  ASSERT_EQ(statement, cache.Lookup(shape));
+  statement->Bind(literals);
+  // where -> and -> (= a 77), (= b "yy")
+  pSyntaxNode connector = statement->tree_->child_->next_->next_->child_;
+  EXPECT_STREQ("77", connector->child_->child_->next_->val_);
+  EXPECT_STREQ("yy", connector->child_->next_->child_->next_->val_);
+
+  // only insert and select are cached
+  sql = "create database d;";
+  ASSERT_TRUE(StatementCache::Normalize(sql, shape, literals));
+  ast = Parse(sql, bp);
+  ASSERT_NE(nullptr, ast);
+  EXPECT_EQ(nullptr, cache.Insert(shape, literals, ast));
+  ParseFinish(bp);
+  EXPECT_EQ(1, cache.Size());
+}
+
+TEST(StatementCacheTest, PlanValidTest) {
+  std::string db_file_name = "statement_cache_test.db";
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto *database = new DBStorageEngine(db_file_name, true);
+  TablePlan plan;
+  plan.database_ = database;
+  database->catalog_mgr_->CreateTable("t", schema.get(), nullptr, plan.table_);
+  plan.catalog_version_ = database->catalog_mgr_->GetVersion();
+  ASSERT_TRUE(plan.IsValid(database));
+  delete database;
+  remove(db_file_name.c_str());
+  // a database dropped and created again, the same steps give the new catalog no old version
+  database = new DBStorageEngine(db_file_name, true);
+  TableInfo *table_info = nullptr;
+  database->catalog_mgr_->CreateTable("t", schema.get(), nullptr, table_info);
+  plan.database_ = database;
+  ASSERT_FALSE(plan.IsValid(database));
+  delete database;
+  remove(db_file_name.c_str());
+}
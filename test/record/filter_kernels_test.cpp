@@ -0,0 +1,99 @@
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "record/filter_kernels.h"
+
+static const CompareOp ops[] = {kCmpEq, kCmpNe, kCmpLt, kCmpLe, kCmpGt, kCmpGe};
+
+template <typename T>
+static bool Expected(T v, CompareOp op, T value) {
+  switch (op) {
+    case kCmpEq:
+      return v == value;
+    case kCmpNe:
+      return v != value;
+    case kCmpLt:
+      return v < value;
+    case kCmpLe:
+      return v <= value;
+    case kCmpGt:
+      return v > value;
+    default:
+      return v >= value;
+  }
+}
+
+template <typename T>
+static void CheckSelection(const std::vector<T> &values, CompareOp op, T value, const std::vector<uint64_t> &selection) {
+  for (uint32_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ(Expected(values[i], op, value), (selection[i / 64] >> (i % 64)) & 1) << "value " << i << " op " << op;
+  }
+  // no bits behind the last value
+  if (values.size() % 64 != 0) {
+    ASSERT_EQ(0, selection[values.size() / 64] >> (values.size() % 64));
+  }
+}
+
+TEST(FilterKernelsTest, NumericKernelsTest) {
+  std::mt19937 rng(7);
+  FilterIsa detected = DetectFilterIsa();
+  for (int isa = kFilterScalar; isa <= kFilterAvx2; isa++) {
+    if (!SetFilterIsa(static_cast<FilterIsa>(isa))) {
+      ASSERT_GT(isa, detected);
+      continue;
+    }
+    // odd counts leave a scalar tail behind the vectors
+    for (uint32_t count : {1u, 63u, 64u, 1000u, FILTER_VECTOR_SIZE}) {
+      std::vector<int32_t> ints(count);
+      std::vector<float> floats(count);
+      for (uint32_t i = 0; i < count; i++) {
+        ints[i] = static_cast<int32_t>(rng() % 100) - 50;
+        floats[i] = static_cast<float>(ints[i]) / 4;
+      }
+      std::vector<uint64_t> selection(SelectionWords(count), ~uint64_t(0));
+      for (auto op : ops) {
+        FilterInt(ints.data(), count, op, 3, selection.data());
+        CheckSelection(ints, op, 3, selection);
+        FilterFloat(floats.data(), count, op, 0.75f, selection.data());
+        CheckSelection(floats, op, 0.75f, selection);
+      }
+    }
+  }
+  ASSERT_TRUE(SetFilterIsa(detected));
+}
+
+TEST(FilterKernelsTest, CharKernelTest) {
+  std::vector<std::string> strings = {"", "a", "ab", "abc", "abd", "b", "ab", "aa"};
+  std::vector<const char *> values;
+  std::vector<uint16_t> lengths;
+  for (auto &s : strings) {
+    values.push_back(s.data());
+    lengths.push_back(s.size());
+  }
+  std::vector<uint64_t> selection(1);
+  for (auto op : ops) {
+    FilterChar(values.data(), lengths.data(), strings.size(), op, "ab", 2, selection.data());
+    CheckSelection(strings, op, std::string("ab"), selection);
+  }
+}
+
+TEST(FilterKernelsTest, FilterVectorTest) {
+  ColumnVector vector;
+  vector.type_ = kTypeInt;
+  vector.count_ = 100;
+  vector.ints_ = vector.buffer_.ints;
+  for (uint32_t i = 0; i < vector.count_; i++) {
+    vector.buffer_.ints[i] = i;
+  }
+  // even values are null
+  memset(vector.valid_, 0xaa, sizeof(vector.valid_));
+  uint64_t selection[FILTER_VECTOR_SIZE / 64];
+  FilterVector(vector, kCmpLt, Field(kTypeInt, 10), selection);
+  std::vector<uint32_t> selected;
+  ForEachSelected(selection, vector.count_, [&selected](uint32_t i) { selected.push_back(i); });
+  ASSERT_EQ(std::vector<uint32_t>({1, 3, 5, 7, 9}), selected);
+  FilterVector(vector, kCmpLt, Field(kTypeInt), selection);
+  ASSERT_EQ(0, selection[0] | selection[1]);
+}
@@ -119,6 +119,121 @@ TEST(TupleTest, RowTest) {
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
 }
 
+TEST(TupleTest, ArenaRowTest) {
+  ArenaMemHeap arena(64);
+  // small blocks, large allocations get their own block
+  char *first = static_cast<char *>(arena.Allocate(10));
+  char *large = static_cast<char *>(arena.Allocate(1000));
+  memset(large, 1, 1000);
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(large) % alignof(std::max_align_t));
+  arena.Reset();
+  ASSERT_EQ(first, arena.Allocate(10));
+
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name = "arena";
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 7), Field(TypeId::kTypeChar, &name[0], name.size(), false)};
+  Row row(fields);
+  // the row keeps its own copy of the chars
+  name[0] = 'X';
+  ASSERT_EQ(std::string("arena"), std::string(row.GetField(1)->GetData(), row.GetField(1)->GetLength()));
+  char buf[PAGE_SIZE];
+  row.SerializeTo(buf, schema.get());
+
+  // rows deserialized into a shared arena, released at once by the owner of the arena
+  for (int i = 0; i < 3; i++) {
+    arena.Reset();
+    Row scan_row(RowId(0, i), &arena);
+    scan_row.DeserializeFrom(buf, schema.get());
+    Row copy = scan_row;
+    ASSERT_EQ(CmpBool::kTrue, copy.GetField(0)->CompareEquals(*row.GetField(0)));
+    ASSERT_EQ(CmpBool::kTrue, copy.GetField(1)->CompareEquals(*row.GetField(1)));
+    // deserializing again replaces the fields
+    scan_row.DeserializeFrom(buf, schema.get());
+    ASSERT_EQ(2, scan_row.GetFieldCount());
+  }
+  Field renamed(TypeId::kTypeChar, const_cast<char *>("heap"), 4, false);
+  row.SetField(1, renamed);
+  ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(renamed));
+}
+
+TEST(TupleTest, RowMoveTest) {
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar, const_cast<char *>("move"), 4, false)};
+  std::vector<Row> rows;
+  for (int i = 0; i < 100; i++) {
+    rows.emplace_back(fields);
+  }
+  Field *name = rows[0].GetField(1);
+  // moving keeps the fields where they are
+  Row moved(std::move(rows[0]));
+  ASSERT_EQ(name, moved.GetField(1));
+  ASSERT_EQ(0, rows[0].GetFieldCount());
+  rows[1] = std::move(moved);
+  ASSERT_EQ(name, rows[1].GetField(1));
+  // a moved-from row can be filled again
+  moved = rows[2];
+  ASSERT_EQ(CmpBool::kTrue, moved.GetField(1)->CompareEquals(fields[1]));
+  ASSERT_NE(rows[2].GetField(1), moved.GetField(1));
+}
+
+TEST(TupleTest, CompactRowTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false),
+          ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 16, 3, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeInt, 188),
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+          Field(TypeId::kTypeFloat),
+          Field(TypeId::kTypeChar, const_cast<char *>("db"), strlen("db"), false)
+  };
+  Row row(fields);
+  char buf[PAGE_SIZE];
+  // version, 1 byte null bitmap, 4 slots, 9 bytes of chars
+  uint32_t size = row.SerializeTo(buf, schema.get());
+  ASSERT_EQ(row.GetSerializedSize(schema.get()), size);
+  ASSERT_EQ(1 + 1 + 4 * 4 + 9, size);
+  ASSERT_FALSE(Row::IsLegacyFormat(buf));
+  ASSERT_EQ(1 << 2, buf[1]);
+  ASSERT_EQ(188, MACH_READ_INT32(buf + Row::SlotOffset(4, 0)));
+  ASSERT_EQ(Row::SlotOffset(4, 4) + 7, MACH_READ_FROM(uint16_t, buf + Row::SlotOffset(4, 3)));
+  Row row2(INVALID_ROWID);
+  ASSERT_EQ(size, row2.DeserializeFrom(buf, schema.get()));
+  ASSERT_EQ(4, row2.GetFieldCount());
+  ASSERT_TRUE(row2.GetField(2)->IsNull());
+  for (size_t i : {0, 1, 3}) {
+    ASSERT_EQ(CmpBool::kTrue, row2.GetField(i)->CompareEquals(fields[i]));
+  }
+
+  // legacy format: magic, field count, null flags, then the non-null fields
+  char *p = buf;
+  MACH_WRITE_UINT32(p, 1055820);
+  MACH_WRITE_UINT32(p + 4, 4);
+  p += 8;
+  for (bool is_null : {false, false, true, false}) {
+    MACH_WRITE_TO(bool, p, is_null);
+    p += sizeof(bool);
+  }
+  for (size_t i : {0, 1, 3}) {
+    p += fields[i].SerializeTo(p);
+  }
+  ASSERT_TRUE(Row::IsLegacyFormat(buf));
+  Row row3(INVALID_ROWID);
+  ASSERT_EQ(p - buf, row3.DeserializeFrom(buf, schema.get()));
+  ASSERT_TRUE(row3.GetField(2)->IsNull());
+  for (size_t i : {0, 1, 3}) {
+    ASSERT_EQ(CmpBool::kTrue, row3.GetField(i)->CompareEquals(fields[i]));
+  }
+}
+
 TEST(TupleTest, ColTest) {
   SimpleMemHeap heap;
   TablePage table_page;
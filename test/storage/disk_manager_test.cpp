@@ -55,4 +55,41 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+TEST(DiskManagerTest, BulkPageDeAllocationTest) {
+  std::string db_name = "disk_test.db";
+  remove(db_name.c_str());
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  int extent_nums = 3;
+  for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE * extent_nums; i++) {
+    disk_mgr->AllocatePage();
+  }
+  // the whole second extent, pages of the others in any order, duplicates and already free pages
+  std::vector<page_id_t> pages;
+  for (uint32_t i = DiskManager::BITMAP_SIZE; i < 2 * DiskManager::BITMAP_SIZE; i++) {
+    pages.push_back(i);
+  }
+  pages.push_back(2 * DiskManager::BITMAP_SIZE + 7);
+  pages.push_back(3);
+  pages.push_back(3);
+  pages.push_back(0);
+  disk_mgr->DeAllocatePage(0);
+  disk_mgr->DeAllocatePages(pages);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE - DiskManager::BITMAP_SIZE - 3, meta_page->GetAllocatedPages());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
+  EXPECT_EQ(0, meta_page->GetExtentUsedPage(1));
+  EXPECT_EQ(DiskManager::BITMAP_SIZE - 1, meta_page->GetExtentUsedPage(2));
+  // an empty extent keeps its bitmap page
+  EXPECT_EQ(extent_nums, meta_page->GetExtentNums());
+  EXPECT_TRUE(disk_mgr->IsPageFree(3));
+  EXPECT_FALSE(disk_mgr->IsPageFree(4));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::BITMAP_SIZE + 5));
+  EXPECT_TRUE(disk_mgr->IsPageFree(2 * DiskManager::BITMAP_SIZE + 7));
+  // freed pages are handed out again
+  page_id_t page_id = disk_mgr->AllocatePage();
+  EXPECT_TRUE(page_id == 0 || page_id == 3);
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -228,3 +228,425 @@ TEST(TableHeapTest, TableHeapIteratorTest) {
   table_heap->FreeHeap();
   // std::cout << "Success" << endl;
 }
+
+TEST(TableHeapTest, TableHeapAppendTuplesTest) {
+  // init testing instance
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 1000;
+  const int batch_size = 300;
+  // create schema
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::vector<Fields *> row_values;
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    int32_t len = RandomUtils::RandomInt(0, 64);
+    char *characters = new char[len];
+    RandomUtils::RandomString(characters, len);
+    Fields *fields =
+        new Fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(characters), len, true),
+                   Field(TypeId::kTypeFloat, RandomUtils::RandomFloat(-999.f, 999.f))};
+    row_values.push_back(fields);
+    rows.emplace_back(*fields);
+    delete[] characters;
+    // mix appended batches with single inserts, which may chain pages behind the append hint
+    if (rows.size() == batch_size || i == row_nums - 1) {
+      ASSERT_TRUE(table_heap->AppendTuples(rows, nullptr));
+      rows.clear();
+      Row row(*row_values[0]);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+  }
+
+  // the appended rows come back in insertion order, behind the single inserts
+  int i = 0;
+  for (TableIterator iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++) {
+    if (iter->GetField(0)->CompareEquals(row_values[0]->at(0)) == CmpBool::kTrue && i != 0) {
+      continue;
+    }
+    ASSERT_LT(i, row_nums);
+    for (size_t j = 0; j < schema.get()->GetColumnCount(); j++) {
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(j)->CompareEquals(row_values[i]->at(j)));
+    }
+    i++;
+  }
+  ASSERT_EQ(row_nums, i);
+  for (auto fields : row_values) {
+    delete fields;
+  }
+  table_heap->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapViewIteratorTest) {
+  // init testing instance
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 2000;
+  // create schema
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::vector<std::string> names;
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    names.push_back(std::to_string(i * 7));
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names.back()[0], names.back().size(), true),
+                  i % 3 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 0.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // deleted tuples are skipped
+  for (int i = 0; i < row_nums; i += 5) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+
+  Field bound(TypeId::kTypeInt, 1000);
+  int count = 0;
+  int less = 0;
+  int expected = 1;
+  for (auto iter = table_heap->ViewBegin(); !iter.IsEnd(); ++iter) {
+    if (expected % 5 == 0) expected++;
+    ASSERT_EQ(rids[expected], iter->GetRowId());
+    ASSERT_EQ(expected, iter->GetInt(0));
+    ASSERT_EQ(names[expected], std::string(iter->GetChars(1), iter->GetCharLength(1)));
+    ASSERT_EQ(expected % 3 == 0, iter->IsNull(2));
+    if (!iter->IsNull(2)) {
+      ASSERT_EQ(expected * 0.5f, iter->GetFloat(2));
+    }
+    ASSERT_EQ(expected % 3 == 0 ? CmpBool::kNull : CmpBool::kFalse,
+              iter->Compare(2, kCmpLt, Field(TypeId::kTypeFloat, -1.f)));
+    if (iter->Compare(0, kCmpLt, bound) == CmpBool::kTrue) less++;
+    // a materialized row outlives the page
+    if (expected == 1) {
+      Row row(INVALID_ROWID);
+      iter->Materialize(&row);
+      ASSERT_EQ(rids[1], row.GetRowId());
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(Field(TypeId::kTypeChar, &names[1][0], 1, false)));
+    }
+    count++;
+    expected++;
+  }
+  ASSERT_EQ(row_nums - row_nums / 5, count);
+  ASSERT_EQ(800, less);
+
+  // a fetch of some row ids visits them in their order, the deleted ones are skipped
+  std::vector<RowId> fetched;
+  std::vector<int> expected_ids;
+  for (int i = 0; i < row_nums; i += 3) {
+    fetched.push_back(rids[i]);
+    if (i % 5 != 0) expected_ids.push_back(i);
+  }
+  std::vector<int> fetched_ids;
+  for (auto iter = table_heap->FetchBegin(fetched); !iter.IsEnd(); ++iter) {
+    ASSERT_EQ(rids[iter->GetInt(0)], iter->GetRowId());
+    ASSERT_EQ(names[iter->GetInt(0)], std::string(iter->GetChars(1), iter->GetCharLength(1)));
+    fetched_ids.push_back(iter->GetInt(0));
+  }
+  ASSERT_EQ(expected_ids, fetched_ids);
+  table_heap->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapPaxTest) {
+  // init testing instance
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 2000;
+  // create schema
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap, kLayoutPax);
+  ASSERT_EQ(kLayoutPax, table_heap->GetLayout());
+  std::vector<std::string> names;
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    names.push_back(std::to_string(i * 7));
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names.back()[0], names.back().size(), true),
+                  i % 3 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 0.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // a char value longer than its column does not fit into the minipage
+  std::string long_name(17, 'x');
+  Fields long_fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, &long_name[0], 17, true),
+                     Field(TypeId::kTypeFloat, 1.f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+
+  for (int i = 0; i < row_nums; i += 5) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  // updates stay in place
+  for (int i = 1; i < row_nums; i += 10) {
+    names[i] = "u" + names[i];
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names[i][0], names[i].size(), true),
+                  Field(TypeId::kTypeFloat, i * 0.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, rids[i], nullptr));
+    ASSERT_EQ(rids[i], row.GetRowId());
+  }
+
+  Row row(rids[11]);
+  ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, row.GetField(1)->CompareEquals(Field(TypeId::kTypeChar, &names[11][0], 3, false)));
+  row.SetRowId(rids[10]);
+  ASSERT_FALSE(table_heap->GetTuple(&row, nullptr));
+
+  // only the projected column is read, the other ones are null
+  std::vector<uint32_t> projection{1};
+  int count = 0;
+  int expected = 1;
+  for (auto iter = table_heap->ViewBegin(&projection); !iter.IsEnd(); ++iter) {
+    if (expected % 5 == 0) expected++;
+    ASSERT_EQ(rids[expected], iter->GetRowId());
+    ASSERT_TRUE(iter->IsNull(0));
+    ASSERT_TRUE(iter->IsNull(2));
+    ASSERT_EQ(names[expected], std::string(iter->GetChars(1), iter->GetCharLength(1)));
+    count++;
+    expected++;
+  }
+  ASSERT_EQ(row_nums - row_nums / 5, count);
+
+  // a reloaded heap reads the same tuples, a freed slot is reused
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                          &heap, kLayoutPax);
+  Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, &names[0][0], 1, true),
+                Field(TypeId::kTypeFloat, 1.f)};
+  Row new_row(fields);
+  ASSERT_TRUE(reloaded->InsertTuple(new_row, nullptr));
+  ASSERT_EQ(rids[0], new_row.GetRowId());
+  count = 0;
+  for (TableIterator iter = reloaded->Begin(nullptr); iter != reloaded->End(); iter++) {
+    ASSERT_EQ(schema->GetColumnCount(), iter->GetFieldCount());
+    if (count == 0) {
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, row_nums)));
+    }
+    count++;
+  }
+  ASSERT_EQ(row_nums - row_nums / 5 + 1, count);
+  reloaded->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapFilterScanTest) {
+  // init testing instance
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 3000;
+  // create schema
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  for (auto layout : {kLayoutRow, kLayoutPax}) {
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap, layout);
+    std::vector<std::string> names;
+    std::vector<RowId> rids;
+    for (int i = 0; i < row_nums; i++) {
+      names.push_back("n" + std::to_string(i % 100));
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names.back()[0], names.back().size(), true),
+                    i % 3 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, (i % 50) * 0.5f)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      rids.push_back(row.GetRowId());
+    }
+    for (int i = 0; i < row_nums; i += 7) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      table_heap->ApplyDelete(rids[i], nullptr);
+    }
+    // the vectorized scan finds the same tuples as comparing every view
+    std::string name = "n42";
+    Fields values{Field(TypeId::kTypeInt, 1234), Field(TypeId::kTypeChar, &name[0], name.size(), true),
+                  Field(TypeId::kTypeFloat, 12.5f)};
+    for (uint32_t column = 0; column < values.size(); column++) {
+      for (auto op : {kCmpEq, kCmpNe, kCmpLt, kCmpGe}) {
+        std::vector<RowId> expected;
+        for (auto iter = table_heap->ViewBegin(); !iter.IsEnd(); ++iter) {
+          if (iter->Compare(column, op, values[column]) == kTrue) {
+            expected.push_back(iter->GetRowId());
+          }
+        }
+        std::vector<RowId> result;
+        table_heap->FilterScan(column, op, values[column], result);
+        ASSERT_FALSE(expected.empty());
+        ASSERT_EQ(expected, result);
+      }
+    }
+    table_heap->FreeHeap();
+  }
+}
+
+TEST(TableHeapTest, TableHeapPageDirectoryTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 1000, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  // enough pages to fill more than one directory page
+  std::string name(1000, 'x');
+  std::vector<Row> rows;
+  for (uint32_t i = 0; i < 5 * TableDirectoryPage::MAX_PAGE_COUNT; i++) {
+    Fields fields{Field(TypeId::kTypeInt, static_cast<int32_t>(i)),
+                  Field(TypeId::kTypeChar, &name[0], name.size(), false)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_TRUE(table_heap->AppendTuples(rows, nullptr));
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+    page_ids.push_back(page_id);
+    page_id = reinterpret_cast<TablePage *>(engine.bpm_->FetchPage(page_id))->GetNextPageId();
+    engine.bpm_->UnpinPage(page_ids.back(), false);
+  }
+  ASSERT_LT(TableDirectoryPage::MAX_PAGE_COUNT, page_ids.size());
+  ASSERT_EQ(page_ids, table_heap->GetPageIds());
+
+  // a reloaded heap reads the directory instead of the chain
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                          &heap, kLayoutRow, table_heap->GetDirectoryPageId());
+  ASSERT_EQ(page_ids.size(), reloaded->GetPageCount());
+  ASSERT_EQ(page_ids.back(), reloaded->GetPageId(page_ids.size() - 1));
+  ASSERT_EQ(page_ids, reloaded->GetPageIds());
+
+  // a heap written without a directory gets one
+  TableHeap *old_heap =
+      TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr, &heap);
+  ASSERT_EQ(INVALID_PAGE_ID, old_heap->GetDirectoryPageId());
+  page_id_t directory_page_id = old_heap->BuildPageDirectory();
+  ASSERT_NE(INVALID_PAGE_ID, directory_page_id);
+  reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr, &heap,
+                               kLayoutRow, directory_page_id);
+  ASSERT_EQ(page_ids, reloaded->GetPageIds());
+  table_heap->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapTruncateTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 1000, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::string name(1000, 'x');
+  std::vector<Row> rows;
+  for (uint32_t i = 0; i < 5 * TableDirectoryPage::MAX_PAGE_COUNT; i++) {
+    Fields fields{Field(TypeId::kTypeInt, static_cast<int32_t>(i)),
+                  Field(TypeId::kTypeChar, &name[0], name.size(), false)};
+    rows.emplace_back(fields);
+  }
+  ASSERT_TRUE(table_heap->AppendTuples(rows, nullptr));
+  std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+  ASSERT_LT(TableDirectoryPage::MAX_PAGE_COUNT, page_ids.size());
+
+  table_heap->Truncate(nullptr);
+  ASSERT_EQ(std::vector<page_id_t>({table_heap->GetFirstPageId()}), table_heap->GetPageIds());
+  ASSERT_TRUE(table_heap->Begin(nullptr) == table_heap->End());
+  for (size_t i = 1; i < page_ids.size(); i++) {
+    ASSERT_TRUE(engine.bpm_->IsPageFree(page_ids[i]));
+  }
+
+  // the truncated heap is filled again, a reload sees the same pages through the kept directory page
+  rows.erase(rows.begin() + 10, rows.end());
+  ASSERT_TRUE(table_heap->AppendTuples(rows, nullptr));
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                          &heap, kLayoutRow, table_heap->GetDirectoryPageId());
+  ASSERT_EQ(table_heap->GetPageIds(), reloaded->GetPageIds());
+  uint32_t count = 0;
+  for (auto iter = reloaded->Begin(nullptr); iter != reloaded->End(); iter++) {
+    ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, static_cast<int32_t>(count++))));
+  }
+  ASSERT_EQ(10, count);
+  table_heap->FreeHeap();
+}
+
+TEST(TableHeapTest, TableHeapVacuumTest) {
+  for (TableLayout layout : {kLayoutRow, kLayoutPax}) {
+    DBStorageEngine engine(db_file_name);
+    SimpleMemHeap heap;
+    const int row_nums = 3000;
+    std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                     ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap, layout);
+    std::vector<std::string> names;
+    std::vector<Row> rows;
+    for (int i = 0; i < row_nums; i++) {
+      names.emplace_back(i % 64, 'a' + i % 26);
+    }
+    for (int i = 0; i < row_nums; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, &names[i][0], names[i].size(), false)};
+      rows.emplace_back(fields);
+    }
+    ASSERT_TRUE(table_heap->AppendTuples(rows, nullptr));
+    // sparse runs of pages, a run of empty pages, deletes applied or only marked
+    std::unordered_map<int64_t, int> ids;
+    for (int i = 0; i < row_nums; i++) {
+      bool kept = (i % 5 == 0 || (i / 200) % 3 == 0) && (i < 1000 || i >= 1400);
+      if (kept) {
+        ids[rows[i].GetRowId().Get()] = i;
+        continue;
+      }
+      table_heap->MarkDelete(rows[i].GetRowId(), nullptr);
+      if (i % 2 == 0) table_heap->ApplyDelete(rows[i].GetRowId(), nullptr);
+    }
+    std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+
+    std::vector<std::pair<RowId, RowId>> moved;
+    uint32_t freed = table_heap->Vacuum(moved, nullptr);
+    ASSERT_LT(0, freed);
+    ASSERT_EQ(page_ids.size() - freed, table_heap->GetPageCount());
+    std::unordered_map<int64_t, int> moved_ids;
+    for (auto &move : moved) {
+      ASSERT_EQ(1, ids.count(move.first.Get()));
+      moved_ids[move.second.Get()] = ids[move.first.Get()];
+      ids.erase(move.first.Get());
+    }
+    for (auto &moved_id : moved_ids) {
+      ASSERT_EQ(0, ids.count(moved_id.first));
+      ids.insert(moved_id);
+    }
+    uint32_t count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++) {
+      ASSERT_EQ(1, ids.count(iter->GetRowId().Get()));
+      int i = ids[iter->GetRowId().Get()];
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(1)->CompareEquals(
+                                    Field(TypeId::kTypeChar, &names[i][0], names[i].size(), false)));
+      count++;
+    }
+    ASSERT_EQ(ids.size(), count);
+
+    // the chain, the directory and the disk agree on the kept pages
+    std::vector<page_id_t> chain;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+      chain.push_back(page_id);
+      page_id = reinterpret_cast<TablePage *>(engine.bpm_->FetchPage(page_id))->GetNextPageId();
+      engine.bpm_->UnpinPage(chain.back(), false);
+    }
+    ASSERT_EQ(chain, table_heap->GetPageIds());
+    TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr, nullptr,
+                                            &heap, layout, table_heap->GetDirectoryPageId());
+    ASSERT_EQ(chain, reloaded->GetPageIds());
+    uint32_t free_count = 0;
+    for (auto page_id : page_ids) {
+      free_count += engine.bpm_->IsPageFree(page_id) ? 1 : 0;
+    }
+    ASSERT_EQ(freed, free_count);
+
+    // a vacuumed heap is left as it is
+    moved.clear();
+    ASSERT_EQ(0, table_heap->Vacuum(moved, nullptr));
+    ASSERT_TRUE(moved.empty());
+    table_heap->FreeHeap();
+  }
+}